@@ -21,6 +21,13 @@
  */
 #define DEBUG_LEVEL 3 // Opšti nivo debagovanja
 
+/**
+ * @brief Hex ispis RS485 okvira na Serial (RAW prijem, timeout, payload logova).
+ * @details 0 = isključeno; okviri se uvijek bilježe u Rs485Trace i čitaju preko
+ *          /rs485_trace. 1 = dodatno ispisuj svaki okvir na Serial (sporo, ~ms po okviru).
+ */
+#define RS485_SERIAL_TRACE 0
+
 /**
  * @brief Macro za ispis debug poruka.
  * 
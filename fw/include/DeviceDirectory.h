@@ -0,0 +1,90 @@
+/**
+ ******************************************************************************
+ * @file    DeviceDirectory.h
+ * @author  Gemini & [Vase Ime]
+ * @brief   Direktorij uređaja: adresa -> bus, protokol, flagovi.
+ *
+ * @note
+ * Gradi se jednom u setup()-u nad učitanim L/R listama (LogPullManager::BuildDeviceTables)
+ * kao sortiran niz sa binarnom pretragom (max 500 uređaja, ~9 poređenja).
+ * Zamjenjuje linearno skeniranje obje liste pri svakom određivanju busa i
+ * protokola. Protokol i flagovi se osvježavaju (RefreshProtocols) kada se
+ * protokol busa promijeni preko HTTP-a, bez ponovnog učitavanja lista.
+ ******************************************************************************
+ */
+
+#ifndef DEVICE_DIRECTORY_H
+#define DEVICE_DIRECTORY_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include "ProjectConfig.h"
+
+// Flagovi uređaja
+#define DEVICE_FLAG_HILLS       0x01    // HILLS protokol (posebne komande i timeouti)
+#define DEVICE_FLAG_DUPLICATE   0x02    // Adresa je u obje liste (vrijedi Lijevi bus)
+
+#define DEVICE_BUS_UNKNOWN      0xFF    // Adresa nije u L/R listama
+
+/**
+ * @brief Jedan uređaj u direktoriju.
+ */
+struct DeviceInfo
+{
+    uint16_t address;
+    uint8_t bus;        ///< 0 = Lijevi, 1 = Desni, DEVICE_BUS_UNKNOWN
+    uint8_t protocol;   ///< ProtocolVersion busa
+    uint8_t flags;      ///< DEVICE_FLAG_*
+};
+
+class DeviceDirectory
+{
+public:
+    DeviceDirectory();
+
+    /**
+     * @brief Gradi direktorij iz L/R listi adresa (briše prethodni sadržaj).
+     * @details Duplikati: vrijedi prvo pojavljivanje (Lijevi bus), kao ranije.
+     */
+    void Build(const uint16_t* list_L, uint16_t count_L, const uint16_t* list_R, uint16_t count_R);
+
+    /**
+     * @brief Ponovo razrješava protokol i flagove svih uređaja iz g_appConfig.
+     * @details Poziva se nakon promjene protocol_version_L/R.
+     */
+    void RefreshProtocols();
+
+    /**
+     * @brief Pronalazi uređaj (binarna pretraga).
+     * @param address Adresa uređaja.
+     * @param out Podaci uređaja; za nepoznatu adresu bus = DEVICE_BUS_UNKNOWN
+     *            i protokol Lijevog busa (kao single bus mode).
+     * @return true ako je adresa u L/R listama.
+     */
+    bool Lookup(uint16_t address, DeviceInfo* out);
+
+    /**
+     * @brief Bus za adresu (0=Lijevi, 1=Desni, -1=Nepoznato).
+     */
+    int8_t GetBus(uint16_t address);
+
+    /**
+     * @brief Protokol za adresu (nepoznata adresa -> protokol Lijevog busa).
+     */
+    ProtocolVersion GetProtocol(uint16_t address);
+
+    uint16_t GetCount() const { return m_count; }
+
+private:
+    const DeviceInfo* Find(uint16_t address) const;
+    static void ResolveProtocol(DeviceInfo* info);
+
+    DeviceInfo m_entries[2 * MAX_ADDRESS_LIST_SIZE_PER_BUS];  ///< Sortirano po adresi
+    uint16_t m_count;
+    DeviceInfo m_default;   ///< Vraća se za adrese van listi
+    portMUX_TYPE m_lock;
+};
+
+extern DeviceDirectory g_deviceDirectory;
+
+#endif // DEVICE_DIRECTORY_H
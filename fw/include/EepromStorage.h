@@ -15,6 +15,8 @@
 
 #include <Arduino.h>
 #include <Wire.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
 #include "ProjectConfig.h"
 
 /**
@@ -68,6 +70,9 @@ struct AppConfig
     
     // NEW: WiFi Configuration
     bool use_wifi_as_primary;                ///< true = WiFi primarni interfejs, false = Ethernet (default)
+
+    // NEW: Ožičenje dual bus moda
+    uint8_t rs485_wiring_mode;               ///< RS485_WIRING_SHARED_RX (default) ili RS485_WIRING_DUAL_UART
 };
 
 /**
@@ -200,6 +205,28 @@ public:
      */
     LoggerStatus WriteLog(const LogEntry* entry);
 
+    /**
+     * @brief Dodaje log u RAM bafer za grupni upis (bez upisa u EEPROM).
+     * @details Pun bafer se automatski upisuje. Log nije trajan (niti vidljiv
+     *          u GetLogCount()) dok FlushLogs() ne vrati LOGGER_OK.
+     * @param entry Pointer na LogEntry strukturu.
+     * @return Status operacije (greška samo ako automatski upis ne uspije).
+     */
+    LoggerStatus StageLog(const LogEntry* entry);
+
+    /**
+     * @brief Upisuje logove iz RAM bafera u uzastopne slotove od head-a.
+     * @details Uzastopni logovi idu u upise cijelih stranica, a metapodaci se
+     *          upisuju jednom za cijeli bafer.
+     * @return Status operacije (kod greške su svi logovi iz bafera odbačeni).
+     */
+    LoggerStatus FlushLogs();
+
+    /**
+     * @brief Odbacuje logove iz RAM bafera bez upisa (nakon greške StageLog()).
+     */
+    void DiscardStagedLogs();
+
     /**
      * @brief Dohvata najstariji log unos.
      * @param entry Pointer na LogEntry strukturu gdje ce se upisati podaci.
@@ -215,12 +242,14 @@ public:
 
     /**
      * @brief Brise blok logova (pomjera tail).
+     * @details Upisuju se samo metapodaci logera; slotovi logova se ne nuliraju.
      * @return Status operacije.
      */
     LoggerStatus DeleteLogBlock();
 
     /**
-     * @brief Brise sve logove (resetuje head i tail).
+     * @brief Brise sve logove (tail = head).
+     * @details Konstantno vrijeme - jedan upis metapodataka, slotovi se ne nuliraju.
      * @return Status operacije.
      */
     LoggerStatus ClearAllLogs();
@@ -239,36 +268,97 @@ private:
     void MigrateConfig(uint16_t oldVersion);
 
     /**
-     * @brief Inicijalizuje logger varijable skeniranjem EEPROM-a.
+     * @brief Inicijalizuje logger varijable iz metapodataka (A/B slot).
+     * @details Skeniranje EEPROM-a (LoggerScan) samo kada nijedan slot nije validan.
      */
     void LoggerInit(); 
 
+    /**
+     * @brief Inicijalizuje logger varijable skeniranjem EEPROM-a.
+     */
+    void LoggerScan();
+
+    /**
+     * @brief Učitava head/tail/count iz novijeg validnog slota metapodataka.
+     * @return true ako je bar jedan slot validan.
+     */
+    bool LoadLoggerMeta();
+
+    /**
+     * @brief Upisuje head/tail/count u stariji slot metapodataka.
+     * @return true ako je upis uspješan.
+     */
+    bool SaveLoggerMeta();
+
+    /**
+     * @brief Čita uzastopne log slotove prstena direktno u bafer pozivaoca.
+     * @details Preko kraja log područja se nastavlja od slota 0 (dva čitanja);
+     *          svaki dio ide u što manje I2C transakcija (ReadBytes).
+     * @param first_index Indeks prvog slota.
+     * @param count Broj slotova.
+     * @param dest Bafer od najmanje count * LOG_ENTRY_SIZE bajtova.
+     * @return true ako je čitanje uspješno.
+     */
+    bool ReadLogRange(uint16_t first_index, uint16_t count, uint8_t* dest);
+
     /**
      * @brief Ucitava podrazumijevanu konfiguraciju.
      */
     void LoadDefaultConfig();
 
+    /**
+     * @brief Bira I2C takt pri inicijalizaciji (Fm+ sa provjerom, inače rezervni).
+     */
+    void SelectI2cClock();
+
+    /**
+     * @brief Prelazi sa Fm+ na rezervni I2C takt nakon greške.
+     * @return true ako je takt spušten i transakciju treba ponoviti.
+     */
+    bool LowerI2cClock();
+
+    /**
+     * @brief Čeka kraj ciklusa upisa EEPROM-a (ACK polling, zadatak spava između ping-ova).
+     * @return true kad uređaj potvrdi adresu, false nakon EEPROM_ACK_POLL_TIMEOUT_MS.
+     */
+    bool WaitForWriteCycle(uint8_t device_addr);
+
+    /**
+     * @brief Oporavak nakon neuspjele I2C transakcije.
+     * @details NACK: čeka se kraj ciklusa upisa, takt ostaje. Takt se spušta samo
+     *          na grešku magistrale ili kad uređaj ne odgovori ni nakon ACK polling-a.
+     * @param error Kod iz Wire.endTransmission() ili I2C_ERROR_SHORT_READ.
+     * @return true ako transakciju treba ponoviti.
+     */
+    bool RecoverI2cError(uint8_t device_addr, uint8_t error);
+
     /**
      * @brief Pise niz bajtova na zadatu adresu u EEPROM-u.
-     * @param address Pocetna adresa u EEPROM-u.
+     * @details Tokom ciklusa upisa (ACK polling) zadatak spava, ne vrti I2C bus.
+     * @param address Pocetna adresa u EEPROM-u (17-bit, 0x00000-0x1FFFF).
      * @param data Pointer na podatke.
      * @param length Duzina podataka.
      * @return true ako je upis uspjesan, false inace.
      */
-    bool WriteBytes(uint16_t address, const uint8_t* data, uint16_t length);
+    bool WriteBytes(uint32_t address, const uint8_t* data, uint16_t length);
 
     /**
      * @brief Cita niz bajtova sa zadate adrese iz EEPROM-a.
-     * @param address Pocetna adresa u EEPROM-u.
+     * @param address Pocetna adresa u EEPROM-u (17-bit, 0x00000-0x1FFFF).
      * @param data Buffer za smjestanje procitanih podataka.
      * @param length Duzina podataka za citanje.
      * @return true ako je citanje uspjesno, false inace.
      */
-    bool ReadBytes(uint16_t address, uint8_t* data, uint16_t length);
+    bool ReadBytes(uint32_t address, uint8_t* data, uint16_t length);
 
+    SemaphoreHandle_t m_mutex;  ///< Rekurzivni mutex: I2C + head/tail (LogWriter zadatak i HTTP)
     uint16_t m_log_write_index; ///< 'head' index
     uint16_t m_log_read_index;  ///< 'tail' index
     uint16_t m_log_count;       ///< Broj aktivnih logova
+    uint32_t m_meta_generation; ///< Generacija posljednjeg upisanog slota metapodataka
+    uint8_t m_stage_buffer[LOG_STAGE_ENTRIES * LOG_ENTRY_SIZE]; ///< Logovi koji čekaju FlushLogs()
+    uint16_t m_stage_count;     ///< Broj logova u m_stage_buffer
+    uint32_t m_i2c_clock_hz;    ///< Trenutni I2C takt (Fm+ ili rezervni)
 };
 
 #endif // EEPROM_STORAGE_H
\ No newline at end of file
@@ -20,8 +20,10 @@
 #undef FILE_WRITE
 #endif
 
-#include "Rs485Service.h"
+#include "Rs485BusOwner.h"
 #include "SdCardManager.h"
+#include "UpdateChunkPrefetch.h"
+#include "RttEstimator.h"
 #include "ProjectConfig.h"
 #include <SD.h>
 
@@ -82,10 +84,10 @@ public:
 
     /**
      * @brief Inicijalizuje menadžera sa potrebnim servisima.
-     * @param pRs485Service Pointer na RS485 servis.
+     * @param pBusOwner Pointer na vlasnika RS485 magistrale.
      * @param pSdCardManager Pointer na SD Card menadžera.
      */
-    void Initialize(Rs485Service* pRs485Service, SdCardManager* pSdCardManager);
+    void Initialize(Rs485BusOwner* pBusOwner, SdCardManager* pSdCardManager);
 
     /**
      * @brief Postavlja referencu na HTTP server.
@@ -127,12 +129,22 @@ private:
     void SendDataPacket();
     void SendRestartCommand();
     void SendAppExeCommand();
+    bool StageFrame(const uint8_t* packet, uint16_t length);
+    void PrefetchNextChunk();
 
     FufUpdateSequence m_sequence;
     FufUpdateSession m_session;
-    Rs485Service* m_rs485_service;
+    Rs485BusOwner* m_bus_owner;
     SdCardManager* m_sd_card_manager;
     class HttpServer* m_http_server;
+
+    // Okvir pripremljen u Fazi 1 (Send*), šalje se u Fazi 2 kao jedna transakcija
+    uint8_t m_tx_frame[MAX_PACKET_LENGTH];
+    uint16_t m_tx_length;
+    uint8_t m_bus_id;       // Bus klijenta (dual mode) ili RS485_BUS_CURRENT
+    UpdateChunkPrefetch m_prefetch;     // Sljedeći chunk, čitan dok je DATA okvir na liniji
+    RttEstimator m_update_rtt;          // Odziv klijenta na DATA okvire (adaptivni timeout)
+    unsigned long m_session_start_time; // Za mjerenje trajanja transfera
 };
 
 #endif // FIRMWARE_UPDATE_MANAGER_H
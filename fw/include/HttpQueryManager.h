@@ -7,6 +7,8 @@
  * @note
  * Replicira blokirajucu logiku `HTTP2RS485`.
  * Implementira IRs485Manager interfejs.
+ * NOVO: Asinhroni upiti (BeginQuery/PollQuery) za CGI handler - AsyncTCP
+ * zadatak samo predaje transakciju i provjerava stanje, nikad ne čeka bus.
  ******************************************************************************
  */
 
@@ -15,7 +17,7 @@
 
 #include <Arduino.h>
 #include <freertos/semphr.h> // Za Semafore (blokiranje)
-#include "Rs485Service.h"
+#include "Rs485BusOwner.h"
 #include "ProjectConfig.h" 
 
 // Komande (preuzete iz httpd_cgi_ssi.c i hotel_ctrl.c)
@@ -42,6 +44,9 @@
 #define RT_DISP_QRC 0x53 // (qra + qrd)
 #define SET_BR2OW 0xE9 // Onewire Bridge command
 
+#define HTTP_CMD_DATA_SIZE 256 // Veličina buffera na koji pokazuje HttpCommand::string_ptr
+#define HTTP_QUERY_PENDING (-2) // PollQuery(): odgovor još nije stigao
+
 // Definisana struktura za komandu
 struct HttpCommand
 {
@@ -56,6 +61,41 @@ struct HttpCommand
 };
 
 
+/**
+ * @brief Stanje asinhronog upita.
+ */
+enum class HttpQueryState : uint8_t
+{
+    BUS_PRIMARY,    ///< Transakcija na ciljnom busu
+    BUS_FALLBACK,   ///< Timeout na Bus 0 - ponovljeno na Bus 1
+    DONE            ///< Rezultat je u result/response
+};
+
+/**
+ * @brief Jedan asinhroni HTTP->RS485 upit (slot u tabeli HttpQueryManager-a).
+ * @details Slot drži kopiju komande i buffere transakcije dok ga svi vlasnici ne
+ *          oslobode (ReleaseQuery) I transakcija ne napusti red vlasnika magistrale.
+ *          NOVO: Identični upiti statusa (cst) dijele slot - jedna transakcija,
+ *          isti rezultat za sve HTTP konekcije (single-flight).
+ */
+struct HttpQuery
+{
+    HttpCommand cmd;
+    uint8_t request_cmd_id;                 ///< cmd_id prije protokol adaptacije (ključ za spajanje upita)
+    uint8_t cmd_data[HTTP_CMD_DATA_SIZE];   ///< Kopija cmd.string_ptr podataka
+    BusTransaction txn;
+    uint8_t packet[MAX_PACKET_LENGTH];
+    uint8_t response[MAX_PACKET_LENGTH];    ///< Po završetku: payload (kao ExecuteBlockingQuery)
+    HttpQueryState state;
+    int result;                             ///< Po završetku: dužina payload-a ili -1
+    uint32_t done_ms;                       ///< millis() prelaza u DONE
+    uint16_t cache_generation;              ///< RoomStatusCache generacija pri predaji (i za Bus 1 fallback)
+    bool in_use;
+    bool joinable;                          ///< Status upit se smije dijeliti (false nakon komande na istu sobu)
+    uint8_t owners;                         ///< HTTP konekcije koje čekaju/šalju rezultat (0 = oslobođen)
+    String body;                            ///< Pripremljen HTTP odgovor (koristi HttpServer)
+};
+
 class HttpQueryManager
 {
 public:
@@ -66,9 +106,16 @@ public:
 
     /**
      * @brief Inicijalizuje menadžera.
-     * @param pRs485Service Pointer na RS485 servis.
+     * @param pBusOwner Pointer na vlasnika RS485 magistrale.
      */
-    void Initialize(Rs485Service* pRs485Service);
+    void Initialize(Rs485BusOwner* pBusOwner);
+
+    /**
+     * @brief Postavlja callback koji javlja završetak transakcije asinhronog upita.
+     * @details Poziva se iz zadatka vlasnika magistrale (vidi BusTxnCallback) -
+     *          HttpServer njime budi konekcije koje čekaju, umjesto poll tick-a.
+     */
+    void SetCompletionHandler(BusTxnCallback handler, void* context);
 
     /**
      * @brief Glavna funkcija koju poziva HttpServer. Sada je BLOKIRAJUĆA.
@@ -76,9 +123,83 @@ public:
      */
     int ExecuteBlockingQuery(HttpCommand* cmd, uint8_t* responseBuffer);
 
+    /**
+     * @brief NEBLOKIRAJUĆE: kopira komandu u slobodan slot i predaje transakciju.
+     * @details Upit statusa identičan upitu koji je u toku (ili je završen prije
+     *          najviše HTTP_QUERY_COALESCE_MS) se pridružuje tom slotu bez nove
+     *          transakcije. Komande koje mijenjaju stanje se nikad ne spajaju i
+     *          zatvaraju upite statusa iste sobe (ExpireStatusQueries).
+     * @param cmd Komanda; string_ptr mora pokazivati na HTTP_CMD_DATA_SIZE bajtova.
+     * @return Slot upita, ili NULL ako su svi slotovi zauzeti.
+     * @note Poziva se samo iz AsyncTCP zadatka (kao PollQuery/ReleaseQuery).
+     */
+    HttpQuery* BeginQuery(const HttpCommand* cmd);
+
+    /**
+     * @brief NEBLOKIRAJUĆE: provjerava upit; po potrebi ga ponavlja na Bus 1.
+     * @return HTTP_QUERY_PENDING dok se čeka, inače rezultat kao ExecuteBlockingQuery()
+     *         (payload je u query->response).
+     */
+    int PollQuery(HttpQuery* query);
+
+    /**
+     * @brief Vlasnik više ne koristi slot (odgovor poslan ili klijent otišao).
+     * @details Slot se ponovo koristi tek kada ga oslobode svi vlasnici i
+     *          transakcija napusti red.
+     */
+    void ReleaseQuery(HttpQuery* query);
+
+    /**
+     * @brief Kreira paket komande za dati bus (protokol adaptacija + okvir).
+     * @details Koristi RoomStatusSweep; cmd->cmd_id se može promijeniti (HILLS).
+     * @return Dužina paketa.
+     */
+    uint16_t BuildQueryPacket(HttpCommand* cmd, uint8_t bus_id, uint8_t* buffer);
+
+    /**
+     * @brief Izdvaja payload iz primljenog okvira (u isti buffer), bez ispisa.
+     * @param response_len Dužina primljenog okvira (>0).
+     * @return Dužina payload-a (kao ParseResponse za primljen okvir).
+     */
+    static int ExtractPayload(uint8_t* responseBuffer, int response_len);
+
 private:
-    Rs485Service* m_rs485_service;
+    Rs485BusOwner* m_bus_owner;
+    HttpQuery m_queries[HTTP_QUERY_SLOTS];
+    uint32_t m_coalesced;                   ///< Upita odgovorenih bez nove transakcije
+    BusTxnCallback m_on_complete;           ///< Završetak transakcije upita (HttpServer)
+    void* m_on_complete_context;
+
+    /**
+     * @brief Traži upit u toku (ili netom završen) identičan komandi.
+     * @return Slot za pridruživanje, ili NULL (komanda mijenja stanje ili nema para).
+     */
+    HttpQuery* FindCoalescableQuery(const HttpCommand* cmd);
+
+    /**
+     * @brief Zatvara upite statusa za spajanje nakon komande koja mijenja stanje sobe.
+     * @details Grupna i broadcast adresa zatvaraju upite statusa svih soba.
+     *          Vlasnici koji već čekaju i dalje dobijaju svoj rezultat.
+     */
+    void ExpireStatusQueries(uint16_t address);
     uint16_t CreateRs485Packet(HttpCommand* cmd, uint8_t* buffer);
+
+    /**
+     * @brief Bira bus za adresu (DeviceDirectory u dual modu, inače Bus 0).
+     */
+    int8_t SelectBus(uint16_t address);
+
+    /**
+     * @brief Predaje paket upita na dati bus (stanje se čita iz PollQuery, završetak javlja m_on_complete).
+     */
+    void SubmitQuery(HttpQuery* query, uint8_t bus_id);
+
+    /**
+     * @brief Izdvaja payload iz primljenog okvira (u isti buffer).
+     * @param response_len Rezultat transakcije (>0 dužina, 0 timeout, -1 greška).
+     * @return Dužina payload-a, ili -1 ako je greška/timeout.
+     */
+    int ParseResponse(uint8_t* responseBuffer, int response_len);
     
     /**
      * @brief Provjerava da li je protokol za određeni bus HILLS.
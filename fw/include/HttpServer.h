@@ -33,6 +33,8 @@ class FirmwareUpdateManager; // NOVO
 class UpdateManager;
 class EepromStorage;
 class SdCardManager; // CHANGED: Zamjenjen SpiFlashStorage
+struct HttpCommand;
+struct HttpQuery;
 
 class HttpServer
 {
@@ -56,9 +58,28 @@ private:
     
     // NEW: SSI Response Helper
     void SendSSIResponse(AsyncWebServerRequest *request, const String& message);
+    String BuildSSIResponse(const String& message);
+
+    // NOVO: Asinhroni RS485 upit - odgovor se šalje kada bus završi
+    void SendQueryResponse(AsyncWebServerRequest *request, HttpCommand* cmd);
+    size_t FillQueryResponse(HttpQuery* query, AsyncClient* client, uint8_t* buffer, size_t maxLen, size_t index);
+
+    // NOVO: Konekcije koje čekaju bus budi završetak transakcije, ne poll tick (~500 ms)
+    struct QueryWaiter
+    {
+        AsyncClient* client;    ///< NULL = slobodno
+        struct tcp_pcb* pcb;
+    };
+    static void OnQueryBusComplete(void* context);      // Zadatak vlasnika magistrale
+    static void WakeQueryWaiters(void* context);        // lwIP (tcpip) nit
+    void AddQueryWaiter(AsyncClient* client);
+    void RemoveQueryWaiter(AsyncClient* client);
+
+    // NOVO: Status više soba jednim prolazom magistrale (/room_status)
+    void HandleRoomStatusRequest(AsyncWebServerRequest *request);
     
     // Funkcije za parsiranje
-    String ParseMacros(String input); 
+    uint16_t ResolveAddress(const String& input);
     uint32_t IpStringToUint(const String& ipString);
     bool StartUpdateSession(AsyncWebServerRequest *request, uint8_t updateCmd, const String& addrParam, const String& lastAddrParam);
 
@@ -77,6 +98,10 @@ private:
     UpdateManager* m_update_manager;
     EepromStorage* m_eeprom_storage;
     SdCardManager* m_sd_card_manager; // CHANGED
+
+    QueryWaiter m_query_waiters[HTTP_QUERY_WAITERS];
+    portMUX_TYPE m_query_waiters_lock;
+    bool m_wake_queued;                 ///< WakeQueryWaiters je već u redu lwIP niti
 };
 
 #endif // HTTP_SERVER_H
\ No newline at end of file
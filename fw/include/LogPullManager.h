@@ -13,8 +13,11 @@
 #ifndef LOG_PULL_MANAGER_H
 #define LOG_PULL_MANAGER_H
 
-#include "Rs485Service.h"
+#include "Rs485BusOwner.h"
 #include "EepromStorage.h"
+#include "DeviceDirectory.h"
+#include "PollScheduler.h"
+#include "LogWriter.h"
 
 class LogPullManager
 {
@@ -26,10 +29,17 @@ public:
 
     /**
      * @brief Inicijalizuje menadžera.
-     * @param pRs485Service Pointer na RS485 servis.
+     * @param pBusOwner Pointer na vlasnika RS485 magistrale.
      * @param pEepromStorage Pointer na EEPROM storage.
      */
-    void Initialize(Rs485Service* pRs485Service, EepromStorage* pEepromStorage);
+    void Initialize(Rs485BusOwner* pBusOwner, EepromStorage* pEepromStorage);
+
+    /**
+     * @brief Gradi g_deviceDirectory i g_roomStatusCache nad učitanim listama adresa.
+     * @details Poziva se jednom u setup()-u, nakon Initialize() primarnog poller-a
+     *          (poller Desnog busa učitava iste liste i ne gradi ih ponovo).
+     */
+    void BuildDeviceTables() const;
 
     /**
      * @brief Izvršava ciklus prikupljanja logova (polling).
@@ -37,28 +47,106 @@ public:
     void Run();
     
     /**
-     * @brief Vraća bus ID za datu adresu (0=Lijevi, 1=Desni, -1=Nepoznato).
-     * @param address Adresa uređaja.
-     * @return Bus ID ili -1 ako adresa nije u listama.
+     * @brief Ograničava anketiranje na jedan bus (paralelni L/R rad).
+     * @details U RS485_WIRING_DUAL_UART modu radi po jedna instanca za svaki bus,
+     *          pa svaka obilazi samo svoju listu i ne prelazi na drugi bus.
+     * @param bus 0 = Lijevi, 1 = Desni, -1 = oba (sekvencijalno, podrazumijevano).
+     */
+    void SetBusFilter(int8_t bus);
+
+    /**
+     * @brief Ispisuje JSON rasporeda ove instance (backoff, stopa pražnjenja po uređaju).
+     */
+    void WriteScheduleJson(Print& out) const { m_scheduler.WriteJson(out); }
+
+    /**
+     * @brief Raspored ove instance (brojači obilazaka, vrućih posjeta, backoff-a).
      */
-    int8_t GetBusForAddress(uint16_t address);
+    const PollScheduler& GetScheduler() const { return m_scheduler; }
+
+    /**
+     * @brief Da li state-mašina trenutno čeka odgovor sa magistrale ili upis loga.
+     * @details loop() tada može spavati na task notifikaciji vlasnika magistrale
+     *          (ili LogWriter zadatka) umjesto da vrti petlju. Dok logovi čekaju
+     *          upis, poller nastavlja sa drugim uređajima - čeka samo kada nema
+     *          šta drugo poslati.
+     */
+    bool IsWaitingForResponse() const
+    {
+        return m_state == PullState::WAITING_FOR_RESPONSE ||
+               (m_state == PullState::IDLE && m_writes_in_use > 0);
+    }
 
 private:
+    /**
+     * @brief Posjeta uređaju. Kada uređaj preda log, posjeta se čuva u PendingWrite
+     *        i nastavlja kada je DELETE poslan.
+     */
+    struct Visit
+    {
+        uint16_t address;
+        int16_t index;              ///< Index u m_scheduler
+        uint8_t bus;                ///< Bus za adresu (ili RS485_BUS_CURRENT)
+        DeviceInfo device;          ///< Bus/protokol iz g_deviceDirectory
+        uint32_t start_ms;          ///< Početak posjete (pomjera se za vrijeme čekanja na upis)
+        uint32_t budget_ms;         ///< Budžet posjete (iz m_scheduler, prema zaostatku uređaja)
+        uint16_t logs;              ///< Logova preuzetih u ovoj posjeti
+        bool budget_hit;            ///< Posjeta je prekinuta zbog budžeta
+        uint8_t retry_count;
+        uint8_t hills_query_attempts; ///< HILLS: uzastopni timeout-i na DELETE ACK
+    };
+
+    /**
+     * @brief Log predat LogWriter-u i DELETE koji ide nakon upisa (jedan po zahtjevu).
+     * @details Memorija mora živjeti dok upis i DELETE ne izađu iz PENDING stanja.
+     */
+    struct PendingWrite
+    {
+        LogPullManager* owner;
+        Visit visit;                ///< Posjeta koja je preuzela log
+        uint32_t suspend_ms;        ///< Kada je posjeta prekinuta predajom loga
+        LogWriteRequest write;
+        BusTransaction delete_txn;  ///< Predaje ga OnLogWritten() tek kada je log upisan
+        uint8_t delete_packet[10];
+        uint8_t ack_buffer[32];     ///< HILLS: DELETE ACK
+        bool delete_needs_ack;      ///< HILLS: čeka se ACK na DELETE
+        uint8_t delete_retries;     ///< Ponovljene predaje DELETE-a koji nije poslan
+        bool written;               ///< Run() je obradio uspješan upis
+        bool done;                  ///< Upis i DELETE su završeni - posjeta čeka nastavak
+        bool in_use;
+    };
+
     void ProcessResponse(uint8_t* packet, uint16_t length);
     void SendStatusRequest(uint16_t address);
-    void SendDeleteLogRequest(uint16_t address);
+    PendingWrite* AcquireWrite();
+    void PrepareDeleteRequest(PendingWrite* pending);
+    static void OnLogWritten(void* context, bool success);
+    bool RetryDelete(PendingWrite* pending);
+    void ServiceWrites();
+    void ResumeVisit(PendingWrite* pending);
+    void HandleLogWriteResult(bool success);
+    void HandleDeleteAck(PendingWrite* pending);
     void SendLogRequest(uint16_t address);
-    uint16_t GetNextAddress();
+    void SendRoomStatusRequest(uint16_t address);
+    bool SelectNextAddress();
+    void ResetScheduler();
     
     // HILLS Protocol helpers
     bool IsHillsProtocol();
     uint8_t GetStatusCommand();
     uint8_t GetLogCommand();
     uint8_t GetDeleteCommand();
+    uint8_t GetRoomStatusCommand();
+    void StartResponseWait();
+    void PrepareResponseWait();
+    void BuildRequestPacket(uint8_t* packet, uint16_t address, uint8_t cmd);
     uint32_t GetResponseTimeout();
     uint32_t GetRxTxDelay();
+    bool IsVisitBudgetExceeded();
+    void EndVisitOnBudget();
+    void FinishVisit();
 
-    Rs485Service* m_rs485_service;
+    Rs485BusOwner* m_bus_owner;
     EepromStorage* m_eeprom_storage;
     
     enum class PullState
@@ -66,30 +154,47 @@ private:
         IDLE,
         SENDING_STATUS_REQUEST,
         SENDING_LOG_REQUEST,
-        WAITING_FOR_RESPONSE,
-        WAITING_FOR_DELETE_CONFIRMATION  // HILLS: wait for DELETE ACK
+        SENDING_ROOM_STATUS_REQUEST,     // Osvježavanje keša statusa sobe (RoomStatusCache)
+        WAITING_FOR_RESPONSE
     };
 
     PullState m_state;
-    uint16_t m_current_address_index;  // Legacy index (single bus mode)
-    uint16_t m_current_pull_address;
+    Visit m_visit;          // Tekuća posjeta
+    bool m_visit_active;    // Posjeta još nije prijavljena rasporedu (FinishVisit)
+    
+    // Legacy single list (za backward compatibility)
+    uint16_t m_address_list[MAX_ADDRESS_LIST_SIZE];
+    uint16_t m_address_list_count;
     
     // Dual bus support
     uint16_t m_address_list_L[MAX_ADDRESS_LIST_SIZE_PER_BUS]; // Lijevi bus
     uint16_t m_address_list_R[MAX_ADDRESS_LIST_SIZE_PER_BUS]; // Desni bus
     uint16_t m_address_list_count_L;
     uint16_t m_address_list_count_R;
-    uint16_t m_address_index_L;  // Samostalan index za Lijevi bus
-    uint16_t m_address_index_R;  // Samostalan index za Desni bus
     uint8_t m_current_bus;  // 0=Lijevi, 1=Desni (za ping-pong)
+    int8_t m_bus_filter;    // -1 = oba busa, 0/1 = samo taj bus (paralelni rad)
+
+    // NOVO: Adaptivni raspored (backoff nedostupnih, vrući red aktivnih uređaja)
+    PollScheduler m_scheduler;
+
+    // NOVO: Pražnjenje logova (GET_LOG -> DELETE -> GET_LOG ...) unutar budžeta posjete
+    bool m_draining;            // Zadnji GET_LOG je poslan bez prethodnog STATUS upita
+
+    // NOVO: Zadnji upit je čitanje statusa sobe za keš (ne log ciklus)
+    bool m_room_status_read;
+    uint16_t m_room_status_generation;  // RoomStatusCache generacija pri predaji čitanja
     
-    // Legacy single list (za backward compatibility)
-    uint16_t m_address_list[MAX_ADDRESS_LIST_SIZE];
-    uint16_t m_address_list_count;
-    
-    uint8_t m_retry_count;
-    uint8_t m_hills_query_attempts;  // HILLS ping-pong counter
     unsigned long m_last_activity_time;
+    
+    // NOVO: Transakcije preko vlasnika magistrale (POLLING klasa).
+    // Memorija mora živjeti dok transakcija ne izađe iz PENDING stanja.
+    BusTransaction m_txn;                       ///< Zahtjev koji čeka odgovor
+    uint8_t m_tx_packet[10];
+    uint8_t m_rx_buffer[MAX_PACKET_LENGTH];
+
+    // NOVO: Logovi predati LogWriter-u - poller u međuvremenu obilazi druge uređaje
+    PendingWrite m_writes[LOGPULL_MAX_PENDING_WRITES];
+    uint8_t m_writes_in_use;
 };
 
 #endif // LOG_PULL_MANAGER_H
@@ -0,0 +1,126 @@
+/**
+ ******************************************************************************
+ * @file    LogWriter.h
+ * @author  Gemini & [Vase Ime]
+ * @brief   Zadatak za upis logova u EEPROM (izvan polling putanje).
+ *
+ * @note
+ * LogPullManager predaje primljeni log i odmah se vraća; upis stranice u
+ * I2C EEPROM sa ACK pollingom (do 15 ms) radi ovaj zadatak. Po uspješnom
+ * upisu poziva se callback zahtjeva (iz zadatka upisa) - tek tada se uređaju
+ * šalje DELETE, pa se log ne može izgubiti ako upis ne uspije.
+ * Logovi koji se nakupe u redu dok traje upis ili stignu u prozoru
+ * LOG_WRITER_FLUSH_MS nakon prvog (oba busa, HTTP) upisuju se grupno: jedan
+ * upis uzastopnih slotova i jedan upis metapodataka za grupu.
+ * Zahtjev je memorija pozivaoca, kao BusTransaction kod Rs485BusOwner-a.
+ ******************************************************************************
+ */
+
+#ifndef LOG_WRITER_H
+#define LOG_WRITER_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+#include "ProjectConfig.h"
+#include "EepromStorage.h"
+
+/**
+ * @brief Stanje zahtjeva za upis.
+ */
+enum class LogWriteStatus : uint8_t
+{
+    PENDING,    ///< U redu ili se upisuje
+    DONE,       ///< Log je upisan u EEPROM
+    FAILED,     ///< Upis nije uspio
+    REJECTED    ///< Red je pun
+};
+
+/**
+ * @brief Callback završetka upisa (poziva se iz LogWriter zadatka, prije upisa statusa).
+ * @param context Kontekst iz zahtjeva.
+ * @param success true ako je log upisan.
+ */
+typedef void (*LogWriteCallback)(void* context, bool success);
+
+/**
+ * @brief Jedan zahtjev za upis (memorija pozivaoca, validna dok je PENDING).
+ */
+struct LogWriteRequest
+{
+    // --- Ulaz ---
+    LogEntry entry;
+    LogWriteCallback on_complete;   ///< NULL = bez callback-a
+    void* context;
+    TaskHandle_t notify_task;       ///< Ako != NULL, dobija xTaskNotifyGive() po završetku
+
+    // --- Izlaz ---
+    volatile LogWriteStatus status;
+
+    // --- Interno ---
+    uint32_t enqueue_time_us;
+};
+
+/**
+ * @brief Statistika upisa.
+ */
+struct LogWriterStats
+{
+    uint32_t submitted;
+    uint32_t written;
+    uint32_t failed;
+    uint32_t rejected;
+    uint16_t max_depth;         ///< High-water reda
+    uint64_t total_latency_us;  ///< Predaja -> upisano (čekanje u redu + upis)
+    uint32_t max_latency_us;
+    uint32_t flushes;           ///< Broj grupnih upisa (FlushLogs)
+    uint16_t max_batch;         ///< Najviše logova u jednom grupnom upisu
+    uint64_t total_write_us;    ///< Samo StageLog() + FlushLogs(), po grupnom upisu
+    uint32_t max_write_us;
+};
+
+class LogWriter
+{
+public:
+    LogWriter();
+
+    /**
+     * @brief Kreira red zahtjeva.
+     * @param pEepromStorage EEPROM u koji se upisuju logovi.
+     */
+    void Initialize(EepromStorage* pEepromStorage);
+
+    /**
+     * @brief Pokreće zadatak upisa.
+     */
+    void StartTask();
+
+    /**
+     * @brief Neblokirajuće predaje log na upis.
+     * @param request Zahtjev (entry, on_complete, context, notify_task popunjava pozivaoc).
+     * @return false ako je red pun (status = REJECTED, callback se ne poziva).
+     */
+    bool Submit(LogWriteRequest* request);
+
+    /**
+     * @brief Ispisuje statistiku upisa kao JSON objekat.
+     */
+    void WriteStatsJson(Print& out);
+
+    /**
+     * @brief Statistika upisa (čita se bez zaključavanja, kao WriteStatsJson()).
+     */
+    const LogWriterStats& GetStats() const { return m_stats; }
+
+private:
+    static void TaskWrapper(void* pvParameters);
+    void RunTask();
+
+    EepromStorage* m_eeprom_storage;
+    QueueHandle_t m_queue;
+    TaskHandle_t m_task_handle;
+    LogWriterStats m_stats;
+};
+
+#endif // LOG_WRITER_H
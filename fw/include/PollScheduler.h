@@ -0,0 +1,146 @@
+/**
+ ******************************************************************************
+ * @file    PollScheduler.h
+ * @author  Gemini & [Vase Ime]
+ * @brief   Adaptivni raspored pollinga uređaja (LogPullManager).
+ *
+ * @note
+ * Osnova je i dalje redovni obilazak liste (L pa R), uz stanje po uređaju:
+ * - nedostupan uređaj (uzastopni timeout-i) se preskače sa eksponencijalnim
+ *   backoff-om do POLL_BACKOFF_MAX_MS, a kada istekne dobija probni upit;
+ * - uređaj sa nedavnim događajima ulazi u mali vrući red i posjećuje se svakih
+ *   POLL_HOT_INTERVAL_MS umjesto jednom po obilasku.
+ * Garancija zastarjelosti: između dvije redovne posjete ide najviše
+ * POLL_HOT_BURST vrućih, pa je dostupan uređaj posjećen bar jednom u
+ * (POLL_HOT_BURST + 1) x N izbora, a nedostupan najkasnije POLL_BACKOFF_MAX_MS
+ * nakon toga.
+ * Budžet posjete (pražnjenje logova) se udvostručuje za uređaj koji ga je
+ * potrošio a da nije ispraznio listu, do LOGPULL_VISIT_BUDGET_MAX_MS, i vraća
+ * na osnovni kada se lista isprazni.
+ ******************************************************************************
+ */
+
+#ifndef POLL_SCHEDULER_H
+#define POLL_SCHEDULER_H
+
+#include <Arduino.h>
+#include "ProjectConfig.h"
+
+#define POLL_NO_DEVICE  (-1)
+
+class PollScheduler
+{
+public:
+    PollScheduler();
+
+    /**
+     * @brief Postavlja listu uređaja i briše stanje (redoslijed: list_a, pa list_b).
+     * @details Liste pripadaju pozivaocu i moraju živjeti koliko i raspored.
+     */
+    void Reset(const uint16_t* list_a, uint16_t count_a, const uint16_t* list_b, uint16_t count_b);
+
+    /**
+     * @brief Bira sljedeći uređaj za posjetu.
+     * @param now Trenutno vrijeme (millis()).
+     * @param wrapped Postavlja se na true ako je redovni obilazak prešao kraj liste.
+     * @return Index uređaja ili POLL_NO_DEVICE ako trenutno nijedan nije na redu.
+     */
+    int16_t Next(uint32_t now, bool* wrapped);
+
+    /**
+     * @brief Adresa uređaja sa datim indexom.
+     */
+    uint16_t GetAddress(int16_t index) const;
+
+    /**
+     * @brief Da li index pripada drugoj listi (list_b).
+     */
+    bool IsInSecondList(int16_t index) const { return index >= (int16_t)m_count_a; }
+
+    /**
+     * @brief Uređaj je odgovorio - briše backoff.
+     */
+    void OnResponse(int16_t index, uint32_t now);
+
+    /**
+     * @brief Uređaj nije odgovorio - nakon POLL_BACKOFF_THRESHOLD uzastopnih
+     *        timeout-a odlaže sljedeću posjetu (eksponencijalno, do plafona).
+     */
+    void OnTimeout(int16_t index, uint32_t now);
+
+    /**
+     * @brief Preuzet je log sa uređaja - uređaj postaje vruć.
+     */
+    void OnLog(int16_t index, uint32_t now);
+
+    /**
+     * @brief Uređaj je javio (ne)ma logova na čekanju.
+     */
+    void OnLogsPending(int16_t index, bool pending);
+
+    /**
+     * @brief Zadržava uređaj van rasporeda (log predat na upis, DELETE još nije poslan).
+     * @details Zadržan uređaj se preskače i u vrućem redu i u redovnom obilasku -
+     *          novi GET_LOG prije DELETE-a bi vratio isti log.
+     */
+    void SetHeld(int16_t index, bool held);
+
+    /**
+     * @brief Budžet posjete za uređaj (adaptivan prema zaostatku logova).
+     */
+    uint32_t GetVisitBudgetMs(int16_t index) const;
+
+    /**
+     * @brief Završena posjeta: ažurira stopu pražnjenja i budžet sljedeće posjete.
+     * @param logs Broj logova preuzetih u posjeti.
+     * @param visit_ms Trajanje posjete.
+     * @param budget_exhausted Posjeta je prekinuta jer je budžet potrošen.
+     */
+    void OnVisitEnd(int16_t index, uint16_t logs, uint32_t visit_ms, bool budget_exhausted);
+
+    /**
+     * @brief JSON sa brojačima rasporeda i redom [addr, timeouts, backoff_ms,
+     *        logs, drain_ms, logs_per_min, budget_ms] po uređaju.
+     * @details Čita se iz HTTP zadatka bez lock-a - vrijednosti su samo statistika.
+     */
+    void WriteJson(Print& out) const;
+
+    uint32_t GetSweeps() const { return m_sweeps; }
+    uint32_t GetHotVisits() const { return m_hot_visits; }
+    uint32_t GetBackoffSkips() const { return m_backoff_skips; }
+    uint32_t GetHeldSkips() const { return m_held_skips; }
+
+private:
+    struct DeviceState
+    {
+        uint32_t next_due_ms;       ///< Najraniji trenutak sljedeće posjete (backoff)
+        uint32_t last_visit_ms;
+        uint32_t last_event_ms;     ///< Zadnji preuzet log
+        uint32_t drain_ms;          ///< Ukupno trajanje posjeta u kojima su preuzeti logovi
+        uint16_t drained_logs;      ///< Ukupno preuzetih logova (saturira)
+        uint8_t timeouts;           ///< Uzastopni timeout-i (saturira)
+        uint8_t flags;              ///< POLL_FLAG_*
+        uint8_t budget_shift;       ///< Budžet = LOGPULL_VISIT_BUDGET_MS << budget_shift
+    };
+
+    static bool IsDue(const DeviceState* st, uint32_t now) { return (int32_t)(now - st->next_due_ms) >= 0; }
+    int16_t NextHot(uint32_t now);
+    void AddHot(int16_t index, uint32_t now);
+
+    const uint16_t* m_list_a;
+    const uint16_t* m_list_b;
+    uint16_t m_count_a;
+    uint16_t m_count;
+
+    DeviceState m_state[MAX_ADDRESS_LIST_SIZE];
+    int16_t m_hot[POLL_HOT_SLOTS];      ///< Indexi vrućih uređaja (POLL_NO_DEVICE = prazno)
+    uint16_t m_cursor;                  ///< Sljedeći index redovnog obilaska
+    uint8_t m_hot_burst;                ///< Vrućih posjeta od zadnje redovne
+
+    uint32_t m_sweeps;
+    uint32_t m_hot_visits;
+    uint32_t m_backoff_skips;
+    uint32_t m_held_skips;
+};
+
+#endif // POLL_SCHEDULER_H
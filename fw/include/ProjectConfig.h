@@ -46,11 +46,25 @@ enum class ProtocolVersion
 #define RS485_DE_PIN2       16  // (P0 Pin 12: IO16) - Drugi RS485 DE
                                 // GPIO16 nije strapping pin - pull-down opcionalan (ali preporučen)
 
+// --- NOVO: Desni bus na zasebnom UART-u (RS485_WIRING_DUAL_UART) ---
+// Svaki bus ima svoj MAX485 RO/DI, pa L i R rade paralelno (dva UART-a, dva poller-a).
+// ⚠️ Na LILYGO T-Internet-POE nema slobodnog izlaznog pina za TX Desnog busa.
+// Dok se TX pin ne dodijeli (nova revizija ploče), ostaje -1: kod za zaseban UART
+// (drugi servis i poller Desnog busa) se ne gradi i koristi se dijeljeni RX.
+#define RS485_RX_PIN_R      36  // (P0: IO36 - Samo ULAZ, isti voltage divider kao IO34)
+#define RS485_TX_PIN_R      -1  // Nije dodijeljen na ovoj ploči
+#define RS485_DUAL_UART_AVAILABLE   (RS485_TX_PIN_R >= 0)
+
 // --- I2C INTERFEJS (EEPROM) - Pinovi na P0 konektoru ---
 // PREMJEŠTENO: Koriste se slobodni I/O pinovi koji nisu "strapping" ili input-only
 #define I2C_SDA_PIN         4   // (P0 Pin 8: IO4)
 #define I2C_SCL_PIN         32  // (P0 Pin 11: IO32)
 #define EEPROM_I2C_ADDR     0x50
+#define EEPROM_I2C_CLOCK_HZ             1000000 // NOVO: Fast-mode Plus (24C1024 podržava 1 MHz)
+#define EEPROM_I2C_FALLBACK_CLOCK_HZ    400000  // Fast-mode ako Fm+ ne radi (ožičenje, pull-up)
+#define EEPROM_ACK_POLL_INTERVAL_TICKS  1       // Spavanje između ACK ping-ova tokom ciklusa upisa
+#define EEPROM_ACK_POLL_TIMEOUT_MS      15      // Max trajanje ciklusa upisa (tWR = 5 ms + rezerva)
+#define EEPROM_I2C_RETRIES              3       // Ponavljanja jednog chunk-a nakon NACK-a / greške magistrale
 
 // --- SPI INTERFEJS (uSD kartica) - Fiksno na ploči ---
 // OVI PINOVI SU INTERNO KORIŠTENI (P0 Pin 5, 6, 7) I NE SMIJU SE KORISTITI ZA DRUGE PERIFERIJE
@@ -125,6 +139,51 @@ enum class ProtocolVersion
 #define RS485_RESP_TOUT_MS          45
 #define RX2TX_DEL_MS                3
 
+// --- UART drajver (event-driven prijem) ---
+#define RS485_UART_NUM              2      // UART2 (ranije Serial2)
+#define RS485_UART_NUM_R            1      // UART1 - Desni bus u RS485_WIRING_DUAL_UART modu
+#define RS485_UART_RX_BUF_SIZE      1024   // RX ring buffer IDF drajvera
+#define RS485_UART_EVENT_QUEUE_LEN  16     // Dubina UART event queue-a
+#define RS485_RX_IDLE_SYMBOLS       3      // RX timeout (u trajanju znakova) = granica okvira
+#define RS485_TX_DONE_TIMEOUT_MS    100    // Max čekanje da TX FIFO ode na liniju
+
+// --- Upravljanje DE pinom ---
+// 1 = UART_MODE_RS485_HALF_DUPLEX: RTS signal UART-a je rutiran na DE pin aktivnog
+//     busa i hardver ga spušta na zadnjem stop bitu (bez softverskih zaštitnih pauza).
+// 0 = DE se postavlja sa digitalWrite() uz RS485_SW_DE_GUARD_US prije i poslije okvira.
+#define RS485_HW_DE_CONTROL         0
+#define RS485_SW_DE_GUARD_US        50     // Zaštitna pauza oko okvira u softverskom modu
+
+// --- Binarni trace okvira (Rs485Trace, /rs485_trace) ---
+#define RS485_TRACE_ENTRIES         128    // Broj zapisa u ringu
+#define RS485_TRACE_SNAP_LEN        64     // Max bajtova okvira po zapisu (ostatak se samo broji)
+
+// --- Adaptivni timeout odgovora (RttEstimator, /rtt_table) ---
+#define RTT_TABLE_SIZE              512    // Slotova po adresi (>= MAX_ADDRESS_LIST_SIZE)
+#define RTT_MIN_TIMEOUT_MS          8      // Donja granica (turnaround kontrolera + tick)
+#define RTT_TIMEOUT_MARGIN_MS       2      // Dodaje se na SRTT + 4*RTTVAR
+#define RTT_MIN_AGGREGATE_SAMPLES   8      // Uzoraka prije korištenja zbirne procjene za nove uređaje
+#define RTT_UNSEEN_FACTOR           2      // Uređaj bez uzoraka: zbirni timeout x faktor
+
+// --- Vlasnik magistrale (Rs485BusOwner) ---
+#define RS485_BUS_CURRENT           0xFF   // bus_id: ostavi trenutno odabran bus
+#define BUS_PRIORITY_CLASSES        6      // HTTP, UPDATE, TIME_SYNC, LOG_DELETE, POLLING, BATCH
+#define BUS_QUEUE_LENGTH            8      // Max transakcija po klasi u redu
+#define BUS_OWNER_TASK_STACK        4096
+#define BUS_OWNER_TASK_PRIORITY     5
+#define BUS_DEADLINE_HTTP_MS        1000   // Max čekanje u redu prije odbacivanja (0 = bez limita)
+#define BUS_DEADLINE_UPDATE_MS      0
+#define BUS_DEADLINE_TIMESYNC_MS    1000
+#define BUS_DEADLINE_LOG_DELETE_MS  0      // DELETE upisanog loga ne smije isteći (inače se log preuzima ponovo)
+#define BUS_DEADLINE_POLLING_MS     500
+#define BUS_DEADLINE_BATCH_MS       0      // Sweep soba čeka koliko treba (ne smije gušiti polling)
+
+// --- Ožičenje dual bus moda (AppConfig::rs485_wiring_mode) ---
+#define RS485_WIRING_SHARED_RX      0      // Jedan UART, dijeljena RX linija, izbor busa preko DE pinova
+#define RS485_WIRING_DUAL_UART      1      // UART2 = Lijevi, UART1 = Desni - paralelan rad
+#define RS485_DEFAULT_WIRING_MODE   RS485_WIRING_SHARED_RX
+#define RS485_MAX_BUS_LANES         2
+
 // --- TimeSync Komande ---
 #define SET_RTC_DATE_TIME           0xD5
 #define RTC_PACKET_LENGTH           17
@@ -142,21 +201,67 @@ enum class ProtocolVersion
 // --- HILLS Protokol Tajminzi ---
 #define HILLS_RESPONSE_TIMEOUT_MS   25
 #define HILLS_RX_TO_TX_DELAY_MS     10
-#define HILLS_MAX_QUERY_ATTEMPTS    5
+#define HILLS_MAX_QUERY_ATTEMPTS    5      // Max uzastopnih timeout-a na DELETE ACK unutar posjete
+
+// --- Adaptivni raspored pollinga (PollScheduler) ---
+// Nedostupan uređaj se ne preskače zauvijek: nakon backoff-a dobija probni upit,
+// pa je njegova max zastarjelost POLL_BACKOFF_MAX_MS + jedan obilazak liste.
+#define POLL_BACKOFF_THRESHOLD      2      // Uzastopnih timeout-a prije backoff-a (1 = odmah)
+#define POLL_BACKOFF_BASE_MS        2000   // Prvi backoff; svaki sljedeći timeout ga udvostručuje
+#define POLL_BACKOFF_MAX_MS         60000  // Plafon backoff-a
+#define POLL_HOT_SLOTS              8      // Max uređaja sa nedavnim događajima u vrućem redu
+#define POLL_HOT_INTERVAL_MS        1000   // Period ponovnih posjeta vrućem uređaju
+#define POLL_HOT_WINDOW_MS          30000  // Koliko dugo uređaj ostaje vruć nakon zadnjeg loga
+#define POLL_HOT_BURST              2      // Max vrućih posjeta između dvije redovne (granica zastarjelosti)
+
+// --- Pražnjenje logova u jednoj posjeti (LogPullManager) ---
+// 1 = standardni protokoli nakon DEL_LOG_LIST odmah šalju GET_LOG_LIST (bez GET_SYS_STAT);
+//     statusni upit ide tek kada uređaj vrati praznu listu.
+#define LOGPULL_DRAIN_MODE          1
+#define LOGPULL_VISIT_BUDGET_MS     300    // Osnovni budžet posjete; ostatak logova u sljedećoj (vrući red)
+#define LOGPULL_VISIT_BUDGET_MAX_MS 2400   // Uređaj koji ne stigne isprazniti listu dobija 2x budžet, do ovog plafona
+#define LOGPULL_DELETE_MAX_RETRIES  5      // Ponovljenih predaja DELETE-a koji nije poslan (pun red, greška slanja)
+#define LOGPULL_MAX_PENDING_WRITES  4      // Logova po polleru koji čekaju upis/DELETE dok poller obilazi druge uređaje
+
+// --- Upis logova u EEPROM (LogWriter zadatak) ---
+#define LOG_WRITER_QUEUE_LEN        (2 * LOGPULL_MAX_PENDING_WRITES) // Max logova koji čekaju upis (oba pollera)
+#define LOG_WRITER_TASK_STACK       3072
+#define LOG_WRITER_TASK_PRIORITY    1      // Kao loop(): ACK polling EEPROM-a ne izgladnjuje polling
+#define LOG_WRITER_BATCH_MAX        LOG_STAGE_ENTRIES // Max logova po jednom grupnom upisu
+#define LOG_WRITER_FLUSH_MS         16     // Prozor skupljanja grupe nakon prvog loga (log po posjeti stiže svakih ~20 ms)
+
+// --- HTTP->RS485 upiti (HttpQueryManager) ---
+#define HTTP_QUERY_SLOTS            8      // Max istovremenih upita koji čekaju bus (asinhroni CGI)
+#define HTTP_QUERY_TIMEOUT_MS       50     // Timeout odgovora na HTTP upit
+#define HTTP_QUERY_WAITERS          16     // Konekcije koje budi završetak upita (ostale čekaju poll tick ~500 ms)
+#define HTTP_QUERY_COALESCE_MS      100    // Identičan upit statusa do ovoliko ms nakon završetka dobija isti rezultat (0 = samo upiti u toku)
+
+// --- Status više soba jednim prolazom (RoomStatusSweep, /room_status) ---
+#define ROOM_STATUS_BATCH_MAX       MAX_ADDRESS_LIST_SIZE // Max soba po zahtjevu
+#define ROOM_STATUS_PIPELINE_DEPTH  2      // Upita po busu u redu vlasnika (sljedeći čeka dok je prethodni na liniji)
+#define ROOM_STATUS_MAX_PAYLOAD     64     // Max bajtova statusa po sobi (GET_APPL_STAT vraća ~52)
+#define ROOM_STATUS_TASK_STACK      3072
+#define ROOM_STATUS_TASK_PRIORITY   4      // Iznad AsyncTCP (3), ispod vlasnika magistrale (5)
+
+// --- Keš statusa soba (RoomStatusCache, max_age parametar cst / room_status) ---
+// Polling uz GET_SYS_STAT povremeno pročita i puni status sobe (GET_APPL_STAT),
+// pa HTTP upit sa max_age dobija odgovor iz RAM-a bez transakcije na busu.
+#define ROOM_STATUS_CACHE_REFRESH_MS 60000 // Starost statusa nakon koje ga polling ponovo čita (0 = bez čitanja)
 
 //=============================================================================
 // 5. GLOBALNE KONSTANTE SISTEMA
 //=============================================================================
 #define EEPROM_MAGIC_NUMBER         0xDEADBEEF
-#define EEPROM_CONFIG_VERSION       4  // UPDATED: Added use_wifi_as_primary flag
+#define EEPROM_CONFIG_VERSION       5  // UPDATED: Added rs485_wiring_mode
 
 #define MAX_ADDRESS_LIST_SIZE       500  // Max 500 adresa po listi
 #define MAX_ADDRESS_LIST_SIZE_PER_BUS 250  // 250 adresa po bus-u u dual mode (2x250=500 total)
 #define LOG_ENTRY_SIZE              16
-#define MAX_LOG_ENTRIES             3900  // ISPRAVKA: Ograničeno na 62KB umjesto 65KB da stane u 16-bit adresiranje
+#define MAX_LOG_ENTRIES             8000  // NOVO: Cijeli 24C1024 (128 KB, 17-bit adresiranje preko A16 bita I2C adrese)
 #define STATUS_BYTE_VALID           0x55
 #define STATUS_BYTE_EMPTY           0xFF
 #define LOG_RECORD_SIZE             LOG_ENTRY_SIZE
+#define LOG_STAGE_ENTRIES           16    // NOVO: RAM bafer grupnog upisa logova (16 x 16 B = stranica EEPROM-a)
 
 // --- TimeSync / NTP ---
 #define TIME_BROADCAST_INTERVAL_MS  6789
@@ -242,6 +347,13 @@ enum class ProtocolVersion
 #define EEPROM_LOG_START_ADDR           (EEPROM_ADDRESS_LIST_START_ADDR + EEPROM_ADDRESS_LIST_SIZE)
 #define EEPROM_LOG_AREA_SIZE            (MAX_LOG_ENTRIES * LOG_RECORD_SIZE)
 
+#define EEPROM_TOTAL_SIZE               0x20000UL  // 24C1024 = 128 KB
+
+// NOVO: Metapodaci logera (head/tail/count) - dva slota koji se naizmjenično
+// upisuju, iza log područja i u različitim stranicama (256 B) EEPROM-a
+#define EEPROM_LOGGER_META_ADDR_A       0x1FE00UL
+#define EEPROM_LOGGER_META_ADDR_B       0x1FF00UL
+
 // --- Ping Watchdog (vraćeno na mjesto) ---
 #define PING_INTERVAL_MS            60000
 #define MAX_PING_FAILURES           10
@@ -0,0 +1,117 @@
+/**
+ ******************************************************************************
+ * @file    RoomStatusCache.h
+ * @author  Gemini & [Vase Ime]
+ * @brief   Keš zadnjeg statusa sobe po uređaju (odgovor cst iz RAM-a).
+ *
+ * @note
+ * Niz fiksne veličine, jedan slot po uređaju iz listi koje polling obilazi
+ * (sortirano, binarna pretraga kao DeviceDirectory - koji u single bus modu
+ * ostaje prazan, pa keš gradi svoj indeks). Slot drži zadnji payload statusa
+ * (GET_APPL_STAT / RUBICON_GET_ROOM_STATUS), vrijeme kada je pročitan i
+ * dostupnost uređaja iz pollinga. Puni se iz tri izvora: polling (povremeno
+ * čitanje statusa, ROOM_STATUS_CACHE_REFRESH_MS), cst i /room_status.
+ * HTTP upit sa max_age dobija payload iz keša ako nije stariji od max_age ms.
+ ******************************************************************************
+ */
+
+#ifndef ROOM_STATUS_CACHE_H
+#define ROOM_STATUS_CACHE_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include "ProjectConfig.h"
+
+/**
+ * @brief Kopija slota keša (vraća Get()).
+ */
+struct RoomStatusSnapshot
+{
+    uint32_t age_ms;            ///< Starost payload-a
+    int8_t bus;                 ///< Bus na kojem je uređaj zadnji put odgovorio (-1 = nepoznat)
+    uint8_t length;
+    char payload[ROOM_STATUS_MAX_PAYLOAD];
+};
+
+class RoomStatusCache
+{
+public:
+    RoomStatusCache();
+
+    /**
+     * @brief Gradi indeks iz listi adresa (briše prethodni sadržaj).
+     * @details Poziva se jednom u setup()-u (LogPullManager::BuildDeviceTables).
+     */
+    void Build(const uint16_t* list_a, uint16_t count_a, const uint16_t* list_b, uint16_t count_b);
+
+    /**
+     * @brief Uređaj je odgovorio na polling upit (dostupan).
+     * @param bus Bus odgovora (RS485_BUS_CURRENT = nepoznat).
+     */
+    void OnResponse(uint16_t address, uint8_t bus);
+
+    /**
+     * @brief Uređaj nije odgovorio na polling upit.
+     * @details Nakon POLL_BACKOFF_THRESHOLD uzastopnih timeout-a keš ne odgovara
+     *          za uređaj (upit ide na bus) dok se ponovo ne javi.
+     */
+    void OnTimeout(uint16_t address);
+
+    /**
+     * @brief Generacija slota (broj Invalidate() poziva za sobu).
+     * @details Hvata se pri predaji čitanja statusa na bus i prosljeđuje Store()-u.
+     */
+    uint16_t GetGeneration(uint16_t address);
+
+    /**
+     * @brief Upisuje novi status sobe (payload kao u cst odgovoru).
+     * @param generation GetGeneration() u trenutku predaje čitanja. Ako je u međuvremenu
+     *        pozvan Invalidate(), odgovor opisuje sobu prije komande i odbacuje se.
+     */
+    void Store(uint16_t address, uint8_t bus, const uint8_t* payload, uint16_t length, uint16_t generation);
+
+    /**
+     * @brief Briše status nakon komande koja mijenja stanje sobe.
+     * @details Adresa van indeksa (grupna, broadcast) briše statuse svih soba.
+     *          Povećava generaciju slota - čitanja predata prije ovoga se ne upisuju.
+     */
+    void Invalidate(uint16_t address);
+
+    /**
+     * @brief Status sobe iz keša.
+     * @param max_age_ms Najveća prihvatljiva starost (0 = nikad iz keša).
+     * @return false ako status ne postoji, stariji je od max_age_ms ili uređaj nije dostupan.
+     */
+    bool Get(uint16_t address, uint32_t max_age_ms, RoomStatusSnapshot* out);
+
+    /**
+     * @brief Da li polling treba ponovo pročitati status (nema ga ili je stariji od
+     *        ROOM_STATUS_CACHE_REFRESH_MS).
+     */
+    bool NeedsRefresh(uint16_t address);
+
+    uint16_t GetCount() const { return m_count; }
+
+private:
+    struct Entry
+    {
+        uint32_t status_ms;     ///< millis() upisa payload-a
+        int8_t bus;
+        uint8_t timeouts;       ///< Uzastopni timeout-i pollinga (saturira)
+        bool valid;             ///< Payload je upisan
+        uint16_t generation;    ///< Povećava Invalidate(); Store() sa starijom se odbacuje
+        uint8_t length;
+        char payload[ROOM_STATUS_MAX_PAYLOAD];
+    };
+
+    int16_t FindSlot(uint16_t address) const;
+
+    uint16_t* m_addresses;      ///< Heap, sortirano; indeks = slot u m_entries
+    Entry* m_entries;           ///< Heap, m_count slotova
+    uint16_t m_count;
+    portMUX_TYPE m_lock;
+};
+
+extern RoomStatusCache g_roomStatusCache;
+
+#endif // ROOM_STATUS_CACHE_H
@@ -0,0 +1,156 @@
+/**
+ ******************************************************************************
+ * @file    RoomStatusSweep.h
+ * @author  Gemini & [Vase Ime]
+ * @brief   Status više soba jednim prolazom magistrale (/room_status).
+ *
+ * @note
+ * Umjesto jednog HTTP zahtjeva i jedne transakcije po sobi (sysctrl.cgi?cst=),
+ * lista adresa se sortira i čita jednim prolazom: zadatak sweep-a drži po
+ * ROOM_STATUS_PIPELINE_DEPTH upita po busu u BATCH redu vlasnika magistrale, pa
+ * sljedeći okvir čeka u redu dok je prethodni na liniji (bez praznog hoda
+ * između soba). BATCH je ispod pollinga: polling, TimeSync, update i
+ * interaktivni HTTP upiti idu između soba, a sweep koristi ostatak busa.
+ * Sa zasebnim UART-om po busu L i R se čitaju paralelno.
+ * Timeout na Bus 0 se ponavlja na Bus 1 (kao kod cst) - na kraju reda Bus 1.
+ * Istovremeno radi samo jedan sweep; rezultati se drže dok ih HTTP konekcija
+ * ne pročita (ili ne nestane).
+ * Sa max_age > 0 sobe čiji status u RoomStatusCache nije stariji od max_age
+ * se ne čitaju sa busa; pročitani statusi se upisuju u keš.
+ ******************************************************************************
+ */
+
+#ifndef ROOM_STATUS_SWEEP_H
+#define ROOM_STATUS_SWEEP_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "ProjectConfig.h"
+#include "Rs485BusOwner.h"
+
+class HttpQueryManager;
+
+/**
+ * @brief Rezultat čitanja jedne sobe.
+ */
+enum class RoomStatusResult : uint8_t
+{
+    PENDING,    ///< Još nije pročitana
+    OK,         ///< Payload je u RoomStatusEntry::payload
+    TIMEOUT,    ///< Nema odgovora (ni na Bus 1)
+    FAILED      ///< Transakcija odbijena/istekla u redu ili greška slanja
+};
+
+/**
+ * @brief Jedna soba u sweep-u.
+ */
+struct RoomStatusEntry
+{
+    uint16_t address;
+    int8_t bus;                 ///< Bus koji je odgovorio (ili zadnji pokušan)
+    RoomStatusResult result;
+    uint8_t length;             ///< Dužina payload-a (odsječeno na ROOM_STATUS_MAX_PAYLOAD)
+    uint32_t age_ms;            ///< Starost statusa iz keša (0 = pročitan u ovom sweep-u)
+    char payload[ROOM_STATUS_MAX_PAYLOAD];
+};
+
+class RoomStatusSweep
+{
+public:
+    RoomStatusSweep();
+
+    /**
+     * @brief Povezuje vlasnika magistrale i HttpQueryManager (kreiranje paketa).
+     */
+    void Initialize(Rs485BusOwner* pBusOwner, HttpQueryManager* pHttpQueryManager);
+
+    /**
+     * @brief Pokreće zadatak sweep-a.
+     */
+    void StartTask();
+
+    /**
+     * @brief NEBLOKIRAJUĆE: pokreće sweep za listu adresa (poziva AsyncTCP zadatak).
+     * @details Adrese se sortiraju, duplikati i adresa 0 se izbacuju.
+     * @param max_age_ms Najveća starost statusa iz keša (0 = sve sobe sa busa).
+     * @return false ako sweep već radi, lista je prazna ili nema memorije.
+     */
+    bool Begin(const uint16_t* addresses, uint16_t count, uint32_t max_age_ms);
+
+    /**
+     * @brief Da li su sve sobe pročitane (rezultat spreman za FillJson).
+     */
+    bool IsDone() const { return m_state == State::DONE; }
+
+    /**
+     * @brief Puni HTTP odgovor JSON-om rezultata (callback odgovor, redom po index-u).
+     * @return Broj upisanih bajtova; 0 = kraj.
+     */
+    size_t FillJson(uint8_t* buffer, size_t maxLen, size_t index);
+
+    /**
+     * @brief Vlasnik (HTTP konekcija) više ne koristi rezultat.
+     * @details Sweep koji još radi se prekida (ne predaju se nove sobe);
+     *          memorija se oslobađa kada se isprazne transakcije u redu.
+     */
+    void Release();
+
+private:
+    enum class State : uint8_t
+    {
+        IDLE,
+        STARTING,   ///< Begin() puni listu (zadatak je ne dira)
+        RUNNING,
+        DONE
+    };
+
+    /**
+     * @brief Jedna transakcija u letu (memorija za BusTransaction).
+     */
+    struct Slot
+    {
+        BusTransaction txn;
+        uint8_t packet[MAX_PACKET_LENGTH];
+        uint8_t response[MAX_PACKET_LENGTH];
+        uint16_t entry;         ///< Indeks u m_entries
+        uint16_t cache_generation; ///< RoomStatusCache generacija pri predaji
+        bool busy;
+    };
+
+    static void TaskWrapper(void* pvParameters);
+    void RunTask();
+    void RunSweep();
+    bool SubmitNext(Slot* slot, uint8_t bus_id);
+    void CompleteSlot(Slot* slot);
+    void FreeEntries();
+    size_t FormatRow(uint16_t row, char* out, size_t out_size);
+
+    Rs485BusOwner* m_bus_owner;
+    HttpQueryManager* m_http_query_manager;
+    TaskHandle_t m_task_handle;
+    portMUX_TYPE m_lock;
+
+    volatile State m_state;
+    volatile bool m_abort;              ///< Vlasnik je otišao prije kraja sweep-a
+
+    RoomStatusEntry* m_entries;         ///< Heap, sortirano po adresi
+    uint16_t m_count;
+    uint16_t m_cached;                  ///< Soba odgovorenih iz keša
+    uint16_t* m_work[RS485_MAX_BUS_LANES];      ///< Red indeksa po busu (heap, m_count mjesta)
+    uint16_t m_work_head[RS485_MAX_BUS_LANES];
+    uint16_t m_work_tail[RS485_MAX_BUS_LANES];
+    Slot m_slots[RS485_MAX_BUS_LANES][ROOM_STATUS_PIPELINE_DEPTH];
+    uint32_t m_start_ms;
+    uint32_t m_elapsed_ms;
+
+    // Stanje ispisa JSON-a (FillJson se poziva redom, iz jedne konekcije)
+    uint16_t m_json_row;                ///< Sljedeći red (0 = zaglavlje, m_count + 1 = kraj)
+    char m_json_line[64 + 6 * ROOM_STATUS_MAX_PAYLOAD];    ///< Payload bajt -> max 6 znakova (\u00XX)
+    uint16_t m_json_len;
+    uint16_t m_json_pos;
+};
+
+extern RoomStatusSweep g_roomStatusSweep;
+
+#endif // ROOM_STATUS_SWEEP_H
@@ -0,0 +1,217 @@
+/**
+ ******************************************************************************
+ * @file    Rs485BusOwner.h
+ * @author  Gemini & [Vase Ime]
+ * @brief   Vlasnik RS485 magistrale: jedini zadatak koji koristi Rs485Service.
+ *
+ * @note
+ * HttpQueryManager, UpdateManager, FirmwareUpdateManager, TimeSync i
+ * LogPullManager više ne diraju UART direktno. Svaki od njih predaje
+ * transakciju (jedan okvir + opcioni odgovor) u red svoje klase prioriteta:
+ *   HTTP > UPDATE > TIME_SYNC > LOG_DELETE > POLLING > BATCH
+ * Zadatak vlasnika uvijek uzima transakciju najvišeg prioriteta, tako da
+ * interaktivna HTTP komanda prekida polling sweep na sljedećoj granici okvira.
+ * BATCH (skupno čitanje soba, /room_status) je ispod pollinga: dugačak sweep
+ * ne gladuje ostale klase, nego ide između njihovih okvira.
+ *
+ * U RS485_WIRING_DUAL_UART modu svaki bus ima svoju "traku" (lane): vlastiti
+ * Rs485Service, redove i zadatak. Transakcija ide na traku svog bus_id-a, pa
+ * L i R rade paralelno. Sa dijeljenim RX-om postoji samo jedna traka i bus
+ * se bira preko DE pinova prije svake transakcije.
+ ******************************************************************************
+ */
+
+#ifndef RS485_BUS_OWNER_H
+#define RS485_BUS_OWNER_H
+
+#include <Arduino.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include "ProjectConfig.h"
+#include "Rs485Service.h"
+
+/**
+ * @brief Klasa prioriteta transakcije (manji broj = viši prioritet).
+ */
+enum class BusPriority : uint8_t
+{
+    HTTP = 0,
+    UPDATE,
+    TIME_SYNC,
+    LOG_DELETE,     ///< DELETE upisanog loga (bez deadline-a - ne smije se izgubiti)
+    POLLING,
+    BATCH           ///< Skupni upiti (RoomStatusSweep) - samo kada ostale klase ne čekaju
+};
+
+/**
+ * @brief Stanje transakcije.
+ */
+enum class BusTxnStatus : uint8_t
+{
+    PENDING,        ///< U redu ili se izvršava
+    DONE,           ///< Poslano (i primljen odgovor ako je tražen)
+    TIMEOUT,        ///< Nema odgovora u zadanom vremenu
+    EXPIRED,        ///< Predugo čekala u redu (deadline klase) - nije poslana
+    SEND_FAILED,    ///< Slanje nije uspjelo
+    RX_ERROR,       ///< Odgovor ne staje u buffer
+    REJECTED        ///< Red je pun
+};
+
+/**
+ * @brief Callback po završetku transakcije (iz zadatka vlasnika magistrale).
+ * @details Mora biti kratak i ne smije blokirati - transakcija se u njemu
+ *          više ne smije dirati (status je već upisan).
+ */
+typedef void (*BusTxnCallback)(void* context);
+
+/**
+ * @brief Jedna RS485 transakcija.
+ * @details Memoriju (struktura, tx i rx buffer) posjeduje pozivaoc i mora je
+ *          držati validnom dok status ne pređe iz PENDING.
+ */
+struct BusTransaction
+{
+    // --- Ulaz ---
+    BusPriority priority;
+    uint8_t bus_id;                 ///< 0 = Lijevi, 1 = Desni, RS485_BUS_CURRENT = bez promjene
+    const uint8_t* tx_data;
+    uint16_t tx_length;
+    uint8_t* rx_buffer;             ///< NULL ako se ne čeka odgovor
+    uint16_t rx_size;
+    uint32_t response_timeout_ms;   ///< 0 = fire-and-forget (broadcast, DELETE...)
+    bool single_byte_mode;          ///< STARI protokol: 1-bajtni ACK/NAK je kompletan odgovor
+    TaskHandle_t notify_task;       ///< Ako != NULL, dobija xTaskNotifyGive() po završetku
+    BusTxnCallback on_complete;     ///< Ako != NULL, poziva se po završetku (nakon upisa statusa)
+    void* context;                  ///< Argument za on_complete
+
+    // --- Izlaz ---
+    volatile BusTxnStatus status;
+    int rx_length;                  ///< Dužina primljenog okvira (ako je DONE i rx_buffer != NULL)
+    uint32_t rtt_us;                ///< Od kraja slanja do kraja prijema odgovora (0 = nema odgovora)
+
+    // --- Interno ---
+    uint32_t enqueue_time_us;
+};
+
+/**
+ * @brief Statistika jedne klase prioriteta.
+ */
+struct BusClassStats
+{
+    uint32_t submitted;
+    uint32_t completed;
+    uint32_t expired;
+    uint32_t rejected;
+    uint16_t max_depth;
+    uint64_t total_wait_us;
+    uint32_t max_wait_us;
+};
+
+class Rs485BusOwner;
+
+/**
+ * @brief Jedna traka: UART servis + redovi + zadatak koji ih opslužuje.
+ */
+struct BusLane
+{
+    Rs485BusOwner* owner;
+    uint8_t index;
+    Rs485Service* service;
+    QueueHandle_t queues[BUS_PRIORITY_CLASSES];
+    SemaphoreHandle_t work_semaphore;       ///< Broji transakcije u svim redovima trake
+    TaskHandle_t task_handle;
+    unsigned long last_txn_end_time;        ///< Za minimalni razmak između okvira
+    BusClassStats stats[BUS_PRIORITY_CLASSES];
+    portMUX_TYPE stats_lock;                ///< Submit() se zove iz više zadataka - brojači se mijenjaju pod ovim lock-om
+};
+
+class Rs485BusOwner
+{
+public:
+    Rs485BusOwner();
+
+    /**
+     * @brief Kreira redove i povezuje RS485 servis(e).
+     * @param pRs485Service Servis Lijevog busa (ili dijeljeni servis za oba busa).
+     * @param pRs485ServiceR Servis Desnog busa na zasebnom UART-u; NULL = dijeljeni RX.
+     */
+    void Initialize(Rs485Service* pRs485Service, Rs485Service* pRs485ServiceR = NULL);
+
+    /**
+     * @brief Pokreće po jedan FreeRTOS zadatak za svaku traku.
+     */
+    void StartTask();
+
+    /**
+     * @brief Da li L i R bus rade paralelno (zaseban UART po busu).
+     */
+    bool IsParallel() const { return m_lane_count > 1; }
+
+    /**
+     * @brief Neblokirajuće predaje transakciju u red njene klase.
+     * @param txn Transakcija (memorija pozivaoca).
+     * @return false ako je red pun (status = REJECTED).
+     */
+    bool Submit(BusTransaction* txn);
+
+    /**
+     * @brief Neblokirajuće: popunjava transakciju pozivaoca i predaje je u red.
+     * @details notify_task = trenutni zadatak, bez on_complete. Pozivaoc koristi vrijeme slanja
+     *          (npr. za čitanje sljedećeg chunk-a) pa poziva WaitForResult().
+     *          Parametri kao kod Transact().
+     * @return false ako je red pun (WaitForResult() tada odmah vraća -1).
+     */
+    bool Submit(BusTransaction* txn, BusPriority priority, uint8_t bus_id,
+                const uint8_t* tx_data, uint16_t tx_length,
+                uint8_t* rx_buffer, uint16_t rx_size,
+                uint32_t timeout_ms, bool single_byte_mode = false);
+
+    /**
+     * @brief Čeka završetak predate transakcije.
+     * @return Rezultat sa semantikom Transact(): dužina odgovora, 0 za timeout, -1 za grešku.
+     */
+    int WaitForResult(BusTransaction* txn);
+
+    /**
+     * @brief Blokirajuće: predaje transakciju i čeka njen završetak.
+     * @return Konačan status transakcije.
+     */
+    BusTxnStatus SubmitAndWait(BusTransaction* txn);
+
+    /**
+     * @brief Pomoćna blokirajuća transakcija sa semantikom ReceivePacket().
+     * @param priority Klasa prioriteta.
+     * @param bus_id Bus (0/1) ili RS485_BUS_CURRENT.
+     * @param tx_data Okvir za slanje.
+     * @param tx_length Dužina okvira.
+     * @param rx_buffer Buffer za odgovor (NULL = bez čekanja odgovora).
+     * @param rx_size Veličina buffera.
+     * @param timeout_ms Timeout odgovora.
+     * @param single_byte_mode 1-bajtni ACK/NAK (STARI protokol).
+     * @return Dužina odgovora (>0), 0 za timeout/bez odgovora, -1 za grešku.
+     */
+    int Transact(BusPriority priority, uint8_t bus_id,
+                 const uint8_t* tx_data, uint16_t tx_length,
+                 uint8_t* rx_buffer, uint16_t rx_size,
+                 uint32_t timeout_ms, bool single_byte_mode = false);
+
+    /**
+     * @brief Vraća JSON sa dubinom redova i vremenima čekanja po klasi.
+     */
+    String GetStatsJson();
+
+private:
+    static void TaskWrapper(void* pvParameters);
+    void RunTask(BusLane* lane);
+    void Execute(BusLane* lane, BusTransaction* txn);
+    void Complete(BusTransaction* txn, BusTxnStatus status);
+    uint32_t GetClassDeadlineMs(uint8_t priority_class);
+    BusLane* GetLaneForBus(uint8_t bus_id);
+    String GetLaneStatsJson(BusLane* lane);
+
+    BusLane m_lanes[RS485_MAX_BUS_LANES];
+    uint8_t m_lane_count;
+};
+
+#endif // RS485_BUS_OWNER_H
@@ -0,0 +1,113 @@
+/**
+ ******************************************************************************
+ * @file    Rs485FrameParser.h
+ * @author  Gemini & [Vase Ime]
+ * @brief   Inkrementalni parser RS485 okvira (bez zavisnosti od Arduino/IDF).
+ *
+ * @note
+ * Parser prima bajt po bajt i vraća stanje okvira. Pravila su identična
+ * onima iz hotel_ctrl.c:
+ *   [0] SOH/STX/ACK/NAK, [1..2] ciljna adresa, [3..4] izvorna adresa,
+ *   [5] dužina podataka, [6..] podaci, checksum (BE) od indeksa 6, EOT.
+ * Ukupna dužina okvira je data_len + 9 (minimalno 10 bajtova).
+ * Modul namjerno ne koristi Serial/millis kako bi se mogao testirati na hostu.
+ ******************************************************************************
+ */
+
+#ifndef RS485_FRAME_PARSER_H
+#define RS485_FRAME_PARSER_H
+
+#include <stdint.h>
+#include "ProjectConfig.h"
+
+/**
+ * @brief Rezultat ubacivanja jednog bajta u parser.
+ */
+enum class FrameStatus
+{
+    INCOMPLETE,     ///< Okvir još nije kompletan, čekaj nove bajtove
+    FRAME_READY,    ///< Kompletan i validan okvir je spreman (GetFrame/GetLength)
+    FRAME_ERROR     ///< Okvir je odbačen (vidi GetLastError)
+};
+
+/**
+ * @brief Razlog odbacivanja okvira.
+ */
+enum class FrameError
+{
+    NONE,
+    BAD_LENGTH,     ///< Bajt dužine [5] daje nevalidnu ukupnu dužinu
+    BAD_START,      ///< Prvi bajt nije SOH/STX/ACK/NAK
+    MISSING_EOT,    ///< Zadnji bajt nije EOT
+    WRONG_TARGET,   ///< Okvir nije adresiran na nas (rsifa)
+    BAD_CHECKSUM    ///< Checksum se ne poklapa
+};
+
+class Rs485FrameParser
+{
+public:
+    /**
+     * @brief Konstruktor.
+     */
+    Rs485FrameParser();
+
+    /**
+     * @brief Odbacuje djelimično primljen okvir i vraća parser u početno stanje.
+     */
+    void Reset();
+
+    /**
+     * @brief Postavlja našu RS485 adresu (rsifa) za provjeru ciljne adrese.
+     * @param address Adresa interfejsa.
+     */
+    void SetLocalAddress(uint16_t address) { m_local_address = address; }
+
+    /**
+     * @brief Uključuje/isključuje single-byte ACK/NAK mod (STARI protokol).
+     * @details U ovom modu se ACK (0x06) ili NAK (0x15) kao prvi bajt odmah
+     *          prijavljuju kao kompletan okvir dužine 1.
+     */
+    void SetSingleByteMode(bool enable) { m_single_byte_mode = enable; }
+
+    /**
+     * @brief Ubacuje jedan primljeni bajt u parser.
+     * @details Nakon FRAME_READY ili FRAME_ERROR sadržaj ostaje dostupan do
+     *          sljedećeg poziva Feed(), koji automatski počinje novi okvir.
+     * @param byte Primljeni bajt.
+     * @return Stanje okvira nakon ovog bajta.
+     */
+    FrameStatus Feed(uint8_t byte);
+
+    /**
+     * @brief Vraća pointer na primljene bajtove (kompletan ili djelimičan okvir).
+     */
+    const uint8_t* GetFrame() const { return m_buffer; }
+
+    /**
+     * @brief Vraća broj primljenih bajtova trenutnog okvira.
+     */
+    uint16_t GetLength() const { return m_rx_count; }
+
+    /**
+     * @brief Da li je prijem okvira u toku (primljen bar jedan bajt).
+     */
+    bool IsInProgress() const { return (m_rx_count > 0) && !m_frame_done; }
+
+    /**
+     * @brief Vraća razlog zadnjeg odbačenog okvira.
+     */
+    FrameError GetLastError() const { return m_last_error; }
+
+private:
+    bool ValidateFrame();
+
+    uint8_t m_buffer[MAX_PACKET_LENGTH];
+    uint16_t m_rx_count;
+    uint16_t m_expected_length;     ///< 0 dok ne primimo bajt dužine [5]
+    uint16_t m_local_address;
+    bool m_single_byte_mode;
+    bool m_frame_done;              ///< Okvir završen (READY/ERROR), sljedeći Feed() resetuje
+    FrameError m_last_error;
+};
+
+#endif // RS485_FRAME_PARSER_H
@@ -11,8 +11,11 @@
 
 #include <Arduino.h>
 #include <freertos/task.h> 
+#include <freertos/queue.h>
+#include <driver/uart.h>
 #include "ProjectConfig.h" 
 #include "EepromStorage.h" // Za pristup AppConfig (rsifa)
+#include "Rs485FrameParser.h"
 
 enum class Rs485State
 {
@@ -23,6 +26,18 @@ enum class Rs485State
     TIMEOUT
 };
 
+/**
+ * @brief Statistika slanja (mjerenje turnaround-a po okviru).
+ * @details overhead = trajanje SendPacket() - teoretsko trajanje okvira na liniji
+ *          (10 bita po bajtu). Sadrži DE zaštitne pauze i kašnjenje TX-done.
+ */
+struct Rs485TxStats
+{
+    uint32_t frames;
+    uint64_t total_overhead_us;
+    uint32_t max_overhead_us;
+};
+
 class Rs485Service
 {
 public:
@@ -33,9 +48,24 @@ public:
 
     /**
      * @brief Inicijalizuje UART interfejs i GPIO pinove.
+     * @details Instalira ESP-IDF UART drajver sa event queue-om. RX timeout
+     *          (RS485_RX_IDLE_SYMBOLS) generiše UART_DATA event na kraju okvira,
+     *          tako da prijemnik spava dok je linija tiha.
      */
     void Initialize();
 
+    /**
+     * @brief Inicijalizuje servis za jedan bus na vlastitom UART-u (bez dijeljenog RX-a).
+     * @details Koristi se u RS485_WIRING_DUAL_UART modu: svaki bus ima svoj
+     *          Rs485Service, pa L i R transakcije teku paralelno.
+     * @param bus_id ID bus-a koji ovaj servis opslužuje (0 = Lijevi, 1 = Desni).
+     * @param uart_num UART periferija.
+     * @param tx_pin TX pin.
+     * @param rx_pin RX pin.
+     * @param de_pin DE pin MAX485 drajvera.
+     */
+    void InitializeDedicated(uint8_t bus_id, uart_port_t uart_num, int tx_pin, int rx_pin, int de_pin);
+
     /**
      * @brief Šalje paket podataka preko RS485.
      * @param data Pointer na podatke.
@@ -46,6 +76,8 @@ public:
 
     /**
      * @brief Čeka i prima paket sa RS485 magistrale.
+     * @details Blokira na UART event queue-u (bez busy-polling-a). Timeout se
+     *          računa od zadnjeg primljenog bajta, kao i ranije.
      * @param buffer Buffer za smještanje primljenih podataka.
      * @param buffer_size Veličina buffera.
      * @param timeout_ms Timeout u milisekundama.
@@ -53,6 +85,41 @@ public:
      */
     int ReceivePacket(uint8_t* buffer, uint16_t buffer_size, uint32_t timeout_ms);
 
+    /**
+     * @brief Priprema neblokirajući prijem novog okvira (resetuje parser).
+     * @details Poziva se odmah nakon SendPacket(); nakon toga se PollPacket()
+     *          poziva iz state-mašine dok ne vrati okvir ili dok pozivaoc ne
+     *          utvrdi da je njegov deadline istekao.
+     */
+    void BeginReceive();
+
+    /**
+     * @brief Neblokirajuće: ubacuje sve trenutno primljene bajtove u parser.
+     * @param buffer Buffer za kompletan okvir.
+     * @param buffer_size Veličina buffera.
+     * @return Dužina okvira ako je kompletan, 0 ako još nije, -1 ako ne staje u buffer.
+     */
+    int PollPacket(uint8_t* buffer, uint16_t buffer_size);
+
+    /**
+     * @brief Vrijeme (millis) zadnjeg primljenog bajta.
+     * @details Pozivaoc koristi za produženje deadline-a dok okvir pristiže.
+     */
+    unsigned long GetLastRxTime() const { return m_last_rx_time; }
+
+    /**
+     * @brief Spava dok UART ne prijavi novi event ili dok ne istekne max_wait.
+     * @details Ne troši event; koristi se u loop() da CPU bude slobodan dok
+     *          state-mašina čeka odgovor.
+     * @param max_wait Maksimalno čekanje u tick-ovima.
+     */
+    void WaitForRxEvent(TickType_t max_wait);
+
+    /**
+     * @brief Ispisuje djelimično primljen okvir (dijagnostika nakon timeout-a).
+     */
+    void LogIncompleteFrame();
+
     /**
      * @brief Aktivira single-byte ACK/NAK mod za STARI protokol (SAX/HILLS/itd).
      * @details Kada je aktiviran, ReceivePacket() odmah prihvata ACK (0x06) ili NAK (0x15)
@@ -68,6 +135,21 @@ public:
      */
     void DisableSingleByteMode();
 
+    /**
+     * @brief Da li je single-byte ACK/NAK mod trenutno aktivan.
+     */
+    bool IsSingleByteMode() const { return m_single_byte_mode; }
+
+    /**
+     * @brief Da li DE pinom upravlja UART hardver (RS485 half-duplex mod).
+     */
+    bool IsHwDeControl() const { return m_hw_de_control; }
+
+    /**
+     * @brief Vraća statistiku slanja (turnaround overhead po okviru).
+     */
+    const Rs485TxStats& GetTxStats() const { return m_tx_stats; }
+
     /**
      * @brief Selektuje aktivni RS485 bus (Lijevi ili Desni).
      * @details U dual bus mode-u, kontroliše DE pinove:
@@ -75,6 +157,8 @@ public:
      *          - Neaktivni bus: DE stalno HIGH (disabled - RX onemogućen)
      * @param busId ID bus-a: 0 = Lijevi (DE_PIN1), 1 = Desni (DE_PIN2)
      * @note KRITIČNO: Neaktivni bus mora imati DE=HIGH da ne ometa dijeljenu RX liniju!
+     * @note U RS485_HW_DE_CONTROL modu RTS signal se premješta na DE pin novog busa,
+     *       a DE pin starog busa se vraća u GPIO (HIGH).
      */
     void SelectBus(uint8_t busId);
 
@@ -85,10 +169,23 @@ public:
     uint8_t GetActiveBus() const { return m_active_bus; }
 
 private:
-    bool ValidatePacket(uint8_t* buffer, uint16_t length);
-    uint16_t CalculateChecksum(uint8_t* buffer, uint16_t data_length); 
+    /**
+     * @brief Prebacuje sve bajtove iz RX ring buffera drajvera u parser.
+     * @param buffer Buffer pozivaoca za kompletan okvir.
+     * @param buffer_size Veličina buffera.
+     * @param bytes_consumed [out] Broj pročitanih bajtova.
+     * @return Dužina okvira ako je kompletan, -1 ako ne staje u buffer, inače 0.
+     */
+    int DrainRxBuffer(uint8_t* buffer, uint16_t buffer_size, uint16_t* bytes_consumed);
+    bool InstallUartDriver(int tx_pin, int rx_pin);
+    void UpdateTxStats(uint16_t length, uint32_t elapsed_us);
+    void LogFrameError();
+    void ProcessPendingEvents();
 
-    HardwareSerial m_rs485_serial;
+    uart_port_t m_uart_num;
+    QueueHandle_t m_uart_event_queue;
+    Rs485FrameParser m_parser;
+    unsigned long m_last_rx_time;
     
     /**
      * @brief Flag koji omogućava single-byte ACK/NAK prijem za STARI protokol.
@@ -103,6 +200,10 @@ private:
      */
     uint8_t m_active_bus;
 
+    uint8_t m_de_pin;   ///< DE pin aktivnog bus-a
+    bool m_dedicated;   ///< true = zaseban UART za jedan bus (SelectBus() ne mijenja bus)
+    bool m_hw_de_control; ///< true = DE vodi RTS (UART_MODE_RS485_HALF_DUPLEX)
+    Rs485TxStats m_tx_stats;
 };
 
 #endif // RS485_SERVICE_H
\ No newline at end of file
@@ -0,0 +1,93 @@
+/**
+ ******************************************************************************
+ * @file    Rs485Trace.h
+ * @author  Gemini & [Vase Ime]
+ * @brief   Binarni trace RS485 okvira (prstenasti buffer fiksne veličine).
+ *
+ * @note
+ * Rs485Service upisuje svaki poslani/primljeni okvir (vrijeme, bus, smjer,
+ * dužina, sirovi bajtovi) kopiranjem u ring - bez formatiranja i bez Serial
+ * ispisa na vrućem putu. Formatiranje se radi samo na zahtjev, preko
+ * HTTP endpointa /rs485_trace (pcap ili tekst).
+ ******************************************************************************
+ */
+
+#ifndef RS485_TRACE_H
+#define RS485_TRACE_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include "ProjectConfig.h"
+
+/**
+ * @brief Smjer/vrsta zapisa.
+ */
+enum class Rs485TraceDir : uint8_t
+{
+    TX = 0,         ///< Poslan okvir
+    RX,             ///< Primljen kompletan okvir
+    RX_PARTIAL,     ///< Timeout sa djelimično primljenim okvirom
+    RX_ERROR        ///< Okvir odbačen (checksum/format)
+};
+
+/**
+ * @brief Jedan zapis u ringu.
+ */
+struct Rs485TraceEntry
+{
+    uint32_t seq;           ///< Redni broj zapisa (0 = prazan)
+    uint32_t timestamp_us;  ///< micros() u trenutku zapisa
+    uint8_t bus;
+    Rs485TraceDir dir;
+    uint16_t length;        ///< Stvarna dužina okvira
+    uint8_t data[RS485_TRACE_SNAP_LEN]; ///< Prvih min(length, SNAP_LEN) bajtova
+};
+
+class Rs485Trace
+{
+public:
+    Rs485Trace();
+
+    /**
+     * @brief Upisuje okvir u ring (sigurno iz više zadataka).
+     * @param bus ID busa (0/1).
+     * @param dir Smjer/vrsta zapisa.
+     * @param data Sirovi bajtovi okvira.
+     * @param length Dužina okvira.
+     */
+    void Record(uint8_t bus, Rs485TraceDir dir, const uint8_t* data, uint16_t length);
+
+    /**
+     * @brief Briše sve zapise.
+     */
+    void Clear();
+
+    /**
+     * @brief Ispisuje sadržaj ringa (od najstarijeg) kao pcap fajl.
+     * @details LINKTYPE_USER0; svaki paket počinje sa 2 bajta [bus, smjer],
+     *          zatim slijede bajtovi okvira.
+     */
+    void WritePcap(Print& out);
+
+    /**
+     * @brief Ispisuje sadržaj ringa (od najstarijeg) kao tekst, jedan okvir po liniji.
+     */
+    void WriteText(Print& out);
+
+    /**
+     * @brief Formatira bajtove kao "XX XX ..." (linearno, bez strlen()).
+     * @return Broj upisanih znakova (bez '\0').
+     */
+    static size_t FormatHex(const uint8_t* data, uint16_t length, char* out, size_t out_size);
+
+private:
+    bool CopyEntry(uint32_t seq, Rs485TraceEntry* out);
+
+    Rs485TraceEntry m_entries[RS485_TRACE_ENTRIES];
+    uint32_t m_next_seq;        ///< seq sljedećeg zapisa (počinje od 1)
+    portMUX_TYPE m_lock;
+};
+
+extern Rs485Trace g_rs485Trace;
+
+#endif // RS485_TRACE_H
@@ -0,0 +1,128 @@
+/**
+ ******************************************************************************
+ * @file    RttEstimator.h
+ * @author  Gemini & [Vase Ime]
+ * @brief   Procjena vremena odziva (RTT) uređaja i adaptivni timeout odgovora.
+ *
+ * @note
+ * Po uzoru na TCP (Jacobson/Karels): SRTT i RTTVAR se ažuriraju iz izmjerenih
+ * vremena odziva, a timeout = SRTT + 4*RTTVAR, ograničen na granice protokola.
+ * Karn-ovo pravilo: uzorci iz ponovljenih pokušaja se ne koriste (odgovor može
+ * pripadati ranijem pokušaju), a timeout ponovljenog pokušaja se udvostručuje.
+ ******************************************************************************
+ */
+
+#ifndef RTT_ESTIMATOR_H
+#define RTT_ESTIMATOR_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include "ProjectConfig.h"
+
+/**
+ * @brief SRTT/RTTVAR procjena za jedan uređaj (ili jednu sesiju).
+ */
+class RttEstimator
+{
+public:
+    RttEstimator() { Reset(); }
+
+    /**
+     * @brief Briše procjenu (nema uzoraka).
+     */
+    void Reset();
+
+    /**
+     * @brief Dodaje izmjereni RTT (samo iz prvog pokušaja - Karn).
+     * @param rtt_us Vrijeme od kraja slanja do kraja prijema odgovora.
+     */
+    void AddSample(uint32_t rtt_us);
+
+    /**
+     * @brief Bilježi timeout (samo statistika; procjena se ne mijenja).
+     */
+    void AddTimeout() { if (m_timeouts < 0xFFFF) m_timeouts++; }
+
+    /**
+     * @brief Da li postoji bar jedan uzorak.
+     */
+    bool HasSamples() const { return m_samples > 0; }
+
+    /**
+     * @brief Timeout u ms iz procjene (SRTT + 4*RTTVAR + margina), bez gornje granice.
+     */
+    uint32_t GetRtoMs() const;
+
+    /**
+     * @brief Timeout za dati pokušaj, ograničen na [RTT_MIN_TIMEOUT_MS, max_ms].
+     * @param max_ms Gornja granica (fiksni timeout protokola); koristi se i bez uzoraka.
+     * @param attempt 0 = prvi pokušaj; svaki ponovljeni pokušaj udvostručuje timeout.
+     */
+    uint32_t GetTimeoutMs(uint32_t max_ms, uint8_t attempt = 0) const;
+
+    uint32_t GetSrttUs() const { return m_srtt_us; }
+    uint32_t GetRttvarUs() const { return m_rttvar_us; }
+    uint16_t GetSamples() const { return m_samples; }
+    uint16_t GetTimeouts() const { return m_timeouts; }
+
+private:
+    uint32_t m_srtt_us;
+    uint32_t m_rttvar_us;
+    uint16_t m_samples;     ///< Saturira na 0xFFFF
+    uint16_t m_timeouts;    ///< Saturira na 0xFFFF
+};
+
+/**
+ * @brief Tabela RTT procjena po adresi uređaja (polling).
+ * @details Hash sa linearnim probanjem; pristup je zaštićen spinlock-om jer
+ *          tabelu čita HTTP zadatak (/rtt_table) dok je pollinga ažurira.
+ */
+class RttTable
+{
+public:
+    RttTable();
+
+    /**
+     * @brief Dodaje uzorak za adresu (i u zbirnu procjenu svih uređaja).
+     */
+    void AddSample(uint16_t address, uint32_t rtt_us);
+
+    /**
+     * @brief Bilježi timeout za adresu.
+     */
+    void AddTimeout(uint16_t address);
+
+    /**
+     * @brief Adaptivni timeout za adresu.
+     * @details Uređaj bez uzoraka dobija zbirnu procjenu x RTT_UNSEEN_FACTOR
+     *          (kada ima dovoljno uzoraka), inače max_ms.
+     * @param address Adresa uređaja.
+     * @param max_ms Fiksni timeout protokola (gornja granica).
+     * @param attempt 0 = prvi pokušaj.
+     */
+    uint32_t GetTimeoutMs(uint16_t address, uint32_t max_ms, uint8_t attempt = 0);
+
+    /**
+     * @brief Ispisuje JSON sa zbirnom procjenom i redom [addr, srtt_us, rttvar_us,
+     *        rto_ms, samples, timeouts] za svaku poznatu adresu.
+     */
+    void WriteJson(Print& out);
+
+private:
+    struct Slot
+    {
+        uint16_t address;
+        bool used;
+        RttEstimator rtt;
+    };
+
+    Slot* FindSlot(uint16_t address, bool create);
+
+    Slot m_slots[RTT_TABLE_SIZE];
+    RttEstimator m_aggregate;
+    portMUX_TYPE m_lock;
+};
+
+extern RttTable g_rttTable;
+
+#endif // RTT_ESTIMATOR_H
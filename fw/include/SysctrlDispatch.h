@@ -0,0 +1,209 @@
+/**
+ ******************************************************************************
+ * @file    SysctrlDispatch.h
+ * @author  Gemini & [Vase Ime]
+ * @brief   Tabela parametara i komandi /sysctrl.cgi (bez zavisnosti od web servera).
+ *
+ * @note
+ * Parametri zahtjeva se jednim prolazom pretvaraju u ključeve (binarna
+ * pretraga sortirane liste), a komanda se bira iz tabele ruta po prioritetu.
+ * HttpServer puni SysctrlArgs iz AsyncWebServerRequest-a; host benchmark
+ * (test/bench_sysctrl_dispatch) koristi isti kod nad svojim parametrima.
+ ******************************************************************************
+ */
+
+#ifndef SYSCTRL_DISPATCH_H
+#define SYSCTRL_DISPATCH_H
+
+#include <Arduino.h>
+
+// Svi poznati parametri /sysctrl.cgi, SORTIRANI po strcmp() redoslijedu
+// (velika slova prije malih). Indeks u listi je ujedno i ključ (SysctrlKey),
+// pa se ime parametra u jednom prolazu pretvara u ključ binarnom pretragom.
+#define SYSCTRL_KEY_LIST(X) \
+    X(DTSET, "DTset") \
+    X(HCFWU, "HCfwu") \
+    X(HSSET, "HSset") \
+    X(RQLOG, "RQlog") \
+    X(BR, "br") \
+    X(BUF, "buf") \
+    X(BUL, "bul") \
+    X(BUS_WIRING, "bus_wiring") \
+    X(CAD, "cad") \
+    X(CBR, "cbr") \
+    X(CDI, "cdi") \
+    X(CDO, "cdo") \
+    X(CST, "cst") \
+    X(CTR, "ctr") \
+    X(CTRL, "ctrl") \
+    X(CUD, "cud") \
+    X(DI0, "di0") \
+    X(DI1, "di1") \
+    X(DI2, "di2") \
+    X(DI3, "di3") \
+    X(DI4, "di4") \
+    X(DI5, "di5") \
+    X(DI6, "di6") \
+    X(DI7, "di7") \
+    X(DIF, "dif") \
+    X(DO0, "do0") \
+    X(DO1, "do1") \
+    X(DO2, "do2") \
+    X(DO3, "do3") \
+    X(DO4, "do4") \
+    X(DO5, "do5") \
+    X(DO6, "do6") \
+    X(DO7, "do7") \
+    X(DUAL_BUS, "dual_bus") \
+    X(FUF, "fuf") \
+    X(FUL, "ful") \
+    X(FWU, "fwu") \
+    X(GWA, "gwa") \
+    X(IFA, "ifa") \
+    X(ILA, "ila") \
+    X(IPA, "ipa") \
+    X(IPR, "ipr") \
+    X(IUF, "iuf") \
+    X(IUL, "iul") \
+    X(LOG, "log") \
+    X(LOGGER_EN, "logger_en") \
+    X(MAX_AGE, "max_age") \
+    X(MDNSNAME, "mdnsname") \
+    X(MOD, "mod") \
+    X(NID, "nid") \
+    X(OUT, "out") \
+    X(OWA, "owa") \
+    X(PER, "per") \
+    X(PGA, "pga") \
+    X(PGU, "pgu") \
+    X(PROTO, "proto") \
+    X(PROTOL, "protoL") \
+    X(PROTOR, "protoR") \
+    X(QRA, "qra") \
+    X(QRC, "qrc") \
+    X(QRD, "qrd") \
+    X(RBA, "rba") \
+    X(RGA, "rga") \
+    X(RIB, "rib") \
+    X(RSA, "rsa") \
+    X(RSC, "rsc") \
+    X(RST, "rst") \
+    X(RUD, "rud") \
+    X(SBR, "sbr") \
+    X(SET_ADD_SYNC, "set_add_sync") \
+    X(SET_IFACE, "set_iface") \
+    X(SET_PROTO, "set_proto") \
+    X(SID, "sid") \
+    X(SNM, "snm") \
+    X(SPT, "spt") \
+    X(STA, "sta") \
+    X(STG, "stg") \
+    X(SYNC_A0, "sync_a0") \
+    X(SYNC_A1, "sync_a1") \
+    X(SYNC_A2, "sync_a2") \
+    X(SYNC_EN0, "sync_en0") \
+    X(SYNC_EN1, "sync_en1") \
+    X(SYNC_EN2, "sync_en2") \
+    X(SYNC_P0, "sync_p0") \
+    X(SYNC_P1, "sync_p1") \
+    X(SYNC_P2, "sync_p2") \
+    X(SYSID, "sysid") \
+    X(TBM, "tbm") \
+    X(TBT, "tbt") \
+    X(TDA, "tda") \
+    X(TDI, "tdi") \
+    X(TDN, "tdn") \
+    X(TDT, "tdt") \
+    X(TDU, "tdu") \
+    X(THA, "tha") \
+    X(TIME_SYNC_INTERVAL, "time_sync_interval") \
+    X(TLG, "tlg") \
+    X(TRC, "trc") \
+    X(TUF, "tuf") \
+    X(TX0, "tx0") \
+    X(TX1, "tx1") \
+    X(TXA, "txa") \
+    X(TXC, "txc") \
+    X(TXF, "txf") \
+    X(TXH, "txh") \
+    X(TXT, "txt") \
+    X(TXV, "txv") \
+    X(TY0, "ty0") \
+    X(TY1, "ty1") \
+    X(VAL, "val")
+
+#define SYSCTRL_KEY_ENUM(id, name) SK_##id,
+
+enum SysctrlKey : uint8_t
+{
+    SYSCTRL_KEY_LIST(SYSCTRL_KEY_ENUM)
+    SK_COUNT
+};
+
+static_assert(SK_DI7 - SK_DI0 == 7 && SK_DO7 - SK_DO0 == 7, "di0..di7 / do0..do7 moraju biti uzastopni");
+static_assert(SK_SYNC_A2 - SK_SYNC_A0 == 2 && SK_SYNC_EN2 - SK_SYNC_EN0 == 2 && SK_SYNC_P2 - SK_SYNC_P0 == 2, "sync_* moraju biti uzastopni");
+
+/**
+ * @brief Komande /sysctrl.cgi.
+ */
+enum class SysctrlCmd : uint8_t
+{
+    SET_IP, PROTO, PROTO_LR, SET_PROTO, SYSID, MDNS_NAME, LOGGER_EN, TIME_SYNC_INTERVAL,
+    DUAL_BUS, BUS_WIRING, SET_IFACE, SET_ADD_SYNC, DATE_TIME, LOG, LOAD_ADDR_LIST, HC_FW_UPDATE,
+    RC_OLD_FW_UPDATE, RC_FW_UPDATE, RC_BL_UPDATE, RT_FW_UPDATE, RT_LOGO_UPDATE, RC_IMAGE_UPDATE,
+    PERMITED_GROUP, DIN_CFG, RT_DISP_MSG, RT_DISP_STA, RT_QRC, ROOM_TEMP, APPL_STAT, BEDDING_REPL,
+    ROOM_STATUS, PREVIEW_IMG, DOUT_STATE, DISPL_BCKLGHT, SOS_RESET, RS485_CFG, SYSTEM_ID, RESTART,
+    HOTEL_STATUS
+};
+
+#define SYSCTRL_ROUTE_MAX_KEYS  5
+
+/**
+ * @brief Komanda se bira ako su prisutni svi njeni ključevi (i vrijednost, ako je zadana).
+ */
+struct SysctrlRoute
+{
+    SysctrlCmd cmd;
+    uint8_t key_count;
+    uint8_t keys[SYSCTRL_ROUTE_MAX_KEYS];
+    const char* value;      ///< NULL = bilo koja vrijednost prvog ključa
+};
+
+/**
+ * @brief Parametri zahtjeva, parsirani jednim prolazom (ključ -> vrijednost i int).
+ * @details Vrijednosti se ne kopiraju - pokazuju na String-ove pozivaoca (request-a),
+ *          koji moraju živjeti dok se SysctrlArgs koristi.
+ *          Kao hasParam()/getParam(): pobjeđuje prvi parametar istog imena.
+ */
+class SysctrlArgs
+{
+public:
+    SysctrlArgs();
+
+    /**
+     * @brief Dodaje parametar zahtjeva; nepoznata imena i ponovljeni ključevi se ignorišu.
+     */
+    void Add(const char* name, const String& value);
+
+    bool Has(uint8_t key) const { return m_values[key] != NULL; }
+    const String& Value(uint8_t key) const;
+    long Int(uint8_t key) const { return m_ints[key]; }  ///< 0 ako parametar ne postoji
+
+private:
+    const String* m_values[SK_COUNT];
+    long m_ints[SK_COUNT];
+};
+
+/**
+ * @brief Binarna pretraga imena parametra u sortiranoj listi ključeva.
+ * @return Ključ ili -1 za nepoznat parametar.
+ */
+int FindSysctrlKey(const char* name);
+
+/**
+ * @brief Prva komanda (po prioritetu) čiji su svi ključevi prisutni.
+ * @return NULL ako nijedna komanda ne odgovara.
+ */
+const SysctrlRoute* FindSysctrlRoute(const SysctrlArgs& args);
+
+#endif // SYSCTRL_DISPATCH_H
@@ -13,7 +13,7 @@
 #ifndef TIME_SYNC_H
 #define TIME_SYNC_H
 
-#include "Rs485Service.h" // Za IRs485Manager
+#include "Rs485BusOwner.h"
 #include "ProjectConfig.h"
 #include "EepromStorage.h" // Za g_appConfig
 
@@ -27,9 +27,9 @@ public:
 
     /**
      * @brief Inicijalizuje TimeSync modul.
-     * @param pRs485Service Pointer na RS485 servis.
+     * @param pBusOwner Pointer na vlasnika RS485 magistrale.
      */
-    void Initialize(Rs485Service* pRs485Service);
+    void Initialize(Rs485BusOwner* pBusOwner);
 
     /**
      * @brief Provjerava i šalje broadcast vremena ako je potrebno.
@@ -49,8 +49,9 @@ public:
 
 private:
     void SendTimeBroadcast();
+    void SendBroadcast(const uint8_t* packet, uint16_t length);
 
-    Rs485Service* m_rs485_service;
+    Rs485BusOwner* m_bus_owner;
     unsigned long m_last_sync_time;
 };
 
@@ -0,0 +1,77 @@
+/**
+ ******************************************************************************
+ * @file    UpdateChunkPrefetch.h
+ * @author  Gemini & [Vase Ime]
+ * @brief   Unaprijed čita sljedeći chunk update fajla dok je okvir na liniji.
+ *
+ * @note
+ * UpdateManager i FirmwareUpdateManager predaju DATA okvir vlasniku magistrale
+ * neblokirajuće (Rs485BusOwner::Submit) i za vrijeme slanja i čekanja ACK-a
+ * čitaju sljedeći chunk sa uSD kartice i računaju njegovu sumu. Ako ACK stigne,
+ * sljedeći DATA okvir se gradi iz ovog buffera bez čekanja na karticu; nakon
+ * NAK-a/timeout-a offset se ne poklapa i chunk se čita ponovo sa kartice.
+ ******************************************************************************
+ */
+
+#ifndef UPDATE_CHUNK_PREFETCH_H
+#define UPDATE_CHUNK_PREFETCH_H
+
+// --- RJEŠAVANJE KONFLIKTA MAKROA (FS/SdFat) ---
+#ifdef FILE_READ
+#undef FILE_READ
+#endif
+#ifdef FILE_WRITE
+#undef FILE_WRITE
+#endif
+// ------------------------------------------------------------
+
+#include <Arduino.h>
+#include <SD.h>
+#include "ProjectConfig.h"
+
+class UpdateChunkPrefetch
+{
+public:
+    UpdateChunkPrefetch();
+
+    /**
+     * @brief Poništava prefetch i brojače (početak nove sesije).
+     */
+    void Reset();
+
+    /**
+     * @brief Čita chunk na datom offsetu u interni buffer.
+     * @details Poziva se dok vlasnik magistrale šalje prethodni okvir.
+     * @param file Otvoren update fajl.
+     * @param offset Offset chunk-a u fajlu.
+     * @param chunk_size Veličina chunk-a (max UPDATE_DATA_CHUNK_SIZE).
+     */
+    void Prefetch(File& file, uint32_t offset, uint16_t chunk_size);
+
+    /**
+     * @brief Vraća chunk na datom offsetu: iz prefetch buffera ako se poklapa, inače sa kartice.
+     * @param file Otvoren update fajl.
+     * @param offset Offset chunk-a u fajlu.
+     * @param buffer Odredišni buffer (min chunk_size bajtova).
+     * @param chunk_size Veličina chunk-a.
+     * @param data_sum [out] Suma bajtova chunk-a (dio checksum-a okvira).
+     * @return Broj pročitanih bajtova (0 ili manje = kraj fajla/greška).
+     */
+    int16_t Read(File& file, uint32_t offset, uint8_t* buffer, uint16_t chunk_size, uint16_t* data_sum);
+
+    uint32_t GetHits() const { return m_hits; }
+    uint32_t GetMisses() const { return m_misses; }
+
+private:
+    static uint16_t SumBytes(const uint8_t* data, int16_t length);
+
+    uint8_t m_buffer[UPDATE_DATA_CHUNK_SIZE];
+    int16_t m_length;       ///< 0 = nema prefetch-a
+    uint32_t m_offset;
+    uint16_t m_chunk_size;
+    uint16_t m_sum;
+    uint32_t m_hits;        ///< Chunk-ovi uzeti iz prefetch buffera
+    uint32_t m_misses;      ///< Chunk-ovi pročitani sa kartice u kritičnom putu
+};
+
+#endif // UPDATE_CHUNK_PREFETCH_H
@@ -23,8 +23,10 @@
 #endif
 // ------------------------------------------------------------
 
-#include "Rs485Service.h"
+#include "Rs485BusOwner.h"
 #include "SdCardManager.h"
+#include "UpdateChunkPrefetch.h"
+#include "RttEstimator.h"
 #include "ProjectConfig.h" // DODATO: Da bi APP_START_DEL bio dostupan
 #include <SD.h>
 
@@ -108,10 +110,10 @@ public:
 
     /**
      * @brief Inicijalizuje Update menadžera.
-     * @param pRs485Service Pointer na RS485 servis.
+     * @param pBusOwner Pointer na vlasnika RS485 magistrale.
      * @param pSdCardManager Pointer na SD Card menadžera.
      */
-    void Initialize(Rs485Service* pRs485Service, SdCardManager* pSdCardManager);
+    void Initialize(Rs485BusOwner* pBusOwner, SdCardManager* pSdCardManager);
 
     /**
      * @brief Postavlja referencu na HTTP server.
@@ -172,6 +174,8 @@ private:
     void SendRestartCommand();
     void SendAppExeCommand(); // Deklaracija za novu funkciju
     void CleanupSession(bool failed = false);
+    bool StageFrame(const uint8_t* packet, uint16_t length);
+    void PrefetchNextChunk();
     
     // REFAKTORISANA: Određuje ime fajla, otvara ga i čita metadatu
     bool PrepareSession(UpdateSession* s, uint8_t updateCmd); 
@@ -210,9 +214,18 @@ private:
      */
     bool UseSingleByteAckForProtocol(uint16_t address);
 
-    Rs485Service* m_rs485_service;
+    Rs485BusOwner* m_bus_owner;
     SdCardManager* m_sd_card_manager;
     class HttpServer* m_http_server;
+
+    // Okvir pripremljen u FAZI 1 (Send*), šalje se u FAZI 2 kao jedna transakcija
+    uint8_t m_tx_frame[MAX_PACKET_LENGTH];
+    uint16_t m_tx_length;
+    bool m_single_byte_ack; // STARI protokol: 1-bajtni ACK/NAK za ovu sesiju
+    uint8_t m_bus_id;       // Bus klijenta (dual mode) ili RS485_BUS_CURRENT
+    UpdateChunkPrefetch m_prefetch;     // Sljedeći chunk, čitan dok je DATA okvir na liniji
+    RttEstimator m_update_rtt;          // Odziv klijenta na DATA okvire (adaptivni timeout)
+    unsigned long m_session_start_time; // Za mjerenje trajanja transfera
     uint8_t m_last_sent_sub_cmd; // NOVO: Čuva zadnju poslanu sub-komandu (npr. 0x64)
     
     // Zastavice za sekvencijalnu logiku
@@ -0,0 +1,151 @@
+/**
+ ******************************************************************************
+ * @file    DeviceDirectory.cpp
+ * @author  Gemini & [Vase Ime]
+ * @brief   Implementacija direktorija uređaja.
+ ******************************************************************************
+ */
+
+#include "DeviceDirectory.h"
+#include "EepromStorage.h"
+#include <stdlib.h>
+
+// Globalna konfiguracija (extern)
+extern AppConfig g_appConfig;
+
+// Globalni direktorij (gradi LogPullManager, čitaju svi moduli koji rutiraju po adresi)
+DeviceDirectory g_deviceDirectory;
+
+static int CompareDeviceInfo(const void* a, const void* b)
+{
+    const DeviceInfo* da = (const DeviceInfo*)a;
+    const DeviceInfo* db = (const DeviceInfo*)b;
+    if (da->address != db->address) {
+        return (da->address < db->address) ? -1 : 1;
+    }
+    // Ista adresa: Lijevi bus ispred Desnog (on ostaje nakon uklanjanja duplikata)
+    return (int)da->bus - (int)db->bus;
+}
+
+DeviceDirectory::DeviceDirectory() :
+    m_count(0)
+{
+    memset(m_entries, 0, sizeof(m_entries));
+    m_default.address = 0;
+    m_default.bus = DEVICE_BUS_UNKNOWN;
+    m_default.protocol = 0;
+    m_default.flags = 0;
+    portMUX_TYPE init = portMUX_INITIALIZER_UNLOCKED;
+    m_lock = init;
+}
+
+/**
+ * @brief Postavlja protokol i protokol-zavisne flagove na osnovu busa uređaja.
+ */
+void DeviceDirectory::ResolveProtocol(DeviceInfo* info)
+{
+    info->protocol = (info->bus == 1) ? g_appConfig.protocol_version_R : g_appConfig.protocol_version_L;
+
+    if (static_cast<ProtocolVersion>(info->protocol) == ProtocolVersion::HILLS) {
+        info->flags |= DEVICE_FLAG_HILLS;
+    } else {
+        info->flags &= ~DEVICE_FLAG_HILLS;
+    }
+}
+
+void DeviceDirectory::Build(const uint16_t* list_L, uint16_t count_L, const uint16_t* list_R, uint16_t count_R)
+{
+    if (count_L > MAX_ADDRESS_LIST_SIZE_PER_BUS) count_L = MAX_ADDRESS_LIST_SIZE_PER_BUS;
+    if (count_R > MAX_ADDRESS_LIST_SIZE_PER_BUS) count_R = MAX_ADDRESS_LIST_SIZE_PER_BUS;
+
+    // Gradi se u setup()-u prije pokretanja HTTP/polling zadataka - bez lock-a
+    uint16_t n = 0;
+    for (uint16_t i = 0; i < count_L; i++) {
+        m_entries[n].address = list_L[i];
+        m_entries[n].bus = 0;
+        m_entries[n].flags = 0;
+        n++;
+    }
+    for (uint16_t i = 0; i < count_R; i++) {
+        m_entries[n].address = list_R[i];
+        m_entries[n].bus = 1;
+        m_entries[n].flags = 0;
+        n++;
+    }
+
+    qsort(m_entries, n, sizeof(DeviceInfo), CompareDeviceInfo);
+
+    // Ukloni duplikate (zadrži prvi = Lijevi bus) i razriješi protokol
+    uint16_t unique = 0;
+    for (uint16_t i = 0; i < n; i++)
+    {
+        if (unique > 0 && m_entries[unique - 1].address == m_entries[i].address) {
+            m_entries[unique - 1].flags |= DEVICE_FLAG_DUPLICATE;
+            continue;
+        }
+        m_entries[unique] = m_entries[i];
+        ResolveProtocol(&m_entries[unique]);
+        unique++;
+    }
+
+    m_count = unique;
+    ResolveProtocol(&m_default);
+
+    if (unique != n) {
+        Serial.printf("[DeviceDirectory] UPOZORENJE: %u adresa je u obje liste (koristi se Lijevi bus)\n", n - unique);
+    }
+    Serial.printf("[DeviceDirectory] %u uređaja (L=%u, R=%u)\n", m_count, count_L, count_R);
+}
+
+void DeviceDirectory::RefreshProtocols()
+{
+    portENTER_CRITICAL(&m_lock);
+    for (uint16_t i = 0; i < m_count; i++) {
+        ResolveProtocol(&m_entries[i]);
+    }
+    ResolveProtocol(&m_default);
+    portEXIT_CRITICAL(&m_lock);
+}
+
+/**
+ * @brief Binarna pretraga. Poziva se unutar kritične sekcije.
+ */
+const DeviceInfo* DeviceDirectory::Find(uint16_t address) const
+{
+    uint16_t lo = 0;
+    uint16_t hi = m_count;
+    while (lo < hi)
+    {
+        uint16_t mid = lo + (hi - lo) / 2;
+        if (m_entries[mid].address < address) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return (lo < m_count && m_entries[lo].address == address) ? &m_entries[lo] : NULL;
+}
+
+bool DeviceDirectory::Lookup(uint16_t address, DeviceInfo* out)
+{
+    portENTER_CRITICAL(&m_lock);
+    const DeviceInfo* info = Find(address);
+    *out = (info != NULL) ? *info : m_default;
+    portEXIT_CRITICAL(&m_lock);
+
+    out->address = address;
+    return (info != NULL);
+}
+
+int8_t DeviceDirectory::GetBus(uint16_t address)
+{
+    DeviceInfo info;
+    return Lookup(address, &info) ? (int8_t)info.bus : -1;
+}
+
+ProtocolVersion DeviceDirectory::GetProtocol(uint16_t address)
+{
+    DeviceInfo info;
+    Lookup(address, &info);
+    return static_cast<ProtocolVersion>(info.protocol);
+}
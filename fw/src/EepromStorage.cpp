@@ -14,15 +14,57 @@
 // Konstante za EEPROM
 #define EEPROM_PAGE_SIZE 256 // ISPRAVKA: Prema AT24C1024 datasheet-u, veličina stranice je 256 bajtova.
 #define EEPROM_WRITE_DELAY 5 
+#define EEPROM_BLOCK_SIZE 0x10000UL // NOVO: 24C1024 = 2 bloka od 64 KB, A16 je bit 0 I2C adrese uređaja
+#define EEPROM_READ_CHUNK 128       // NOVO: Wire (ESP32) RX bafer je 128 bajtova
+#define LOG_SCAN_BATCH    (EEPROM_PAGE_SIZE / LOG_ENTRY_SIZE) // Slotova po čitanju pri skeniranju
+
+// Kodovi Wire.endTransmission() (arduino-esp32 2.0.x): 2 = NACK (ESP_FAIL),
+// 4 = greška magistrale/arbitraže, 5 = timeout drajvera
+#define I2C_ERROR_NACK        2
+#define I2C_ERROR_NACK_DATA   3
+#define I2C_ERROR_SHORT_READ  0xFF // requestFrom() vratio manje bajtova (kod greške nije dostupan)
+
+/**
+ * @brief I2C adresa uređaja za blok u kojem je adresa (A16 -> bit 0).
+ */
+static inline uint8_t EepromDeviceAddr(uint32_t address)
+{
+    return (uint8_t)(EEPROM_I2C_ADDR | ((address >> 16) & 0x01));
+}
 
 // Globalni objekat za konfiguraciju
 AppConfig g_appConfig; 
 
+/**
+ * @brief Drži mutex EEPROM-a do kraja bloka.
+ * @details Logove upisuje LogWriter zadatak, a HTTP zadatak ih istovremeno čita
+ *          i briše - I2C transakcija i head/tail indeksi moraju biti zaštićeni.
+ *          Mutex je rekurzivan jer javne funkcije pozivaju WriteBytes()/ReadBytes().
+ */
+class EepromLock
+{
+public:
+    explicit EepromLock(SemaphoreHandle_t mutex) : m_mutex(mutex)
+    {
+        if (m_mutex != NULL) xSemaphoreTakeRecursive(m_mutex, portMAX_DELAY);
+    }
+    ~EepromLock()
+    {
+        if (m_mutex != NULL) xSemaphoreGiveRecursive(m_mutex);
+    }
+private:
+    SemaphoreHandle_t m_mutex;
+};
+
 
 EepromStorage::EepromStorage() :
+    m_mutex(NULL),
     m_log_write_index(0),
     m_log_read_index(0),
-    m_log_count(0)
+    m_log_count(0),
+    m_meta_generation(0),
+    m_stage_count(0),
+    m_i2c_clock_hz(EEPROM_I2C_FALLBACK_CLOCK_HZ)
 {
     // Konstruktor
 }
@@ -126,7 +168,9 @@ void EepromStorage::MigrateConfig(uint16_t oldVersion)
     // Ako je true ili false, ostavi kao što jeste; ako je inicijalizovano, ne mijenjaj
     // Ali ako struktura dolazi iz stare verzije, postavi default na true (omogući logger)
     // Budući da je bool, ne možemo provjeriti "prazninu", ali možemo provjeriti da li je verzija stara
-    if (oldVersion < EEPROM_CONFIG_VERSION)
+    // KRITIČNO: Verzija u kojoj je polje dodato (V2), ne trenutna - inače bi svaka
+    // migracija vratila logger na true i korisnik bi izgubio svoju postavku.
+    if (oldVersion < 2)
     {
         // Nova instalacija ili stara verzija - omogući logger po defaultu
         g_appConfig.logger_enable = true;
@@ -177,12 +221,24 @@ void EepromStorage::MigrateConfig(uint16_t oldVersion)
     
     // Postavi default za use_wifi_as_primary (default: false = Ethernet primarni)
     // Ova provera radi jer je bool tipa, ali koristimo verziju kao indikator
-    if (oldVersion < EEPROM_CONFIG_VERSION)
+    // (verzija u kojoj je polje dodato - V4 uređaji zadržavaju svoju postavku)
+    if (oldVersion < 4)
     {
         g_appConfig.use_wifi_as_primary = false;
         LOG_DEBUG(2, "[Eeprom] Inicijalizovan use_wifi_as_primary -> false (Ethernet primarni - default)\n");
     }
     
+    // ========================================================================
+    // NOVO: Ožičenje dual bus moda (dodato u V5)
+    // ========================================================================
+
+    // Stari uređaji su ožičeni sa dijeljenim RX-om - zadrži to ponašanje
+    if (oldVersion < 5 || g_appConfig.rs485_wiring_mode > RS485_WIRING_DUAL_UART)
+    {
+        g_appConfig.rs485_wiring_mode = RS485_DEFAULT_WIRING_MODE;
+        LOG_DEBUG(2, "[Eeprom] Inicijalizovan rs485_wiring_mode -> %d (dijeljeni RX - kompatibilnost)\n", RS485_DEFAULT_WIRING_MODE);
+    }
+
     // ========================================================================
     // TEMPLATE ZA BUDUĆA POLJA - kopiraj i prilagodi:
     // ========================================================================
@@ -297,6 +353,9 @@ void EepromStorage::LoadDefaultConfig()
     // 12. NEW: WiFi Configuration (default: Ethernet primarni)
     g_appConfig.use_wifi_as_primary = false;
 
+    // 12.1 NEW: Ožičenje dual bus moda (default: dijeljeni RX)
+    g_appConfig.rs485_wiring_mode = RS485_DEFAULT_WIRING_MODE;
+
     // 13. Snimi nove (defaultne) vrijednosti u EEPROM
     if (WriteConfig(&g_appConfig))
     {
@@ -312,7 +371,11 @@ void EepromStorage::Initialize(int8_t sda_pin, int8_t scl_pin)
 {
     LOG_DEBUG(5, "[Eeprom] Entering Initialize()...\n");
     LOG_DEBUG(3, "[Eeprom] Inicijalizacija I2C na SDA=%d, SCL=%d\n", sda_pin, scl_pin);
+    if (m_mutex == NULL) {
+        m_mutex = xSemaphoreCreateRecursiveMutex();
+    }
     Wire.begin(sda_pin, scl_pin);
+    SelectI2cClock();
     
     // Učitaj globalnu konfiguraciju
     if (!ReadConfig(&g_appConfig))
@@ -420,18 +483,109 @@ bool EepromStorage::WriteConfig(const AppConfig* config)
 }
 
 //=============================================================================
-// I2C Drajver - Implementacija Page Write logike (24C1024)
+// I2C Drajver - Implementacija Page Write logike (24C1024, 17-bit adresa)
 //=============================================================================
 
-bool EepromStorage::WriteBytes(uint16_t address, const uint8_t* data, uint16_t length)
+/**
+ * @brief Spušta I2C takt sa Fm+ na rezervni nakon greške na magistrali.
+ * @return true ako je takt spušten (pozivaoc ponavlja transakciju), false ako je već rezervni.
+ */
+bool EepromStorage::LowerI2cClock()
+{
+    if (m_i2c_clock_hz <= EEPROM_I2C_FALLBACK_CLOCK_HZ) {
+        return false;
+    }
+    m_i2c_clock_hz = EEPROM_I2C_FALLBACK_CLOCK_HZ;
+    Wire.setClock(m_i2c_clock_hz);
+    LOG_DEBUG(2, "[Eeprom] UPOZORENJE: I2C greška na Fm+, prelazim na %lu Hz.\n", (unsigned long)m_i2c_clock_hz);
+    return true;
+}
+
+/**
+ * @brief Čeka da EEPROM završi ciklus upisa ("Acknowledge Polling" prema datasheet-u).
+ * @details Tokom ciklusa upisa EEPROM ne potvrđuje svoju adresu. Čim endTransmission()
+ *          vrati 0, uređaj je spreman. Između ping-ova zadatak spava jedan tick
+ *          (vTaskDelay) umjesto da vrti I2C bus - ciklus traje ~5 ms.
+ */
+bool EepromStorage::WaitForWriteCycle(uint8_t device_addr)
+{
+    TickType_t ack_poll_start = xTaskGetTickCount();
+    while (true)
+    {
+        vTaskDelay(EEPROM_ACK_POLL_INTERVAL_TICKS);
+        Wire.beginTransmission(device_addr);
+        if (Wire.endTransmission() == 0) {
+            return true;
+        }
+        if ((xTaskGetTickCount() - ack_poll_start) > pdMS_TO_TICKS(EEPROM_ACK_POLL_TIMEOUT_MS)) {
+            return false;
+        }
+    }
+}
+
+/**
+ * @brief Odluka nakon neuspjele I2C transakcije: čekanje ciklusa upisa ili sporiji takt.
+ * @details NACK (i kratko čitanje) je normalan kad je EEPROM u ciklusu upisa - tada
+ *          se čeka ACK polling-om i takt ostaje isti. Takt se spušta samo na grešku
+ *          magistrale (arbitraža, timeout drajvera) ili kad uređaj ne odgovori ni
+ *          nakon isteka ACK polling-a.
+ */
+bool EepromStorage::RecoverI2cError(uint8_t device_addr, uint8_t error)
+{
+    if (error != I2C_ERROR_NACK && error != I2C_ERROR_NACK_DATA && error != I2C_ERROR_SHORT_READ)
+    {
+        LOG_DEBUG(2, "[Eeprom] I2C greška magistrale (kod %u).\n", error);
+        return LowerI2cClock();
+    }
+    if (WaitForWriteCycle(device_addr)) {
+        return true;
+    }
+    LOG_DEBUG(2, "[Eeprom] EEPROM ne potvrđuje adresu ni nakon %u ms.\n", EEPROM_ACK_POLL_TIMEOUT_MS);
+    return LowerI2cClock();
+}
+
+/**
+ * @brief Bira najbrži I2C takt koji EEPROM (i ožičenje) podržava.
+ * @details Isti blok se čita na rezervnom taktu i na Fm+; Fm+ ostaje samo ako
+ *          čitanje uspije i podaci su identični.
+ */
+void EepromStorage::SelectI2cClock()
 {
-    LOG_DEBUG(5, "[Eeprom] Entering WriteBytes(addr=0x%04X, len=%u)...\n", address, length);
-    uint16_t current_addr = address;
+    uint8_t reference[16];
+    uint8_t probe[16];
+
+    m_i2c_clock_hz = EEPROM_I2C_FALLBACK_CLOCK_HZ;
+    Wire.setClock(m_i2c_clock_hz);
+    if (EEPROM_I2C_CLOCK_HZ <= EEPROM_I2C_FALLBACK_CLOCK_HZ ||
+        !ReadBytes(EEPROM_CONFIG_START_ADDR, reference, sizeof(reference)))
+    {
+        return;
+    }
+
+    m_i2c_clock_hz = EEPROM_I2C_CLOCK_HZ;
+    Wire.setClock(m_i2c_clock_hz);
+    if (!ReadBytes(EEPROM_CONFIG_START_ADDR, probe, sizeof(probe)) ||
+        memcmp(reference, probe, sizeof(reference)) != 0)
+    {
+        // ReadBytes() je možda već spustio takt; ako nije (pogrešni podaci), spusti ga ovdje
+        LowerI2cClock();
+    }
+    LOG_DEBUG(3, "[Eeprom] I2C takt: %lu Hz\n", (unsigned long)m_i2c_clock_hz);
+}
+
+bool EepromStorage::WriteBytes(uint32_t address, const uint8_t* data, uint16_t length)
+{
+    EepromLock lock(m_mutex);
+    LOG_DEBUG(5, "[Eeprom] Entering WriteBytes(addr=0x%05lX, len=%u)...\n", (unsigned long)address, length);
+    uint32_t current_addr = address;
     uint16_t bytes_remaining = length;
     uint16_t data_offset = 0;
+    uint8_t retries = 0; // Ponavljanja tekućeg chunk-a
 
     while (bytes_remaining > 0)
     {
+        // Stranica nikad ne prelazi granicu bloka od 64 KB, pa je blok isti za cijeli chunk
+        uint8_t device_addr = EepromDeviceAddr(current_addr);
         uint16_t page_offset = current_addr % EEPROM_PAGE_SIZE;
         uint16_t bytes_to_end_of_page = EEPROM_PAGE_SIZE - page_offset;
         uint16_t chunk_size = min(bytes_remaining, bytes_to_end_of_page);
@@ -439,8 +593,8 @@ bool EepromStorage::WriteBytes(uint16_t address, const uint8_t* data, uint16_t l
         // ISPRAVKA: Wire buffer je 128 bajtova. 2 bajta adrese + 64 bajta podataka = 66 bajtova (SIGURNO).
         chunk_size = min(chunk_size, (uint16_t)64);
         
-        LOG_DEBUG(4, "[Eeprom] -> Pisanje chunk-a: addr=0x%04X, size=%u\n", current_addr, chunk_size);
-        Wire.beginTransmission(EEPROM_I2C_ADDR);
+        LOG_DEBUG(4, "[Eeprom] -> Pisanje chunk-a: addr=0x%05lX, size=%u\n", (unsigned long)current_addr, chunk_size);
+        Wire.beginTransmission(device_addr);
         Wire.write((uint8_t)(current_addr >> 8));   
         Wire.write((uint8_t)(current_addr & 0xFF)); 
         
@@ -451,31 +605,25 @@ bool EepromStorage::WriteBytes(uint16_t address, const uint8_t* data, uint16_t l
              return false; // Kritična greška - ne možemo nastaviti
         }
         
-        if (Wire.endTransmission() != 0)
+        uint8_t error = Wire.endTransmission();
+        if (error != 0)
         {
-            LOG_DEBUG(1, "[Eeprom] GRESKA: I2C endTransmission nije uspio.\n");
+            // NOVO: NACK -> čekaj kraj ciklusa upisa; greška magistrale -> sporiji takt. Isti chunk se ponavlja.
+            if (retries++ < EEPROM_I2C_RETRIES && RecoverI2cError(device_addr, error)) continue;
+            LOG_DEBUG(1, "[Eeprom] GRESKA: I2C endTransmission nije uspio (kod %u).\n", error);
             return false;
         }
         
-        // IMPLEMENTACIJA "ACKNOWLEDGE POLLING" PREMA DATASHEET-u
-        // Nakon što je poslat STOP bit (sa Wire.endTransmission()), EEPROM započinje interni
-        // ciklus pisanja. Tokom ovog ciklusa, on ne odgovara (ne šalje ACK) na svoju I2C adresu.
-        // Petlja ispod konstantno "ping-uje" EEPROM slanjem njegove adrese.
-        // Čim EEPROM odgovori sa ACK (endTransmission vrati 0), znamo da je spreman za sljedeću komandu.
-        unsigned long ack_poll_start = millis();
-        while (true)
+        // Nakon STOP bita EEPROM započinje interni ciklus upisa - čekaj ACK prije sljedeće komande
+        if (!WaitForWriteCycle(device_addr))
         {
-            Wire.beginTransmission(EEPROM_I2C_ADDR);
-            if (Wire.endTransmission() == 0) {
-                break; // Uspjeh! EEPROM je odgovorio sa ACK, spreman je.
-            }
-            if (millis() - ack_poll_start > 15) { // Sigurnosni timeout od 15ms
-                LOG_DEBUG(1, "[Eeprom] GRESKA: ACK Polling timeout. EEPROM ne odgovara.\n");
-                return false;
-            }
-            // Ne treba delay, petlja se vrti maksimalnom brzinom dok čeka odgovor.
+            // Uređaj ne odgovara ni nakon tWR - chunk se ponavlja na sporijem taktu
+            if (retries++ < EEPROM_I2C_RETRIES && LowerI2cClock()) continue;
+            LOG_DEBUG(1, "[Eeprom] GRESKA: ACK Polling timeout. EEPROM ne odgovara.\n");
+            return false;
         }
 
+        retries = 0;
         current_addr += chunk_size;
         data_offset += chunk_size;
         bytes_remaining -= chunk_size;
@@ -485,35 +633,44 @@ bool EepromStorage::WriteBytes(uint16_t address, const uint8_t* data, uint16_t l
     return true;
 }
 
-bool EepromStorage::ReadBytes(uint16_t address, uint8_t* data, uint16_t length)
+bool EepromStorage::ReadBytes(uint32_t address, uint8_t* data, uint16_t length)
 {
-    LOG_DEBUG(5, "[Eeprom] Entering CHUNKED ReadBytes(addr=0x%04X, len=%u)...\n", address, length);
+    EepromLock lock(m_mutex);
+    LOG_DEBUG(5, "[Eeprom] Entering CHUNKED ReadBytes(addr=0x%05lX, len=%u)...\n", (unsigned long)address, length);
     
     uint16_t bytes_remaining = length;
-    uint16_t current_addr = address;
+    uint32_t current_addr = address;
     uint16_t data_offset = 0;
+    uint8_t retries = 0; // Ponavljanja tekućeg chunk-a
 
     while (bytes_remaining > 0)
     {
-        // Smanjujemo i čitanje na 64 radi konzistentnosti i sigurnosti I2C bafera
-        uint16_t chunk_size = min((uint16_t)bytes_remaining, (uint16_t)64);
-        LOG_DEBUG(4, "[Eeprom] -> Čitanje chunk-a: addr=0x%04X, size=%u\n", current_addr, chunk_size);
+        // NOVO: Čitanje koristi cijeli Wire RX bafer (adresa ide u zasebnu TX transakciju)
+        uint16_t chunk_size = min((uint16_t)bytes_remaining, (uint16_t)EEPROM_READ_CHUNK);
+        // NOVO: Chunk ne smije preći granicu bloka od 64 KB (druga I2C adresa uređaja)
+        uint32_t bytes_to_end_of_block = EEPROM_BLOCK_SIZE - (current_addr % EEPROM_BLOCK_SIZE);
+        if (chunk_size > bytes_to_end_of_block) chunk_size = (uint16_t)bytes_to_end_of_block;
+        uint8_t device_addr = EepromDeviceAddr(current_addr);
+        LOG_DEBUG(4, "[Eeprom] -> Čitanje chunk-a: addr=0x%05lX, size=%u\n", (unsigned long)current_addr, chunk_size);
 
         // 1. Postavi adresu sa koje se čita
-        Wire.beginTransmission(EEPROM_I2C_ADDR);
+        Wire.beginTransmission(device_addr);
         Wire.write((uint8_t)(current_addr >> 8));
         Wire.write((uint8_t)(current_addr & 0xFF));
         
         // endTransmission(false) šalje REPEATED START, što je ključno za čitanje.
-        if (Wire.endTransmission(false) != 0)
+        uint8_t error = Wire.endTransmission(false);
+        if (error != 0)
         {
-            LOG_DEBUG(1, "[Eeprom] GRESKA: I2C endTransmission (za čitanje) nije uspio.\n");
+            if (retries++ < EEPROM_I2C_RETRIES && RecoverI2cError(device_addr, error)) continue;
+            LOG_DEBUG(1, "[Eeprom] GRESKA: I2C endTransmission (za čitanje) nije uspio (kod %u).\n", error);
             return false;
         }
 
         // 2. Zatraži i pročitaj "komad" podataka
-        if (Wire.requestFrom((uint8_t)EEPROM_I2C_ADDR, (size_t)chunk_size) != chunk_size)
+        if (Wire.requestFrom(device_addr, (size_t)chunk_size) != chunk_size)
         {
+            if (retries++ < EEPROM_I2C_RETRIES && RecoverI2cError(device_addr, I2C_ERROR_SHORT_READ)) continue;
             LOG_DEBUG(1, "[Eeprom] GRESKA: I2C requestFrom nije vratio očekivani broj bajtova za chunk.\n");
             return false;
         }
@@ -524,6 +681,7 @@ bool EepromStorage::ReadBytes(uint16_t address, uint8_t* data, uint16_t length)
         }
 
         // Ažuriraj pokazivače za sljedeću iteraciju
+        retries = 0;
         bytes_remaining -= chunk_size;
         current_addr += chunk_size;
         data_offset += chunk_size;
@@ -537,7 +695,124 @@ bool EepromStorage::ReadBytes(uint16_t address, uint8_t* data, uint16_t length)
 // API za Logger (Rjesava greske u Loger funkcijama)
 //=============================================================================
 
+// NOVO: Zapis metapodataka logera (16 bajta, jedan slot)
+#define LOGGER_META_MAGIC   0x4C4D  // 'LM'
+
+struct LoggerMeta
+{
+    uint16_t magic;
+    uint16_t head;          ///< m_log_write_index
+    uint16_t tail;          ///< m_log_read_index
+    uint16_t count;         ///< m_log_count
+    uint32_t generation;    ///< Raste sa svakim upisom; veći = noviji slot
+    uint16_t reserved;      ///< 0 (ulazi u CRC; raniji upisi su ovdje imali brojač brisanja)
+    uint16_t crc;           ///< CRC16-CCITT preko prethodnih 14 bajta
+};
+
+static_assert(sizeof(LoggerMeta) == 16, "LoggerMeta mora biti 16 bajta");
+static_assert(EEPROM_LOG_START_ADDR + EEPROM_LOG_AREA_SIZE <= EEPROM_LOGGER_META_ADDR_A,
+              "Log podrucje se preklapa sa metapodacima logera");
+static_assert(EEPROM_LOGGER_META_ADDR_B + sizeof(LoggerMeta) <= EEPROM_TOTAL_SIZE,
+              "Metapodaci logera su izvan EEPROM-a");
+
+static uint16_t LoggerMetaCrc(const LoggerMeta* meta)
+{
+    const uint8_t* data = (const uint8_t*)meta;
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < offsetof(LoggerMeta, crc); i++)
+    {
+        crc ^= (uint16_t)data[i] << 8;
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+static bool IsLoggerMetaValid(const LoggerMeta* meta)
+{
+    if (meta->magic != LOGGER_META_MAGIC || meta->crc != LoggerMetaCrc(meta)) return false;
+    if (meta->head >= MAX_LOG_ENTRIES || meta->tail >= MAX_LOG_ENTRIES) return false;
+    if (meta->count > MAX_LOG_ENTRIES) return false;
+    // Konzistentnost kružnog bafera: tail + count == head
+    return ((meta->tail + meta->count) % MAX_LOG_ENTRIES) == meta->head;
+}
+
+// Nijedan validan slot: prvi start, stari firmware ili oštećenje oba slota
+bool EepromStorage::LoadLoggerMeta()
+{
+    const uint32_t slot_addr[2] = { EEPROM_LOGGER_META_ADDR_A, EEPROM_LOGGER_META_ADDR_B };
+    LoggerMeta best = {};
+    bool found = false;
+
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        LoggerMeta meta;
+        if (!ReadBytes(slot_addr[i], (uint8_t*)&meta, sizeof(meta)) || !IsLoggerMetaValid(&meta)) {
+            LOG_DEBUG(3, "[Eeprom] Slot metapodataka %c nije validan.\n", 'A' + i);
+            continue;
+        }
+        if (!found || meta.generation > best.generation) {
+            best = meta;
+            found = true;
+        }
+    }
+
+    if (!found) return false;
+
+    m_log_write_index = best.head;
+    m_log_read_index = best.tail;
+    m_log_count = best.count;
+    m_meta_generation = best.generation;
+    return true;
+}
+
+/**
+ * @brief Upisuje head/tail/count u stariji slot (naizmjenično A/B).
+ * @details Prekid napajanja tokom upisa ošteti samo slot koji se upisuje -
+ *          drugi slot i dalje drži prethodno stanje.
+ */
+bool EepromStorage::SaveLoggerMeta()
+{
+    LoggerMeta meta;
+    meta.magic = LOGGER_META_MAGIC;
+    meta.head = m_log_write_index;
+    meta.tail = m_log_read_index;
+    meta.count = m_log_count;
+    meta.generation = m_meta_generation + 1;
+    meta.reserved = 0;
+    meta.crc = LoggerMetaCrc(&meta);
+
+    uint32_t addr = (meta.generation & 1) ? EEPROM_LOGGER_META_ADDR_B : EEPROM_LOGGER_META_ADDR_A;
+    if (!WriteBytes(addr, (const uint8_t*)&meta, sizeof(meta)))
+    {
+        LOG_DEBUG(1, "[Eeprom] GRESKA: Upis metapodataka logera na 0x%05lX nije uspio.\n", (unsigned long)addr);
+        return false;
+    }
+
+    m_meta_generation = meta.generation;
+    return true;
+}
+
 void EepromStorage::LoggerInit()
+{
+    // NOVO: Metapodaci umjesto skeniranja cijelog log područja (3900 čitanja preko I2C)
+    if (LoadLoggerMeta())
+    {
+        LOG_DEBUG(3, "[Eeprom] Logger učitan iz metapodataka (gen %lu): %u logova, Head: %u, Tail: %u\n",
+                  (unsigned long)m_meta_generation, m_log_count, m_log_write_index, m_log_read_index);
+        return;
+    }
+
+    // Nema validnih metapodataka - skeniraj i zapiši ih za sljedeći start
+    LoggerScan();
+    SaveLoggerMeta();
+}
+
+// NAPOMENA: Obrisani logovi se ne nuliraju (DeleteLogBlock i ClearAllLogs mijenjaju
+// samo metapodatke), pa skeniranje nakon gubitka OBA slota metapodataka može vratiti
+// već preuzete logove (duplikati, nikad gubitak). Na starom formatu je tačno.
+void EepromStorage::LoggerScan()
 {
     LOG_DEBUG(3, "[Eeprom] Započeto skeniranje EEPROM-a za logove...\n");
 
@@ -548,18 +823,26 @@ void EepromStorage::LoggerInit()
 
     // 1. Pronađi prvi uzastopni blok validnih logova
     // ISPRAVKA: Ne koristimo status bajt, čitamo log_id iz LogEntry
-    for (uint16_t i = 0; i < MAX_LOG_ENTRIES; ++i)
+    // NOVO: Slotovi se čitaju u grupama (ReadLogRange) umjesto jednog I2C čitanja po slotu
+    uint8_t scan_buffer[LOG_SCAN_BATCH * LOG_ENTRY_SIZE];
+    bool scan_done = false;
+    for (uint16_t batch_start = 0; batch_start < MAX_LOG_ENTRIES && !scan_done; batch_start += LOG_SCAN_BATCH)
     {
-        // Reset watchdog svakih 100 iteracija (duga operacija)
-        if (i % 100 == 0)
+        // Reset watchdog po grupi (duga operacija)
+        esp_task_wdt_reset();
+
+        uint16_t batch_count = min((uint16_t)LOG_SCAN_BATCH, (uint16_t)(MAX_LOG_ENTRIES - batch_start));
+        if (!ReadLogRange(batch_start, batch_count, scan_buffer))
         {
-            esp_task_wdt_reset();
+            continue;
         }
 
-        uint16_t addr = EEPROM_LOG_START_ADDR + (i * LOG_ENTRY_SIZE);
-        LogEntry temp_entry;
-        if (ReadBytes(addr, (uint8_t*)&temp_entry, sizeof(LogEntry)))
+        for (uint16_t j = 0; j < batch_count; ++j)
         {
+            uint16_t i = batch_start + j;
+            LogEntry temp_entry;
+            memcpy(&temp_entry, &scan_buffer[j * LOG_ENTRY_SIZE], LOG_ENTRY_SIZE);
+
             // Provjeri da li je log_id != 0 i != 0xFFFF (validni log)
             if (temp_entry.log_id != 0 && temp_entry.log_id != 0xFFFF)
             {
@@ -580,12 +863,14 @@ void EepromStorage::LoggerInit()
                 {
                     // Rupa u logovima - prestani brojati (ignorisi rasute stare logove)
                     LOG_DEBUG(2, "[Eeprom] Detektovana rupa na poziciji %u, zaustavljam brojanje.\n", i);
+                    scan_done = true;
                     break;
                 }
             }
             else if (first_valid_found)
             {
                 // Prazan slot nakon što smo počeli brojati - kraj uzastopnog bloka
+                scan_done = true;
                 break;
             }
         }
@@ -618,7 +903,7 @@ void EepromStorage::LoggerInit()
                           ( (last_valid_index == MAX_LOG_ENTRIES - 1) && (first_valid_index > 0) );
 
         uint16_t next_free_index = (last_valid_index + 1) % MAX_LOG_ENTRIES;
-        uint16_t check_addr = EEPROM_LOG_START_ADDR + (next_free_index * LOG_ENTRY_SIZE);
+        uint32_t check_addr = EEPROM_LOG_START_ADDR + ((uint32_t)next_free_index * LOG_ENTRY_SIZE);
         LogEntry check_entry;
         ReadBytes(check_addr, (uint8_t*)&check_entry, sizeof(LogEntry));
 
@@ -646,39 +931,141 @@ void EepromStorage::LoggerInit()
     }
 }
 
+bool EepromStorage::ReadLogRange(uint16_t first_index, uint16_t count, uint8_t* dest)
+{
+    EepromLock lock(m_mutex);
+    uint16_t done = 0;
+    while (done < count)
+    {
+        // Uzastopni slotovi do kraja log područja; ostatak se čita od slota 0
+        uint16_t index = (first_index + done) % MAX_LOG_ENTRIES;
+        uint16_t run = min((uint16_t)(count - done), (uint16_t)(MAX_LOG_ENTRIES - index));
+        uint32_t read_addr = EEPROM_LOG_START_ADDR + ((uint32_t)index * LOG_ENTRY_SIZE);
+
+        LOG_DEBUG(4, "[Eeprom]   Citanje %u logova: index=%u, addr=0x%05lX\n", run, index, (unsigned long)read_addr);
+        if (!ReadBytes(read_addr, dest + (done * LOG_ENTRY_SIZE), run * LOG_ENTRY_SIZE))
+        {
+            return false;
+        }
+        done += run;
+    }
+    return true;
+}
+
 LoggerStatus EepromStorage::WriteLog(const LogEntry* entry)
 {
-    // Adresa na koju upisujemo novi log (head)
-    uint16_t write_addr = EEPROM_LOG_START_ADDR + (m_log_write_index * LOG_ENTRY_SIZE);
+    EepromLock lock(m_mutex);
+    LoggerStatus status = StageLog(entry);
+    if (status != LoggerStatus::LOGGER_OK)
+    {
+        return status;
+    }
+    return FlushLogs();
+}
+
+LoggerStatus EepromStorage::StageLog(const LogEntry* entry)
+{
+    EepromLock lock(m_mutex);
 
-    // Upisujemo 16 bajtova LogEntry strukture
-    if (!WriteBytes(write_addr, (const uint8_t*)entry, LOG_ENTRY_SIZE))
+    // Pun bafer se prvo upisuje (upis cijele stranice), pa se tek onda dodaje novi log
+    if (m_stage_count >= LOG_STAGE_ENTRIES)
     {
-        LOG_DEBUG(1, "[Eeprom] GRESKA: Pisanje loga na adresu 0x%04X nije uspjelo.\n", write_addr);
-        return LoggerStatus::LOGGER_ERROR;
+        LoggerStatus status = FlushLogs();
+        if (status != LoggerStatus::LOGGER_OK)
+        {
+            return status;
+        }
     }
 
-    // Pomjeramo head (indeks za pisanje) na sljedeću poziciju
-    m_log_write_index = (m_log_write_index + 1) % MAX_LOG_ENTRIES;
+    memcpy(&m_stage_buffer[m_stage_count * LOG_ENTRY_SIZE], entry, LOG_ENTRY_SIZE);
+    m_stage_count++;
+    return LoggerStatus::LOGGER_OK;
+}
+
+LoggerStatus EepromStorage::FlushLogs()
+{
+    EepromLock lock(m_mutex);
+    if (m_stage_count == 0)
+    {
+        return LoggerStatus::LOGGER_OK;
+    }
+
+    uint16_t staged = m_stage_count;
+    // Bafer se prazni i kod greške - logovi se ne brišu sa uređaja pa će biti ponovo preuzeti
+    m_stage_count = 0;
+
+    // Uzastopni slotovi od head-a; na kraju log područja upis se dijeli na dva dijela.
+    // WriteBytes() dijeli svaki dio na granicama stranica EEPROM-a.
+    uint16_t written = 0;
+    while (written < staged)
+    {
+        uint16_t index = (m_log_write_index + written) % MAX_LOG_ENTRIES;
+        uint16_t run = min((uint16_t)(staged - written), (uint16_t)(MAX_LOG_ENTRIES - index));
+        uint32_t write_addr = EEPROM_LOG_START_ADDR + ((uint32_t)index * LOG_ENTRY_SIZE);
+
+        if (!WriteBytes(write_addr, &m_stage_buffer[written * LOG_ENTRY_SIZE], run * LOG_ENTRY_SIZE))
+        {
+            LOG_DEBUG(1, "[Eeprom] GRESKA: Pisanje %u logova na adresu 0x%05lX nije uspjelo.\n", run, (unsigned long)write_addr);
+            return LoggerStatus::LOGGER_ERROR;
+        }
+        written += run;
+    }
+
+    // Stanje prije upisa - vraća se ako metapodaci ne budu upisani
+    uint16_t old_write_index = m_log_write_index;
+    uint16_t old_read_index = m_log_read_index;
+    uint16_t old_count = m_log_count;
+    uint32_t old_generation = m_meta_generation;
+
+    // Pomjeramo head (indeks za pisanje) iza upisanih logova
+    m_log_write_index = (m_log_write_index + staged) % MAX_LOG_ENTRIES;
 
     // Ako je bafer pun, tail (indeks čitanja) također mora pratiti head.
-    if (m_log_count >= MAX_LOG_ENTRIES)
+    uint16_t free_slots = MAX_LOG_ENTRIES - m_log_count;
+    if (staged > free_slots)
     {
-        m_log_read_index = (m_log_read_index + 1) % MAX_LOG_ENTRIES;
-        LOG_DEBUG(4, "[Eeprom] Bafer je pun, prepisan je najstariji log.\n");
+        uint16_t overwritten = staged - free_slots;
+        m_log_read_index = (m_log_read_index + overwritten) % MAX_LOG_ENTRIES;
+        m_log_count = MAX_LOG_ENTRIES;
+        LOG_DEBUG(4, "[Eeprom] Bafer je pun, prepisano je %u najstarijih logova.\n", overwritten);
     }
     else
     {
         // Ako bafer nije pun, samo povećavamo brojač
-        m_log_count++;
+        m_log_count += staged;
     }
 
-    LOG_DEBUG(3, "[Eeprom] Log uspješno zapisan. Ukupno logova: %u. Head: %u, Tail: %u\n", m_log_count, m_log_write_index, m_log_read_index);
+    // Log nije trajno zapisan dok head nije u metapodacima (inače se nakon
+    // restarta prepisuje) - greška se prijavljuje da se log ne obriše sa uređaja
+    if (!SaveLoggerMeta())
+    {
+        // Kao DeleteLogBlock(): RAM stanje ostaje isto kao u metapodacima. Upisani
+        // slotovi su od head-a i biće prepisani ponovo preuzetim logovima (kod punog
+        // bafera su već prepisali najstarije - isto bi bilo i nakon restarta).
+        m_log_write_index = old_write_index;
+        m_log_read_index = old_read_index;
+        m_log_count = old_count;
+        m_meta_generation = old_generation;
+        return LoggerStatus::LOGGER_ERROR;
+    }
+
+    LOG_DEBUG(3, "[Eeprom] Upisano %u logova. Ukupno logova: %u. Head: %u, Tail: %u\n", staged, m_log_count, m_log_write_index, m_log_read_index);
     return LoggerStatus::LOGGER_OK;
 }
 
+void EepromStorage::DiscardStagedLogs()
+{
+    EepromLock lock(m_mutex);
+    if (m_stage_count > 0)
+    {
+        LOG_DEBUG(2, "[Eeprom] Odbačeno %u neupisanih logova iz bafera.\n", m_stage_count);
+    }
+    m_stage_count = 0;
+}
+
 LoggerStatus EepromStorage::GetOldestLog(LogEntry* entry)
 {
+    EepromLock lock(m_mutex);
     LOG_DEBUG(5, "[Eeprom] Entering GetOldestLog()...\n");
     if (m_log_count == 0)
     {
@@ -688,18 +1075,18 @@ LoggerStatus EepromStorage::GetOldestLog(LogEntry* entry)
     // Citamo 1 bajt (status) + LOG_ENTRY_SIZE bajtova podataka
     uint8_t read_buffer[LOG_RECORD_SIZE];
 
-    uint16_t read_addr = EEPROM_LOG_START_ADDR + (m_log_read_index * LOG_RECORD_SIZE); 
+    uint32_t read_addr = EEPROM_LOG_START_ADDR + ((uint32_t)m_log_read_index * LOG_RECORD_SIZE);
     
     if (!ReadBytes(read_addr, read_buffer, LOG_RECORD_SIZE))
     {
-        LOG_DEBUG(1, "[Eeprom] GRESKA: Čitanje loga sa adrese 0x%04X nije uspjelo.\n", read_addr);
+        LOG_DEBUG(1, "[Eeprom] GRESKA: Čitanje loga sa adrese 0x%05lX nije uspjelo.\n", (unsigned long)read_addr);
         return LoggerStatus::LOGGER_ERROR;
     }
 
     // Status Byte mora biti VALID
     if (read_buffer[0] != STATUS_BYTE_VALID)
     {
-        LOG_DEBUG(2, "[Eeprom] UPOZORENJE: Status bajt za log na adresi 0x%04X nije validan (0x%02X).\n", read_addr, read_buffer[0]);
+        LOG_DEBUG(2, "[Eeprom] UPOZORENJE: Status bajt za log na adresi 0x%05lX nije validan (0x%02X).\n", (unsigned long)read_addr, read_buffer[0]);
         return LoggerStatus::LOGGER_ERROR;
     }
 
@@ -714,7 +1101,7 @@ LoggerStatus EepromStorage::GetOldestLog(LogEntry* entry)
         memset(((uint8_t*)entry) + entry_copy_size, 0, sizeof(LogEntry) - entry_copy_size);
     }
 
-    LOG_DEBUG(4, "[Eeprom] Uspješno pročitan najstariji log sa adrese 0x%04X.\n", read_addr);
+    LOG_DEBUG(4, "[Eeprom] Uspješno pročitan najstariji log sa adrese 0x%05lX.\n", (unsigned long)read_addr);
     return LoggerStatus::LOGGER_OK;
 }
 
@@ -723,6 +1110,7 @@ LoggerStatus EepromStorage::GetOldestLog(LogEntry* entry)
 // ============================================================================
 String EepromStorage::ReadLogBlockAsHexString()
 {
+    EepromLock lock(m_mutex);
     LOG_DEBUG(3, "[Eeprom] Čitanje bloka logova kao HEX string (V2 - Kompatibilno)...\n");
     LOG_DEBUG(3, "[Eeprom] -> Trenutni log count: %u, read_index: %u\n", m_log_count, m_log_read_index);
 
@@ -747,23 +1135,11 @@ String EepromStorage::ReadLogBlockAsHexString()
 
     LOG_DEBUG(3, "[Eeprom] -> Čitam %u logova (%u bajtova) počevši od indeksa %u.\n", logs_to_read, total_bytes_to_read, m_log_read_index);
 
-    // 3. Pročitaj validne logove u bafer
-    for (uint16_t i = 0; i < logs_to_read; ++i)
+    // 3. Pročitaj validne logove direktno u bafer (jedno čitanje opsega, i preko kraja prstena)
+    if (!ReadLogRange(m_log_read_index, logs_to_read, data_buffer))
     {
-        // Izračunaj indeks i adresu trenutnog loga u kružnom baferu
-        uint16_t current_log_index = (m_log_read_index + i) % MAX_LOG_ENTRIES;
-        uint16_t read_addr = EEPROM_LOG_START_ADDR + (current_log_index * LOG_ENTRY_SIZE);
-        
-        LOG_DEBUG(4, "[Eeprom]   Log %u: index=%u, addr=0x%04X\n", i, current_log_index, read_addr);
-        
-        // Adresa u odredišnom baferu
-        uint8_t* dest_buffer = data_buffer + (i * LOG_RECORD_SIZE);
-
-        if (!ReadBytes(read_addr, dest_buffer, LOG_RECORD_SIZE))
-        {
-            LOG_DEBUG(1, "[Eeprom] GRESKA: Čitanje loga na indeksu %u nije uspjelo.\n", current_log_index);
-            return HTTP_RESPONSE_ERROR;
-        }
+        LOG_DEBUG(1, "[Eeprom] GRESKA: Čitanje %u logova od indeksa %u nije uspjelo.\n", logs_to_read, m_log_read_index);
+        return HTTP_RESPONSE_ERROR;
     }
 
     // 4. Popuni ostatak bafera nulama (zero-fill)
@@ -789,6 +1165,7 @@ String EepromStorage::ReadLogBlockAsHexString()
 
 LoggerStatus EepromStorage::DeleteLogBlock()
 {
+    EepromLock lock(m_mutex);
     if (m_log_count == 0)
     {
         LOG_DEBUG(3, "[Eeprom] Nema logova za brisanje.\n");
@@ -802,24 +1179,22 @@ LoggerStatus EepromStorage::DeleteLogBlock()
     uint16_t logs_to_delete = min((uint16_t)m_log_count, logs_in_block);
 
     LOG_DEBUG(3, "[Eeprom] Brisanje bloka od %u logova...\n", logs_to_delete);
-    
-    uint8_t zero_buffer[LOG_ENTRY_SIZE];
-    memset(zero_buffer, 0, LOG_ENTRY_SIZE);
-
-    for (uint16_t i = 0; i < logs_to_delete; i++)
-    {
-        uint16_t current_log_index = (m_log_read_index + i) % MAX_LOG_ENTRIES;
-        uint16_t delete_addr = EEPROM_LOG_START_ADDR + (current_log_index * LOG_ENTRY_SIZE);
-        if (!WriteBytes(delete_addr, zero_buffer, LOG_ENTRY_SIZE))
-        {
-            LOG_DEBUG(1, "[Eeprom] GRESKA: Brisanje loga na indeksu %u nije uspjelo.\n", current_log_index);
-            return LoggerStatus::LOGGER_ERROR;
-        }
-    }
 
+    // NOVO: Brisanje samo pomjera tail u metapodacima (jedan upis od 16 B umjesto
+    // 16 upisa nula). Slotovi iza tail-a su nevažeći po head/tail, ne po log_id.
+    uint16_t old_read_index = m_log_read_index;
+    uint16_t old_count = m_log_count;
     m_log_read_index = (m_log_read_index + logs_to_delete) % MAX_LOG_ENTRIES;
     m_log_count -= logs_to_delete;
 
+    if (!SaveLoggerMeta())
+    {
+        // Tail nije trajno pomjeren - blok ostaje za ponovno čitanje
+        m_log_read_index = old_read_index;
+        m_log_count = old_count;
+        return LoggerStatus::LOGGER_ERROR;
+    }
+
     LOG_DEBUG(3, "[Eeprom] Blok od %u logova obrisan. Preostalo logova: %u\n", logs_to_delete, m_log_count);
     return LoggerStatus::LOGGER_OK;
 }
@@ -1004,59 +1379,24 @@ bool EepromStorage::ParseAddressListFromCSV(const String& csvContent, uint16_t*
 // ============================================================================
 LoggerStatus EepromStorage::ClearAllLogs()
 {
-    LOG_DEBUG(3, "[Eeprom] Brisanje svih logova (punjenje nulama)...\n");
-
-    // ISPRAVKA: Ograniči brisanje na dostupan prostor u EEPROM-u
-    // 24C1024 = 128KB = 131,072 bajta
-    // Dostupan prostor za logove = 128KB - Config(256B) - AddressList(1000B) = 129,816 bajta
-    const uint32_t EEPROM_TOTAL_SIZE = 131072; // 128KB
-    const uint32_t AVAILABLE_LOG_SPACE = EEPROM_TOTAL_SIZE - EEPROM_LOG_START_ADDR;
-    
-    // Briši manji od: konfigurisani prostor ILI dostupni prostor
-    uint32_t bytes_to_clear = min((uint32_t)EEPROM_LOG_AREA_SIZE, AVAILABLE_LOG_SPACE);
-    
-    LOG_DEBUG(3, "[Eeprom] -> Log start: 0x%04X, Bytes to clear: %u\n", EEPROM_LOG_START_ADDR, bytes_to_clear);
-
-    // Pripremi buffer sa 0x00 (prazan log slot)
-    uint8_t empty_buffer[EEPROM_PAGE_SIZE];
-    memset(empty_buffer, 0, EEPROM_PAGE_SIZE);
-
-    uint32_t current_address = EEPROM_LOG_START_ADDR; // ISPRAVKA: uint32_t umjesto uint16_t!
-    uint16_t chunks_written = 0;
+    EepromLock lock(m_mutex);
+    LOG_DEBUG(3, "[Eeprom] Brisanje svih logova...\n");
+
+    // NOVO: Umjesto punjenja ~62 KB nulama (sekunde u HTTP handleru) brisanje je
+    // jedan upis metapodataka: tail = head, count = 0. Stari slotovi
+    // ostaju u EEPROM-u i prepisuju se redom kako stižu novi logovi.
+    uint16_t old_read_index = m_log_read_index;
+    uint16_t old_count = m_log_count;
+    m_log_read_index = m_log_write_index;
+    m_log_count = 0;
 
-    while (bytes_to_clear > 0)
+    if (!SaveLoggerMeta())
     {
-        // Reset watchdog svakih 10 chunk-ova (duga operacija)
-        if (chunks_written % 10 == 0)
-        {
-            esp_task_wdt_reset();
-        }
-
-        // Odredi koliko pisati u ovom ciklusu
-        uint16_t chunk_size = min((uint32_t)bytes_to_clear, (uint32_t)sizeof(empty_buffer));
-        
-        // ISPRAVKA: Ograniči adresu na 16-bit opseg (24C1024 ima 17-bit adresiranje preko device address)
-        uint16_t write_addr = (uint16_t)(current_address & 0xFFFF);
-        
-        if (!WriteBytes(write_addr, empty_buffer, chunk_size))
-        {
-            LOG_DEBUG(1, "[Eeprom] GRESKA pri brisanju logova na adresi 0x%04X.\n", write_addr);
-            return LoggerStatus::LOGGER_ERROR;
-        }
-        
-        bytes_to_clear -= chunk_size;
-        current_address += chunk_size;
-        chunks_written++;
+        m_log_read_index = old_read_index;
+        m_log_count = old_count;
+        return LoggerStatus::LOGGER_ERROR;
     }
 
-    // Finalni watchdog reset
-    esp_task_wdt_reset();
-
-    // Resetuj head/tail pokazivače
-    m_log_write_index = 0;
-    m_log_read_index = 0;
-    m_log_count = 0;
-
     LOG_DEBUG(3, "[Eeprom] Svi logovi obrisani.\n");
     return LoggerStatus::LOGGER_OK;
 }
\ No newline at end of file
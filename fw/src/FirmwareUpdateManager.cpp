@@ -13,6 +13,7 @@
 #include "FirmwareUpdateManager.h"
 #include "ProjectConfig.h"
 #include "TimeSync.h"
+#include "DeviceDirectory.h" // Za routing po adresi
 #include "HttpServer.h"  // NAKON ostalih da izbjegnemo FILE_READ konflikt
 #include <cstring>
 
@@ -66,14 +67,17 @@ FirmwareUpdateManager::FirmwareUpdateManager()
 {
     m_session.state = FUF_S_IDLE;
     m_sequence.is_active = false;
-    m_rs485_service = NULL;
+    m_bus_owner = NULL;
     m_sd_card_manager = NULL;
+    m_tx_length = 0;
+    m_bus_id = RS485_BUS_CURRENT;
+    m_session_start_time = 0;
     m_http_server = NULL;
 }
 
-void FirmwareUpdateManager::Initialize(Rs485Service* pRs485Service, SdCardManager* pSdCardManager)
+void FirmwareUpdateManager::Initialize(Rs485BusOwner* pBusOwner, SdCardManager* pSdCardManager)
 {
-    m_rs485_service = pRs485Service;
+    m_bus_owner = pBusOwner;
     m_sd_card_manager = pSdCardManager;
 }
 
@@ -119,6 +123,15 @@ bool FirmwareUpdateManager::StartSession(uint16_t clientAddress, FufUpdateType t
 
     m_session.clientAddress = clientAddress;
     m_session.bytesSent = 0;
+
+    // Dual mode: sve transakcije sesije idu na bus ove adrese
+    m_bus_id = RS485_BUS_CURRENT;
+    if (g_appConfig.enable_dual_bus_mode) {
+        int8_t bus = g_deviceDirectory.GetBus(clientAddress);
+        if (bus >= 0) {
+            m_bus_id = (uint8_t)bus;
+        }
+    }
     m_session.currentSequenceNum = 0;
     m_session.retryCount = 0;
 
@@ -144,6 +157,10 @@ bool FirmwareUpdateManager::StartSession(uint16_t clientAddress, FufUpdateType t
     m_session.file_size = m_session.file_handle.size();
     m_session.file_crc = CalculateCRC32(m_session.file_handle);
 
+    m_prefetch.Reset();
+    m_update_rtt.Reset();
+    m_session_start_time = millis();
+
     Serial.printf("[FufManager] Sesija pokrenuta za klijenta 0x%X, fajl %s\n", clientAddress, m_session.filename.c_str());
     m_session.state = FUF_S_STARTING;
     return true;
@@ -235,7 +252,9 @@ void FirmwareUpdateManager::Run()
     if (m_session.state == FUF_S_WAITING_FOR_START_ACK)
     {
         response_timeout = IMG_COPY_DEL; // Dugi timeout za brisanje flash-a
-        response_len = m_rs485_service->ReceivePacket(response_buffer, MAX_PACKET_LENGTH, response_timeout);
+        response_len = m_bus_owner->Transact(BusPriority::UPDATE, m_bus_id,
+                                             m_tx_frame, m_tx_length,
+                                             response_buffer, MAX_PACKET_LENGTH, response_timeout);
         if (response_len > 0) {
             ProcessResponse(response_buffer, response_len);
         } else {
@@ -244,12 +263,28 @@ void FirmwareUpdateManager::Run()
     }
     else if (m_session.state == FUF_S_WAITING_FOR_DATA_ACK)
     {
+        bool rtt_sample = false;
         if ((m_session.bytesSent + m_session.read_chunk_size) >= m_session.file_size) {
             response_timeout = IMG_COPY_DEL; // Dugi timeout za CRC verifikaciju
         } else {
-            response_timeout = UPDATE_PACKET_TIMEOUT_MS;
+            // NOVO: Adaptivni timeout iz RTT-a sesije (uzorak samo iz prvog pokušaja)
+            response_timeout = m_update_rtt.GetTimeoutMs(UPDATE_PACKET_TIMEOUT_MS, m_session.retryCount);
+            rtt_sample = (m_session.retryCount == 0);
+        }
+        // NOVO: Neblokirajuća predaja - sljedeći chunk se čita dok je okvir na liniji
+        BusTransaction txn;
+        if (m_bus_owner->Submit(&txn, BusPriority::UPDATE, m_bus_id,
+                                m_tx_frame, m_tx_length,
+                                response_buffer, MAX_PACKET_LENGTH, response_timeout))
+        {
+            PrefetchNextChunk();
+        }
+        response_len = m_bus_owner->WaitForResult(&txn);
+        if (rtt_sample && response_len > 0) {
+            m_update_rtt.AddSample(txn.rtt_us);
+        } else if (rtt_sample && response_len == 0) {
+            m_update_rtt.AddTimeout();
         }
-        response_len = m_rs485_service->ReceivePacket(response_buffer, MAX_PACKET_LENGTH, response_timeout);
         if (response_len > 0) {
             ProcessResponse(response_buffer, response_len);
         } else {
@@ -354,7 +389,7 @@ void FirmwareUpdateManager::SendStartRequest()
     packet[18] = (checksum & 0xFF);
     packet[19] = EOT;
 
-    if (m_rs485_service->SendPacket(packet, 20)) {
+    if (StageFrame(packet, 20)) {
         s->state = FUF_S_WAITING_FOR_START_ACK;
     } else {
         CleanupSession(true);
@@ -364,7 +399,8 @@ void FirmwareUpdateManager::SendStartRequest()
 void FirmwareUpdateManager::SendDataPacket()
 {
     FufUpdateSession* s = &m_session;
-    int16_t bytes_read = s->file_handle.read(s->read_buffer, UPDATE_DATA_CHUNK_SIZE);
+    uint16_t data_sum = 0;
+    int16_t bytes_read = m_prefetch.Read(s->file_handle, s->bytesSent, s->read_buffer, UPDATE_DATA_CHUNK_SIZE, &data_sum);
 
     if (bytes_read <= 0) {
         Serial.println(F("[FufManager] GREŠKA: Neočekivan kraj fajla."));
@@ -390,14 +426,14 @@ void FirmwareUpdateManager::SendDataPacket()
     packet[7] = (s->currentSequenceNum & 0xFF);
     memcpy(&packet[8], s->read_buffer, s->read_chunk_size);
 
-    uint16_t checksum = 0;
-    for (uint32_t i = 6; i < (6 + data_len); i++) checksum += packet[i];
+    // Suma podataka je izračunata pri čitanju chunk-a; dodaje se samo sekvenca
+    uint16_t checksum = packet[6] + packet[7] + data_sum;
 
     packet[total_packet_length - 3] = (checksum >> 8);
     packet[total_packet_length - 2] = (checksum & 0xFF);
     packet[total_packet_length - 1] = EOT;
 
-    if (m_rs485_service->SendPacket(packet, total_packet_length)) {
+    if (StageFrame(packet, total_packet_length)) {
         s->state = FUF_S_WAITING_FOR_DATA_ACK;
     } else {
         CleanupSession(true);
@@ -422,7 +458,7 @@ void FirmwareUpdateManager::SendRestartCommand()
     packet[8] = (checksum & 0xFF);
     packet[9] = EOT;
 
-    if (!m_rs485_service->SendPacket(packet, 10)) {
+    if (m_bus_owner->Transact(BusPriority::UPDATE, m_bus_id, packet, 10, NULL, 0, 0) < 0) {
         CleanupSession(true);
     }
 }
@@ -445,11 +481,37 @@ void FirmwareUpdateManager::SendAppExeCommand()
     packet[8] = (checksum & 0xFF);
     packet[9] = EOT;
 
-    if (!m_rs485_service->SendPacket(packet, 10)) {
+    if (m_bus_owner->Transact(BusPriority::UPDATE, m_bus_id, packet, 10, NULL, 0, 0) < 0) {
         CleanupSession(true);
     }
 }
 
+/**
+ * @brief Čita chunk koji slijedi nakon trenutnog DATA okvira (dok se čeka ACK).
+ */
+void FirmwareUpdateManager::PrefetchNextChunk()
+{
+    uint32_t next_offset = m_session.bytesSent + m_session.read_chunk_size;
+    if (next_offset >= m_session.file_size) {
+        return;
+    }
+    m_prefetch.Prefetch(m_session.file_handle, next_offset, UPDATE_DATA_CHUNK_SIZE);
+}
+
+/**
+ * @brief Kopira okvir u m_tx_frame; šalje ga Faza 2 zajedno sa čekanjem odgovora.
+ * @return false ako okvir ne staje u buffer.
+ */
+bool FirmwareUpdateManager::StageFrame(const uint8_t* packet, uint16_t length)
+{
+    if (length > sizeof(m_tx_frame)) {
+        return false;
+    }
+    memcpy(m_tx_frame, packet, length);
+    m_tx_length = length;
+    return true;
+}
+
 void FirmwareUpdateManager::CleanupSession(bool failed)
 {
     // POKRENI SERVER - ALI SAMO AKO NEMA AKTIVNE SEKVENCE!
@@ -461,6 +523,14 @@ void FirmwareUpdateManager::CleanupSession(bool failed)
         m_session.file_handle.close();
     }
 
+    // NOVO: Trajanje transfera (poređenje sa/bez prefetch-a na istom fajlu)
+    unsigned long elapsed_ms = millis() - m_session_start_time;
+    Serial.printf("[FufManager] Transfer: %lu B za %lu ms (%lu B/s), prefetch pogodaka %lu/%lu\n",
+                  (unsigned long)m_session.bytesSent, elapsed_ms,
+                  (elapsed_ms > 0) ? (unsigned long)((uint64_t)m_session.bytesSent * 1000UL / elapsed_ms) : 0UL,
+                  (unsigned long)m_prefetch.GetHits(),
+                  (unsigned long)(m_prefetch.GetHits() + m_prefetch.GetMisses()));
+
     extern TimeSync g_timeSync;
     g_timeSync.ResetTimer();
 
@@ -10,7 +10,8 @@
 #include "DebugConfig.h"   // Uključujemo za LOG_RS485
 #include "ProjectConfig.h"
 #include "EepromStorage.h" // Za g_appConfig
-#include "LogPullManager.h" // Za GetBusForAddress routing
+#include "DeviceDirectory.h" // Za routing po adresi
+#include "RoomStatusCache.h"
 #include <esp_task_wdt.h>  // NOVO: Uključujemo za watchdog reset
 #include <cstring>
 
@@ -20,22 +21,52 @@ extern AppConfig g_appConfig;
 // Makro Vrijednosti
 #define DEF_HC_OWIFA 31U
 
-// Definišemo specifičan timeout za HTTP upite
-#define HTTP_QUERY_TIMEOUT_MS 50
+/**
+ * @brief Da li je komanda čitanje statusa sobe (cst) - njen odgovor ide u RoomStatusCache.
+ */
+static bool IsRoomStatusCommand(uint8_t cmd_id)
+{
+    return cmd_id == GET_APPL_STAT || cmd_id == RUBICON_GET_ROOM_STATUS;
+}
+
+/**
+ * @brief Upisuje pročitan status sobe u keš.
+ * @details Keširani status sobe briše se već pri predaji komande koja mijenja
+ *          stanje (BeginQuery/ExecuteBlockingQuery), ne kada je odgovor preuzet.
+ * @param generation Generacija slota keša uhvaćena pri predaji čitanja na bus.
+ */
+static void StoreRoomStatus(const HttpCommand* cmd, uint8_t bus_id, int response_len, const uint8_t* payload, int payload_len,
+                            uint16_t generation)
+{
+    if (IsRoomStatusCommand(cmd->cmd_id) && response_len >= 9 && payload_len > 0)
+    {
+        g_roomStatusCache.Store(cmd->address, bus_id, payload, (uint16_t)payload_len, generation);
+    }
+}
 
 HttpQueryManager::HttpQueryManager() :
-    m_rs485_service(NULL)
+    m_bus_owner(NULL),
+    m_coalesced(0),
+    m_on_complete(NULL),
+    m_on_complete_context(NULL)
 {
-    // Konstruktor
+    for (uint8_t i = 0; i < HTTP_QUERY_SLOTS; i++) {
+        m_queries[i].in_use = false;
+        m_queries[i].joinable = false;
+        m_queries[i].owners = 0;
+    }
 }
 
-void HttpQueryManager::Initialize(Rs485Service* pRs485Service)
+void HttpQueryManager::Initialize(Rs485BusOwner* pBusOwner)
 {
-    m_rs485_service = pRs485Service;
+    m_bus_owner = pBusOwner;
 }
 
-// Extern pointer za LogPullManager (routing)
-extern LogPullManager* g_logPullManager_ptr;
+void HttpQueryManager::SetCompletionHandler(BusTxnCallback handler, void* context)
+{
+    m_on_complete_context = context;
+    m_on_complete = handler;
+}
 
 /**
  * @brief Kreira RS485 paket iz HttpCommand strukture (bazirano na HC_CreateCmdRequest).
@@ -212,42 +243,86 @@ uint16_t HttpQueryManager::CreateRs485Packet(HttpCommand* cmd, uint8_t* buffer)
 }
 
 
-/**
- * @brief BLOKIRAJUCA funkcija. Ceka dok RS485 ne zavrsi.
- * @return Payload length (broj bajtova), ili -1 ako je greška/timeout
- */
-int HttpQueryManager::ExecuteBlockingQuery(HttpCommand* cmd, uint8_t* responseBuffer)
-{    
-    LOG_DEBUG(4, "[HttpQuery] Primljen zahtev za komandu 0x%X na adresu 0x%X\n", cmd->cmd_id, cmd->address);
-
+int8_t HttpQueryManager::SelectBus(uint16_t address)
+{
     // ========================================================================
     // DUAL BUS ROUTING LOGIC
     // ========================================================================
-    bool dual_mode = g_appConfig.enable_dual_bus_mode;
-    int8_t target_bus = -1;
-    
-    if (dual_mode && g_logPullManager_ptr != NULL)
+    if (!g_appConfig.enable_dual_bus_mode)
     {
-        target_bus = g_logPullManager_ptr->GetBusForAddress(cmd->address);
-        
-        if (target_bus >= 0)
+        return 0; // Single bus mode koristi Bus 0
+    }
+
+    int8_t target_bus = g_deviceDirectory.GetBus(address);
+    if (target_bus >= 0)
+    {
+        // Adresa pronađena u listi, transakcija ide na odgovarajući bus
+        LOG_DEBUG(4, "[HttpQuery] Adresa 0x%04X -> Bus %d\n", address, target_bus);
+        return target_bus;
+    }
+
+    // Adresa nije u listama - fallback na Bus 0
+    LOG_DEBUG(3, "[HttpQuery] Adresa 0x%04X nepoznata, fallback na Bus 0\n", address);
+    return 0;
+}
+
+int HttpQueryManager::ExtractPayload(uint8_t* responseBuffer, int response_len)
+{
+    // Parsiranje odgovora - identično kao u starom kodu (httpd_cgi_ssi.c linija 143)
+    if (response_len >= 9)
+    {
+        uint16_t data_field_len = responseBuffer[5];
+        if (data_field_len >= 2 && (data_field_len + 7) <= response_len)
         {
-            // Adresa pronađena u listi, postavi odgovarajući bus
-            m_rs485_service->SelectBus(target_bus);
-            LOG_DEBUG(4, "[HttpQuery] Adresa 0x%04X -> Bus %d\n", cmd->address, target_bus);
+            // data_field_len = CMD (1 bajt) + DATA (n bajtova), CRC je van data_field_len
+            // Payload je samo DATA, pa treba oduzeti CMD (1 bajt)
+            uint16_t payload_len = data_field_len - 1;
+            memmove(responseBuffer, &responseBuffer[7], payload_len);
+            responseBuffer[payload_len] = '\0';
+            return payload_len;
         }
         else
         {
-            // Adresa nije u listama - fallback na Bus 0
-            LOG_DEBUG(3, "[HttpQuery] Adresa 0x%04X nepoznata, fallback na Bus 0\n", cmd->address);
-            m_rs485_service->SelectBus(0);
-            target_bus = 0; // Postavi target_bus za protokol selekciju
+            strcpy((char*)responseBuffer, "OK");
+            return 2;
         }
     }
     else
     {
-        target_bus = 0; // Single bus mode koristi Bus 0
+        strcpy((char*)responseBuffer, "ERROR");
+        return 5;  // "ERROR" je 5 bajtova
+    }
+}
+
+int HttpQueryManager::ParseResponse(uint8_t* responseBuffer, int response_len)
+{
+    if (response_len > 0)
+    {
+        LOG_DEBUG(4, "[HttpQuery] Primljen odgovor. Dužina: %d\n", response_len);
+        return ExtractPayload(responseBuffer, response_len);
+    }
+    else if (response_len == 0)
+    {
+        LOG_DEBUG(2, "[HttpQuery] TIMEOUT. Nije primljen odgovor na komandu.\n");
+        return -1;  // Timeout
     }
+    else // response_len < 0
+    {
+        LOG_DEBUG(1, "[HttpQuery] GRESKA: Slanje/overflow ili transakcija odbijena/istekla u redu.\n");
+        return -1;  // Greška
+    }
+}
+
+/**
+ * @brief BLOKIRAJUCA funkcija. Ceka dok RS485 ne zavrsi.
+ * @return Payload length (broj bajtova), ili -1 ako je greška/timeout
+ */
+int HttpQueryManager::ExecuteBlockingQuery(HttpCommand* cmd, uint8_t* responseBuffer)
+{    
+    LOG_DEBUG(4, "[HttpQuery] Primljen zahtev za komandu 0x%X na adresu 0x%X\n", cmd->cmd_id, cmd->address);
+
+    bool dual_mode = g_appConfig.enable_dual_bus_mode;
+    int8_t target_bus = SelectBus(cmd->address);
     
     // ========================================================================
     // PROTOCOL ADAPTATION
@@ -258,26 +333,30 @@ int HttpQueryManager::ExecuteBlockingQuery(HttpCommand* cmd, uint8_t* responseBu
 
     uint8_t packet[MAX_PACKET_LENGTH];
     uint16_t length = CreateRs485Packet(cmd, packet);
-  
-    // Odmah zauzmi magistralu i pošalji
-    if (!m_rs485_service->SendPacket(packet, length))
-    {
-        LOG_DEBUG(1, "[HttpQuery] GRESKA: SendPacket nije uspio.\n");
-        return -1;  // Greška slanja
-    }
 
-    // Čekaj odgovor
-    int response_len = m_rs485_service->ReceivePacket(responseBuffer, MAX_PACKET_LENGTH, HTTP_QUERY_TIMEOUT_MS);
+    // Komanda može promijeniti stanje sobe - keširani status više ne važi
+    if (!IsRoomStatusCommand(cmd->cmd_id)) {
+        g_roomStatusCache.Invalidate(cmd->address);
+    }
+    uint16_t cache_generation = g_roomStatusCache.GetGeneration(cmd->address);
+  
+    // HTTP klasa ima najviši prioritet - vlasnik magistrale je šalje odmah nakon
+    // okvira koji je trenutno na liniji (polling sweep se prekida na granici okvira)
+    int response_len = m_bus_owner->Transact(BusPriority::HTTP, (uint8_t)target_bus,
+                                             packet, length,
+                                             responseBuffer, MAX_PACKET_LENGTH,
+                                             HTTP_QUERY_TIMEOUT_MS);
 
     // ========================================================================
     // FALLBACK: Ako timeout, pokušaj drugi bus
     // ========================================================================
     // U DUAL MODE: Ako je adresa bila u listi Bus 0, pokušaj Bus 1
     // U SINGLE MODE: Uvijek pokušaj Bus 1 ako Bus 0 ne odgovori
+    uint8_t response_bus = (uint8_t)target_bus;
     if (response_len == 0 && target_bus == 0)
     {
         LOG_DEBUG(3, "[HttpQuery] Timeout na Bus 0, pokušavam Bus 1...\n");
-        m_rs485_service->SelectBus(1);
+        response_bus = 1;
         
         // U SINGLE MODE: Možda trebamo prilagoditi protokol za Bus 1
         if (!dual_mode) {
@@ -288,57 +367,222 @@ int HttpQueryManager::ExecuteBlockingQuery(HttpCommand* cmd, uint8_t* responseBu
             length = CreateRs485Packet(cmd, packet);
         }
         
-        if (m_rs485_service->SendPacket(packet, length))
-        {
-            response_len = m_rs485_service->ReceivePacket(responseBuffer, MAX_PACKET_LENGTH, HTTP_QUERY_TIMEOUT_MS);
-            
-            if (response_len > 0) {
-                LOG_DEBUG(3, "[HttpQuery] USPJEH na Bus 1!\n");
-            } else {
-                LOG_DEBUG(3, "[HttpQuery] Timeout i na Bus 1.\n");
-            }
+        response_len = m_bus_owner->Transact(BusPriority::HTTP, 1,
+                                             packet, length,
+                                             responseBuffer, MAX_PACKET_LENGTH,
+                                             HTTP_QUERY_TIMEOUT_MS);
+
+        if (response_len > 0) {
+            LOG_DEBUG(3, "[HttpQuery] USPJEH na Bus 1!\n");
+        } else {
+            LOG_DEBUG(3, "[HttpQuery] Timeout i na Bus 1.\n");
         }
     }
     // ========================================================================
 
-    if (response_len > 0)
+    int payload_len = ParseResponse(responseBuffer, response_len);
+    StoreRoomStatus(cmd, response_bus, response_len, responseBuffer, payload_len, cache_generation);
+    return payload_len;
+}
+
+// ============================================================================
+// NOVO: ASINHRONI UPITI (CGI handler na AsyncTCP zadatku)
+// ============================================================================
+
+void HttpQueryManager::SubmitQuery(HttpQuery* query, uint8_t bus_id)
+{
+    BusTransaction* txn = &query->txn;
+    txn->priority = BusPriority::HTTP;
+    txn->bus_id = bus_id;
+    txn->tx_data = query->packet;
+    txn->tx_length = CreateRs485Packet(&query->cmd, query->packet);
+    txn->rx_buffer = query->response;
+    txn->rx_size = MAX_PACKET_LENGTH;
+    txn->response_timeout_ms = HTTP_QUERY_TIMEOUT_MS;
+    txn->single_byte_mode = false;
+    txn->notify_task = NULL; // AsyncTCP zadatak ne čeka - stanje čita PollQuery()
+    txn->on_complete = m_on_complete;
+    txn->context = m_on_complete_context;
+
+    // Pun red -> status REJECTED, PollQuery() to vraća kao grešku
+    m_bus_owner->Submit(txn);
+}
+
+/**
+ * @brief Single-flight: identičan upit statusa koji je u toku ili netom završen.
+ * @details Spajaju se samo upiti statusa sobe (čitanje bez promjene stanja).
+ *          Upit u toku je živ dok ga neka konekcija čeka ili je transakcija u
+ *          redu; završen se dijeli još HTTP_QUERY_COALESCE_MS (dok slot nije
+ *          ponovo iskorišten).
+ */
+HttpQuery* HttpQueryManager::FindCoalescableQuery(const HttpCommand* cmd)
+{
+    if (!IsRoomStatusCommand(cmd->cmd_id)) {
+        return NULL;
+    }
+
+    uint32_t now = millis();
+    for (uint8_t i = 0; i < HTTP_QUERY_SLOTS; i++)
     {
-        LOG_DEBUG(4, "[HttpQuery] Primljen odgovor. Dužina: %d\n", response_len);
-        // Parsiranje odgovora - identično kao u starom kodu (httpd_cgi_ssi.c linija 143)
-        if (response_len >= 9)
-        {
-            uint16_t data_field_len = responseBuffer[5];
-            if (data_field_len >= 2 && (data_field_len + 7) <= response_len)
-            {
-                // data_field_len = CMD (1 bajt) + DATA (n bajtova), CRC je van data_field_len
-                // Payload je samo DATA, pa treba oduzeti CMD (1 bajt)
-                uint16_t payload_len = data_field_len - 1;
-                memmove(responseBuffer, &responseBuffer[7], payload_len);
-                responseBuffer[payload_len] = '\0';
-                return payload_len;
-            }
-            else
-            {
-                strcpy((char*)responseBuffer, "OK");
-                return 2;
-            }
+        HttpQuery* slot = &m_queries[i];
+        if (!slot->in_use ||
+            !slot->joinable ||
+            slot->request_cmd_id != cmd->cmd_id ||
+            slot->cmd.address != cmd->address ||
+            slot->cmd.owa_addr != cmd->owa_addr ||
+            slot->cmd.param1 != cmd->param1 ||
+            slot->cmd.param2 != cmd->param2 ||
+            slot->cmd.param3 != cmd->param3 ||
+            slot->cmd.string_len != cmd->string_len) {
+            continue;
         }
-        else
-        {
-            strcpy((char*)responseBuffer, "ERROR");
-            return 5;  // "ERROR" je 5 bajtova
+        if (cmd->string_len > 0 &&
+            (cmd->string_ptr == NULL || memcmp(slot->cmd_data, cmd->string_ptr, cmd->string_len) != 0)) {
+            continue;
+        }
+
+        bool live = (slot->state == HttpQueryState::DONE)
+                  ? (now - slot->done_ms) <= HTTP_QUERY_COALESCE_MS
+                  : (slot->owners > 0 || slot->txn.status == BusTxnStatus::PENDING);
+        if (live && slot->owners < 0xFF) {
+            return slot;
         }
     }
-    else if (response_len == 0)
+    return NULL;
+}
+
+/**
+ * @brief Status pročitan (ili poslan na bus) prije komande više ne smije dobiti
+ *        novi upit - inače bi se vratilo stanje sobe prije te komande.
+ */
+void HttpQueryManager::ExpireStatusQueries(uint16_t address)
+{
+    bool all = (address == g_appConfig.rs485_group_addr || address == g_appConfig.rs485_bcast_addr);
+
+    for (uint8_t i = 0; i < HTTP_QUERY_SLOTS; i++)
     {
-        LOG_DEBUG(2, "[HttpQuery] TIMEOUT. Nije primljen odgovor na komandu.\n");
-        return -1;  // Timeout
+        HttpQuery* slot = &m_queries[i];
+        if (slot->in_use && slot->joinable && (all || slot->cmd.address == address)) {
+            slot->joinable = false;
+        }
     }
-    else // response_len < 0
+}
+
+HttpQuery* HttpQueryManager::BeginQuery(const HttpCommand* cmd)
+{
+    bool status_query = IsRoomStatusCommand(cmd->cmd_id);
+    if (!status_query) {
+        // Keš i upiti u toku se zatvaraju odmah pri predaji - ne čeka se da
+        // konekcija preuzme odgovor (klijent može otići prije toga)
+        g_roomStatusCache.Invalidate(cmd->address);
+        ExpireStatusQueries(cmd->address);
+    }
+
+    // NOVO: Identičan upit statusa već čeka bus (ili je netom završen) - bez nove transakcije
+    HttpQuery* query = FindCoalescableQuery(cmd);
+    if (query != NULL)
     {
-        LOG_DEBUG(1, "[HttpQuery] GRESKA: Prijemni bafer je pun (overflow).\n");
-        return -1;  // Greška
+        query->owners++;
+        m_coalesced++;
+        LOG_DEBUG(4, "[HttpQuery] Upit 0x%X na 0x%X spojen sa upitom u toku (vlasnika: %u, ukupno spojenih: %lu)\n",
+                  cmd->cmd_id, cmd->address, query->owners, (unsigned long)m_coalesced);
+        return query;
+    }
+
+    for (uint8_t i = 0; i < HTTP_QUERY_SLOTS; i++)
+    {
+        HttpQuery* slot = &m_queries[i];
+        // Oslobođen slot čija je transakcija još u redu vlasnika magistrale se preskače
+        if (slot->in_use && slot->owners == 0 && slot->txn.status != BusTxnStatus::PENDING) {
+            slot->in_use = false;
+        }
+        if (!slot->in_use && query == NULL) {
+            query = slot;
+        }
+    }
+
+    if (query == NULL)
+    {
+        LOG_DEBUG(2, "[HttpQuery] Svi slotovi upita su zauzeti (%d).\n", HTTP_QUERY_SLOTS);
+        return NULL;
+    }
+
+    LOG_DEBUG(4, "[HttpQuery] Asinhroni upit: komanda 0x%X na adresu 0x%X\n", cmd->cmd_id, cmd->address);
+
+    query->in_use = true;
+    query->joinable = status_query;
+    query->owners = 1;
+    query->result = -1;
+    query->body = String();
+    query->cmd = *cmd;
+    query->request_cmd_id = cmd->cmd_id;
+    if (cmd->string_ptr != NULL) {
+        memcpy(query->cmd_data, cmd->string_ptr, HTTP_CMD_DATA_SIZE);
+    } else {
+        memset(query->cmd_data, 0, HTTP_CMD_DATA_SIZE);
+    }
+    query->cmd.string_ptr = query->cmd_data;
+
+    int8_t target_bus = SelectBus(query->cmd.address);
+    AdaptCommandForProtocol(&query->cmd, target_bus);
+    query->state = HttpQueryState::BUS_PRIMARY;
+    query->cache_generation = g_roomStatusCache.GetGeneration(query->cmd.address);
+    SubmitQuery(query, (uint8_t)target_bus);
+    return query;
+}
+
+int HttpQueryManager::PollQuery(HttpQuery* query)
+{
+    if (query->state == HttpQueryState::DONE) {
+        return query->result;
+    }
+
+    BusTxnStatus status = query->txn.status;
+    if (status == BusTxnStatus::PENDING) {
+        return HTTP_QUERY_PENDING;
+    }
+
+    int response_len;
+    switch (status)
+    {
+    case BusTxnStatus::DONE:    response_len = query->txn.rx_length; break;
+    case BusTxnStatus::TIMEOUT: response_len = 0; break;
+    default:                    response_len = -1; break;
+    }
+
+    // FALLBACK kao kod ExecuteBlockingQuery(): timeout na Bus 0 -> pokušaj Bus 1
+    if (response_len == 0 && query->state == HttpQueryState::BUS_PRIMARY && query->txn.bus_id == 0)
+    {
+        LOG_DEBUG(3, "[HttpQuery] Timeout na Bus 0, pokušavam Bus 1...\n");
+        if (!g_appConfig.enable_dual_bus_mode) {
+            AdaptCommandForProtocol(&query->cmd, 1);
+        }
+        query->state = HttpQueryState::BUS_FALLBACK;
+        SubmitQuery(query, 1);
+        return HTTP_QUERY_PENDING;
     }
+
+    query->result = ParseResponse(query->response, response_len);
+    query->state = HttpQueryState::DONE;
+    query->done_ms = millis();
+    StoreRoomStatus(&query->cmd, query->txn.bus_id, response_len, query->response, query->result, query->cache_generation);
+    return query->result;
+}
+
+void HttpQueryManager::ReleaseQuery(HttpQuery* query)
+{
+    if (query->owners > 0) {
+        query->owners--;
+    }
+    if (query->owners == 0) {
+        query->body = String(); // Oslobodi heap odmah; slot se vraća u BeginQuery()
+    }
+}
+
+uint16_t HttpQueryManager::BuildQueryPacket(HttpCommand* cmd, uint8_t bus_id, uint8_t* buffer)
+{
+    AdaptCommandForProtocol(cmd, (int8_t)bus_id);
+    return CreateRs485Packet(cmd, buffer);
 }
 
 /**
@@ -20,21 +20,45 @@
 #include "UpdateManager.h"
 #include "EepromStorage.h"
 #include "SdCardManager.h"
+#include "Rs485BusOwner.h"
+#include "Rs485Trace.h"
+#include "RttEstimator.h"
+#include "DeviceDirectory.h"
+#include "LogPullManager.h"
+#include "LogWriter.h"
+#include "RoomStatusSweep.h"
+#include "RoomStatusCache.h"
+#include "SysctrlDispatch.h"
 #include "HttpResponseStrings.h" // NOVO: Uključujemo centralizovane stringove
 #include <Update.h>
 #include <SD.h>
 #include <cstring>
 #include <time.h>
 #include <pgmspace.h>
+#include "lwip/tcpip.h"
+#include "lwip/priv/tcp_priv.h" // tcp_active_pcbs (provjera da je konekcija još živa)
+
+// Content-Type SSI odgovora (kao stari log.html)
+#define SSI_CONTENT_TYPE "text/html; charset=windows-1252"
 
 // Globalni objekti (extern)
 extern AppConfig g_appConfig;
 extern NetworkManager g_networkManager; // Potrebno za Eth/RS485 restart
 extern FirmwareUpdateManager g_fufUpdateManager; // NOVO
-
-HttpServer::HttpServer() : m_server(HTTP_PORT)
+extern Rs485BusOwner g_rs485BusOwner;
+extern LogPullManager g_logPullManager;
+#if RS485_DUAL_UART_AVAILABLE
+extern LogPullManager g_logPullManagerR;
+#endif
+extern LogWriter g_logWriter;
+
+HttpServer::HttpServer() :
+    m_server(HTTP_PORT),
+    m_wake_queued(false)
 {
-    // Konstruktor
+    memset(m_query_waiters, 0, sizeof(m_query_waiters));
+    portMUX_TYPE init = portMUX_INITIALIZER_UNLOCKED;
+    m_query_waiters_lock = init;
 }
 
 void HttpServer::Initialize(
@@ -51,6 +75,9 @@ void HttpServer::Initialize(
     m_eeprom_storage = pEepromStorage;
     m_sd_card_manager = pSdCardManager;
 
+    // NOVO: Završetak transakcije budi konekciju koja čeka odgovor upita
+    m_http_query_manager->SetCompletionHandler(OnQueryBusComplete, this);
+
     // 1. Serviranje glavne stranice (Frontend) - ZASTICENO
     m_server.on("/", HTTP_GET, [this](AsyncWebServerRequest *request)
     {
@@ -291,6 +318,91 @@ void HttpServer::Initialize(
         }
     });
 
+    // 7. NEW: Statistika redova RS485 magistrale (dubina, čekanje po klasi) - ZASTICENO
+    m_server.on("/bus_stats", HTTP_GET, [this](AsyncWebServerRequest *request)
+    {
+        if (!this->IsAuthenticated(request))
+        {
+            return request->requestAuthentication();
+        }
+
+        request->send(200, "application/json", g_rs485BusOwner.GetStatsJson());
+    });
+
+    // 8. NEW: Binarni trace RS485 okvira - ZASTICENO
+    //    ?format=pcap (podrazumijevano) ili ?format=text, ?clear=1 briše ring nakon ispisa
+    m_server.on("/rs485_trace", HTTP_GET, [this](AsyncWebServerRequest *request)
+    {
+        if (!this->IsAuthenticated(request))
+        {
+            return request->requestAuthentication();
+        }
+
+        bool as_text = request->hasParam("format") && request->getParam("format")->value() == "text";
+        AsyncResponseStream *response;
+        if (as_text)
+        {
+            response = request->beginResponseStream("text/plain");
+            g_rs485Trace.WriteText(*response);
+        }
+        else
+        {
+            response = request->beginResponseStream("application/vnd.tcpdump.pcap");
+            response->addHeader("Content-Disposition", "attachment; filename=\"rs485.pcap\"");
+            g_rs485Trace.WritePcap(*response);
+        }
+
+        if (request->hasParam("clear") && request->getParam("clear")->value() == "1")
+        {
+            g_rs485Trace.Clear();
+        }
+        request->send(response);
+    });
+
+    // 9. NEW: Procjena vremena odziva (SRTT/RTTVAR) i adaptivni timeout po adresi - ZASTICENO
+    m_server.on("/rtt_table", HTTP_GET, [this](AsyncWebServerRequest *request)
+    {
+        if (!this->IsAuthenticated(request))
+        {
+            return request->requestAuthentication();
+        }
+
+        AsyncResponseStream *response = request->beginResponseStream("application/json");
+        g_rttTable.WriteJson(*response);
+        request->send(response);
+    });
+
+    // 10. NEW: Raspored pollinga (backoff, budžet posjete, stopa pražnjenja logova po uređaju)
+    //     i statistika LogWriter zadatka (high-water reda, latencija upisa) - ZASTICENO
+    m_server.on("/poll_stats", HTTP_GET, [this](AsyncWebServerRequest *request)
+    {
+        if (!this->IsAuthenticated(request))
+        {
+            return request->requestAuthentication();
+        }
+
+        AsyncResponseStream *response = request->beginResponseStream("application/json");
+        response->printf("{\"parallel\":%s,\"log_writer\":", g_rs485BusOwner.IsParallel() ? "true" : "false");
+        g_logWriter.WriteStatsJson(*response);
+        response->print(",\"pollers\":[");
+        g_logPullManager.WriteScheduleJson(*response);
+#if RS485_DUAL_UART_AVAILABLE
+        if (g_rs485BusOwner.IsParallel())
+        {
+            response->print(",");
+            g_logPullManagerR.WriteScheduleJson(*response);
+        }
+#endif
+        response->print("]}");
+        request->send(response);
+    });
+
+    // 11. NEW: Status više soba jednim prolazom magistrale (PMS, dashboard)
+    //     ?first=<adr>&last=<adr> ili ?list=<adr>,<adr>,... - bez autentifikacije, kao /sysctrl.cgi
+    //     &max_age=<ms>: sobe sa dovoljno svježim statusom u RoomStatusCache se ne čitaju sa busa
+    m_server.on("/room_status", HTTP_GET, [this](AsyncWebServerRequest *request)
+                { this->HandleRoomStatusRequest(request); });
+
 
     m_server.onNotFound([this](AsyncWebServerRequest *request)
                         { this->HandleNotFound(request); });
@@ -365,6 +477,14 @@ void HttpServer::HandleRoot(AsyncWebServerRequest *request)
  * @brief POMOĆNA: Šalje SSI odgovor (V1 Kompatibilnost).
  */
 void HttpServer::SendSSIResponse(AsyncWebServerRequest *request, const String &message)
+{
+    request->send(200, SSI_CONTENT_TYPE, BuildSSIResponse(message));
+}
+
+/**
+ * @brief POMOĆNA: Sastavlja tijelo SSI odgovora (V1 Kompatibilnost).
+ */
+String HttpServer::BuildSSIResponse(const String &message)
 {
     // REPLIKACIJA STAROG SISTEMA:
     // Stari sistem je vraćao sadržaj fajla 'log.html' koji je sadržavao samo SSI tag uokviren '$' znakovima.
@@ -390,7 +510,178 @@ void HttpServer::SendSSIResponse(AsyncWebServerRequest *request, const String &m
     response += "</body>\r\n";
     response += "</html>\r\n";
     
-    request->send(200, "text/html; charset=windows-1252", response);
+    return response;
+}
+
+/**
+ * @brief Šalje odgovor RS485 upita bez blokiranja AsyncTCP zadatka.
+ * @details Transakcija se predaje u red vlasnika magistrale, a odgovor je
+ *          callback odgovor bez Content-Length (kraj = zatvaranje konekcije, kao
+ *          stari sistem). Dok bus ne završi, callback vraća RESPONSE_TRY_AGAIN i
+ *          biblioteka ga ponovo poziva na poll konekcije - ostale konekcije se
+ *          za to vrijeme normalno opslužuju. Poll konekcije izaziva završetak
+ *          transakcije (WakeQueryWaiters), a lwIP poll tick (~500 ms) ostaje
+ *          samo rezerva kada je tabela čekanja puna.
+ */
+void HttpServer::SendQueryResponse(AsyncWebServerRequest *request, HttpCommand* cmd)
+{
+    HttpQuery* query = m_http_query_manager->BeginQuery(cmd);
+    if (query == NULL)
+    {
+        SendSSIResponse(request, HTTP_RESPONSE_BUSY);
+        return;
+    }
+
+    // Slot se oslobađa kada konekcija nestane (odgovor poslan ili klijent otišao)
+    AsyncClient* client = request->client();
+    request->onDisconnect([this, query, client]() {
+        RemoveQueryWaiter(client);
+        m_http_query_manager->ReleaseQuery(query);
+    });
+
+    // KRITIČNO: Prije send() - callback se prvi put poziva već u send(), a
+    // transakcija može završiti odmah nakon toga
+    AddQueryWaiter(client);
+
+    AsyncWebServerResponse* response = request->beginResponse(SSI_CONTENT_TYPE, 0,
+        [this, query, client](uint8_t* buffer, size_t maxLen, size_t index) -> size_t {
+            return FillQueryResponse(query, client, buffer, maxLen, index);
+        });
+    request->send(response);
+}
+
+size_t HttpServer::FillQueryResponse(HttpQuery* query, AsyncClient* client, uint8_t* buffer, size_t maxLen, size_t index)
+{
+    if (index == 0 && query->body.length() == 0)
+    {
+        int payload_len = m_http_query_manager->PollQuery(query);
+        if (payload_len == HTTP_QUERY_PENDING)
+        {
+            return RESPONSE_TRY_AGAIN;
+        }
+        RemoveQueryWaiter(client); // Ostatak odgovora tjeraju ACK-ovi
+
+        if (payload_len > 0)
+        {
+            // Upit je uspio, proslijedi stvarni odgovor
+            // VAŽNO: Payload može sadržati null bajtove, pa koristimo eksplicitnu dužinu
+            query->body = BuildSSIResponse(String((char*)query->response, payload_len));
+        }
+        else if (payload_len == 0)
+        {
+            // Prazan odgovor - možda je validno za neke komande
+            query->body = BuildSSIResponse(HTTP_RESPONSE_OK);
+        }
+        else
+        {
+            // Timeout ili greška (payload_len == -1)
+            query->body = BuildSSIResponse(HTTP_RESPONSE_TIMEOUT);
+        }
+    }
+
+    if (index >= query->body.length())
+    {
+        return 0; // Kraj odgovora
+    }
+
+    size_t len = query->body.length() - index;
+    if (len > maxLen) len = maxLen;
+    memcpy(buffer, query->body.c_str() + index, len);
+    return len;
+}
+
+/**
+ * @brief Upisuje konekciju koja čeka bus u tabelu čekanja (AsyncTCP zadatak).
+ * @details Pri punoj tabeli konekcija čeka poll tick kao ranije.
+ */
+void HttpServer::AddQueryWaiter(AsyncClient* client)
+{
+    if (client == NULL || client->pcb() == NULL) return;
+
+    portENTER_CRITICAL(&m_query_waiters_lock);
+    for (uint8_t i = 0; i < HTTP_QUERY_WAITERS; i++)
+    {
+        if (m_query_waiters[i].client == NULL)
+        {
+            m_query_waiters[i].client = client;
+            m_query_waiters[i].pcb = client->pcb();
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&m_query_waiters_lock);
+}
+
+void HttpServer::RemoveQueryWaiter(AsyncClient* client)
+{
+    portENTER_CRITICAL(&m_query_waiters_lock);
+    for (uint8_t i = 0; i < HTTP_QUERY_WAITERS; i++)
+    {
+        if (m_query_waiters[i].client == client)
+        {
+            m_query_waiters[i].client = NULL;
+            m_query_waiters[i].pcb = NULL;
+        }
+    }
+    portEXIT_CRITICAL(&m_query_waiters_lock);
+}
+
+/**
+ * @brief Callback vlasnika magistrale: transakcija HTTP upita je završena.
+ * @details Konekcije se ne smiju dirati iz ovog zadatka - buđenje se predaje
+ *          lwIP niti. Više završetaka prije buđenja dijeli jedan poziv.
+ */
+void HttpServer::OnQueryBusComplete(void* context)
+{
+    HttpServer* self = static_cast<HttpServer*>(context);
+    bool queue = false;
+
+    portENTER_CRITICAL(&self->m_query_waiters_lock);
+    if (!self->m_wake_queued)
+    {
+        self->m_wake_queued = true;
+        queue = true;
+    }
+    portEXIT_CRITICAL(&self->m_query_waiters_lock);
+
+    // Neblokirajuće - pri punom redu lwIP niti ostaje poll tick konekcije
+    if (queue && tcpip_try_callback(WakeQueryWaiters, self) != ERR_OK)
+    {
+        portENTER_CRITICAL(&self->m_query_waiters_lock);
+        self->m_wake_queued = false;
+        portEXIT_CRITICAL(&self->m_query_waiters_lock);
+    }
+}
+
+/**
+ * @brief Poziva poll callback konekcija koje čekaju (lwIP nit).
+ * @details Isto što radi lwIP poll tajmer: AsyncTCP poll događaj ponovo poziva
+ *          FillQueryResponse() u AsyncTCP zadatku. Konekcija se dira samo ako
+ *          je njen pcb još aktivan i pripada istom klijentu (mogla je biti
+ *          zatvorena nakon upisa u tabelu).
+ */
+void HttpServer::WakeQueryWaiters(void* context)
+{
+    HttpServer* self = static_cast<HttpServer*>(context);
+    QueryWaiter waiters[HTTP_QUERY_WAITERS];
+
+    portENTER_CRITICAL(&self->m_query_waiters_lock);
+    self->m_wake_queued = false;
+    memcpy(waiters, self->m_query_waiters, sizeof(waiters));
+    portEXIT_CRITICAL(&self->m_query_waiters_lock);
+
+    for (uint8_t i = 0; i < HTTP_QUERY_WAITERS; i++)
+    {
+        if (waiters[i].client == NULL) continue;
+
+        for (struct tcp_pcb* pcb = tcp_active_pcbs; pcb != NULL; pcb = pcb->next)
+        {
+            if (pcb != waiters[i].pcb) continue;
+            if (pcb->callback_arg == waiters[i].client && pcb->poll != NULL) {
+                pcb->poll(pcb->callback_arg, pcb);
+            }
+            break;
+        }
+    }
 }
 
 /**
@@ -420,26 +711,28 @@ uint32_t HttpServer::IpStringToUint(const String &ipString)
 }
 
 /**
- * @brief Zamjenjuje makroe (RCgra, RSbra, itd.) aktuelnim adresama.
+ * @brief Pretvara adresu ili makro (RCgra, RSbra, itd.) u numeričku adresu.
+ * @details Bez privremenih String-ova - poredi se direktno nad c_str().
  */
-String HttpServer::ParseMacros(String input)
+uint16_t HttpServer::ResolveAddress(const String& input)
 {
-    if (input.equalsIgnoreCase("RSbra"))
-        return String(g_appConfig.rs485_bcast_addr);
-    if (input.equalsIgnoreCase("HCgra"))
-        return String(g_appConfig.rs485_group_addr);
-    if (input.equalsIgnoreCase("HCifa"))
-        return String(g_appConfig.rs485_iface_addr);
-    if (input.equalsIgnoreCase("RTgra"))
-        return String(30855);
-    if (input.equalsIgnoreCase("RCgra"))
-        return String(26486);
-    if (input.equalsIgnoreCase("OWbra"))
-        return String(127);
-    if (input.equalsIgnoreCase("RTgraOW"))
-        return String(10);
-
-    return input;
+    const char* s = input.c_str();
+    if (strcasecmp(s, "RSbra") == 0)
+        return g_appConfig.rs485_bcast_addr;
+    if (strcasecmp(s, "HCgra") == 0)
+        return g_appConfig.rs485_group_addr;
+    if (strcasecmp(s, "HCifa") == 0)
+        return g_appConfig.rs485_iface_addr;
+    if (strcasecmp(s, "RTgra") == 0)
+        return 30855;
+    if (strcasecmp(s, "RCgra") == 0)
+        return 26486;
+    if (strcasecmp(s, "OWbra") == 0)
+        return 127;
+    if (strcasecmp(s, "RTgraOW") == 0)
+        return 10;
+
+    return (uint16_t)input.toInt();
 }
 
 /**
@@ -448,8 +741,8 @@ String HttpServer::ParseMacros(String input)
 void HttpServer::BuildAddressList(const String &firstAddrStr, const String &lastAddrStr, uint16_t *list, uint16_t *count)
 {
     *count = 0;
-    uint16_t first_addr = ParseMacros(firstAddrStr).toInt();
-    uint16_t last_addr = ParseMacros(lastAddrStr).toInt();
+    uint16_t first_addr = ResolveAddress(firstAddrStr);
+    uint16_t last_addr = ResolveAddress(lastAddrStr);
 
     if (first_addr == 0 || last_addr == 0 || last_addr < first_addr)
     {
@@ -506,28 +799,117 @@ bool HttpServer::StartUpdateSession(AsyncWebServerRequest *request, uint8_t upda
     return m_update_manager->StartSession(clientAddr, updateCmd);
 }
 
+/**
+ * @brief Status liste soba (kao cst) u jednom JSON odgovoru.
+ * @details Sobe čita g_roomStatusSweep jednim prolazom magistrale; odgovor je
+ *          callback odgovor kao kod SendQueryResponse() - RESPONSE_TRY_AGAIN dok
+ *          sweep ne završi, zatim JSON red po red (bez buffera cijelog odgovora).
+ */
+void HttpServer::HandleRoomStatusRequest(AsyncWebServerRequest *request)
+{
+    // KRITIČNO: Kao sysctrl.cgi - bez RS485 upita dok je file update u toku
+    if (m_update_manager->IsActive() || m_fuf_update_manager->IsActive())
+    {
+        request->send(503, "text/plain", HTTP_RESPONSE_BUSY);
+        return;
+    }
+
+    uint16_t addresses[ROOM_STATUS_BATCH_MAX];
+    uint16_t count = 0;
+
+    if (request->hasParam("first") && request->hasParam("last"))
+    {
+        uint16_t first_addr = ResolveAddress(request->getParam("first")->value());
+        uint16_t last_addr = ResolveAddress(request->getParam("last")->value());
+        // U dual modu opseg obuhvata samo adrese iz L/R listi (ne cijeli numerički opseg)
+        bool filter = (g_deviceDirectory.GetCount() > 0);
+
+        for (uint32_t addr = first_addr; addr != 0 && addr <= last_addr && count < ROOM_STATUS_BATCH_MAX; addr++)
+        {
+            DeviceInfo info;
+            if (!filter || g_deviceDirectory.Lookup((uint16_t)addr, &info))
+            {
+                addresses[count++] = (uint16_t)addr;
+            }
+        }
+    }
+    else if (request->hasParam("list"))
+    {
+        const char* p = request->getParam("list")->value().c_str();
+        while (*p != '\0' && count < ROOM_STATUS_BATCH_MAX)
+        {
+            char* end;
+            unsigned long addr = strtoul(p, &end, 10);
+            if (end == p)
+            {
+                p++; // Separator
+                continue;
+            }
+            if (addr > 0 && addr <= 0xFFFF)
+            {
+                addresses[count++] = (uint16_t)addr;
+            }
+            p = end;
+        }
+    }
+
+    if (count == 0)
+    {
+        request->send(400, "text/plain", "Missing Parameters");
+        return;
+    }
+
+    uint32_t max_age_ms = 0;
+    if (request->hasParam("max_age"))
+    {
+        max_age_ms = strtoul(request->getParam("max_age")->value().c_str(), NULL, 10);
+    }
+
+    if (!g_roomStatusSweep.Begin(addresses, count, max_age_ms))
+    {
+        request->send(503, "text/plain", HTTP_RESPONSE_BUSY);
+        return;
+    }
+
+    // Rezultat se oslobađa (ili se sweep prekida) kada konekcija nestane
+    request->onDisconnect([]() {
+        g_roomStatusSweep.Release();
+    });
+
+    AsyncWebServerResponse* response = request->beginResponse("application/json", 0,
+        [](uint8_t* buffer, size_t maxLen, size_t index) -> size_t {
+            if (!g_roomStatusSweep.IsDone())
+            {
+                return RESPONSE_TRY_AGAIN;
+            }
+            return g_roomStatusSweep.FillJson(buffer, maxLen, index);
+        });
+    request->send(response);
+}
+
 // ============================================================================
-// GLAVNI CGI HANDLER - POTPUNO REFAKTORISAN
+// SYSCTRL.CGI - POMOĆNE FUNKCIJE (tabela ključeva i komandi je u SysctrlDispatch)
 // ============================================================================
-void HttpServer::HandleSysctrlRequest(AsyncWebServerRequest *request)
+
+/**
+ * @brief Parsira 'len' decimalnih cifara (bez privremenog substring-a).
+ */
+static int ParseDigits(const char* s, uint8_t len)
 {
-    // Detaljan log primljenog zahtjeva
-    Serial.println(F("[HttpServer] ========================================"));
-    Serial.println(F("[HttpServer] Primljen /sysctrl.cgi zahtjev:"));
-    Serial.printf("[HttpServer]   URL: %s\n", request->url().c_str());
-    Serial.printf("[HttpServer]   Method: %s\n", request->methodToString());
-    Serial.printf("[HttpServer]   Host: %s\n", request->host().c_str());
-    Serial.printf("[HttpServer]   Broj parametara: %d\n", request->params());
-    
-    // Ispis svih parametara
-    if (request->params() > 0) {
-        Serial.println(F("[HttpServer]   Parametri:"));
-        for (int i = 0; i < request->params(); i++) {
-            AsyncWebParameter* p = request->getParam(i);
-            Serial.printf("[HttpServer]     %s = %s\n", p->name().c_str(), p->value().c_str());
-        }
+    int value = 0;
+    for (uint8_t i = 0; i < len && s[i] >= '0' && s[i] <= '9'; i++) {
+        value = value * 10 + (s[i] - '0');
     }
-    Serial.println(F("[HttpServer] ========================================"));
+    return value;
+}
+
+// ============================================================================
+// GLAVNI CGI HANDLER - TABELARNI DISPEČER
+// ============================================================================
+void HttpServer::HandleSysctrlRequest(AsyncWebServerRequest *request)
+{
+    // Detaljan log primljenog zahtjeva (parametri se ispisuju u prolazu ispod)
+    LOG_DEBUG(4, "[HttpServer] /sysctrl.cgi: %s (%d parametara)\n", request->url().c_str(), request->params());
 
     // KRITIČNO: Blokiraj SVE sysctrl.cgi komande ako je file update u toku!
     // Ovo sprječava RS485 konflikte između UpdateManager i ostalih komponenti.
@@ -539,24 +921,43 @@ void HttpServer::HandleSysctrlRequest(AsyncWebServerRequest *request)
         return;
     }
 
+    // NOVO: Jedan prolaz kroz parametre, zatim izbor komande iz tabele
+    // Kao hasParam()/getParam(): samo GET parametri
+    SysctrlArgs args;
+    for (size_t i = 0; i < request->params(); i++)
+    {
+        AsyncWebParameter* p = request->getParam(i);
+        LOG_DEBUG(4, "[HttpServer]     %s = %s\n", p->name().c_str(), p->value().c_str());
+        if (p->isPost() || p->isFile()) continue;
+        args.Add(p->name().c_str(), p->value());
+    }
+    const SysctrlRoute* route = FindSysctrlRoute(args);
+    if (route == NULL)
+    {
+        SendSSIResponse(request, HTTP_RESPONSE_ERROR); // Nepoznata komanda
+        return;
+    }
+
     // Inicijalizacija
-    char buffer_data[256] = {0};
+    char buffer_data[HTTP_CMD_DATA_SIZE] = {0};
     HttpCommand cmd = {};
     cmd.string_ptr = (uint8_t *)buffer_data;
     cmd.string_len = 0;
-    String targetAddrStr;
+    uint16_t target_addr = 0;
     bool is_blocking = false;
 
+    switch (route->cmd)
+    {
     // ========================================================================
     // --- LOKALNE KOMANDE (Ne idu na RS485 bus) ---
     // ========================================================================
 
     // --- HC set IP addresses: ipa, snm, gwa ---
-    if (request->hasParam("ipa") && request->hasParam("snm") && request->hasParam("gwa"))
+    case SysctrlCmd::SET_IP:
     {
-        g_appConfig.ip_address = IpStringToUint(request->getParam("ipa")->value());
-        g_appConfig.subnet_mask = IpStringToUint(request->getParam("snm")->value());
-        g_appConfig.gateway = IpStringToUint(request->getParam("gwa")->value());
+        g_appConfig.ip_address = IpStringToUint(args.Value(SK_IPA));
+        g_appConfig.subnet_mask = IpStringToUint(args.Value(SK_SNM));
+        g_appConfig.gateway = IpStringToUint(args.Value(SK_GWA));
         if (m_eeprom_storage->WriteConfig(&g_appConfig))
         {
             SendSSIResponse(request, HTTP_RESPONSE_OK);
@@ -569,15 +970,18 @@ void HttpServer::HandleSysctrlRequest(AsyncWebServerRequest *request)
     }
 
     // --- NEW: HC set protocol version: proto (DEPRECATED - koristi protoL/protoR) ---
-    if (request->hasParam("proto"))
+    // --- HC set main protocol: set_proto (DEPRECATED - koristi protoL/protoR) ---
+    case SysctrlCmd::PROTO:
+    case SysctrlCmd::SET_PROTO:
     {
-        uint8_t proto_val = request->getParam("proto")->value().toInt();
+        uint8_t proto_val = args.Int((route->cmd == SysctrlCmd::PROTO) ? SK_PROTO : SK_SET_PROTO);
         if (proto_val <= static_cast<uint8_t>(ProtocolVersion::SAX)) // Validate enum range
         {
             // Za backward compatibility - postavi oba protokola na istu vrijednost
             g_appConfig.protocol_version = proto_val;
             g_appConfig.protocol_version_L = proto_val;
             g_appConfig.protocol_version_R = proto_val;
+            g_deviceDirectory.RefreshProtocols();
             if (m_eeprom_storage->WriteConfig(&g_appConfig))
             {
                 Serial.printf("[HttpServer] Postavljena verzija protokola: %d (L i R)\n", proto_val);
@@ -596,11 +1000,11 @@ void HttpServer::HandleSysctrlRequest(AsyncWebServerRequest *request)
     }
 
     // --- NEW: HC set dual protocol: protoL, protoR ---
-    if (request->hasParam("protoL") && request->hasParam("protoR"))
+    case SysctrlCmd::PROTO_LR:
     {
-        uint8_t proto_L = request->getParam("protoL")->value().toInt();
-        uint8_t proto_R = request->getParam("protoR")->value().toInt();
-        
+        uint8_t proto_L = args.Int(SK_PROTOL);
+        uint8_t proto_R = args.Int(SK_PROTOR);
+
         if (proto_L <= static_cast<uint8_t>(ProtocolVersion::SAX) &&
             proto_R <= static_cast<uint8_t>(ProtocolVersion::SAX))
         {
@@ -608,37 +1012,11 @@ void HttpServer::HandleSysctrlRequest(AsyncWebServerRequest *request)
             g_appConfig.protocol_version_R = proto_R;
             // Ažuriraj i stari protocol_version za backward compatibility
             g_appConfig.protocol_version = proto_L;
-            
-            if (m_eeprom_storage->WriteConfig(&g_appConfig))
-            {
-                Serial.printf("[HttpServer] Postavljeni protokoli: L=%d, R=%d\n", proto_L, proto_R);
-                SendSSIResponse(request, HTTP_RESPONSE_OK);
-            }
-            else
-            {
-                SendSSIResponse(request, HTTP_RESPONSE_ERROR);
-            }
-        }
-        else
-        {
-            SendSSIResponse(request, HTTP_RESPONSE_ERROR);
-        }
-        return;
-    }
+            g_deviceDirectory.RefreshProtocols();
 
-    // --- HC set main protocol: set_proto (DEPRECATED - koristi protoL/protoR) ---
-    if (request->hasParam("set_proto"))
-    {
-        uint8_t proto_val = request->getParam("set_proto")->value().toInt();
-        if (proto_val <= static_cast<uint8_t>(ProtocolVersion::SAX))
-        {
-            // Za backward compatibility - postavi oba protokola na istu vrijednost
-            g_appConfig.protocol_version = proto_val;
-            g_appConfig.protocol_version_L = proto_val;
-            g_appConfig.protocol_version_R = proto_val;
             if (m_eeprom_storage->WriteConfig(&g_appConfig))
             {
-                Serial.printf("[HttpServer] Glavni protokol postavljen: %d\n", proto_val);
+                Serial.printf("[HttpServer] Postavljeni protokoli: L=%d, R=%d\n", proto_L, proto_R);
                 SendSSIResponse(request, HTTP_RESPONSE_OK);
             }
             else
@@ -654,14 +1032,14 @@ void HttpServer::HandleSysctrlRequest(AsyncWebServerRequest *request)
     }
 
     // --- HC set system ID (lokalno): sysid ---
-    if (request->hasParam("sysid"))
+    case SysctrlCmd::SYSID:
     {
-        uint16_t new_sysid = request->getParam("sysid")->value().toInt();
+        uint16_t new_sysid = args.Int(SK_SYSID);
         if (new_sysid > 0 && new_sysid <= 65000)
         {
             Serial.printf("[HttpServer] Promjena lokalnog System ID: %d -> %d\n", g_appConfig.system_id, new_sysid);
             g_appConfig.system_id = new_sysid;
-            
+
             if (m_eeprom_storage->WriteConfig(&g_appConfig)) {
                 SendSSIResponse(request, HTTP_RESPONSE_OK);
             } else {
@@ -676,10 +1054,10 @@ void HttpServer::HandleSysctrlRequest(AsyncWebServerRequest *request)
     }
 
     // --- HC set mDNS name (lokalno): mdnsname ---
-    if (request->hasParam("mdnsname"))
+    case SysctrlCmd::MDNS_NAME:
     {
         Serial.println("[HttpServer] DEBUG: USAO U mdnsname HANDLER!");
-        String new_mdns = request->getParam("mdnsname")->value();
+        const String& new_mdns = args.Value(SK_MDNSNAME);
         Serial.printf("[HttpServer] DEBUG: Primljena vrednost: '%s' (length=%d)\n", new_mdns.c_str(), new_mdns.length());
         // Validacija: dozvoljavamo alfanumeričke karaktere, crticu i donju crtu (max 16 karaktera)
         bool valid = true;
@@ -702,7 +1080,7 @@ void HttpServer::HandleSysctrlRequest(AsyncWebServerRequest *request)
             valid = false;
             Serial.printf("[HttpServer] DEBUG: Validacija PALA - duzina van opsega: %d\n", new_mdns.length());
         }
-        
+
         if (valid)
         {
             Serial.printf("[HttpServer] Promjena mDNS imena: '%s' -> '%s'\n", g_appConfig.mdns_name, new_mdns.c_str());
@@ -710,19 +1088,19 @@ void HttpServer::HandleSysctrlRequest(AsyncWebServerRequest *request)
             memset(g_appConfig.mdns_name, 0, sizeof(g_appConfig.mdns_name));
             strncpy(g_appConfig.mdns_name, new_mdns.c_str(), sizeof(g_appConfig.mdns_name) - 1);
             Serial.printf("[HttpServer] DEBUG: Posle kopiranja - g_appConfig.mdns_name = '%s'\n", g_appConfig.mdns_name);
-            
+
             if (m_eeprom_storage->WriteConfig(&g_appConfig)) {
                 Serial.printf("[HttpServer] DEBUG: EEPROM WriteConfig USPEO!\n");
                 // Primeni mDNS odmah na Ethernet interfejs
                 ETH.setHostname(g_appConfig.mdns_name);
                 Serial.printf("[HttpServer] mDNS ime primenjeno na ETH: %s\n", g_appConfig.mdns_name);
-                
+
                 // VERIFIKACIJA: Procitaj nazad iz EEPROM-a
                 AppConfig verify_config;
                 if (m_eeprom_storage->ReadConfig(&verify_config)) {
                     Serial.printf("[HttpServer] DEBUG: Verifikacija - procitano iz EEPROM: '%s'\n", verify_config.mdns_name);
                 }
-                
+
                 SendSSIResponse(request, HTTP_RESPONSE_OK);
             } else {
                 Serial.printf("[HttpServer] DEBUG: EEPROM WriteConfig NIJE USPEO!\n");
@@ -737,9 +1115,9 @@ void HttpServer::HandleSysctrlRequest(AsyncWebServerRequest *request)
     }
 
     // --- HC logger enable/disable: logger_en ---
-    if (request->hasParam("logger_en"))
+    case SysctrlCmd::LOGGER_EN:
     {
-        g_appConfig.logger_enable = (request->getParam("logger_en")->value() == "1");
+        g_appConfig.logger_enable = (args.Value(SK_LOGGER_EN) == "1");
         if (m_eeprom_storage->WriteConfig(&g_appConfig))
         {
             Serial.printf("[HttpServer] Logger %s\n", g_appConfig.logger_enable ? "omogućen" : "onemogućen");
@@ -753,19 +1131,19 @@ void HttpServer::HandleSysctrlRequest(AsyncWebServerRequest *request)
     }
 
     // --- HC TimeSync interval: time_sync_interval ---
-    if (request->hasParam("time_sync_interval"))
+    case SysctrlCmd::TIME_SYNC_INTERVAL:
     {
         // Primamo u minutama i direktno snimamo
-        uint16_t intervalMin = request->getParam("time_sync_interval")->value().toInt();
-        
+        uint16_t intervalMin = args.Int(SK_TIME_SYNC_INTERVAL);
+
         // Ograničenje: 0-255 minuta
         if (intervalMin <= 255)
         {
             g_appConfig.time_sync_interval_min = (uint8_t)intervalMin;
-            
+
             if (m_eeprom_storage->WriteConfig(&g_appConfig))
             {
-                Serial.printf("[HttpServer] TimeSync interval: %u min\n", 
+                Serial.printf("[HttpServer] TimeSync interval: %u min\n",
                     g_appConfig.time_sync_interval_min);
                 SendSSIResponse(request, HTTP_RESPONSE_OK);
             }
@@ -782,16 +1160,16 @@ void HttpServer::HandleSysctrlRequest(AsyncWebServerRequest *request)
     }
 
     // --- HC Dual Bus Mode toggle: dual_bus ---
-    if (request->hasParam("dual_bus"))
+    case SysctrlCmd::DUAL_BUS:
     {
-        bool new_dual_bus_mode = (request->getParam("dual_bus")->value() == "1");
-        
-        Serial.printf("[HttpServer] Promjena Dual Bus Mode: %s -> %s\n", 
+        bool new_dual_bus_mode = (args.Value(SK_DUAL_BUS) == "1");
+
+        Serial.printf("[HttpServer] Promjena Dual Bus Mode: %s -> %s\n",
             g_appConfig.enable_dual_bus_mode ? "Dual" : "Single",
             new_dual_bus_mode ? "Dual" : "Single");
-        
+
         g_appConfig.enable_dual_bus_mode = new_dual_bus_mode;
-        
+
         if (m_eeprom_storage->WriteConfig(&g_appConfig))
         {
             Serial.println(F("[HttpServer] UPOZORENJE: Restart potreban za primjenu dual bus mode promjene!"));
@@ -804,23 +1182,52 @@ void HttpServer::HandleSysctrlRequest(AsyncWebServerRequest *request)
         return;
     }
 
+    // --- NOVO: RS485 ožičenje: bus_wiring (0 = dijeljeni RX, 1 = zaseban UART po busu) ---
+    case SysctrlCmd::BUS_WIRING:
+    {
+        int wiring_value = args.Int(SK_BUS_WIRING);
+        // Zaseban UART po busu samo na ploči sa TX pinom Desnog busa
+        if (wiring_value != RS485_WIRING_SHARED_RX &&
+            (wiring_value != RS485_WIRING_DUAL_UART || !RS485_DUAL_UART_AVAILABLE))
+        {
+            SendSSIResponse(request, HTTP_RESPONSE_ERROR);
+            return;
+        }
+
+        Serial.printf("[HttpServer] Promjena RS485 ozicenja: %d -> %d\n",
+            g_appConfig.rs485_wiring_mode, wiring_value);
+
+        g_appConfig.rs485_wiring_mode = (uint8_t)wiring_value;
+
+        if (m_eeprom_storage->WriteConfig(&g_appConfig))
+        {
+            Serial.println(F("[HttpServer] UPOZORENJE: Restart potreban za primjenu RS485 ozicenja!"));
+            SendSSIResponse(request, HTTP_RESPONSE_OK);
+        }
+        else
+        {
+            SendSSIResponse(request, HTTP_RESPONSE_ERROR);
+        }
+        return;
+    }
+
     // --- NOVO: Promjena primarnog mrežnog interfejsa: set_iface ---
-    if (request->hasParam("set_iface"))
+    case SysctrlCmd::SET_IFACE:
     {
-        int iface_value = request->getParam("set_iface")->value().toInt();
+        int iface_value = args.Int(SK_SET_IFACE);
         bool new_use_wifi = (iface_value == 1); // 0 = Ethernet, 1 = WiFi
-        
-        Serial.printf("[HttpServer] Promjena primarnog interfejsa: %s -> %s\n", 
+
+        Serial.printf("[HttpServer] Promjena primarnog interfejsa: %s -> %s\n",
             g_appConfig.use_wifi_as_primary ? "WiFi" : "Ethernet",
             new_use_wifi ? "WiFi" : "Ethernet");
-        
+
         g_appConfig.use_wifi_as_primary = new_use_wifi;
-        
+
         if (m_eeprom_storage->WriteConfig(&g_appConfig))
         {
             Serial.println(F("[HttpServer] Konfiguracija snimljena. Uređaj će se restartovati..."));
             SendSSIResponse(request, HTTP_RESPONSE_OK);
-            
+
             // Zakaži restart nakon 2 sekunde (daj vremena za slanje odgovora)
             delay(1000);
             ESP.restart();
@@ -834,27 +1241,23 @@ void HttpServer::HandleSysctrlRequest(AsyncWebServerRequest *request)
     }
 
     // --- HC set additional sync packets: set_add_sync ---
-    if (request->hasParam("set_add_sync"))
+    case SysctrlCmd::SET_ADD_SYNC:
     {
         bool all_valid = true;
         for (int i = 0; i < 3; i++)
         {
-            String en_param = "sync_en" + String(i);
-            String p_param = "sync_p" + String(i);
-            String a_param = "sync_a" + String(i);
-
             // Uvijek treba biti prisutan parametar
-            if (request->hasParam(en_param.c_str()))
+            if (args.Has(SK_SYNC_EN0 + i))
             {
-                uint8_t enabled = request->getParam(en_param.c_str())->value().toInt();
+                uint8_t enabled = args.Int(SK_SYNC_EN0 + i);
                 // STROGA VALIDACIJA: samo 1 je enabled, sve ostalo je 0
                 g_appConfig.additional_sync[i].enabled = (enabled == 1) ? 1 : 0;
 
                 if (g_appConfig.additional_sync[i].enabled == 1)
                 {
-                    if (request->hasParam(p_param.c_str()))
+                    if (args.Has(SK_SYNC_P0 + i))
                     {
-                        uint8_t protocol = request->getParam(p_param.c_str())->value().toInt();
+                        uint8_t protocol = args.Int(SK_SYNC_P0 + i);
                         if (protocol <= static_cast<uint8_t>(ProtocolVersion::SAX))
                         {
                             g_appConfig.additional_sync[i].protocol_version = protocol;
@@ -866,10 +1269,9 @@ void HttpServer::HandleSysctrlRequest(AsyncWebServerRequest *request)
                         }
                     }
 
-                    if (request->hasParam(a_param.c_str()))
+                    if (args.Has(SK_SYNC_A0 + i))
                     {
-                        uint16_t address = request->getParam(a_param.c_str())->value().toInt();
-                        g_appConfig.additional_sync[i].broadcast_addr = address;
+                        g_appConfig.additional_sync[i].broadcast_addr = args.Int(SK_SYNC_A0 + i);
                     }
                 }
                 else
@@ -888,8 +1290,8 @@ void HttpServer::HandleSysctrlRequest(AsyncWebServerRequest *request)
             {
                 if (g_appConfig.additional_sync[i].enabled != 0)
                 {
-                    Serial.printf("  [%d] Protokol: %d, Adresa: %d\n", 
-                        i, 
+                    Serial.printf("  [%d] Protokol: %d, Adresa: %d\n",
+                        i,
                         g_appConfig.additional_sync[i].protocol_version,
                         g_appConfig.additional_sync[i].broadcast_addr);
                 }
@@ -904,27 +1306,22 @@ void HttpServer::HandleSysctrlRequest(AsyncWebServerRequest *request)
     }
 
     // --- HC update rtc date & time: tdu / DTset ---
-    if (request->hasParam("tdu") || request->hasParam("DTset"))
+    case SysctrlCmd::DATE_TIME:
     {
-        String dt = request->hasParam("tdu") ? request->getParam("tdu")->value() : request->getParam("DTset")->value();
+        const String& dt = args.Value(args.Has(SK_TDU) ? SK_TDU : SK_DTSET);
 
         if (dt.length() == 15)
         {
-            // int weekday = dt.substring(0, 1).toInt(); // Stari format
-            int day = dt.substring(1, 3).toInt();
-            int month = dt.substring(3, 5).toInt();
-            int year = dt.substring(5, 9).toInt();
-            int hour = dt.substring(9, 11).toInt();
-            int minute = dt.substring(11, 13).toInt();
-            int second = dt.substring(13, 15).toInt();
+            // Format: W DD MM YYYY hh mm ss (weekday se ignoriše)
+            const char* s = dt.c_str();
 
             struct tm tm_time = {};
-            tm_time.tm_year = year - 1900;
-            tm_time.tm_mon = month - 1;
-            tm_time.tm_mday = day;
-            tm_time.tm_hour = hour;
-            tm_time.tm_min = minute;
-            tm_time.tm_sec = second;
+            tm_time.tm_year = ParseDigits(s + 5, 4) - 1900;
+            tm_time.tm_mon = ParseDigits(s + 3, 2) - 1;
+            tm_time.tm_mday = ParseDigits(s + 1, 2);
+            tm_time.tm_hour = ParseDigits(s + 9, 2);
+            tm_time.tm_min = ParseDigits(s + 11, 2);
+            tm_time.tm_sec = ParseDigits(s + 13, 2);
 
             time_t t = mktime(&tm_time);
             if (t != (time_t)-1)
@@ -940,11 +1337,12 @@ void HttpServer::HandleSysctrlRequest(AsyncWebServerRequest *request)
     }
 
     // --- HC log list request: log ---
-    if (request->hasParam("log") || request->hasParam("RQlog"))
+    case SysctrlCmd::LOG:
     {
-        String log_op = request->getParam(request->hasParam("log") ? "log" : "RQlog")->value();
+        const String& log_op = args.Value(args.Has(SK_LOG) ? SK_LOG : SK_RQLOG);
+        const char* op = log_op.c_str();
 
-        if (log_op == "3" || log_op.equalsIgnoreCase("RDlog"))
+        if (strcmp(op, "3") == 0 || strcasecmp(op, "RDlog") == 0)
         {
             String hex_log_block = m_eeprom_storage->ReadLogBlockAsHexString();
             if (hex_log_block != HTTP_RESPONSE_ERROR)
@@ -957,7 +1355,7 @@ void HttpServer::HandleSysctrlRequest(AsyncWebServerRequest *request)
             }
             return;
         }
-        else if (log_op == "4" || log_op.equalsIgnoreCase("DLlog"))
+        else if (strcmp(op, "4") == 0 || strcasecmp(op, "DLlog") == 0)
         {
             if (m_eeprom_storage->DeleteLogBlock() == LoggerStatus::LOGGER_OK)
             {
@@ -969,7 +1367,7 @@ void HttpServer::HandleSysctrlRequest(AsyncWebServerRequest *request)
             }
             return;
         }
-        else if (log_op == "5" || log_op.equalsIgnoreCase("DLlst"))
+        else if (strcmp(op, "5") == 0 || strcasecmp(op, "DLlst") == 0)
         {
             if (m_eeprom_storage->ClearAllLogs() == LoggerStatus::LOGGER_OK)
             {
@@ -986,7 +1384,7 @@ void HttpServer::HandleSysctrlRequest(AsyncWebServerRequest *request)
     }
 
     // --- NEW: HC load address list: cad=load ---
-    if (request->hasParam("cad") && request->getParam("cad")->value() == "load")
+    case SysctrlCmd::LOAD_ADDR_LIST:
     {
         Serial.println(F("[HttpServer] Učitavam listu adresa sa uSD kartice..."));
 
@@ -1006,7 +1404,7 @@ void HttpServer::HandleSysctrlRequest(AsyncWebServerRequest *request)
         // Parsiranje CTRL_ADD.TXT pomoću centralizovane funkcije
         uint16_t address_list[MAX_ADDRESS_LIST_SIZE];
         uint16_t count = 0;
-        
+
         if (!m_eeprom_storage->ParseAddressListFromCSV(content, address_list, MAX_ADDRESS_LIST_SIZE, &count))
         {
             SendSSIResponse(request, HTTP_RESPONSE_ERROR);
@@ -1033,7 +1431,7 @@ void HttpServer::HandleSysctrlRequest(AsyncWebServerRequest *request)
     }
 
     // --- HC update firmware: fwu ---
-    if (request->hasParam("fwu") || request->hasParam("HCfwu"))
+    case SysctrlCmd::HC_FW_UPDATE:
     {
         Serial.println("[HttpServer] Restarting system for update (fwu=hc)...");
         SendSSIResponse(request, HTTP_RESPONSE_OK);
@@ -1047,9 +1445,23 @@ void HttpServer::HandleSysctrlRequest(AsyncWebServerRequest *request)
     // ========================================================================
 
     // --- RC update old firmware: cud ---
-    if (request->hasParam("cud"))
+    // --- RT update firmware: tuf, owa ---
+    // --- upload RT display user logo image: tlg, owa ---
+    case SysctrlCmd::RC_OLD_FW_UPDATE:
+    case SysctrlCmd::RT_FW_UPDATE:
+    case SysctrlCmd::RT_LOGO_UPDATE:
     {
-        if (StartUpdateSession(request, CMD_OLD_UPDATE_FWR, request->getParam("cud")->value(), request->getParam("cud")->value()))
+        uint8_t update_cmd = CMD_OLD_UPDATE_FWR;
+        uint8_t addr_key = SK_CUD;
+        if (route->cmd == SysctrlCmd::RT_FW_UPDATE) {
+            update_cmd = CMD_RT_DWNLD_FWR;
+            addr_key = SK_TUF;
+        } else if (route->cmd == SysctrlCmd::RT_LOGO_UPDATE) {
+            update_cmd = CMD_RT_DWNLD_LOGO;
+            addr_key = SK_TLG;
+        }
+
+        if (StartUpdateSession(request, update_cmd, args.Value(addr_key), args.Value(addr_key)))
         {
             SendSSIResponse(request, HTTP_RESPONSE_OK);
         }
@@ -1061,71 +1473,28 @@ void HttpServer::HandleSysctrlRequest(AsyncWebServerRequest *request)
     }
 
     // --- RC update firmware: fuf, ful ---
-    if (request->hasParam("fuf") && request->hasParam("ful"))
-    {
-        if (!m_sd_card_manager->IsCardMounted()) {
-            SendSSIResponse(request, HTTP_RESPONSE_ERROR);
-            return;
-        }
-        uint16_t first_addr = request->getParam("fuf")->value().toInt();
-        uint16_t last_addr = request->getParam("ful")->value().toInt();
-        if (first_addr == 0 || last_addr < first_addr) {
-            SendSSIResponse(request, HTTP_RESPONSE_ERROR);
-            return;
-        }
-        m_fuf_update_manager->StartFirmwareUpdateSequence(first_addr, last_addr, FUF_TYPE_FIRMWARE);
-        SendSSIResponse(request, "OK (FUF sequence started)");
-        return;
-    }
-
     // --- RC update bootloader: buf, bul ---
-    if (request->hasParam("buf") && request->hasParam("bul"))
+    case SysctrlCmd::RC_FW_UPDATE:
+    case SysctrlCmd::RC_BL_UPDATE:
     {
+        bool is_firmware = (route->cmd == SysctrlCmd::RC_FW_UPDATE);
         if (!m_sd_card_manager->IsCardMounted()) {
             SendSSIResponse(request, HTTP_RESPONSE_ERROR);
             return;
         }
-        uint16_t first_addr = request->getParam("buf")->value().toInt();
-        uint16_t last_addr = request->getParam("bul")->value().toInt();
+        uint16_t first_addr = args.Int(is_firmware ? SK_FUF : SK_BUF);
+        uint16_t last_addr = args.Int(is_firmware ? SK_FUL : SK_BUL);
         if (first_addr == 0 || last_addr < first_addr) {
             SendSSIResponse(request, HTTP_RESPONSE_ERROR);
             return;
         }
-        m_fuf_update_manager->StartFirmwareUpdateSequence(first_addr, last_addr, FUF_TYPE_BOOTLOADER);
-        SendSSIResponse(request, "OK (BUF sequence started)");
-        return;
-    }
-
-    // --- RT update firmware: tuf, owa ---
-    if (request->hasParam("tuf") && request->hasParam("owa"))
-    {
-        if (StartUpdateSession(request, CMD_RT_DWNLD_FWR, request->getParam("tuf")->value(), request->getParam("tuf")->value()))
-        {
-            SendSSIResponse(request, HTTP_RESPONSE_OK);
-        }
-        else
-        {
-            SendSSIResponse(request, HTTP_RESPONSE_ERROR);
-        }
-        return;
-    }
-
-    // --- upload RT display user logo image: tlg, owa ---
-    if (request->hasParam("tlg") && request->hasParam("owa"))
-    {
-        if (StartUpdateSession(request, CMD_RT_DWNLD_LOGO, request->getParam("tlg")->value(), request->getParam("tlg")->value()))
-        {
-            SendSSIResponse(request, HTTP_RESPONSE_OK);
-        }
-        else
-        {
-            SendSSIResponse(request, HTTP_RESPONSE_ERROR);
-        }
+        m_fuf_update_manager->StartFirmwareUpdateSequence(first_addr, last_addr, is_firmware ? FUF_TYPE_FIRMWARE : FUF_TYPE_BOOTLOADER);
+        SendSSIResponse(request, is_firmware ? "OK (FUF sequence started)" : "OK (BUF sequence started)");
         return;
     }
 
     // --- RC update display image: iuf, iul, ifa, ila ---
-    if (request->hasParam("iuf") && request->hasParam("iul") && request->hasParam("ifa") && request->hasParam("ila"))
+    case SysctrlCmd::RC_IMAGE_UPDATE:
     {
         // Provjeri da li postoji SD kartica
         if (!m_sd_card_manager->IsCardMounted()) {
@@ -1133,10 +1502,10 @@ void HttpServer::HandleSysctrlRequest(AsyncWebServerRequest *request)
             return;
         }
 
-        uint16_t first_addr = request->getParam("iuf")->value().toInt();
-        uint16_t last_addr = request->getParam("iul")->value().toInt();
-        uint8_t first_img = request->getParam("ifa")->value().toInt();
-        uint8_t last_img = request->getParam("ila")->value().toInt();
+        uint16_t first_addr = args.Int(SK_IUF);
+        uint16_t last_addr = args.Int(SK_IUL);
+        uint8_t first_img = args.Int(SK_IFA);
+        uint8_t last_img = args.Int(SK_ILA);
 
         if (first_img < 1 || last_img > 14 || first_img > last_img || first_addr == 0 || last_addr < first_addr) {
             SendSSIResponse(request, HTTP_RESPONSE_ERROR);
@@ -1153,258 +1522,264 @@ void HttpServer::HandleSysctrlRequest(AsyncWebServerRequest *request)
     // ========================================================================
 
     // --- Implementacija SET_PERMITED_GROUP (pga) ---
-    if (request->hasParam("pga") && request->hasParam("pgu"))
+    case SysctrlCmd::PERMITED_GROUP:
     {
-        targetAddrStr = request->getParam("pga")->value();
+        target_addr = ResolveAddress(args.Value(SK_PGA));
         cmd.cmd_id = SET_PERMITED_GROUP;
 
-        String groups = request->getParam("pgu")->value();
         memset(buffer_data, ' ', 16);
-        strncpy(buffer_data, groups.c_str(), 16);
+        strncpy(buffer_data, args.Value(SK_PGU).c_str(), 16);
         cmd.string_len = 16;
         is_blocking = true;
+        break;
     }
 
     // --- Implementacija CMD_SET_DIN_CFG (cdi) ---
-    else if (request->hasParam("cdi") && request->hasParam("di0")) 
+    case SysctrlCmd::DIN_CFG:
     {
-        targetAddrStr = request->getParam("cdi")->value();
+        target_addr = ResolveAddress(args.Value(SK_CDI));
         cmd.cmd_id = CMD_SET_DIN_CFG;
 
         for (int i = 0; i < 8; ++i)
         {
-            String paramName = "di" + String(i);
-            if (request->hasParam(paramName)) {
-                buffer_data[i] = request->getParam(paramName)->value().toInt() + '0';
-            } else {
-                buffer_data[i] = '0';
-            }
+            buffer_data[i] = args.Has(SK_DI0 + i) ? (args.Int(SK_DI0 + i) + '0') : '0';
         }
         cmd.string_len = 8;
         is_blocking = true;
+        break;
     }
 
     // --- Implementacija CMD_RT_DISP_MSG (txa) ---
-    else if (request->hasParam("txa") && request->hasParam("txt"))
+    case SysctrlCmd::RT_DISP_MSG:
     {
-        targetAddrStr = request->getParam("txa")->value();
+        target_addr = ResolveAddress(args.Value(SK_TXA));
         cmd.cmd_id = CMD_RT_DISP_MSG;
-        
+
         uint8_t i = 0; // Index unutar buffer_data (Payload)
-        
-        cmd.string_ptr[i++] = request->getParam("trc")->value().toInt() & 0xFFU;
 
-        uint16_t tx0 = request->getParam("tx0")->value().toInt();
-        uint16_t ty0 = request->getParam("ty0")->value().toInt();
+        cmd.string_ptr[i++] = args.Int(SK_TRC) & 0xFFU;
+
+        uint16_t tx0 = args.Int(SK_TX0);
+        uint16_t ty0 = args.Int(SK_TY0);
         cmd.string_ptr[i++] = (uint8_t)((tx0 >> 8) & 0xFFU);
         cmd.string_ptr[i++] = (uint8_t)(tx0 & 0xFFU);
         cmd.string_ptr[i++] = (uint8_t)((ty0 >> 8) & 0xFFU);
         cmd.string_ptr[i++] = (uint8_t)(ty0 & 0xFFU);
-        
-        uint16_t tx1 = request->getParam("tx1")->value().toInt();
-        uint16_t ty1 = request->getParam("ty1")->value().toInt();
+
+        uint16_t tx1 = args.Int(SK_TX1);
+        uint16_t ty1 = args.Int(SK_TY1);
         cmd.string_ptr[i++] = (uint8_t)((tx1 >> 8) & 0xFFU);
         cmd.string_ptr[i++] = (uint8_t)(tx1 & 0xFFU);
         cmd.string_ptr[i++] = (uint8_t)((ty1 >> 8) & 0xFFU);
         cmd.string_ptr[i++] = (uint8_t)(ty1 & 0xFFU);
-        
-        cmd.string_ptr[i++] = request->getParam("txc")->value().toInt() & 0xFFU; 
-        cmd.string_ptr[i++] = request->getParam("txf")->value().toInt() & 0xFFU; 
-        cmd.string_ptr[i++] = request->getParam("txh")->value().toInt() & 0xFFU; 
-        cmd.string_ptr[i++] = request->getParam("txv")->value().toInt() & 0xFFU; 
-        
-        String text = request->getParam("txt")->value(); 
+
+        cmd.string_ptr[i++] = args.Int(SK_TXC) & 0xFFU;
+        cmd.string_ptr[i++] = args.Int(SK_TXF) & 0xFFU;
+        cmd.string_ptr[i++] = args.Int(SK_TXH) & 0xFFU;
+        cmd.string_ptr[i++] = args.Int(SK_TXV) & 0xFFU;
+
+        const String& text = args.Value(SK_TXT);
         size_t text_len = text.length();
-        size_t max_text_len = MAX_PACKET_LENGTH - 10 - 1 - i; 
+        size_t max_text_len = MAX_PACKET_LENGTH - 10 - 1 - i;
         size_t final_text_len = min((size_t)text_len, max_text_len);
-        
-        memcpy(&cmd.string_ptr[i], text.c_str(), final_text_len); 
-        cmd.string_len = i + final_text_len; 
+
+        memcpy(&cmd.string_ptr[i], text.c_str(), final_text_len);
+        cmd.string_len = i + final_text_len;
         is_blocking = true;
+        break;
     }
 
     // --- Implementacija RT_SET_DISP_STA (tda) ---
-    else if (request->hasParam("tda") && request->hasParam("tdi")) 
+    case SysctrlCmd::RT_DISP_STA:
     {
-        targetAddrStr = request->getParam("tda")->value();
+        target_addr = ResolveAddress(args.Value(SK_TDA));
         cmd.cmd_id = RT_SET_DISP_STA;
 
-        buffer_data[0] = request->getParam("tdn")->value().toInt();
-        buffer_data[1] = request->getParam("tdi")->value().toInt();
-        buffer_data[2] = request->getParam("tdt")->value().toInt();
-        buffer_data[3] = request->getParam("tbm")->value().toInt();
-        buffer_data[4] = request->getParam("tbt")->value().toInt();
+        buffer_data[0] = args.Int(SK_TDN);
+        buffer_data[1] = args.Int(SK_TDI);
+        buffer_data[2] = args.Int(SK_TDT);
+        buffer_data[3] = args.Int(SK_TBM);
+        buffer_data[4] = args.Int(SK_TBT);
         cmd.string_len = 5;
         is_blocking = true;
+        break;
     }
 
     // --- Implementacija CMD_RT_UPD_QRC / RT_DISP_QRC (qra) ---
-    else if (request->hasParam("qra"))
+    case SysctrlCmd::RT_QRC:
     {
-        targetAddrStr = request->getParam("qra")->value();
-        
-        if (request->hasParam("qrc")) // Upload (CMD_RT_UPD_QRC)
+        target_addr = ResolveAddress(args.Value(SK_QRA));
+
+        if (args.Has(SK_QRC)) // Upload (CMD_RT_UPD_QRC)
         {
             cmd.cmd_id = CMD_RT_UPD_QRC;
-            String qrText = request->getParam("qrc")->value();
-            qrText.replace('+', '=');
-            qrText.replace('-', '&');
-            strncpy(buffer_data, qrText.c_str(), 255);
-            cmd.string_len = qrText.length();
+            strncpy(buffer_data, args.Value(SK_QRC).c_str(), 255);
+            cmd.string_len = strlen(buffer_data);
+            // '+' -> '=' i '-' -> '&' direktno u payload-u (bez kopije String-a)
+            for (uint16_t i = 0; i < cmd.string_len; i++)
+            {
+                if (buffer_data[i] == '+') buffer_data[i] = '=';
+                else if (buffer_data[i] == '-') buffer_data[i] = '&';
+            }
             is_blocking = true;
         }
-        else if (request->hasParam("qrd")) // Display (RT_DISP_QRC)
+        else if (args.Has(SK_QRD)) // Display (RT_DISP_QRC)
         {
             cmd.cmd_id = RT_DISP_QRC;
             is_blocking = true;
         }
+        break;
     }
+
     // --- Implementacija SET_ROOM_TEMP (tha) ---
-    else if (request->hasParam("tha")) 
+    case SysctrlCmd::ROOM_TEMP:
     {
-        targetAddrStr = request->getParam("tha")->value();
+        target_addr = ResolveAddress(args.Value(SK_THA));
         cmd.cmd_id = SET_ROOM_TEMP;
-        
+
         uint8_t config_byte = 0;
-        cmd.param1 = 0; // spt
-        cmd.param2 = 1; // dif (Default: 1)
+        cmd.param1 = args.Int(SK_SPT);                        // spt (Default: 0)
+        cmd.param2 = args.Has(SK_DIF) ? args.Int(SK_DIF) : 1; // dif (Default: 1)
+
+        const char* sta = args.Value(SK_STA).c_str();
+        if (strcasecmp(sta, "ON") == 0)           config_byte |= (1 << 0) | (1 << 4);
+        else if (strcasecmp(sta, "OFF") == 0)     config_byte |= (1 << 4);
+
+        const char* mod = args.Value(SK_MOD).c_str();
+        if (strcasecmp(mod, "HEAT") == 0)         config_byte |= (1 << 1) | (1 << 5);
+        else if (strcasecmp(mod, "COOL") == 0)    config_byte |= (1 << 5);
+
+        const char* ctr = args.Value(SK_CTR).c_str();
+        if (strcasecmp(ctr, "ENA") == 0)          config_byte |= (1 << 2) | (1 << 6);
+        else if (strcasecmp(ctr, "DIS") == 0)     config_byte |= (1 << 6);
+
+        const char* out = args.Value(SK_OUT).c_str();
+        if (strcasecmp(out, "ON") == 0)           config_byte |= (1 << 3) | (1 << 7);
+        else if (strcasecmp(out, "OFF") == 0)     config_byte |= (1 << 7);
 
-        for (int i = 1; i < request->params(); ++i) 
-        {
-            String pName = request->getParam(i)->name();
-            String pValue = request->getParam(i)->value();
-            
-            if (pName == "spt") 
-                cmd.param1 = pValue.toInt();
-            else if (pName == "dif") 
-                cmd.param2 = pValue.toInt(); 
-            else if (pName == "sta")
-            {
-                if (pValue.equalsIgnoreCase("ON"))      config_byte |= (1 << 0) | (1 << 4);
-                else if (pValue.equalsIgnoreCase("OFF")) config_byte |= (1 << 4);
-            }
-            else if (pName == "mod")
-            {
-                if (pValue.equalsIgnoreCase("HEAT"))    config_byte |= (1 << 1) | (1 << 5);
-                else if (pValue.equalsIgnoreCase("COOL")) config_byte |= (1 << 5);
-            }
-            else if (pName == "ctr")
-            {
-                if (pValue.equalsIgnoreCase("ENA"))     config_byte |= (1 << 2) | (1 << 6);
-                else if (pValue.equalsIgnoreCase("DIS")) config_byte |= (1 << 6);
-            }
-            else if (pName == "out")
-            {
-                if (pValue.equalsIgnoreCase("ON"))      config_byte |= (1 << 3) | (1 << 7);
-                else if (pValue.equalsIgnoreCase("OFF")) config_byte |= (1 << 7);
-            }
-        }
         cmd.param3 = config_byte;
         is_blocking = true;
+        break;
     }
-    
+
     // ========================================================================
     // --- NOVO: Implementacija preostalih CGI komandi ---
     // ========================================================================
 
     // --- RC set room status: stg, val ---
-    else if (request->hasParam("stg") && request->hasParam("val"))
+    case SysctrlCmd::APPL_STAT:
     {
-        targetAddrStr = request->getParam("stg")->value();
+        target_addr = ResolveAddress(args.Value(SK_STG));
         cmd.cmd_id = SET_APPL_STAT;
-        cmd.param1 = request->getParam("val")->value().toInt();
+        cmd.param1 = args.Int(SK_VAL);
         is_blocking = true;
+        break;
     }
     // --- RC set bedding period: sbr, per ---
-    else if (request->hasParam("sbr") && request->hasParam("per"))
+    case SysctrlCmd::BEDDING_REPL:
     {
-        targetAddrStr = request->getParam("sbr")->value();
+        target_addr = ResolveAddress(args.Value(SK_SBR));
         cmd.cmd_id = SET_BEDDING_REPL;
-        cmd.param1 = request->getParam("per")->value().toInt();
+        cmd.param1 = args.Int(SK_PER);
         is_blocking = true;
+        break;
     }
     // --- RC room status request: cst ---
-    else if (request->hasParam("cst"))
+    case SysctrlCmd::ROOM_STATUS:
     {
-        targetAddrStr = request->getParam("cst")->value();
+        target_addr = ResolveAddress(args.Value(SK_CST));
+
+        // NOVO: cst=<adr>&max_age=<ms> - dovoljno svjež status iz keša, bez upita na busu
+        RoomStatusSnapshot cached;
+        long max_age_ms = args.Int(SK_MAX_AGE);
+        if (max_age_ms > 0 && g_roomStatusCache.Get(target_addr, (uint32_t)max_age_ms, &cached))
+        {
+            SendSSIResponse(request, String(cached.payload, cached.length));
+            return;
+        }
+
         // HILLS protokol koristi 0x95, ostali protokoli 0xA1
         if (static_cast<ProtocolVersion>(g_appConfig.protocol_version) == ProtocolVersion::HILLS)
             cmd.cmd_id = RUBICON_GET_ROOM_STATUS;  // 0x95
         else
             cmd.cmd_id = GET_APPL_STAT;  // 0xA1
         is_blocking = true;
+        break;
     }
     // --- RC preview display image: ipr ---
-    else if (request->hasParam("ipr"))
+    case SysctrlCmd::PREVIEW_IMG:
     {
-        targetAddrStr = request->getParam("ipr")->value();
+        target_addr = ResolveAddress(args.Value(SK_IPR));
         cmd.cmd_id = PREVIEW_DISPL_IMG;
         is_blocking = true;
+        break;
     }
     // --- RC set digital output: cdo ---
-    else if (request->hasParam("cdo") && request->hasParam("ctrl"))
+    case SysctrlCmd::DOUT_STATE:
     {
-        targetAddrStr = request->getParam("cdo")->value();
+        target_addr = ResolveAddress(args.Value(SK_CDO));
         cmd.cmd_id = CMD_SET_DOUT_STATE;
-        
+
         // Payload je 9 bajtova (do0-do7 + ctrl) -
-        buffer_data[0] = request->hasParam("do0") ? (request->getParam("do0")->value().toInt() + '0') : '0';
-        buffer_data[1] = request->hasParam("do1") ? (request->getParam("do1")->value().toInt() + '0') : '0';
-        buffer_data[2] = request->hasParam("do2") ? (request->getParam("do2")->value().toInt() + '0') : '0';
-        buffer_data[3] = request->hasParam("do3") ? (request->getParam("do3")->value().toInt() + '0') : '0';
-        buffer_data[4] = request->hasParam("do4") ? (request->getParam("do4")->value().toInt() + '0') : '0';
-        buffer_data[5] = request->hasParam("do5") ? (request->getParam("do5")->value().toInt() + '0') : '0';
-        buffer_data[6] = request->hasParam("do6") ? (request->getParam("do6")->value().toInt() + '0') : '0';
-        buffer_data[7] = request->hasParam("do7") ? (request->getParam("do7")->value().toInt() + '0') : '0';
-        buffer_data[8] = request->getParam("ctrl")->value().toInt() + '0';
-        
+        for (int i = 0; i < 8; ++i)
+        {
+            buffer_data[i] = args.Has(SK_DO0 + i) ? (args.Int(SK_DO0 + i) + '0') : '0';
+        }
+        buffer_data[8] = args.Int(SK_CTRL) + '0';
+
         cmd.string_len = 9;
         is_blocking = true;
+        break;
     }
     // --- RC set display brightness: cbr, br ---
-    else if (request->hasParam("cbr") && request->hasParam("br")) 
+    case SysctrlCmd::DISPL_BCKLGHT:
     {
-        targetAddrStr = request->getParam("cbr")->value();
+        target_addr = ResolveAddress(args.Value(SK_CBR));
         cmd.cmd_id = SET_DISPL_BCKLGHT;
-        cmd.param1 = request->getParam("br")->value().toInt();
+        cmd.param1 = args.Int(SK_BR);
         is_blocking = true;
+        break;
     }
     // --- RC SOS alarm reset request: rud ---
-    else if (request->hasParam("rud"))
+    case SysctrlCmd::SOS_RESET:
     {
-        targetAddrStr = request->getParam("rud")->value();
+        target_addr = ResolveAddress(args.Value(SK_RUD));
         cmd.cmd_id = RESET_SOS_ALARM;
         is_blocking = true;
+        break;
     }
     // --- RC set rs485 address: rsc, rsa, rga, rba, rib ---
-    else if (request->hasParam("rsc") && request->hasParam("rsa") && request->hasParam("rga") && request->hasParam("rba") && request->hasParam("rib"))
+    case SysctrlCmd::RS485_CFG:
     {
-        targetAddrStr = request->getParam("rsc")->value();
-        
-        uint16_t rsa = request->getParam("rsa")->value().toInt();
-        uint16_t rga = request->getParam("rga")->value().toInt();
-        uint16_t rba = request->getParam("rba")->value().toInt();
-        uint8_t rib = request->getParam("rib")->value().toInt();
+        target_addr = ResolveAddress(args.Value(SK_RSC));
+
+        uint16_t rsa = args.Int(SK_RSA);
+        uint16_t rga = args.Int(SK_RGA);
+        uint16_t rba = args.Int(SK_RBA);
+        uint8_t rib = args.Int(SK_RIB);
 
         // 1. Lokalna promjena (ako je HC adresa)
-        if (ParseMacros(targetAddrStr).toInt() == g_appConfig.rs485_iface_addr)
+        if (target_addr == g_appConfig.rs485_iface_addr)
         {
             Serial.println(F("[HttpServer] Primljena lokalna RS485 konfiguracija..."));
             g_appConfig.rs485_iface_addr = rsa;
             g_appConfig.rs485_group_addr = rga;
             g_appConfig.rs485_bcast_addr = rba;
-            
-            if (m_eeprom_storage->WriteConfig(&g_appConfig)) 
+
+            if (m_eeprom_storage->WriteConfig(&g_appConfig))
             {
                 SendSSIResponse(request, HTTP_RESPONSE_OK);
+            }
+            else
+            {
                 SendSSIResponse(request, HTTP_RESPONSE_ERROR);
             }
-            return; 
+            return;
         }
-        
+
         // 2. Slanje komande na daljinu
         cmd.cmd_id = SET_RS485_CFG;
-        
+
         buffer_data[0] = (uint8_t)((rsa >> 8) & 0xFFU);
         buffer_data[1] = (uint8_t)(rsa & 0xFFU);
         buffer_data[2] = (uint8_t)((rga >> 8) & 0xFFU);
@@ -1412,39 +1787,41 @@ void HttpServer::HandleSysctrlRequest(AsyncWebServerRequest *request)
         buffer_data[4] = (uint8_t)((rba >> 8) & 0xFFU);
         buffer_data[5] = (uint8_t)(rba & 0xFFU);
         buffer_data[6] = (uint8_t)(rib + '0'); // Baudrate se u starom kodu slao kao char
-        
+
         cmd.string_len = 7;
         is_blocking = true;
+        break;
     }
     // --- HC set system ID: sid, nid ---
-    else if (request->hasParam("sid") && request->hasParam("nid"))
-    {     
-        targetAddrStr = request->getParam("sid")->value();
-        uint16_t new_id = request->getParam("nid")->value().toInt();
-        
+    case SysctrlCmd::SYSTEM_ID:
+    {
+        target_addr = ResolveAddress(args.Value(SK_SID));
+        uint16_t new_id = args.Int(SK_NID);
+
         // 1. Lokalna promjena (HC) -
-        if (ParseMacros(targetAddrStr).toInt() == g_appConfig.rs485_iface_addr)
+        if (target_addr == g_appConfig.rs485_iface_addr)
         {
             Serial.println(F("[HttpServer] Primljen lokalni System ID..."));
             g_appConfig.system_id = new_id;
             if (!m_eeprom_storage->WriteConfig(&g_appConfig)) {
                 SendSSIResponse(request, HTTP_RESPONSE_ERROR);
                 return;
-            }            
-            targetAddrStr = "RSbra"; 
+            }
+            target_addr = g_appConfig.rs485_bcast_addr; // RSbra
         }
-        
+
         // 2. Slanje komande (P2P ili Broadcast)
         cmd.cmd_id = SET_SYSTEM_ID;
         cmd.param1 = new_id;
         is_blocking = true;
+        break;
     }
-    
+
     // --- HC RC RT reset controller: rst ---
-    else if (request->hasParam("rst"))
+    case SysctrlCmd::RESTART:
     {
-        targetAddrStr = request->getParam("rst")->value();
-        if (targetAddrStr == "0" || ParseMacros(targetAddrStr).toInt() == g_appConfig.rs485_iface_addr)
+        target_addr = ResolveAddress(args.Value(SK_RST));
+        if (args.Value(SK_RST) == "0" || target_addr == g_appConfig.rs485_iface_addr)
         {
             SendSSIResponse(request, "OK (Restarting HC...)");
             delay(100);
@@ -1453,51 +1830,35 @@ void HttpServer::HandleSysctrlRequest(AsyncWebServerRequest *request)
         }
         cmd.cmd_id = RESTART_CTRL;
         is_blocking = true;
+        break;
     }
     // --- update hotel status: HSset ---
-    else if (request->hasParam("HSset"))
+    case SysctrlCmd::HOTEL_STATUS:
     {
-        targetAddrStr = "RSbra";
+        target_addr = g_appConfig.rs485_bcast_addr; // RSbra
         cmd.cmd_id = DWNLD_JRNL;
-        cmd.string_len = request->getParam("HSset")->value().length();
-        strncpy((char *)cmd.string_ptr, request->getParam("HSset")->value().c_str(), 255);
+        cmd.string_len = args.Value(SK_HSSET).length();
+        strncpy((char *)cmd.string_ptr, args.Value(SK_HSSET).c_str(), 255);
         is_blocking = true;
+        break;
+    }
     }
 
 
     // ========================================================================
-    // --- IZVRŠENJE BLOKIRAJUĆEG UPITA ---
+    // --- IZVRŠENJE RS485 UPITA (asinhrono) ---
     // ========================================================================
     if (is_blocking)
     {
-        cmd.address = ParseMacros(targetAddrStr).toInt();
+        cmd.address = target_addr;
         cmd.owa_addr = 0;
-        if (request->hasParam("owa"))
+        if (args.Has(SK_OWA))
         {
-            cmd.owa_addr = ParseMacros(request->getParam("owa")->value()).toInt();
+            cmd.owa_addr = ResolveAddress(args.Value(SK_OWA));
         }
 
-        uint8_t response_buffer[MAX_PACKET_LENGTH];
-        memset(response_buffer, 0, MAX_PACKET_LENGTH);
-
-        int payload_len = m_http_query_manager->ExecuteBlockingQuery(&cmd, response_buffer);
-        if (payload_len > 0)
-        {
-            // Upit je uspio, proslijedi stvarni odgovor
-            // VAŽNO: Payload može sadržati null bajtove, pa koristimo eksplicitnu dužinu
-            String response_str((char*)response_buffer, payload_len);
-            SendSSIResponse(request, response_str);
-        }
-        else if (payload_len == 0)
-        {
-            // Prazan odgovor - možda je validno za neke komande
-            SendSSIResponse(request, HTTP_RESPONSE_OK);
-        }
-        else
-        {
-            // Timeout ili greška (payload_len == -1)
-            SendSSIResponse(request, HTTP_RESPONSE_TIMEOUT);
-        }
+        // NOVO: Ne čeka se bus na AsyncTCP zadatku - odgovor se šalje kada upit završi
+        SendQueryResponse(request, &cmd);
     }
     else
     {
@@ -8,34 +8,48 @@
 
 #include "DebugConfig.h" 
 #include "LogPullManager.h"
+#include "Rs485Trace.h"
+#include "RttEstimator.h"
+#include "DeviceDirectory.h"
+#include "LogWriter.h"
+#include "RoomStatusCache.h"
+#include "HttpQueryManager.h" // GET_APPL_STAT, ExtractPayload()
 #include "ProjectConfig.h"
 #include <cstring> 
 
 // Globalna konfiguracija (extern)
 extern AppConfig g_appConfig; 
+extern LogWriter g_logWriter;
 
 LogPullManager::LogPullManager() :
-    m_rs485_service(NULL),
+    m_bus_owner(NULL),
     m_eeprom_storage(NULL),
     m_state(PullState::IDLE),
-    m_current_address_index(0),
-    m_current_pull_address(0),
+    m_visit_active(false),
     m_address_list_count(0),
     m_address_list_count_L(0),
     m_address_list_count_R(0),
-    m_address_index_L(0),
-    m_address_index_R(0),
     m_current_bus(0),
-    m_retry_count(0),
-    m_hills_query_attempts(0),
-    m_last_activity_time(0)
+    m_bus_filter(-1),
+    m_draining(false),
+    m_room_status_read(false),
+    m_room_status_generation(0),
+    m_last_activity_time(0),
+    m_writes_in_use(0)
 {
     // Konstruktor
+    memset(&m_visit, 0, sizeof(m_visit));
+    m_visit.bus = RS485_BUS_CURRENT;
+    m_visit.index = POLL_NO_DEVICE;
+    m_visit.budget_ms = LOGPULL_VISIT_BUDGET_MS;
+    memset(&m_txn, 0, sizeof(m_txn));
+    m_txn.status = BusTxnStatus::DONE;
+    memset(m_writes, 0, sizeof(m_writes));
 }
 
-void LogPullManager::Initialize(Rs485Service* pRs485Service, EepromStorage* pEepromStorage)
+void LogPullManager::Initialize(Rs485BusOwner* pBusOwner, EepromStorage* pEepromStorage)
 {
-    m_rs485_service = pRs485Service;
+    m_bus_owner = pBusOwner;
     m_eeprom_storage = pEepromStorage;
 
     if (g_appConfig.enable_dual_bus_mode)
@@ -90,33 +104,62 @@ void LogPullManager::Initialize(Rs485Service* pRs485Service, EepromStorage* pEep
         m_address_list_count_L = 0;
         m_address_list_count_R = 0;
     }
+
+    ResetScheduler();
+}
+
+void LogPullManager::BuildDeviceTables() const
+{
+    // NOVO: Direktorij adresa -> bus/protokol (u single bus modu ostaje prazan,
+    // pa sve adrese dobijaju protokol Lijevog busa kao i ranije)
+    g_deviceDirectory.Build(m_address_list_L, m_address_list_count_L,
+                            m_address_list_R, m_address_list_count_R);
+
+    // NOVO: Keš statusa soba nad istim listama koje polling obilazi
+    if (g_appConfig.enable_dual_bus_mode) {
+        g_roomStatusCache.Build(m_address_list_L, m_address_list_count_L, m_address_list_R, m_address_list_count_R);
+    } else {
+        g_roomStatusCache.Build(m_address_list, m_address_list_count, NULL, 0);
+    }
+}
+
+/**
+ * @brief Ograničava anketiranje na jedan bus i ponovo postavlja raspored.
+ */
+void LogPullManager::SetBusFilter(int8_t bus)
+{
+    m_bus_filter = bus;
+    ResetScheduler();
+}
+
+/**
+ * @brief Postavlja raspored nad listama koje ova instanca obilazi.
+ * @details Redoslijed ostaje kao ranije: dual mode - SVE sa L, pa SVE sa R
+ *          (ili samo lista filtriranog busa); single mode - legacy lista.
+ */
+void LogPullManager::ResetScheduler()
+{
+    if (!g_appConfig.enable_dual_bus_mode) {
+        m_scheduler.Reset(m_address_list, m_address_list_count, NULL, 0);
+    } else if (m_bus_filter == 0) {
+        m_scheduler.Reset(m_address_list_L, m_address_list_count_L, NULL, 0);
+    } else if (m_bus_filter == 1) {
+        m_scheduler.Reset(m_address_list_R, m_address_list_count_R, NULL, 0);
+    } else {
+        m_scheduler.Reset(m_address_list_L, m_address_list_count_L, m_address_list_R, m_address_list_count_R);
+    }
+    m_visit.index = POLL_NO_DEVICE;
 }
 
 /**
  * @brief Provjerava da li je HILLS protokol aktivan za trenutnu adresu.
+ * @details Protokol se razrješava jednom po adresi (m_visit.device, u IDLE stanju),
+ *          a ne pri svakom pozivu Get*Command()/GetResponseTimeout().
  */
 bool LogPullManager::IsHillsProtocol()
 {
     // KRITIČNO: NE koristiti m_current_bus jer se mijenja prerano u GetNextAddress()!
-    // Umjesto toga, odredi protokol na osnovu ADRESE koja se trenutno polluje
-    uint8_t current_protocol;
-    
-    if (g_appConfig.enable_dual_bus_mode) {
-        int8_t bus_id = GetBusForAddress(m_current_pull_address);
-        if (bus_id == 0) {
-            current_protocol = g_appConfig.protocol_version_L;
-        } else if (bus_id == 1) {
-            current_protocol = g_appConfig.protocol_version_R;
-        } else {
-            // Fallback ako adresa nije u listama (ne bi se smjelo desiti)
-            current_protocol = g_appConfig.protocol_version_L;
-        }
-    } else {
-        // Single bus mode
-        current_protocol = g_appConfig.protocol_version_L;
-    }
-    
-    return (static_cast<ProtocolVersion>(current_protocol) == ProtocolVersion::HILLS);
+    return (m_visit.device.flags & DEVICE_FLAG_HILLS) != 0;
 }
 
 /**
@@ -143,6 +186,14 @@ uint8_t LogPullManager::GetDeleteCommand()
     return IsHillsProtocol() ? HILLS_DELETE_LOG_LIST : DEL_LOG_LIST;
 }
 
+/**
+ * @brief Vraća protokol-specifičnu komandu za status sobe (isto kao cst).
+ */
+uint8_t LogPullManager::GetRoomStatusCommand()
+{
+    return IsHillsProtocol() ? RUBICON_GET_ROOM_STATUS : GET_APPL_STAT;
+}
+
 /**
  * @brief Vraća protokol-specifičan response timeout.
  */
@@ -159,6 +210,47 @@ uint32_t LogPullManager::GetRxTxDelay()
     return IsHillsProtocol() ? HILLS_RX_TO_TX_DELAY_MS : RX2TX_DEL_MS;
 }
 
+/**
+ * @brief Da li je tekuća posjeta potrošila LOGPULL_VISIT_BUDGET_MS.
+ * @details Preostali logovi se preuzimaju u sljedećoj posjeti (uređaj ostaje
+ *          u vrućem redu rasporeda), da jedan uređaj ne zadrži cijeli obilazak.
+ */
+bool LogPullManager::IsVisitBudgetExceeded()
+{
+    return (millis() - m_visit.start_ms) >= m_visit.budget_ms;
+}
+
+/**
+ * @brief Prekida posjetu zbog budžeta; uređaj ostaje označen sa logovima na čekanju.
+ */
+void LogPullManager::EndVisitOnBudget()
+{
+    LOG_DEBUG(4, "[LogPull] Budžet posjete (%lu ms) potrošen za 0x%X, preuzeto %u logova\n",
+              (unsigned long)m_visit.budget_ms, m_visit.address, m_visit.logs);
+    m_scheduler.OnLogsPending(m_visit.index, true);
+    m_visit.budget_hit = true;
+    m_draining = false;
+    m_visit.hills_query_attempts = 0;
+    m_state = PullState::IDLE;
+    m_last_activity_time = millis();
+}
+
+/**
+ * @brief Prijavljuje završenu posjetu rasporedu (stopa pražnjenja, budžet sljedeće).
+ * @details Kraj posjete je zadnji prelaz u IDLE (m_last_activity_time).
+ */
+void LogPullManager::FinishVisit()
+{
+    if (!m_visit_active) return;
+    m_visit_active = false;
+
+    m_scheduler.OnVisitEnd(m_visit.index, m_visit.logs, m_last_activity_time - m_visit.start_ms, m_visit.budget_hit);
+    if (m_visit.logs > 0) {
+        LOG_DEBUG(4, "[LogPull] 0x%X: %u logova za %lu ms\n", m_visit.address, m_visit.logs,
+                  (unsigned long)(m_last_activity_time - m_visit.start_ms));
+    }
+}
+
 /**
  * @brief Glavna funkcija koju poziva state-mašina. Obavlja jedan puni ciklus pollinga.
  */
@@ -173,6 +265,9 @@ void LogPullManager::Run()
     }
     // ========================================================================
     
+    // NOVO: Logovi predati LogWriter-u - rezultat upisa i DELETE-a (neblokirajuće)
+    ServiceWrites();
+
     // ========================================================================
     // --- IMPLEMENTACIJA OBAVEZNE RX->TX PAUZE (protokol-specifična) ---
     // ========================================================================
@@ -183,46 +278,61 @@ void LogPullManager::Run()
     }
     // ========================================================================
 
-    // KORAK 2: Ako čekamo odgovor, provjeri da li je stigao.
-    if (m_state == PullState::WAITING_FOR_RESPONSE || m_state == PullState::WAITING_FOR_DELETE_CONFIRMATION)
+    // KORAK 2: Ako čekamo odgovor, provjeri da li je transakcija završena (NEBLOKIRAJUĆE).
+    // Vlasnik magistrale izvršava slanje/prijem u svom zadatku; Run() samo
+    // provjerava status i odmah se vraća dok je transakcija u redu ili na liniji.
+    if (m_state == PullState::WAITING_FOR_RESPONSE)
     {
-        uint8_t response_buffer[MAX_PACKET_LENGTH];
-        uint32_t timeout = GetResponseTimeout();
-        int response_len = m_rs485_service->ReceivePacket(response_buffer, MAX_PACKET_LENGTH, timeout);
+        if (m_txn.status == BusTxnStatus::PENDING) {
+            return; // Još čekamo - ne blokiraj loop()
+        }
 
-        if (response_len > 0) {
-            // Imamo odgovor, obradi ga i promijeni stanje.
-            ProcessResponse(response_buffer, response_len);
-        } else {
-            // Timeout
-            if (IsHillsProtocol() && m_state == PullState::WAITING_FOR_DELETE_CONFIRMATION)
-            {
-                // HILLS: Timeout na DELETE confirmation
-                m_hills_query_attempts++;
-                LOG_DEBUG(3, "[LogPull-HILLS] Timeout na DELETE (attempt %d/%d)\n", 
-                    m_hills_query_attempts, HILLS_MAX_QUERY_ATTEMPTS);
-                
-                if (m_hills_query_attempts >= HILLS_MAX_QUERY_ATTEMPTS)
-                {
-                    LOG_DEBUG(3, "[LogPull-HILLS] Max attempts dostignut za 0x%X\n", m_current_pull_address);
-                    m_state = PullState::IDLE;
-                    m_hills_query_attempts = 0;
-                }
-                else
-                {
-                    // Pokušaj ponovo GET_LOG_LIST
-                    m_state = PullState::SENDING_LOG_REQUEST;
-                }
-            }
-            else
-            {
-                // Timeout - idi na sljedeću adresu
-                LOG_DEBUG(4, "[LogPull] Timeout za 0x%X.\n", m_current_pull_address);
-                m_state = PullState::IDLE;
-                m_hills_query_attempts = 0;
+        if (m_txn.status == BusTxnStatus::DONE && m_txn.rx_length > 0) {
+            // NOVO: RTT uzorak samo iz prvog pokušaja (Karn) - odgovor na ponovljeni
+            // upit može biti zakašnjeli odgovor na raniji. Duži odgovor statusa sobe
+            // ne ulazi u procjenu (timeout mu je fiksni timeout protokola).
+            if (m_visit.retry_count == 0 && !m_room_status_read) {
+                g_rttTable.AddSample(m_visit.address, m_txn.rtt_us);
             }
+            g_roomStatusCache.OnResponse(m_visit.address, m_visit.bus);
+            m_visit.retry_count = 0;
+            m_scheduler.OnResponse(m_visit.index, millis());
+
+            // Imamo odgovor, obradi ga i promijeni stanje.
+            ProcessResponse(m_rx_buffer, m_txn.rx_length);
+            return;
+        }
+
+        // Status sobe za keš nije dio log ciklusa - bez odgovora samo nastavi obilazak
+        if (m_room_status_read)
+        {
+            LOG_DEBUG(4, "[LogPull] Bez odgovora na status sobe od 0x%X.\n", m_visit.address);
+            m_room_status_read = false;
+            m_state = PullState::IDLE;
             m_last_activity_time = millis();
+            return;
         }
+
+        // Drain: uređaj ne mora odgovoriti na GET_LOG kada nema logova -
+        // nije greška uređaja, provjeri stanje statusnim upitom.
+        if (m_draining && m_state == PullState::WAITING_FOR_RESPONSE)
+        {
+            LOG_DEBUG(4, "[LogPull] Drain: bez odgovora na GET_LOG od 0x%X, STATUS upit.\n", m_visit.address);
+            m_draining = false;
+            m_state = PullState::SENDING_STATUS_REQUEST;
+            m_last_activity_time = millis();
+            return;
+        }
+
+        // Timeout - idi na sljedeću adresu
+        if (m_txn.status == BusTxnStatus::TIMEOUT) {
+            g_rttTable.AddTimeout(m_visit.address);
+            g_roomStatusCache.OnTimeout(m_visit.address);
+            m_scheduler.OnTimeout(m_visit.index, millis());
+        }
+        LOG_DEBUG(4, "[LogPull] Timeout za 0x%X.\n", m_visit.address);
+        m_state = PullState::IDLE;
+        m_last_activity_time = millis();
         return;
     }
     
@@ -232,54 +342,98 @@ void LogPullManager::Run()
         // Dual bus mode check
         if (g_appConfig.enable_dual_bus_mode)
         {
+            if (m_bus_filter == 0 && m_address_list_count_L == 0) return;
+            if (m_bus_filter == 1 && m_address_list_count_R == 0) return;
             if (m_address_list_count_L == 0 && m_address_list_count_R == 0) {
-                vTaskDelay(pdMS_TO_TICKS(100)); // Nema adresa, pauziraj.
-                return;
+                return; // Nema adresa, nema šta raditi.
             }
         }
         else
         {
             if (m_address_list_count == 0) {
-                vTaskDelay(pdMS_TO_TICKS(100)); // Nema adresa, pauziraj.
-                return;
+                return; // Nema adresa, nema šta raditi.
             }
         }
         
-        // Uzmi novu adresu
-        m_current_pull_address = GetNextAddress();
+        // Prethodna posjeta je završena
+        FinishVisit();
+
+        // NOVO: Posjeta čiji je log upisan (i DELETE poslan) nastavlja prije novog uređaja
+        for (uint8_t i = 0; i < LOGPULL_MAX_PENDING_WRITES; i++)
+        {
+            if (m_writes[i].in_use && m_writes[i].done)
+            {
+                ResumeVisit(&m_writes[i]);
+                break;
+            }
+        }
+
+        // Nastavljena posjeta je odmah završena (budžet, greška) - prijavljuje je sljedeći poziv
+        if (m_visit_active && m_state == PullState::IDLE) {
+            return;
+        }
+    }
+
+    if (m_state == PullState::IDLE)
+    {
+        // Uzmi novu adresu (nijedna nije na redu ako su sve u backoff-u ili čekaju upis)
+        if (!SelectNextAddress())
+        {
+            m_last_activity_time = millis();
+            return;
+        }
         
-        // Postavi aktivan bus
+        // Odredi bus i protokol za ovu adresu - jednom po transakciji
+        // (vlasnik magistrale selektuje bus prije slanja)
+        bool known = g_deviceDirectory.Lookup(m_visit.address, &m_visit.device);
         if (g_appConfig.enable_dual_bus_mode)
         {
-            int8_t bus_id = GetBusForAddress(m_current_pull_address);
-            if (bus_id >= 0) {
-                m_rs485_service->SelectBus(bus_id);
-                LOG_DEBUG(4, "[LogPull] Dual mode: Adresa 0x%04X -> Bus %d\n", m_current_pull_address, bus_id);
+            m_visit.bus = known ? m_visit.device.bus : RS485_BUS_CURRENT;
+            if (known) {
+                LOG_DEBUG(4, "[LogPull] Dual mode: Adresa 0x%04X -> Bus %d\n", m_visit.address, m_visit.device.bus);
             }
         }
         else
         {
             // SINGLE MODE: Koristi m_current_bus (toggle između 0 i 1)
-            m_rs485_service->SelectBus(m_current_bus);
-            LOG_DEBUG(4, "[LogPull] Single mode: Adresa 0x%04X -> Bus %d\n", m_current_pull_address, m_current_bus);
+            m_visit.bus = m_current_bus;
+            LOG_DEBUG(4, "[LogPull] Single mode: Adresa 0x%04X -> Bus %d\n", m_visit.address, m_current_bus);
         }
         
-        m_retry_count = 0;
-        m_hills_query_attempts = 0; // Reset counter za novu adresu
+        m_visit.retry_count = 0;
+        m_visit.hills_query_attempts = 0; // Reset counter za novu adresu
+        m_draining = false;
+        m_visit.start_ms = millis();
+        m_visit.budget_ms = m_scheduler.GetVisitBudgetMs(m_visit.index);
+        m_visit.logs = 0;
+        m_visit.budget_hit = false;
+        m_visit_active = true;
         m_state = PullState::SENDING_STATUS_REQUEST; // Pripremi se za slanje statusnog upita.
     }
 
     // KORAK 4: Izvrši akciju slanja (ako je stanje postavljeno u prethodnom koraku).
     // Ove funkcije samo pošalju paket i odmah se završe.
-    // NAPOMENA: Pauza između paketa (CONST_PAUSE) je implementirana u Rs485Service::SendPacket()
+    // NAPOMENA: Minimalnu pauzu između okvira provodi Rs485BusOwner
     
     switch (m_state)
     {
         case PullState::SENDING_STATUS_REQUEST:
-            SendStatusRequest(m_current_pull_address);
+            SendStatusRequest(m_visit.address);
             break;
         case PullState::SENDING_LOG_REQUEST:
-            SendLogRequest(m_current_pull_address);
+            if (m_writes_in_use >= LOGPULL_MAX_PENDING_WRITES)
+            {
+                // Svi zahtjevi upisa su zauzeti - log ostaje na uređaju za sljedeću posjetu
+                m_scheduler.OnLogsPending(m_visit.index, true);
+                m_draining = false;
+                m_state = PullState::IDLE;
+                m_last_activity_time = millis();
+                break;
+            }
+            SendLogRequest(m_visit.address);
+            break;
+        case PullState::SENDING_ROOM_STATUS_REQUEST:
+            SendRoomStatusRequest(m_visit.address);
             break;
         default:
             break;
@@ -287,157 +441,391 @@ void LogPullManager::Run()
 }
 
 /**
- * @brief Vraća sljedeću adresu za polling (Replicira HC_GetNextAddr).
- * Implementira sekvencijalnu logiku: prvo SVE adrese sa L liste, pa SVE sa R liste.
+ * @brief Bira sljedeću adresu za polling (m_visit.address, m_visit.index).
+ * @details Redovni obilazak kao u HC_GetNextAddr, uz PollScheduler: uređaji u
+ *          backoff-u se preskaču, a uređaji sa nedavnim događajima se posjećuju češće.
+ * @return false ako trenutno nijedan uređaj nije na redu.
  */
-uint16_t LogPullManager::GetNextAddress()
+bool LogPullManager::SelectNextAddress()
 {
-    if (g_appConfig.enable_dual_bus_mode)
-    {
-        // SEKVENCIJALNA LOGIKA: Prvo SVE adrese sa Lijeve, pa SVE sa Desne
-        if (m_current_bus == 0) // Lijevi bus je TRENUTNO aktivan
-        {
-            if (m_address_list_count_L == 0)
-            {
-                // Lijeva lista prazna, prebaci na Desnu
-                m_current_bus = 1;
-                m_address_index_R = 0; // Resetuj index za Desnu listu
-                if (m_address_list_count_R == 0) return 0;
-                // Uzmi prvu adresu sa Desne liste
-                uint16_t address = m_address_list_R[m_address_index_R];
-                m_address_index_R++;
-                return address;
-            }
-            
-            // Uzmi adresu sa Lijeve liste koristeći njen index
-            uint16_t current_address = m_address_list_L[m_address_index_L];
-            m_address_index_L++;
-            
-            // PROVJERA: Da li smo završili Lijevu listu?
-            if (m_address_index_L >= m_address_list_count_L)
-            {
-                // Završili smo Lijevu listu - prebaci na Desnu
-                m_address_index_L = 0; // Resetuj index za sledeći ciklus
-                m_current_bus = 1;     // Prebaci na Desni bus
-                m_address_index_R = 0; // Resetuj index Desne liste
-            }
-            
-            return current_address;
-        }
-        else // Desni bus je TRENUTNO aktivan (m_current_bus == 1)
-        {
-            if (m_address_list_count_R == 0)
-            {
-                // Desna lista prazna, prebaci na Lijevu
-                m_current_bus = 0;
-                m_address_index_L = 0; // Resetuj index za Lijevu listu
-                if (m_address_list_count_L == 0) return 0;
-                // Uzmi prvu adresu sa Lijeve liste
-                uint16_t address = m_address_list_L[m_address_index_L];
-                m_address_index_L++;
-                return address;
-            }
-            
-            // Uzmi adresu sa Desne liste koristeći njen index
-            uint16_t current_address = m_address_list_R[m_address_index_R];
-            m_address_index_R++;
-            
-            // PROVJERA: Da li smo završili Desnu listu?
-            if (m_address_index_R >= m_address_list_count_R)
-            {
-                // Završili smo Desnu listu - prebaci na Lijevu
-                m_address_index_R = 0; // Resetuj index za sledeći ciklus
-                m_current_bus = 0;     // Prebaci na Lijevi bus
-                m_address_index_L = 0; // Resetuj index Lijeve liste
-            }
-            
-            return current_address;
-        }
-    }
-    else
+    bool wrapped = false;
+    int16_t index = m_scheduler.Next(millis(), &wrapped);
+
+    if (wrapped)
     {
-        // Single mode: prvo SVE adrese na Bus 0, zatim SVE na Bus 1
-        if (m_address_list_count == 0) return 0;
-        
-        uint16_t current_address = m_address_list[m_current_address_index];
-        m_current_address_index++;
-        
-        // Kada završimo cijelu listu, prebaci na drugi bus
-        if (m_current_address_index >= m_address_list_count)
+        LOG_DEBUG(4, "[LogPull] Obilazak završen (sweeps=%lu, hot=%lu, backoff_skip=%lu)\n",
+                  (unsigned long)m_scheduler.GetSweeps(), (unsigned long)m_scheduler.GetHotVisits(),
+                  (unsigned long)m_scheduler.GetBackoffSkips());
+
+        if (!g_appConfig.enable_dual_bus_mode)
         {
-            m_current_address_index = 0;
+            // Single mode: prvo SVE adrese na Bus 0, zatim SVE na Bus 1
             m_current_bus = (m_current_bus == 0) ? 1 : 0; // Toggle Bus 0 <-> Bus 1
             LOG_DEBUG(4, "[LogPull] Single mode: Završena lista, prebacujem na Bus %d\n", m_current_bus);
         }
-        
-        return current_address;
     }
+
+    if (index == POLL_NO_DEVICE) {
+        return false;
+    }
+
+    if (g_appConfig.enable_dual_bus_mode) {
+        m_current_bus = (m_bus_filter >= 0) ? (uint8_t)m_bus_filter
+                                            : (m_scheduler.IsInSecondList(index) ? 1 : 0);
+    }
+
+    m_visit.index = index;
+    m_visit.address = m_scheduler.GetAddress(index);
+    return true;
 }
 
 /**
- * @brief Kreira i salje GET_SYS_STAT paket (Polling).
+ * @brief Predaje m_tx_packet vlasniku magistrale i prelazi u stanje čekanja.
  */
-void LogPullManager::SendStatusRequest(uint16_t address)
+void LogPullManager::StartResponseWait()
 {
-    uint8_t cmd = GetStatusCommand();
-    LOG_DEBUG(4, "[LogPull] -> Šaljem STATUS(0x%02X) na 0x%X\n", cmd, address);
-    
-    uint8_t packet[10]; 
-    uint16_t rsifa = g_appConfig.rs485_iface_addr;
-    uint8_t data_len = 1;
+    PrepareResponseWait();
 
-    packet[0] = SOH;
-    packet[1] = (address >> 8);
-    packet[2] = (address & 0xFF);
-    packet[3] = (rsifa >> 8);
-    packet[4] = (rsifa & 0xFF);
-    packet[5] = data_len; 
-    packet[6] = cmd;
-    
-    uint16_t checksum = cmd;
-    packet[7] = (checksum >> 8);
-    packet[8] = (checksum & 0xFF);
-    packet[9] = EOT;
-    
-    if (m_rs485_service->SendPacket(packet, 10))
+    if (!m_bus_owner->Submit(&m_txn))
     {
-        m_state = PullState::WAITING_FOR_RESPONSE;
+        // Red je pun (HTTP/Update zauzimaju magistralu) - pokušaj kasnije
+        m_last_activity_time = millis();
+        return;
     }
+
+    m_state = PullState::WAITING_FOR_RESPONSE;
 }
 
 /**
- * @brief Kreira i salje DEL_LOG_LIST paket.
+ * @brief Popunjava m_txn za m_tx_packet (bez predaje vlasniku magistrale).
  */
-void LogPullManager::SendDeleteLogRequest(uint16_t address)
+void LogPullManager::PrepareResponseWait()
+{
+    m_txn.priority = BusPriority::POLLING;
+    m_txn.bus_id = m_visit.bus;
+    m_txn.tx_data = m_tx_packet;
+    m_txn.tx_length = sizeof(m_tx_packet);
+    m_txn.rx_buffer = m_rx_buffer;
+    m_txn.rx_size = sizeof(m_rx_buffer);
+    // NOVO: Timeout iz izmjerenog RTT-a uređaja, ograničen fiksnim timeout-om protokola
+    // (RTT je mjeren na kratkim odgovorima - status sobe dobija puni timeout)
+    m_txn.response_timeout_ms = m_room_status_read ? GetResponseTimeout()
+                                                   : g_rttTable.GetTimeoutMs(m_visit.address, GetResponseTimeout(), m_visit.retry_count);
+    m_txn.single_byte_mode = false;
+    m_txn.notify_task = xTaskGetCurrentTaskHandle();
+}
+
+/**
+ * @brief Kreira 10-bajtni upitni paket (CMD bez podataka).
+ */
+void LogPullManager::BuildRequestPacket(uint8_t* packet, uint16_t address, uint8_t cmd)
 {
-    uint8_t cmd = GetDeleteCommand();
-    LOG_DEBUG(4, "[LogPull] -> Šaljem DELETE(0x%02X) na 0x%X\n", cmd, address);
-    
-    uint8_t packet[10]; 
     uint16_t rsifa = g_appConfig.rs485_iface_addr;
-    
+
     packet[0] = SOH;
     packet[1] = (address >> 8);
     packet[2] = (address & 0xFF);
     packet[3] = (rsifa >> 8);
     packet[4] = (rsifa & 0xFF);
-    packet[5] = 1;
+    packet[5] = 1; // data_len
     packet[6] = cmd;
-    
+
     uint16_t checksum = cmd;
     packet[7] = (checksum >> 8);
     packet[8] = (checksum & 0xFF);
     packet[9] = EOT;
-    
-    if (m_rs485_service->SendPacket(packet, 10))
+}
+
+/**
+ * @brief Kreira i salje GET_SYS_STAT paket (Polling).
+ */
+void LogPullManager::SendStatusRequest(uint16_t address)
+{
+    uint8_t cmd = GetStatusCommand();
+    LOG_DEBUG(4, "[LogPull] -> Šaljem STATUS(0x%02X) na 0x%X\n", cmd, address);
+
+    m_room_status_read = false;
+    BuildRequestPacket(m_tx_packet, address, cmd);
+    StartResponseWait();
+}
+
+/**
+ * @brief Slobodan zahtjev upisa (NULL ako su svi zauzeti).
+ */
+LogPullManager::PendingWrite* LogPullManager::AcquireWrite()
+{
+    for (uint8_t i = 0; i < LOGPULL_MAX_PENDING_WRITES; i++)
     {
-        if (IsHillsProtocol())
+        PendingWrite* pending = &m_writes[i];
+        if (!pending->in_use)
         {
-            // HILLS: Čekamo ACK na DELETE
-            m_state = PullState::WAITING_FOR_DELETE_CONFIRMATION;
-            LOG_DEBUG(4, "[LogPull-HILLS] Čekam DELETE ACK...\n");
+            pending->in_use = true;
+            pending->written = false;
+            pending->done = false;
+            m_writes_in_use++;
+            return pending;
         }
-        // Standardni: Fire-and-forget
+    }
+    return NULL;
+}
+
+/**
+ * @brief Priprema DEL_LOG_LIST paket i transakciju (šalje se tek nakon upisa loga).
+ * @details HILLS čeka ACK na DELETE, standardni je fire-and-forget. Bus, protokol
+ *          i timeout se uzimaju iz tekuće posjete, dok je m_visit još njena.
+ */
+void LogPullManager::PrepareDeleteRequest(PendingWrite* pending)
+{
+    BusTransaction* txn = &pending->delete_txn;
+    pending->delete_needs_ack = IsHillsProtocol();
+    pending->delete_retries = 0;
+
+    BuildRequestPacket(pending->delete_packet, m_visit.address, GetDeleteCommand());
+    txn->priority = BusPriority::LOG_DELETE; // Bez deadline-a u redu
+    txn->bus_id = m_visit.bus;
+    txn->tx_data = pending->delete_packet;
+    txn->tx_length = sizeof(pending->delete_packet);
+    txn->single_byte_mode = false;
+    txn->notify_task = xTaskGetCurrentTaskHandle();
+    txn->on_complete = NULL;
+    txn->context = NULL;
+
+    if (pending->delete_needs_ack)
+    {
+        // HILLS: Čekamo ACK na DELETE
+        txn->rx_buffer = pending->ack_buffer;
+        txn->rx_size = sizeof(pending->ack_buffer);
+        txn->response_timeout_ms = g_rttTable.GetTimeoutMs(m_visit.address, GetResponseTimeout(), m_visit.retry_count);
+    }
+    else
+    {
+        // Standardni: Fire-and-forget (bez rx buffera, timeout 0)
+        txn->rx_buffer = NULL;
+        txn->rx_size = 0;
+        txn->response_timeout_ms = 0;
+    }
+}
+
+/**
+ * @brief Callback LogWriter-a: log je (ne)upisan u EEPROM.
+ * @details Poziva se iz LogWriter zadatka. DELETE se šalje samo ako je upis
+ *          uspio - inače log ostaje na uređaju i preuzima se ponovo.
+ */
+void LogPullManager::OnLogWritten(void* context, bool success)
+{
+    PendingWrite* pending = static_cast<PendingWrite*>(context);
+    if (!success) {
+        return;
+    }
+
+    LOG_DEBUG(4, "[LogPull] -> Šaljem DELETE na 0x%X (log upisan)\n", pending->visit.address);
+    // Pun red ostavlja status REJECTED - Run() tada ponovo predaje DELETE (RetryDelete)
+    pending->owner->m_bus_owner->Submit(&pending->delete_txn);
+}
+
+/**
+ * @brief Ponovo predaje DELETE koji nije stigao na bus (REJECTED, SEND_FAILED...).
+ * @details Poziva se iz Run() (loop kontekst) kada je DELETE završio bez slanja.
+ * @return true ako je DELETE ponovo predat (čeka se), false ako su pokušaji
+ *         potrošeni - log ostaje na uređaju i biće preuzet ponovo.
+ */
+bool LogPullManager::RetryDelete(PendingWrite* pending)
+{
+    BusTransaction* txn = &pending->delete_txn;
+    if (pending->delete_retries >= LOGPULL_DELETE_MAX_RETRIES)
+    {
+        LOG_DEBUG(1, "[LogPull] GRESKA: DELETE na 0x%X nije poslan nakon %u pokušaja (status %u)\n",
+                  pending->visit.address, pending->delete_retries, (unsigned)txn->status);
+        return false;
+    }
+
+    pending->delete_retries++;
+    LOG_DEBUG(2, "[LogPull] DELETE na 0x%X nije poslan (status %u), pokušaj %u/%u\n",
+              pending->visit.address, (unsigned)txn->status, pending->delete_retries, LOGPULL_DELETE_MAX_RETRIES);
+    m_bus_owner->Submit(txn);
+    return true;
+}
+
+/**
+ * @brief Prati logove predate LogWriter-u (loop kontekst, neblokirajuće).
+ * @details Zahtjev je gotov kada upis nije uspio, ili kada je log upisan i
+ *          DELETE otišao na bus. Do tada je uređaj zadržan u rasporedu, a
+ *          posjeta čeka u zahtjevu da je Run() nastavi (ResumeVisit).
+ */
+void LogPullManager::ServiceWrites()
+{
+    for (uint8_t i = 0; i < LOGPULL_MAX_PENDING_WRITES; i++)
+    {
+        PendingWrite* pending = &m_writes[i];
+        if (!pending->in_use || pending->done || pending->write.status == LogWriteStatus::PENDING) {
+            continue;
+        }
+
+        if (pending->write.status != LogWriteStatus::DONE)
+        {
+            pending->done = true; // Upis nije uspio - DELETE nije ni predat
+            continue;
+        }
+
+        if (!pending->written)
+        {
+            pending->written = true;
+            LOG_DEBUG(3, "[LogPull] -> Log upisan (ID:%u, addr:0x%X)\n",
+                pending->write.entry.log_id, pending->visit.address);
+            m_scheduler.OnLog(pending->visit.index, millis());
+            if (pending->visit.logs < 0xFFFF) pending->visit.logs++;
+        }
+
+        // KRITIČNO: DELETE upisanog loga mora otići na bus prije sljedećeg GET_LOG-a
+        // istom uređaju, inače uređaj ponovo vrati isti log i on se upiše dvaput.
+        BusTxnStatus status = pending->delete_txn.status;
+        if (status == BusTxnStatus::PENDING) {
+            continue;
+        }
+        if (status != BusTxnStatus::DONE && status != BusTxnStatus::TIMEOUT && RetryDelete(pending)) {
+            continue;
+        }
+        pending->done = true;
+    }
+}
+
+/**
+ * @brief Nastavlja posjetu iz završenog zahtjeva upisa i oslobađa zahtjev.
+ * @details Vrijeme dok je posjeta čekala upis ne troši njen budžet - poller je
+ *          tada obilazio druge uređaje.
+ */
+void LogPullManager::ResumeVisit(PendingWrite* pending)
+{
+    m_visit = pending->visit;
+    m_visit.start_ms += millis() - pending->suspend_ms;
+    m_visit_active = true;
+    m_draining = false;
+    m_room_status_read = false;
+    m_scheduler.SetHeld(m_visit.index, false);
+
+    bool written = (pending->write.status == LogWriteStatus::DONE);
+    BusTxnStatus delete_status = pending->delete_txn.status;
+
+    if (written && pending->delete_needs_ack)
+    {
+        HandleDeleteAck(pending);
+    }
+    else if (written && delete_status != BusTxnStatus::DONE)
+    {
+        // DELETE nije poslan ni nakon ponovljenih predaja - log ostaje na uređaju
+        m_scheduler.OnLogsPending(m_visit.index, true);
+        m_state = PullState::IDLE;
+        m_last_activity_time = millis();
+    }
+    else
+    {
+        HandleLogWriteResult(written);
+    }
+
+    pending->in_use = false;
+    m_writes_in_use--;
+}
+
+/**
+ * @brief Nastavak posjete nakon upisa loga (loop kontekst).
+ * @param success true ako je log upisan i standardni DELETE poslan.
+ */
+void LogPullManager::HandleLogWriteResult(bool success)
+{
+    if (!success)
+    {
+        // Log nije upisan i nije obrisan na uređaju - pokušaj u sljedećoj posjeti
+        m_scheduler.OnLogsPending(m_visit.index, true);
+        m_draining = false;
+        m_state = PullState::IDLE;
+        m_last_activity_time = millis();
+        return;
+    }
+
+    if (IsVisitBudgetExceeded())
+    {
+        // Budžet posjete potrošen - ostatak u sljedećoj posjeti
+        EndVisitOnBudget();
+    }
+    else
+    {
+#if LOGPULL_DRAIN_MODE
+        // Drain: odmah sljedeći log (DELETE je već poslan)
+        m_draining = true;
+        m_state = PullState::SENDING_LOG_REQUEST;
+#else
+        // Standardni: Vrati se na status check
+        m_state = PullState::SENDING_STATUS_REQUEST;
+#endif
+    }
+}
+
+/**
+ * @brief HILLS: nastavak posjete prema odgovoru na DELETE (ping-pong).
+ */
+void LogPullManager::HandleDeleteAck(PendingWrite* pending)
+{
+    BusTransaction* txn = &pending->delete_txn;
+    m_last_activity_time = millis();
+
+    if (txn->status == BusTxnStatus::DONE && txn->rx_length > 0)
+    {
+        if (m_visit.retry_count == 0) {
+            g_rttTable.AddSample(m_visit.address, txn->rtt_us);
+        }
+        g_roomStatusCache.OnResponse(m_visit.address, m_visit.bus);
+        m_visit.retry_count = 0;
+        m_scheduler.OnResponse(m_visit.index, millis());
+
+        // Provjeri ACK i komandu
+        if (pending->ack_buffer[0] == ACK && pending->ack_buffer[6] == GetDeleteCommand())
+        {
+            LOG_DEBUG(3, "[LogPull-HILLS] DELETE ACK primljen. Nastavljam ping-pong.\n");
+            m_visit.hills_query_attempts = 0;
+
+            // NOVO: Umjesto fiksnih HILLS_MAX_QUERY_ATTEMPTS ciklusa, ping-pong traje
+            // dok je lista neprazna i dok traje budžet posjete (raste sa zaostatkom).
+            if (IsVisitBudgetExceeded())
+            {
+                EndVisitOnBudget();
+                return;
+            }
+
+            // Nastavi ping-pong: šalji novi GET_LOG_LIST
+            m_state = PullState::SENDING_LOG_REQUEST;
+            return;
+        }
+
+        m_state = PullState::IDLE;
+        m_visit.hills_query_attempts = 0;
+        return;
+    }
+
+    if (txn->status == BusTxnStatus::TIMEOUT)
+    {
+        g_rttTable.AddTimeout(m_visit.address);
+        g_roomStatusCache.OnTimeout(m_visit.address);
+        m_scheduler.OnTimeout(m_visit.index, millis());
+    }
+
+    // HILLS: Timeout na DELETE confirmation (ili DELETE nije poslan)
+    m_visit.hills_query_attempts++;
+    LOG_DEBUG(3, "[LogPull-HILLS] Timeout na DELETE (attempt %d/%d)\n",
+        m_visit.hills_query_attempts, HILLS_MAX_QUERY_ATTEMPTS);
+
+    if (txn->status != BusTxnStatus::TIMEOUT ||
+        m_visit.hills_query_attempts >= HILLS_MAX_QUERY_ATTEMPTS || IsVisitBudgetExceeded())
+    {
+        LOG_DEBUG(3, "[LogPull-HILLS] Prekid posjete 0x%X nakon %d timeout-a\n", m_visit.address, m_visit.hills_query_attempts);
+        m_scheduler.OnLogsPending(m_visit.index, true);
+        m_state = PullState::IDLE;
+        m_visit.hills_query_attempts = 0;
+    }
+    else
+    {
+        // Pokušaj ponovo GET_LOG_LIST (sa udvostručenim adaptivnim timeout-om)
+        m_visit.retry_count++;
+        m_state = PullState::SENDING_LOG_REQUEST;
     }
 }
 
@@ -449,27 +837,23 @@ void LogPullManager::SendLogRequest(uint16_t address)
     uint8_t cmd = GetLogCommand();
     LOG_DEBUG(4, "[LogPull] -> Šaljem GET_LOG(0x%02X) na 0x%X\n", cmd, address);
 
-    uint8_t packet[10]; 
-    uint16_t rsifa = g_appConfig.rs485_iface_addr;
-    uint8_t data_len = 1;
-    
-    packet[0] = SOH;
-    packet[1] = (address >> 8);
-    packet[2] = (address & 0xFF);
-    packet[3] = (rsifa >> 8);
-    packet[4] = (rsifa & 0xFF);
-    packet[5] = data_len;
-    packet[6] = cmd;
-    
-    uint16_t checksum = cmd;
-    packet[7] = (checksum >> 8);
-    packet[8] = (checksum & 0xFF);
-    packet[9] = EOT;
-    
-    if (m_rs485_service->SendPacket(packet, 10))
-    {
-        m_state = PullState::WAITING_FOR_RESPONSE;
-    }
+    m_room_status_read = false;
+    BuildRequestPacket(m_tx_packet, address, cmd);
+    StartResponseWait();
+}
+
+/**
+ * @brief Kreira i salje upit statusa sobe (kao cst) za RoomStatusCache.
+ */
+void LogPullManager::SendRoomStatusRequest(uint16_t address)
+{
+    uint8_t cmd = GetRoomStatusCommand();
+    LOG_DEBUG(4, "[LogPull] -> Šaljem STATUS SOBE(0x%02X) na 0x%X\n", cmd, address);
+
+    m_room_status_read = true;
+    m_room_status_generation = g_roomStatusCache.GetGeneration(address);
+    BuildRequestPacket(m_tx_packet, address, cmd);
+    StartResponseWait();
 }
 
 
@@ -485,10 +869,10 @@ void LogPullManager::ProcessResponse(uint8_t* packet, uint16_t length)
     // --- KLJUČNA ISPRAVKA I DEBUG LOG ---
     // ========================================================================
     LOG_DEBUG(4, "[LogPull] Primljen paket od 0x%X (očekujem od 0x%X). CMD: 0x%02X, Dužina: %d\n", 
-              sender_addr, m_current_pull_address, response_cmd, length);
+              sender_addr, m_visit.address, response_cmd, length);
 
     // Striktna provjera: Da li je ovo odgovor od uređaja koji smo pitali?
-    if (sender_addr != m_current_pull_address) {
+    if (sender_addr != m_visit.address) {
         LOG_DEBUG(4, "[LogPull] -> ODBACUJEM. Paket nije od očekivanog uređaja.\n");
         m_state = PullState::IDLE;
         m_last_activity_time = millis();
@@ -498,12 +882,30 @@ void LogPullManager::ProcessResponse(uint8_t* packet, uint16_t length)
     // ========================================================================
     // --- NOVI DEBUG LOG: Ispis sadržaja primljenog paketa ---
     // ========================================================================
-    char payload_str[128] = {0};
-    for (int i = 0; i < min((int)length - 9, 40); i++) { // Ispisujemo do 40 bajtova payload-a
-        sprintf(payload_str + strlen(payload_str), "%02X ", packet[i + 7]);
-    }
+    // Sirovi okvir je već u Rs485Trace (/rs485_trace); hex ispis samo na zahtjev
+#if RS485_SERIAL_TRACE
+    char payload_str[40 * 3 + 1];
+    Rs485Trace::FormatHex(&packet[7], (length > 9) ? min((int)length - 9, 40) : 0, payload_str, sizeof(payload_str)); // Do 40 bajtova payload-a
     LOG_DEBUG(3, "[LogPull] -> Odgovor od 0x%X: [ %s]\n", sender_addr, payload_str);
+#endif
     
+    // ========================================================================
+    // NOVO: Status sobe za keš (payload kao u cst odgovoru)
+    // ========================================================================
+    if (m_room_status_read)
+    {
+        m_room_status_read = false;
+        if (length >= 9)
+        {
+            int payload_len = HttpQueryManager::ExtractPayload(packet, length);
+            g_roomStatusCache.Store(m_visit.address, m_visit.bus, packet, (uint16_t)payload_len, m_room_status_generation);
+            LOG_DEBUG(4, "[LogPull] Status sobe 0x%X u kešu (%d B)\n", m_visit.address, payload_len);
+        }
+        m_state = PullState::IDLE;
+        m_last_activity_time = millis();
+        return;
+    }
+
     // ========================================================================
     // Obrada STATUS odgovora (0xA0 ili 0xBA)
     // ========================================================================
@@ -513,14 +915,23 @@ void LogPullManager::ProcessResponse(uint8_t* packet, uint16_t length)
         // Provjera "Log Pending" flaga
         if (packet[7] == '1' || (length > 8 && packet[8] == '1'))
         {
-            LOG_DEBUG(3, "[LogPull] 0x%X ima log(ove)\n", m_current_pull_address);
+            LOG_DEBUG(3, "[LogPull] 0x%X ima log(ove)\n", m_visit.address);
+            m_scheduler.OnLogsPending(m_visit.index, true);
             m_state = PullState::SENDING_LOG_REQUEST;
             return;
         }
         else {
-             LOG_DEBUG(4, "[LogPull] 0x%X nema logova\n", m_current_pull_address);
-             m_state = PullState::IDLE;
+             LOG_DEBUG(4, "[LogPull] 0x%X nema logova\n", m_visit.address);
+             m_scheduler.OnLogsPending(m_visit.index, false);
              m_last_activity_time = millis();
+
+             // NOVO: Uređaj je slobodan - osvježi zastarjeli status sobe u kešu
+             if (g_roomStatusCache.NeedsRefresh(m_visit.address))
+             {
+                 m_state = PullState::SENDING_ROOM_STATUS_REQUEST;
+                 return;
+             }
+             m_state = PullState::IDLE;
         }
     }
     // ========================================================================
@@ -534,9 +945,10 @@ void LogPullManager::ProcessResponse(uint8_t* packet, uint16_t length)
         // HILLS: Provjera za "prazna lista" (data_len == 1)
         if (IsHillsProtocol() && data_len == 1)
         {
-            LOG_DEBUG(3, "[LogPull-HILLS] Prazna lista na 0x%X. Sljedeća adresa.\n", m_current_pull_address);
+            LOG_DEBUG(3, "[LogPull-HILLS] Prazna lista na 0x%X. Sljedeća adresa.\n", m_visit.address);
+            m_scheduler.OnLogsPending(m_visit.index, false);
             m_state = PullState::IDLE;
-            m_hills_query_attempts = 0;
+            m_visit.hills_query_attempts = 0;
             m_last_activity_time = millis();
             return;
         }
@@ -544,7 +956,7 @@ void LogPullManager::ProcessResponse(uint8_t* packet, uint16_t length)
         // Log paket (18 bajtova: CMD + 16B log + checksum)
         if (data_len >= (LOG_RECORD_SIZE + 2)) 
         {
-            LOG_DEBUG(3, "[LogPull] Primljen LOG sa 0x%X\n", m_current_pull_address);
+            LOG_DEBUG(3, "[LogPull] Primljen LOG sa 0x%X\n", m_visit.address);
             LogEntry newLog; 
             memcpy((uint8_t*)&newLog, &packet[7], LOG_RECORD_SIZE);
             
@@ -558,99 +970,62 @@ void LogPullManager::ProcessResponse(uint8_t* packet, uint16_t length)
             
             // Kasting u niz bajtova za direktnu manipulaciju
             uint8_t* log_bytes = (uint8_t*)&newLog;
-            log_bytes[3] = (m_current_pull_address >> 8) & 0xFF; // Upis adrese (MSB) na 4. bajt
-            log_bytes[4] = m_current_pull_address & 0xFF;        // Upis adrese (LSB) na 5. bajt
+            log_bytes[3] = (m_visit.address >> 8) & 0xFF; // Upis adrese (MSB) na 4. bajt
+            log_bytes[4] = m_visit.address & 0xFF;        // Upis adrese (LSB) na 5. bajt
             // Originalni event na log_bytes[2] ostaje netaknut, što je ispravno ponašanje.
             // ========================================================================
             
             // NOVI DEBUG LOG: Ispis heksadecimalnog sadržaja strukture newLog prije upisa
+#if RS485_SERIAL_TRACE
             char log_hex_buffer[LOG_RECORD_SIZE * 3 + 1];
-            log_hex_buffer[0] = '\0';
-            uint8_t* log_ptr = (uint8_t*)&newLog;
-            for (int i = 0; i < LOG_RECORD_SIZE; i++) {
-                sprintf(log_hex_buffer + strlen(log_hex_buffer), "%02X ", log_ptr[i]);
-            }
+            Rs485Trace::FormatHex((const uint8_t*)&newLog, LOG_RECORD_SIZE, log_hex_buffer, sizeof(log_hex_buffer));
             LOG_DEBUG(3, "[LogPull] -> Pripremljen Log za upis: [ %s]\n", log_hex_buffer);
+#endif
+
+            // NOVO: Upis ide u LogWriter zadatak, poller se odmah vraća. DELETE
+            // šalje callback tek kada je log upisan u EEPROM. Posjeta se čuva u
+            // zahtjevu, a poller do tada obilazi druge uređaje (ovaj je zadržan).
+            PendingWrite* pending = AcquireWrite(); // Slobodan - provjereno prije GET_LOG-a
+            pending->owner = this;
+            PrepareDeleteRequest(pending);
+            memcpy(&pending->write.entry, &newLog, sizeof(LogEntry));
+            pending->write.on_complete = OnLogWritten;
+            pending->write.context = pending;
+            pending->write.notify_task = xTaskGetCurrentTaskHandle();
 
-            if (m_eeprom_storage->WriteLog(&newLog) == LoggerStatus::LOGGER_OK)
+            pending->visit = m_visit;
+            pending->suspend_ms = millis();
+
+            m_draining = false;
+            m_state = PullState::IDLE;
+            m_last_activity_time = millis();
+
+            if (!g_logWriter.Submit(&pending->write))
             {
-                LOG_DEBUG(3, "[LogPull] -> Log upisan (ID:%u, addr:0x%X)\n", 
-                    newLog.log_id, m_current_pull_address);
-                SendDeleteLogRequest(m_current_pull_address);
-                
-                // HILLS vs Standardni
-                if (IsHillsProtocol())
-                {
-                    // HILLS: State već postavljen u SendDeleteLogRequest()
-                    // Čekamo DELETE ACK pa nastavljamo ping-pong
-                    LOG_DEBUG(4, "[LogPull-HILLS] Ping-pong: čekam DELETE ACK\n");
-                }
-                else
-                {
-                    // Standardni: Vrati se na status check
-                    m_state = PullState::SENDING_STATUS_REQUEST;
-                }
+                // Red upisa je pun - log ostaje na uređaju (bez DELETE-a)
+                pending->in_use = false;
+                m_writes_in_use--;
+                m_scheduler.OnLogsPending(m_visit.index, true);
+                return;
             }
+
+            m_visit_active = false; // Posjetu prijavljuje rasporedu tek njen nastavak
+            m_scheduler.SetHeld(m_visit.index, true);
             return;
         }
-    }
-    // ========================================================================
-    // HILLS: Obrada DELETE ACK
-    // ========================================================================
-    uint8_t expected_delete_cmd = GetDeleteCommand();
-    if (IsHillsProtocol() && m_state == PullState::WAITING_FOR_DELETE_CONFIRMATION)
-    {
-        // Provjeri ACK i komandu
-        if (packet[0] == ACK && response_cmd == expected_delete_cmd)
+
+        // Drain: lista je prazna - potvrdi statusnim upitom
+        if (!IsHillsProtocol() && m_draining)
         {
-            LOG_DEBUG(3, "[LogPull-HILLS] DELETE ACK primljen. Nastavljam ping-pong.\n");
-            m_hills_query_attempts++;
-            
-            if (m_hills_query_attempts >= HILLS_MAX_QUERY_ATTEMPTS)
-            {
-                LOG_DEBUG(3, "[LogPull-HILLS] Max ping-pong ciklusa za 0x%X\n", m_current_pull_address);
-                m_state = PullState::IDLE;
-                m_hills_query_attempts = 0;
-            }
-            else
-            {
-                // Nastavi ping-pong: šalji novi GET_LOG_LIST
-                m_state = PullState::SENDING_LOG_REQUEST;
-            }
+            LOG_DEBUG(4, "[LogPull] Drain: prazna lista na 0x%X, STATUS upit.\n", m_visit.address);
+            m_draining = false;
+            m_state = PullState::SENDING_STATUS_REQUEST;
             m_last_activity_time = millis();
             return;
         }
     }
-
     // Default: Vrati se u IDLE
     m_state = PullState::IDLE;
-    m_hills_query_attempts = 0;
+    m_visit.hills_query_attempts = 0;
     m_last_activity_time = millis();
 }
-
-/**
- * @brief Vraća bus ID za datu adresu.
- * @param address Adresa uređaja.
- * @return 0 (Lijevi bus), 1 (Desni bus), ili -1 (nije pronađeno).
- */
-int8_t LogPullManager::GetBusForAddress(uint16_t address)
-{
-    // Provjera u Lijevoj listi
-    for (uint16_t i = 0; i < m_address_list_count_L; i++)
-    {
-        if (m_address_list_L[i] == address) {
-            return 0; // Lijevi bus
-        }
-    }
-    
-    // Provjera u Desnoj listi
-    for (uint16_t i = 0; i < m_address_list_count_R; i++)
-    {
-        if (m_address_list_R[i] == address) {
-            return 1; // Desni bus
-        }
-    }
-    
-    // Adresa nije pronađena ni u jednoj listi
-    return -1;
-}
@@ -0,0 +1,176 @@
+/**
+ ******************************************************************************
+ * @file    LogWriter.cpp
+ * @author  Gemini & [Vase Ime]
+ * @brief   Implementacija zadatka za upis logova u EEPROM.
+ ******************************************************************************
+ */
+
+#include "LogWriter.h"
+#include "DebugConfig.h"
+
+LogWriter::LogWriter() :
+    m_eeprom_storage(NULL),
+    m_queue(NULL),
+    m_task_handle(NULL)
+{
+    memset(&m_stats, 0, sizeof(m_stats));
+}
+
+void LogWriter::Initialize(EepromStorage* pEepromStorage)
+{
+    m_eeprom_storage = pEepromStorage;
+    m_queue = xQueueCreate(LOG_WRITER_QUEUE_LEN, sizeof(LogWriteRequest*));
+}
+
+void LogWriter::StartTask()
+{
+    xTaskCreate(
+        TaskWrapper,
+        "LogWriterTask",
+        LOG_WRITER_TASK_STACK,
+        this,
+        LOG_WRITER_TASK_PRIORITY,
+        &m_task_handle
+    );
+}
+
+void LogWriter::TaskWrapper(void* pvParameters)
+{
+    static_cast<LogWriter*>(pvParameters)->RunTask();
+}
+
+bool LogWriter::Submit(LogWriteRequest* request)
+{
+    if (m_queue == NULL)
+    {
+        request->status = LogWriteStatus::REJECTED;
+        return false;
+    }
+
+    request->status = LogWriteStatus::PENDING;
+    request->enqueue_time_us = (uint32_t)micros();
+
+    if (xQueueSend(m_queue, &request, 0) != pdTRUE)
+    {
+        m_stats.rejected++;
+        request->status = LogWriteStatus::REJECTED;
+        LOG_DEBUG(2, "[LogWriter] Red je pun - log odbijen (ostaje na uređaju).\n");
+        return false;
+    }
+
+    m_stats.submitted++;
+    uint16_t depth = (uint16_t)uxQueueMessagesWaiting(m_queue);
+    if (depth > m_stats.max_depth)
+    {
+        m_stats.max_depth = depth;
+    }
+    return true;
+}
+
+void LogWriter::RunTask()
+{
+    LogWriteRequest* batch[LOG_WRITER_BATCH_MAX];
+
+    while (true)
+    {
+        if (xQueueReceive(m_queue, &batch[0], portMAX_DELAY) != pdTRUE)
+        {
+            continue;
+        }
+
+        // Grupni upis: logovi koji su već u redu (stigli dok je trajao prethodni
+        // upis) i logovi koji stignu u kratkom prozoru nakon prvog idu u isti upis
+        // stranice i isti upis metapodataka. Poller ne čeka upis (obilazi druge
+        // uređaje), pa za LOG_WRITER_FLUSH_MS stiže log sa sljedećeg uređaja.
+        // Puna grupa se upisuje odmah.
+        uint16_t count = 1;
+        TickType_t window_start = xTaskGetTickCount();
+        while (count < LOG_WRITER_BATCH_MAX)
+        {
+            TickType_t elapsed = xTaskGetTickCount() - window_start;
+            TickType_t wait = (elapsed < pdMS_TO_TICKS(LOG_WRITER_FLUSH_MS)) ?
+                              (TickType_t)(pdMS_TO_TICKS(LOG_WRITER_FLUSH_MS) - elapsed) : 0;
+            if (xQueueReceive(m_queue, &batch[count], wait) != pdTRUE)
+            {
+                break;
+            }
+            count++;
+        }
+
+        uint32_t start_us = (uint32_t)micros();
+        bool ok = true;
+        for (uint16_t i = 0; i < count && ok; i++)
+        {
+            ok = (m_eeprom_storage->StageLog(&batch[i]->entry) == LoggerStatus::LOGGER_OK);
+        }
+        // Upis prije callback-a: DELETE se šalje tek za trajno upisan log
+        if (ok)
+        {
+            ok = (m_eeprom_storage->FlushLogs() == LoggerStatus::LOGGER_OK);
+        }
+        else
+        {
+            // Cijela grupa je neuspjela - dio grupe koji je stao u bafer ne smije
+            // ući u sljedeći upis (log bi se upisao dva puta nakon ponovnog preuzimanja)
+            m_eeprom_storage->DiscardStagedLogs();
+        }
+        uint32_t end_us = (uint32_t)micros();
+
+        uint32_t write_us = end_us - start_us;
+        m_stats.flushes++;
+        m_stats.total_write_us += write_us;
+        if (write_us > m_stats.max_write_us) m_stats.max_write_us = write_us;
+        if (count > m_stats.max_batch) m_stats.max_batch = count;
+
+        for (uint16_t i = 0; i < count; i++)
+        {
+            LogWriteRequest* request = batch[i];
+            uint32_t latency_us = end_us - request->enqueue_time_us;
+            if (ok)
+            {
+                m_stats.written++;
+                m_stats.total_latency_us += latency_us;
+                if (latency_us > m_stats.max_latency_us) m_stats.max_latency_us = latency_us;
+            }
+            else
+            {
+                m_stats.failed++;
+                LOG_DEBUG(1, "[LogWriter] GRESKA: Upis loga (ID:%u) nije uspio - log ostaje na uređaju.\n", request->entry.log_id);
+            }
+
+            // Callback (npr. slanje DELETE-a) ide PRIJE upisa statusa - nakon upisa
+            // statusa pozivaoc smije ponovo iskoristiti zahtjev.
+            if (request->on_complete != NULL)
+            {
+                request->on_complete(request->context, ok);
+            }
+
+            TaskHandle_t notify_task = request->notify_task;
+            __sync_synchronize();
+            request->status = ok ? LogWriteStatus::DONE : LogWriteStatus::FAILED;
+            if (notify_task != NULL)
+            {
+                xTaskNotifyGive(notify_task);
+            }
+        }
+    }
+}
+
+void LogWriter::WriteStatsJson(Print& out)
+{
+    LogWriterStats st = m_stats;
+    uint16_t depth = (m_queue != NULL) ? (uint16_t)uxQueueMessagesWaiting(m_queue) : 0;
+
+    out.printf("{\"submitted\":%lu,\"written\":%lu,\"failed\":%lu,\"rejected\":%lu,"
+               "\"depth\":%u,\"max_depth\":%u,\"queue_len\":%u,\"flushes\":%lu,\"max_batch\":%u,"
+               "\"avg_latency_us\":%lu,\"max_latency_us\":%lu,\"avg_flush_us\":%lu,\"max_flush_us\":%lu}",
+               (unsigned long)st.submitted, (unsigned long)st.written,
+               (unsigned long)st.failed, (unsigned long)st.rejected,
+               depth, st.max_depth, LOG_WRITER_QUEUE_LEN,
+               (unsigned long)st.flushes, st.max_batch,
+               (unsigned long)(st.written ? st.total_latency_us / st.written : 0),
+               (unsigned long)st.max_latency_us,
+               (unsigned long)(st.flushes ? st.total_write_us / st.flushes : 0),
+               (unsigned long)st.max_write_us);
+}
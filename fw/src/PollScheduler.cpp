@@ -0,0 +1,269 @@
+/**
+ ******************************************************************************
+ * @file    PollScheduler.cpp
+ * @author  Gemini & [Vase Ime]
+ * @brief   Implementacija adaptivnog rasporeda pollinga.
+ ******************************************************************************
+ */
+
+#include "PollScheduler.h"
+
+#define POLL_FLAG_RESPONSIVE    0x01    // Zadnja posjeta je dobila odgovor
+#define POLL_FLAG_HAS_LOGS      0x02    // Uređaj je javio logove na čekanju
+#define POLL_FLAG_HELD          0x04    // Log uređaja čeka upis/DELETE - bez posjete
+
+PollScheduler::PollScheduler()
+{
+    Reset(NULL, 0, NULL, 0);
+}
+
+void PollScheduler::Reset(const uint16_t* list_a, uint16_t count_a, const uint16_t* list_b, uint16_t count_b)
+{
+    if (list_a == NULL) count_a = 0;
+    if (list_b == NULL) count_b = 0;
+    if (count_a > MAX_ADDRESS_LIST_SIZE) count_a = MAX_ADDRESS_LIST_SIZE;
+    if (count_a + count_b > MAX_ADDRESS_LIST_SIZE) count_b = MAX_ADDRESS_LIST_SIZE - count_a;
+
+    m_list_a = list_a;
+    m_list_b = list_b;
+    m_count_a = count_a;
+    m_count = count_a + count_b;
+
+    memset(m_state, 0, sizeof(m_state));
+    for (uint8_t i = 0; i < POLL_HOT_SLOTS; i++) {
+        m_hot[i] = POLL_NO_DEVICE;
+    }
+    m_cursor = 0;
+    m_hot_burst = 0;
+    m_sweeps = 0;
+    m_hot_visits = 0;
+    m_backoff_skips = 0;
+    m_held_skips = 0;
+}
+
+uint16_t PollScheduler::GetAddress(int16_t index) const
+{
+    if (index < 0 || index >= (int16_t)m_count) return 0;
+    return (index < (int16_t)m_count_a) ? m_list_a[index] : m_list_b[index - m_count_a];
+}
+
+/**
+ * @brief Vrući uređaj koji je na redu (logovi na čekanju ili istekao period).
+ */
+int16_t PollScheduler::NextHot(uint32_t now)
+{
+    for (uint8_t i = 0; i < POLL_HOT_SLOTS; i++)
+    {
+        int16_t index = m_hot[i];
+        if (index == POLL_NO_DEVICE) continue;
+
+        DeviceState* st = &m_state[index];
+        bool pending = (st->flags & POLL_FLAG_HAS_LOGS) != 0;
+
+        // Ohlađen uređaj izlazi iz vrućeg reda (osim ako još ima logova)
+        if (!pending && (now - st->last_event_ms) > POLL_HOT_WINDOW_MS) {
+            m_hot[i] = POLL_NO_DEVICE;
+            continue;
+        }
+
+        if (!IsDue(st, now)) continue;  // U backoff-u - čeka probu
+        if (st->flags & POLL_FLAG_HELD) continue;
+        if (pending || (now - st->last_visit_ms) >= POLL_HOT_INTERVAL_MS) {
+            return index;
+        }
+    }
+    return POLL_NO_DEVICE;
+}
+
+int16_t PollScheduler::Next(uint32_t now, bool* wrapped)
+{
+    *wrapped = false;
+    if (m_count == 0) return POLL_NO_DEVICE;
+
+    // 1) Vrući red - ograničeno, da redovni obilazak uvijek napreduje
+    if (m_hot_burst < POLL_HOT_BURST)
+    {
+        int16_t hot = NextHot(now);
+        if (hot != POLL_NO_DEVICE)
+        {
+            m_hot_burst++;
+            m_hot_visits++;
+            m_state[hot].last_visit_ms = now;
+            return hot;
+        }
+    }
+
+    // 2) Redovni obilazak - preskače uređaje u backoff-u (najviše jedan krug)
+    for (uint16_t step = 0; step < m_count; step++)
+    {
+        int16_t index = (int16_t)m_cursor;
+        m_cursor++;
+        if (m_cursor >= m_count)
+        {
+            m_cursor = 0;
+            m_sweeps++;
+            *wrapped = true;
+        }
+
+        DeviceState* st = &m_state[index];
+        if (!IsDue(st, now))
+        {
+            m_backoff_skips++;
+            continue;
+        }
+        if (st->flags & POLL_FLAG_HELD)
+        {
+            // Uređaj ima logove (vruć je) - posjećuje se kada se pusti
+            m_held_skips++;
+            continue;
+        }
+
+        m_hot_burst = 0;
+        st->last_visit_ms = now;
+        return index;
+    }
+
+    // Svi uređaji su u backoff-u ili zadržani
+    m_hot_burst = 0;
+    return POLL_NO_DEVICE;
+}
+
+void PollScheduler::OnResponse(int16_t index, uint32_t now)
+{
+    if (index < 0 || index >= (int16_t)m_count) return;
+    DeviceState* st = &m_state[index];
+    st->timeouts = 0;
+    st->flags |= POLL_FLAG_RESPONSIVE;
+    st->next_due_ms = now;
+}
+
+void PollScheduler::OnTimeout(int16_t index, uint32_t now)
+{
+    if (index < 0 || index >= (int16_t)m_count) return;
+    DeviceState* st = &m_state[index];
+
+    if (st->timeouts < 0xFF) st->timeouts++;
+    st->flags &= ~POLL_FLAG_RESPONSIVE;
+
+    if (st->timeouts < POLL_BACKOFF_THRESHOLD) {
+        return; // Pojedinačni gubitak okvira ne odlaže uređaj
+    }
+
+    // BASE, 2*BASE, 4*BASE ... do plafona
+    uint32_t delay = POLL_BACKOFF_BASE_MS;
+    for (uint8_t i = POLL_BACKOFF_THRESHOLD; i < st->timeouts && delay < POLL_BACKOFF_MAX_MS; i++) {
+        delay *= 2;
+    }
+    if (delay > POLL_BACKOFF_MAX_MS) delay = POLL_BACKOFF_MAX_MS;
+
+    st->next_due_ms = now + delay;
+}
+
+void PollScheduler::OnLog(int16_t index, uint32_t now)
+{
+    if (index < 0 || index >= (int16_t)m_count) return;
+    DeviceState* st = &m_state[index];
+    st->last_event_ms = now;
+    st->flags |= POLL_FLAG_HAS_LOGS;
+    AddHot(index, now);
+}
+
+void PollScheduler::OnLogsPending(int16_t index, bool pending)
+{
+    if (index < 0 || index >= (int16_t)m_count) return;
+    if (pending) {
+        m_state[index].flags |= POLL_FLAG_HAS_LOGS;
+    } else {
+        m_state[index].flags &= ~POLL_FLAG_HAS_LOGS;
+    }
+}
+
+void PollScheduler::SetHeld(int16_t index, bool held)
+{
+    if (index < 0 || index >= (int16_t)m_count) return;
+    if (held) {
+        m_state[index].flags |= POLL_FLAG_HELD;
+    } else {
+        m_state[index].flags &= ~POLL_FLAG_HELD;
+    }
+}
+
+uint32_t PollScheduler::GetVisitBudgetMs(int16_t index) const
+{
+    if (index < 0 || index >= (int16_t)m_count) return LOGPULL_VISIT_BUDGET_MS;
+    uint32_t budget = (uint32_t)LOGPULL_VISIT_BUDGET_MS << m_state[index].budget_shift;
+    return (budget > LOGPULL_VISIT_BUDGET_MAX_MS) ? LOGPULL_VISIT_BUDGET_MAX_MS : budget;
+}
+
+void PollScheduler::OnVisitEnd(int16_t index, uint16_t logs, uint32_t visit_ms, bool budget_exhausted)
+{
+    if (index < 0 || index >= (int16_t)m_count) return;
+    DeviceState* st = &m_state[index];
+
+    if (logs > 0)
+    {
+        st->drained_logs = ((uint32_t)st->drained_logs + logs > 0xFFFF) ? 0xFFFF : st->drained_logs + logs;
+        st->drain_ms += visit_ms;
+    }
+
+    if (budget_exhausted)
+    {
+        // Zaostatak veći od jedne posjete - sljedeća posjeta dobija veći budžet
+        if (GetVisitBudgetMs(index) < LOGPULL_VISIT_BUDGET_MAX_MS) st->budget_shift++;
+    }
+    else
+    {
+        st->budget_shift = 0;
+    }
+}
+
+void PollScheduler::WriteJson(Print& out) const
+{
+    uint32_t now = millis();
+
+    out.printf("{\"devices_total\":%u,\"sweeps\":%lu,\"hot_visits\":%lu,\"backoff_skips\":%lu,\"held_skips\":%lu,",
+               m_count, (unsigned long)m_sweeps, (unsigned long)m_hot_visits, (unsigned long)m_backoff_skips,
+               (unsigned long)m_held_skips);
+    out.print("\"columns\":[\"addr\",\"timeouts\",\"backoff_ms\",\"logs\",\"drain_ms\",\"logs_per_min\",\"budget_ms\"],\"devices\":[");
+
+    for (uint16_t i = 0; i < m_count; i++)
+    {
+        const DeviceState* st = &m_state[i];
+        int32_t backoff = (int32_t)(st->next_due_ms - now);
+        uint32_t rate = (st->drain_ms > 0) ? (uint32_t)(((uint64_t)st->drained_logs * 60000UL) / st->drain_ms) : 0;
+
+        out.printf("%s[%u,%u,%ld,%u,%lu,%lu,%lu]", (i == 0) ? "" : ",",
+                   GetAddress(i), st->timeouts, (long)((backoff > 0) ? backoff : 0),
+                   st->drained_logs, (unsigned long)st->drain_ms, (unsigned long)rate,
+                   (unsigned long)GetVisitBudgetMs(i));
+    }
+    out.print("]}");
+}
+
+/**
+ * @brief Ubacuje uređaj u vrući red; ako je pun, istiskuje najdavnije aktivan.
+ */
+void PollScheduler::AddHot(int16_t index, uint32_t now)
+{
+    int8_t free_slot = -1;
+    int8_t oldest_slot = 0;
+    uint32_t oldest_age = 0;
+
+    for (uint8_t i = 0; i < POLL_HOT_SLOTS; i++)
+    {
+        if (m_hot[i] == index) return;
+        if (m_hot[i] == POLL_NO_DEVICE)
+        {
+            if (free_slot < 0) free_slot = i;
+            continue;
+        }
+        uint32_t age = now - m_state[m_hot[i]].last_event_ms;
+        if (age >= oldest_age)
+        {
+            oldest_age = age;
+            oldest_slot = i;
+        }
+    }
+
+    m_hot[(free_slot >= 0) ? free_slot : oldest_slot] = index;
+}
@@ -0,0 +1,236 @@
+/**
+ ******************************************************************************
+ * @file    RoomStatusCache.cpp
+ * @author  Gemini & [Vase Ime]
+ * @brief   Implementacija keša statusa soba.
+ ******************************************************************************
+ */
+
+#include "RoomStatusCache.h"
+#include "DebugConfig.h"
+#include <stdlib.h>
+
+// Globalni keš (puni LogPullManager, HttpQueryManager i RoomStatusSweep, čita HttpServer)
+RoomStatusCache g_roomStatusCache;
+
+static int CompareAddress(const void* a, const void* b)
+{
+    return (int)*(const uint16_t*)a - (int)*(const uint16_t*)b;
+}
+
+RoomStatusCache::RoomStatusCache() :
+    m_addresses(NULL),
+    m_entries(NULL),
+    m_count(0)
+{
+    portMUX_TYPE init = portMUX_INITIALIZER_UNLOCKED;
+    m_lock = init;
+}
+
+void RoomStatusCache::Build(const uint16_t* list_a, uint16_t count_a, const uint16_t* list_b, uint16_t count_b)
+{
+    uint16_t total = count_a + count_b;
+    uint16_t* addresses = NULL;
+    Entry* entries = NULL;
+    uint16_t unique = 0;
+
+    if (total > 0)
+    {
+        addresses = (uint16_t*)malloc(total * sizeof(uint16_t));
+        if (addresses == NULL)
+        {
+            Serial.println(F("[RoomStatusCache] GRESKA: Nema memorije za indeks!"));
+            return;
+        }
+        memcpy(addresses, list_a, count_a * sizeof(uint16_t));
+        if (count_b > 0) {
+            memcpy(&addresses[count_a], list_b, count_b * sizeof(uint16_t));
+        }
+        qsort(addresses, total, sizeof(uint16_t), CompareAddress);
+
+        // Bez duplikata (adresa u obje liste) i adrese 0
+        for (uint16_t i = 0; i < total; i++)
+        {
+            if (addresses[i] == 0 || (unique > 0 && addresses[unique - 1] == addresses[i])) {
+                continue;
+            }
+            addresses[unique++] = addresses[i];
+        }
+
+        entries = (Entry*)calloc(unique, sizeof(Entry));
+        if (entries == NULL)
+        {
+            Serial.printf("[RoomStatusCache] GRESKA: Nema memorije za %u soba!\n", unique);
+            free(addresses);
+            return;
+        }
+        for (uint16_t i = 0; i < unique; i++) {
+            entries[i].bus = -1;
+        }
+    }
+
+    // Zamjena pod lock-om; stari nizovi se oslobađaju izvan kritične sekcije
+    portENTER_CRITICAL(&m_lock);
+    uint16_t* old_addresses = m_addresses;
+    Entry* old_entries = m_entries;
+    m_addresses = addresses;
+    m_entries = entries;
+    m_count = unique;
+    portEXIT_CRITICAL(&m_lock);
+
+    free(old_addresses);
+    free(old_entries);
+
+    Serial.printf("[RoomStatusCache] %u soba (%u B)\n", unique, (unsigned)(unique * (sizeof(Entry) + sizeof(uint16_t))));
+}
+
+/**
+ * @brief Binarna pretraga. Poziva se unutar kritične sekcije.
+ * @return Slot ili -1 ako adresa nije u indeksu.
+ */
+int16_t RoomStatusCache::FindSlot(uint16_t address) const
+{
+    uint16_t lo = 0;
+    uint16_t hi = m_count;
+    while (lo < hi)
+    {
+        uint16_t mid = lo + (hi - lo) / 2;
+        if (m_addresses[mid] < address) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return (lo < m_count && m_addresses[lo] == address) ? (int16_t)lo : -1;
+}
+
+void RoomStatusCache::OnResponse(uint16_t address, uint8_t bus)
+{
+    portENTER_CRITICAL(&m_lock);
+    int16_t slot = FindSlot(address);
+    if (slot >= 0)
+    {
+        m_entries[slot].timeouts = 0;
+        if (bus != RS485_BUS_CURRENT) {
+            m_entries[slot].bus = (int8_t)bus;
+        }
+    }
+    portEXIT_CRITICAL(&m_lock);
+}
+
+void RoomStatusCache::OnTimeout(uint16_t address)
+{
+    portENTER_CRITICAL(&m_lock);
+    int16_t slot = FindSlot(address);
+    if (slot >= 0 && m_entries[slot].timeouts < 0xFF) {
+        m_entries[slot].timeouts++;
+    }
+    portEXIT_CRITICAL(&m_lock);
+}
+
+uint16_t RoomStatusCache::GetGeneration(uint16_t address)
+{
+    uint16_t generation = 0;
+
+    portENTER_CRITICAL(&m_lock);
+    int16_t slot = FindSlot(address);
+    if (slot >= 0) {
+        generation = m_entries[slot].generation;
+    }
+    portEXIT_CRITICAL(&m_lock);
+
+    return generation;
+}
+
+void RoomStatusCache::Store(uint16_t address, uint8_t bus, const uint8_t* payload, uint16_t length, uint16_t generation)
+{
+    if (length > ROOM_STATUS_MAX_PAYLOAD) length = ROOM_STATUS_MAX_PAYLOAD;
+
+    portENTER_CRITICAL(&m_lock);
+    int16_t slot = FindSlot(address);
+    // KRITIČNO: Čitanje koje je bilo u redu ili na liniji kada je komanda
+    // promijenila sobu vraća staro stanje - ne smije prepisati Invalidate()
+    if (slot >= 0 && m_entries[slot].generation == generation)
+    {
+        Entry* entry = &m_entries[slot];
+        memcpy(entry->payload, payload, length);
+        entry->length = (uint8_t)length;
+        entry->status_ms = millis();
+        entry->valid = true;
+        entry->timeouts = 0;
+        if (bus != RS485_BUS_CURRENT) {
+            entry->bus = (int8_t)bus;
+        }
+    }
+    portEXIT_CRITICAL(&m_lock);
+}
+
+void RoomStatusCache::Invalidate(uint16_t address)
+{
+    portENTER_CRITICAL(&m_lock);
+    int16_t slot = FindSlot(address);
+    if (slot >= 0)
+    {
+        m_entries[slot].valid = false;
+        m_entries[slot].generation++;
+    }
+    else
+    {
+        for (uint16_t i = 0; i < m_count; i++) {
+            m_entries[i].valid = false;
+            m_entries[i].generation++;
+        }
+    }
+    portEXIT_CRITICAL(&m_lock);
+}
+
+bool RoomStatusCache::Get(uint16_t address, uint32_t max_age_ms, RoomStatusSnapshot* out)
+{
+    if (max_age_ms == 0) {
+        return false;
+    }
+
+    bool hit = false;
+    uint32_t now = millis();
+
+    portENTER_CRITICAL(&m_lock);
+    int16_t slot = FindSlot(address);
+    if (slot >= 0)
+    {
+        const Entry* entry = &m_entries[slot];
+        uint32_t age = now - entry->status_ms;
+        if (entry->valid && age <= max_age_ms && entry->timeouts < POLL_BACKOFF_THRESHOLD)
+        {
+            out->age_ms = age;
+            out->bus = entry->bus;
+            out->length = entry->length;
+            memcpy(out->payload, entry->payload, entry->length);
+            hit = true;
+        }
+    }
+    portEXIT_CRITICAL(&m_lock);
+
+    return hit;
+}
+
+bool RoomStatusCache::NeedsRefresh(uint16_t address)
+{
+#if ROOM_STATUS_CACHE_REFRESH_MS > 0
+    uint32_t now = millis();
+    bool refresh = false;
+
+    portENTER_CRITICAL(&m_lock);
+    int16_t slot = FindSlot(address);
+    if (slot >= 0)
+    {
+        const Entry* entry = &m_entries[slot];
+        refresh = !entry->valid || (now - entry->status_ms) >= ROOM_STATUS_CACHE_REFRESH_MS;
+    }
+    portEXIT_CRITICAL(&m_lock);
+
+    return refresh;
+#else
+    (void)address;
+    return false;
+#endif
+}
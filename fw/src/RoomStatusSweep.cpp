@@ -0,0 +1,433 @@
+/**
+ ******************************************************************************
+ * @file    RoomStatusSweep.cpp
+ * @author  Gemini & [Vase Ime]
+ * @brief   Implementacija statusa više soba jednim prolazom magistrale.
+ ******************************************************************************
+ */
+
+#include "RoomStatusSweep.h"
+#include "DebugConfig.h"
+#include "HttpQueryManager.h"
+#include "DeviceDirectory.h"
+#include "RoomStatusCache.h"
+#include "EepromStorage.h" // Za g_appConfig
+
+extern AppConfig g_appConfig;
+
+// Sigurnosni period buđenja (red pun -> ponovni pokušaj predaje)
+#define ROOM_STATUS_WAIT_TICKS      pdMS_TO_TICKS(100)
+
+static const char* ROOM_STATUS_NAMES[] = { "pending", "ok", "timeout", "error" };
+
+RoomStatusSweep::RoomStatusSweep() :
+    m_bus_owner(NULL),
+    m_http_query_manager(NULL),
+    m_task_handle(NULL),
+    m_state(State::IDLE),
+    m_abort(false),
+    m_entries(NULL),
+    m_count(0),
+    m_cached(0),
+    m_start_ms(0),
+    m_elapsed_ms(0),
+    m_json_row(0),
+    m_json_len(0),
+    m_json_pos(0)
+{
+    for (uint8_t b = 0; b < RS485_MAX_BUS_LANES; b++)
+    {
+        m_work[b] = NULL;
+        m_work_head[b] = 0;
+        m_work_tail[b] = 0;
+        for (uint8_t d = 0; d < ROOM_STATUS_PIPELINE_DEPTH; d++) {
+            m_slots[b][d].busy = false;
+        }
+    }
+    portMUX_TYPE init = portMUX_INITIALIZER_UNLOCKED;
+    m_lock = init;
+}
+
+void RoomStatusSweep::Initialize(Rs485BusOwner* pBusOwner, HttpQueryManager* pHttpQueryManager)
+{
+    m_bus_owner = pBusOwner;
+    m_http_query_manager = pHttpQueryManager;
+}
+
+void RoomStatusSweep::StartTask()
+{
+    xTaskCreate(
+        TaskWrapper,
+        "RoomStatusTask",
+        ROOM_STATUS_TASK_STACK,
+        this,
+        ROOM_STATUS_TASK_PRIORITY,
+        &m_task_handle
+    );
+}
+
+void RoomStatusSweep::TaskWrapper(void* pvParameters)
+{
+    static_cast<RoomStatusSweep*>(pvParameters)->RunTask();
+}
+
+static int CompareAddress(const void* a, const void* b)
+{
+    return (int)*(const uint16_t*)a - (int)*(const uint16_t*)b;
+}
+
+bool RoomStatusSweep::Begin(const uint16_t* addresses, uint16_t count, uint32_t max_age_ms)
+{
+    if (count == 0 || count > ROOM_STATUS_BATCH_MAX || m_task_handle == NULL || m_bus_owner == NULL) {
+        return false;
+    }
+
+    // Rezervacija (samo jedan sweep istovremeno)
+    portENTER_CRITICAL(&m_lock);
+    bool idle = (m_state == State::IDLE);
+    if (idle) m_state = State::STARTING;
+    portEXIT_CRITICAL(&m_lock);
+    if (!idle)
+    {
+        LOG_DEBUG(2, "[RoomStatus] Sweep je već u toku.\n");
+        return false;
+    }
+
+    m_entries = (RoomStatusEntry*)malloc(count * sizeof(RoomStatusEntry));
+    bool allocated = (m_entries != NULL);
+    for (uint8_t b = 0; b < RS485_MAX_BUS_LANES; b++)
+    {
+        m_work[b] = (uint16_t*)malloc(count * sizeof(uint16_t));
+        allocated = allocated && (m_work[b] != NULL);
+    }
+    if (!allocated)
+    {
+        LOG_DEBUG(1, "[RoomStatus] GRESKA: Nema memorije za %u soba.\n", count);
+        FreeEntries();
+        m_state = State::IDLE;
+        return false;
+    }
+
+    // Sortiranje (redoslijed na busu = redoslijed adresa), bez duplikata i adrese 0
+    uint16_t* sorted = m_work[0];
+    memcpy(sorted, addresses, count * sizeof(uint16_t));
+    qsort(sorted, count, sizeof(uint16_t), CompareAddress);
+
+    m_count = 0;
+    m_cached = 0;
+    for (uint16_t i = 0; i < count; i++)
+    {
+        if (sorted[i] == 0 || (m_count > 0 && m_entries[m_count - 1].address == sorted[i])) {
+            continue;
+        }
+        RoomStatusEntry* entry = &m_entries[m_count++];
+        entry->address = sorted[i];
+        entry->bus = -1;
+        entry->result = RoomStatusResult::PENDING;
+        entry->length = 0;
+        entry->age_ms = 0;
+
+        // Dovoljno svjež status iz keša - soba ne ide na bus
+        RoomStatusSnapshot cached;
+        if (g_roomStatusCache.Get(entry->address, max_age_ms, &cached))
+        {
+            entry->bus = cached.bus;
+            entry->result = RoomStatusResult::OK;
+            entry->length = cached.length;
+            entry->age_ms = cached.age_ms;
+            memcpy(entry->payload, cached.payload, cached.length);
+            m_cached++;
+        }
+    }
+
+    // Raspodjela po busu kao HttpQueryManager::SelectBus() (nepoznata adresa -> Bus 0)
+    for (uint8_t b = 0; b < RS485_MAX_BUS_LANES; b++)
+    {
+        m_work_head[b] = 0;
+        m_work_tail[b] = 0;
+    }
+    for (uint16_t i = 0; i < m_count; i++)
+    {
+        if (m_entries[i].result != RoomStatusResult::PENDING) {
+            continue;
+        }
+        int8_t bus = g_appConfig.enable_dual_bus_mode ? g_deviceDirectory.GetBus(m_entries[i].address) : 0;
+        if (bus < 0) bus = 0;
+        m_work[bus][m_work_tail[bus]++] = i;
+    }
+
+    m_abort = false;
+    m_elapsed_ms = 0;
+    m_start_ms = millis();
+    LOG_DEBUG(3, "[RoomStatus] Sweep: %u soba (Bus 0: %u, Bus 1: %u, keš: %u)\n",
+              m_count, m_work_tail[0], m_work_tail[1], m_cached);
+
+    m_state = State::RUNNING;
+    xTaskNotifyGive(m_task_handle);
+    return true;
+}
+
+void RoomStatusSweep::Release()
+{
+    portENTER_CRITICAL(&m_lock);
+    State state = m_state;
+    if (state == State::RUNNING) {
+        m_abort = true; // Zadatak oslobađa memoriju kada se isprazne transakcije
+    }
+    portEXIT_CRITICAL(&m_lock);
+
+    if (state == State::DONE)
+    {
+        FreeEntries();
+        m_state = State::IDLE;
+    }
+}
+
+void RoomStatusSweep::FreeEntries()
+{
+    free(m_entries);
+    m_entries = NULL;
+    for (uint8_t b = 0; b < RS485_MAX_BUS_LANES; b++)
+    {
+        free(m_work[b]);
+        m_work[b] = NULL;
+    }
+    m_count = 0;
+}
+
+void RoomStatusSweep::RunTask()
+{
+    while (true)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        // Zakašnjela notifikacija prethodnog sweep-a se ignoriše
+        if (m_state == State::RUNNING) {
+            RunSweep();
+        }
+    }
+}
+
+/**
+ * @brief Predaje sljedeću sobu iz reda busa u slot.
+ * @return false ako je red busa prazan ili je red vlasnika pun (soba ostaje u redu).
+ */
+bool RoomStatusSweep::SubmitNext(Slot* slot, uint8_t bus_id)
+{
+    if (m_work_head[bus_id] == m_work_tail[bus_id]) {
+        return false;
+    }
+
+    uint16_t index = m_work[bus_id][m_work_head[bus_id]];
+    RoomStatusEntry* entry = &m_entries[index];
+
+    // GET_APPL_STAT se adaptira na HILLS (0x95) prema protokolu busa
+    HttpCommand cmd = {};
+    cmd.cmd_id = GET_APPL_STAT;
+    cmd.address = entry->address;
+
+    BusTransaction* txn = &slot->txn;
+    txn->priority = BusPriority::BATCH; // Ispod pollinga - ne gladuje ostale klase
+    txn->bus_id = bus_id;
+    txn->tx_data = slot->packet;
+    txn->tx_length = m_http_query_manager->BuildQueryPacket(&cmd, bus_id, slot->packet);
+    txn->rx_buffer = slot->response;
+    txn->rx_size = MAX_PACKET_LENGTH;
+    // Fiksni timeout kao kod cst: RTT tabela uči na kratkim odgovorima pollinga (pod 8 ms),
+    // a odgovor statusa sobe je ~61 B (~5 ms na liniji) - naučeni timeout bi ga odsjekao
+    txn->response_timeout_ms = HTTP_QUERY_TIMEOUT_MS;
+    txn->single_byte_mode = false;
+    txn->notify_task = m_task_handle;
+    txn->on_complete = NULL;
+    txn->context = NULL;
+
+    if (!m_bus_owner->Submit(txn)) {
+        return false;
+    }
+
+    m_work_head[bus_id]++;
+    entry->bus = (int8_t)bus_id;
+    slot->entry = index;
+    slot->cache_generation = g_roomStatusCache.GetGeneration(entry->address);
+    slot->busy = true;
+    return true;
+}
+
+void RoomStatusSweep::CompleteSlot(Slot* slot)
+{
+    RoomStatusEntry* entry = &m_entries[slot->entry];
+    BusTransaction* txn = &slot->txn;
+    slot->busy = false;
+
+    switch (txn->status)
+    {
+    case BusTxnStatus::DONE:
+    {
+        if (txn->rx_length < 9)
+        {
+            entry->result = RoomStatusResult::FAILED;
+            break;
+        }
+        int len = HttpQueryManager::ExtractPayload(slot->response, txn->rx_length);
+        if (len > ROOM_STATUS_MAX_PAYLOAD) len = ROOM_STATUS_MAX_PAYLOAD;
+        memcpy(entry->payload, slot->response, len);
+        entry->length = (uint8_t)len;
+        entry->result = RoomStatusResult::OK;
+        g_roomStatusCache.Store(entry->address, txn->bus_id, slot->response, (uint16_t)len, slot->cache_generation);
+        break;
+    }
+    case BusTxnStatus::TIMEOUT:
+        // FALLBACK kao kod cst: timeout na Bus 0 -> Bus 1 (na kraj reda Bus 1)
+        if (txn->bus_id == 0) {
+            m_work[1][m_work_tail[1]++] = slot->entry;
+        } else {
+            entry->result = RoomStatusResult::TIMEOUT;
+        }
+        break;
+    default:
+        entry->result = RoomStatusResult::FAILED;
+        break;
+    }
+}
+
+void RoomStatusSweep::RunSweep()
+{
+    uint16_t in_flight = 0;
+
+    while (true)
+    {
+        // Dopuni slobodne slotove - vlasnik magistrale uvijek ima sljedeću sobu u redu
+        for (uint8_t b = 0; b < RS485_MAX_BUS_LANES && !m_abort; b++)
+        {
+            for (uint8_t d = 0; d < ROOM_STATUS_PIPELINE_DEPTH; d++)
+            {
+                if (!m_slots[b][d].busy && SubmitNext(&m_slots[b][d], b)) {
+                    in_flight++;
+                }
+            }
+        }
+
+        bool work_left = false;
+        for (uint8_t b = 0; b < RS485_MAX_BUS_LANES; b++) {
+            work_left = work_left || (m_work_head[b] != m_work_tail[b]);
+        }
+        if (in_flight == 0 && (m_abort || !work_left)) {
+            break;
+        }
+
+        // Vlasnik magistrale budi zadatak po završetku svake transakcije
+        ulTaskNotifyTake(pdTRUE, ROOM_STATUS_WAIT_TICKS);
+
+        for (uint8_t b = 0; b < RS485_MAX_BUS_LANES; b++)
+        {
+            for (uint8_t d = 0; d < ROOM_STATUS_PIPELINE_DEPTH; d++)
+            {
+                Slot* slot = &m_slots[b][d];
+                if (slot->busy && slot->txn.status != BusTxnStatus::PENDING)
+                {
+                    CompleteSlot(slot);
+                    in_flight--;
+                }
+            }
+        }
+    }
+
+    m_elapsed_ms = millis() - m_start_ms;
+    LOG_DEBUG(3, "[RoomStatus] Sweep završen: %u soba za %lu ms%s\n",
+              m_count, (unsigned long)m_elapsed_ms, m_abort ? " (prekinut)" : "");
+
+    portENTER_CRITICAL(&m_lock);
+    bool aborted = m_abort;
+    if (!aborted) {
+        m_state = State::DONE;
+    }
+    portEXIT_CRITICAL(&m_lock);
+
+    if (aborted)
+    {
+        FreeEntries();
+        m_state = State::IDLE;
+    }
+}
+
+/**
+ * @brief Formatira red JSON-a: 0 = zaglavlje, 1..m_count = sobe, m_count+1 = kraj.
+ * @return Dužina reda (bez '\0').
+ */
+size_t RoomStatusSweep::FormatRow(uint16_t row, char* out, size_t out_size)
+{
+    if (row == 0)
+    {
+        return snprintf(out, out_size,
+            "{\"count\":%u,\"cached\":%u,\"elapsed_ms\":%lu,\"parallel\":%s,"
+            "\"columns\":[\"addr\",\"bus\",\"status\",\"payload\",\"age_ms\"],\"rooms\":[",
+            m_count, m_cached, (unsigned long)m_elapsed_ms, m_bus_owner->IsParallel() ? "true" : "false");
+    }
+    if (row > m_count)
+    {
+        return snprintf(out, out_size, "]}");
+    }
+
+    static const char HEX_DIGITS[] = "0123456789ABCDEF";
+    const RoomStatusEntry* entry = &m_entries[row - 1];
+    size_t pos = snprintf(out, out_size, "%s[%u,%d,\"%s\",\"", (row > 1) ? "," : "",
+                          entry->address, entry->bus, ROOM_STATUS_NAMES[(uint8_t)entry->result]);
+
+    // Payload je ASCII status kontrolera; ostali bajtovi kao \u00XX
+    for (uint8_t i = 0; i < entry->length && (pos + 20) < out_size; i++)
+    {
+        uint8_t c = (uint8_t)entry->payload[i];
+        if (c == '"' || c == '\\')
+        {
+            out[pos++] = '\\';
+            out[pos++] = (char)c;
+        }
+        else if (c < 0x20 || c > 0x7E)
+        {
+            memcpy(&out[pos], "\\u00", 4);
+            pos += 4;
+            out[pos++] = HEX_DIGITS[c >> 4];
+            out[pos++] = HEX_DIGITS[c & 0x0F];
+        }
+        else
+        {
+            out[pos++] = (char)c;
+        }
+    }
+    pos += snprintf(&out[pos], out_size - pos, "\",%lu]", (unsigned long)entry->age_ms);
+    return pos;
+}
+
+size_t RoomStatusSweep::FillJson(uint8_t* buffer, size_t maxLen, size_t index)
+{
+    if (m_state != State::DONE) {
+        return 0;
+    }
+
+    if (index == 0)
+    {
+        m_json_row = 0;
+        m_json_len = 0;
+        m_json_pos = 0;
+    }
+
+    size_t written = 0;
+    while (written < maxLen)
+    {
+        if (m_json_pos >= m_json_len)
+        {
+            if (m_json_row > m_count + 1) {
+                break; // Kraj odgovora
+            }
+            m_json_len = (uint16_t)FormatRow(m_json_row++, m_json_line, sizeof(m_json_line));
+            m_json_pos = 0;
+            continue;
+        }
+
+        size_t len = m_json_len - m_json_pos;
+        if (len > maxLen - written) len = maxLen - written;
+        memcpy(buffer + written, m_json_line + m_json_pos, len);
+        m_json_pos += len;
+        written += len;
+    }
+    return written;
+}
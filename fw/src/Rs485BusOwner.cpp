@@ -0,0 +1,382 @@
+/**
+ ******************************************************************************
+ * @file    Rs485BusOwner.cpp
+ * @author  Gemini & [Vase Ime]
+ * @brief   Implementacija vlasnika RS485 magistrale (prioritetni red transakcija).
+ ******************************************************************************
+ */
+
+#include "Rs485BusOwner.h"
+#include "DebugConfig.h"
+
+static const char* BUS_CLASS_NAMES[BUS_PRIORITY_CLASSES] = { "http", "update", "timesync", "log_delete", "polling", "batch" };
+
+Rs485BusOwner::Rs485BusOwner() :
+    m_lane_count(0)
+{
+    memset(m_lanes, 0, sizeof(m_lanes));
+}
+
+void Rs485BusOwner::Initialize(Rs485Service* pRs485Service, Rs485Service* pRs485ServiceR)
+{
+    m_lane_count = (pRs485ServiceR != NULL) ? 2 : 1;
+
+    for (uint8_t l = 0; l < m_lane_count; l++)
+    {
+        BusLane* lane = &m_lanes[l];
+        lane->owner = this;
+        lane->index = l;
+        lane->service = (l == 0) ? pRs485Service : pRs485ServiceR;
+        portMUX_TYPE init = portMUX_INITIALIZER_UNLOCKED;
+        lane->stats_lock = init;
+
+        // Jedan red po klasi prioriteta; u redu su samo pointeri na transakcije pozivaoca
+        for (uint8_t i = 0; i < BUS_PRIORITY_CLASSES; i++)
+        {
+            lane->queues[i] = xQueueCreate(BUS_QUEUE_LENGTH, sizeof(BusTransaction*));
+        }
+        lane->work_semaphore = xSemaphoreCreateCounting(BUS_PRIORITY_CLASSES * BUS_QUEUE_LENGTH, 0);
+    }
+
+    Serial.printf("[Rs485BusOwner] Inicijalizovan (%s).\n",
+                  IsParallel() ? "2 trake - paralelni L/R" : "1 traka - dijeljeni RX");
+}
+
+void Rs485BusOwner::StartTask()
+{
+    static const char* TASK_NAMES[RS485_MAX_BUS_LANES] = { "Rs485BusOwnerTask", "Rs485BusOwnerTaskR" };
+
+    for (uint8_t l = 0; l < m_lane_count; l++)
+    {
+        xTaskCreate(
+            TaskWrapper,
+            TASK_NAMES[l],
+            BUS_OWNER_TASK_STACK,
+            &m_lanes[l],
+            BUS_OWNER_TASK_PRIORITY,
+            &m_lanes[l].task_handle
+        );
+    }
+}
+
+void Rs485BusOwner::TaskWrapper(void* pvParameters)
+{
+    BusLane* lane = static_cast<BusLane*>(pvParameters);
+    lane->owner->RunTask(lane);
+}
+
+/**
+ * @brief Vraća traku koja opslužuje dati bus.
+ * @details Sa dijeljenim RX-om sve ide na traku 0; RS485_BUS_CURRENT u paralelnom
+ *          modu ide na Lijevi bus.
+ */
+BusLane* Rs485BusOwner::GetLaneForBus(uint8_t bus_id)
+{
+    if (m_lane_count > 1 && bus_id == 1)
+    {
+        return &m_lanes[1];
+    }
+    return &m_lanes[0];
+}
+
+bool Rs485BusOwner::Submit(BusTransaction* txn)
+{
+    uint8_t cls = (uint8_t)txn->priority;
+    BusLane* lane = GetLaneForBus(txn->bus_id);
+    if (cls >= BUS_PRIORITY_CLASSES || lane->queues[cls] == NULL)
+    {
+        txn->status = BusTxnStatus::REJECTED;
+        return false;
+    }
+
+    txn->status = BusTxnStatus::PENDING;
+    txn->rx_length = 0;
+    txn->rtt_us = 0;
+    txn->enqueue_time_us = (uint32_t)micros();
+
+    BusClassStats* stats = &lane->stats[cls];
+    if (xQueueSend(lane->queues[cls], &txn, 0) != pdTRUE)
+    {
+        portENTER_CRITICAL(&lane->stats_lock);
+        stats->rejected++;
+        portEXIT_CRITICAL(&lane->stats_lock);
+        txn->status = BusTxnStatus::REJECTED;
+        LOG_DEBUG(2, "[Rs485BusOwner] Red '%s' (traka %d) je pun - transakcija odbijena.\n", BUS_CLASS_NAMES[cls], lane->index);
+        return false;
+    }
+
+    // KRITIČNO: Submit() zovu HTTP, poller, LogWriter... - bez lock-a se inkrementi gube
+    uint16_t depth = (uint16_t)uxQueueMessagesWaiting(lane->queues[cls]);
+    portENTER_CRITICAL(&lane->stats_lock);
+    stats->submitted++;
+    if (depth > stats->max_depth)
+    {
+        stats->max_depth = depth;
+    }
+    portEXIT_CRITICAL(&lane->stats_lock);
+
+    xSemaphoreGive(lane->work_semaphore);
+    return true;
+}
+
+bool Rs485BusOwner::Submit(BusTransaction* txn, BusPriority priority, uint8_t bus_id,
+                           const uint8_t* tx_data, uint16_t tx_length,
+                           uint8_t* rx_buffer, uint16_t rx_size,
+                           uint32_t timeout_ms, bool single_byte_mode)
+{
+    txn->priority = priority;
+    txn->bus_id = bus_id;
+    txn->tx_data = tx_data;
+    txn->tx_length = tx_length;
+    txn->rx_buffer = rx_buffer;
+    txn->rx_size = rx_size;
+    txn->response_timeout_ms = timeout_ms;
+    txn->single_byte_mode = single_byte_mode;
+    txn->notify_task = xTaskGetCurrentTaskHandle();
+    txn->on_complete = NULL;
+    txn->context = NULL;
+
+    return Submit(txn);
+}
+
+BusTxnStatus Rs485BusOwner::SubmitAndWait(BusTransaction* txn)
+{
+    txn->notify_task = xTaskGetCurrentTaskHandle();
+    if (Submit(txn))
+    {
+        WaitForResult(txn);
+    }
+    return txn->status;
+}
+
+int Rs485BusOwner::WaitForResult(BusTransaction* txn)
+{
+    // Notifikacija može biti zaostala od ranije asinhrone transakcije istog zadatka,
+    // zato se uvijek provjerava status a ne samo prijem notifikacije.
+    while (txn->status == BusTxnStatus::PENDING)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+
+    switch (txn->status)
+    {
+    case BusTxnStatus::DONE:
+        return txn->rx_length;
+    case BusTxnStatus::TIMEOUT:
+        return 0;
+    default:
+        return -1;
+    }
+}
+
+int Rs485BusOwner::Transact(BusPriority priority, uint8_t bus_id,
+                            const uint8_t* tx_data, uint16_t tx_length,
+                            uint8_t* rx_buffer, uint16_t rx_size,
+                            uint32_t timeout_ms, bool single_byte_mode)
+{
+    BusTransaction txn;
+    Submit(&txn, priority, bus_id, tx_data, tx_length, rx_buffer, rx_size, timeout_ms, single_byte_mode);
+    return WaitForResult(&txn);
+}
+
+void Rs485BusOwner::RunTask(BusLane* lane)
+{
+    LOG_DEBUG(5, "[Rs485BusOwner] Entering RunTask() (traka %d)...\n", lane->index);
+
+    while (true)
+    {
+        // Spavaj dok bilo koji red ove trake ne dobije transakciju
+        if (xSemaphoreTake(lane->work_semaphore, portMAX_DELAY) != pdTRUE)
+        {
+            continue;
+        }
+
+        // Uvijek uzmi transakciju iz reda najvišeg prioriteta
+        BusTransaction* txn = NULL;
+        for (uint8_t i = 0; i < BUS_PRIORITY_CLASSES; i++)
+        {
+            if (xQueueReceive(lane->queues[i], &txn, 0) == pdTRUE)
+            {
+                break;
+            }
+        }
+
+        if (txn != NULL)
+        {
+            Execute(lane, txn);
+        }
+    }
+}
+
+/**
+ * @brief Izvršava jednu transakciju: izbor bus-a, slanje, (opciono) prijem.
+ */
+void Rs485BusOwner::Execute(BusLane* lane, BusTransaction* txn)
+{
+    uint8_t cls = (uint8_t)txn->priority;
+    uint32_t wait_us = (uint32_t)micros() - txn->enqueue_time_us;
+    BusClassStats* stats = &lane->stats[cls];
+    Rs485Service* service = lane->service;
+
+    portENTER_CRITICAL(&lane->stats_lock);
+    stats->total_wait_us += wait_us;
+    if (wait_us > stats->max_wait_us)
+    {
+        stats->max_wait_us = wait_us;
+    }
+    portEXIT_CRITICAL(&lane->stats_lock);
+
+    // Zastarjela transakcija (npr. polling iza dugog HTTP niza) se ne šalje
+    uint32_t deadline_ms = GetClassDeadlineMs(cls);
+    if (deadline_ms > 0 && wait_us > deadline_ms * 1000UL)
+    {
+        portENTER_CRITICAL(&lane->stats_lock);
+        stats->expired++;
+        portEXIT_CRITICAL(&lane->stats_lock);
+        LOG_DEBUG(3, "[Rs485BusOwner] Transakcija '%s' istekla u redu (%lu us).\n", BUS_CLASS_NAMES[cls], (unsigned long)wait_us);
+        Complete(txn, BusTxnStatus::EXPIRED);
+        return;
+    }
+
+    // Minimalni razmak između kraja prethodnog i početka novog okvira
+    unsigned long since_last = millis() - lane->last_txn_end_time;
+    if (since_last < RX2TX_DEL_MS)
+    {
+        vTaskDelay(pdMS_TO_TICKS(RX2TX_DEL_MS - since_last));
+    }
+
+    // Izbor busa preko DE pinova postoji samo sa dijeljenim RX-om
+    if (!IsParallel() && txn->bus_id != RS485_BUS_CURRENT)
+    {
+        service->SelectBus(txn->bus_id);
+    }
+
+    if (txn->single_byte_mode != service->IsSingleByteMode())
+    {
+        if (txn->single_byte_mode)
+        {
+            service->EnableSingleByteMode();
+        }
+        else
+        {
+            service->DisableSingleByteMode();
+        }
+    }
+
+    BusTxnStatus status = BusTxnStatus::DONE;
+
+    if (!service->SendPacket(txn->tx_data, txn->tx_length))
+    {
+        status = BusTxnStatus::SEND_FAILED;
+    }
+    else if (txn->rx_buffer != NULL && txn->response_timeout_ms > 0)
+    {
+        uint32_t tx_done_us = (uint32_t)micros();
+        int len = service->ReceivePacket(txn->rx_buffer, txn->rx_size, txn->response_timeout_ms);
+        if (len > 0)
+        {
+            txn->rx_length = len;
+            txn->rtt_us = (uint32_t)micros() - tx_done_us; // Uzorak za RttEstimator
+        }
+        else if (len == 0)
+        {
+            status = BusTxnStatus::TIMEOUT;
+        }
+        else
+        {
+            status = BusTxnStatus::RX_ERROR;
+        }
+    }
+
+    lane->last_txn_end_time = millis();
+    portENTER_CRITICAL(&lane->stats_lock);
+    stats->completed++;
+    portEXIT_CRITICAL(&lane->stats_lock);
+    Complete(txn, status);
+}
+
+void Rs485BusOwner::Complete(BusTransaction* txn, BusTxnStatus status)
+{
+    // KRITIČNO: notify_task i on_complete se čitaju prije upisa statusa - nakon upisa pozivaoc
+    // smije osloboditi/ponovo iskoristiti strukturu.
+    TaskHandle_t notify_task = txn->notify_task;
+    BusTxnCallback on_complete = txn->on_complete;
+    void* context = txn->context;
+    __sync_synchronize();
+    txn->status = status;
+    if (notify_task != NULL)
+    {
+        xTaskNotifyGive(notify_task);
+    }
+    if (on_complete != NULL)
+    {
+        on_complete(context);
+    }
+}
+
+uint32_t Rs485BusOwner::GetClassDeadlineMs(uint8_t priority_class)
+{
+    switch ((BusPriority)priority_class)
+    {
+    case BusPriority::HTTP:      return BUS_DEADLINE_HTTP_MS;
+    case BusPriority::UPDATE:    return BUS_DEADLINE_UPDATE_MS;
+    case BusPriority::TIME_SYNC: return BUS_DEADLINE_TIMESYNC_MS;
+    case BusPriority::LOG_DELETE: return BUS_DEADLINE_LOG_DELETE_MS;
+    case BusPriority::POLLING:   return BUS_DEADLINE_POLLING_MS;
+    case BusPriority::BATCH:     return BUS_DEADLINE_BATCH_MS;
+    default:                     return 0;
+    }
+}
+
+String Rs485BusOwner::GetStatsJson()
+{
+    String json = "{\"parallel\":";
+    json += IsParallel() ? "true" : "false";
+    json += ",\"lanes\":[";
+    for (uint8_t l = 0; l < m_lane_count; l++)
+    {
+        if (l > 0) json += ",";
+        json += GetLaneStatsJson(&m_lanes[l]);
+    }
+    json += "]}";
+    return json;
+}
+
+String Rs485BusOwner::GetLaneStatsJson(BusLane* lane)
+{
+    String json = "{";
+    for (uint8_t i = 0; i < BUS_PRIORITY_CLASSES; i++)
+    {
+        // Kopija pod lock-om - JSON se gradi van kritične sekcije
+        portENTER_CRITICAL(&lane->stats_lock);
+        BusClassStats s = lane->stats[i];
+        portEXIT_CRITICAL(&lane->stats_lock);
+        uint32_t depth = (lane->queues[i] != NULL) ? (uint32_t)uxQueueMessagesWaiting(lane->queues[i]) : 0;
+        uint32_t executed = s.completed + s.expired;
+        uint32_t avg_wait = (executed > 0) ? (uint32_t)(s.total_wait_us / executed) : 0;
+
+        if (i > 0) json += ",";
+        json += "\"" + String(BUS_CLASS_NAMES[i]) + "\":{";
+        json += "\"depth\":" + String(depth) + ",";
+        json += "\"max_depth\":" + String(s.max_depth) + ",";
+        json += "\"submitted\":" + String(s.submitted) + ",";
+        json += "\"completed\":" + String(s.completed) + ",";
+        json += "\"expired\":" + String(s.expired) + ",";
+        json += "\"rejected\":" + String(s.rejected) + ",";
+        json += "\"avg_wait_us\":" + String(avg_wait) + ",";
+        json += "\"max_wait_us\":" + String(s.max_wait_us);
+        json += "}";
+    }
+
+    // NOVO: Turnaround overhead slanja (softverski DE vs. RS485 half-duplex)
+    const Rs485TxStats& tx = lane->service->GetTxStats();
+    uint32_t avg_overhead = (tx.frames > 0) ? (uint32_t)(tx.total_overhead_us / tx.frames) : 0;
+    json += ",\"tx\":{";
+    json += "\"hw_de\":" + String(lane->service->IsHwDeControl() ? "true" : "false") + ",";
+    json += "\"frames\":" + String(tx.frames) + ",";
+    json += "\"avg_overhead_us\":" + String(avg_overhead) + ",";
+    json += "\"max_overhead_us\":" + String(tx.max_overhead_us);
+    json += "}";
+    json += "}";
+    return json;
+}
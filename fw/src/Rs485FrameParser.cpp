@@ -0,0 +1,125 @@
+/**
+ ******************************************************************************
+ * @file    Rs485FrameParser.cpp
+ * @author  Gemini & [Vase Ime]
+ * @brief   Implementacija inkrementalnog parsera RS485 okvira.
+ ******************************************************************************
+ */
+
+#include "Rs485FrameParser.h"
+
+Rs485FrameParser::Rs485FrameParser() :
+    m_rx_count(0),
+    m_expected_length(0),
+    m_local_address(0),
+    m_single_byte_mode(false),
+    m_frame_done(false),
+    m_last_error(FrameError::NONE)
+{
+}
+
+void Rs485FrameParser::Reset()
+{
+    m_rx_count = 0;
+    m_expected_length = 0;
+    m_frame_done = false;
+}
+
+FrameStatus Rs485FrameParser::Feed(uint8_t byte)
+{
+    // Prethodni okvir je završen (uspješno ili ne) - počinjemo novi
+    if (m_frame_done)
+    {
+        Reset();
+    }
+
+    // =============================================================================
+    // WORKAROUND: Ignoriši null bajtove na početku (HIGH-Z artifact od voltage divider-a)
+    // TODO HARDVER: Dodati 10kΩ pull-up otpornik između GPIO34 i 3.3V
+    // =============================================================================
+    if (m_rx_count == 0 && byte == 0x00)
+    {
+        return FrameStatus::INCOMPLETE;
+    }
+
+    m_buffer[m_rx_count++] = byte;
+
+    // Single-byte ACK/NAK za STARI protokol - ovo JE kompletan validni odgovor
+    if (m_single_byte_mode && m_rx_count == 1 && (byte == ACK || byte == NAK))
+    {
+        m_frame_done = true;
+        m_last_error = FrameError::NONE;
+        return FrameStatus::FRAME_READY;
+    }
+
+    // KORAK 1: Nakon 6 bajtova znamo očekivanu dužinu okvira
+    if (m_rx_count == 6)
+    {
+        m_expected_length = m_buffer[5] + 9; // payload + header + checksum + EOT
+
+        if (m_expected_length < 10 || m_expected_length > sizeof(m_buffer))
+        {
+            m_frame_done = true;
+            m_last_error = FrameError::BAD_LENGTH;
+            return FrameStatus::FRAME_ERROR;
+        }
+    }
+
+    // KORAK 2: Čekamo da stignu svi bajtovi
+    if (m_expected_length == 0 || m_rx_count < m_expected_length)
+    {
+        return FrameStatus::INCOMPLETE;
+    }
+
+    // KORAK 3: Kompletan okvir - validiraj ga
+    m_frame_done = true;
+    if (!ValidateFrame())
+    {
+        return FrameStatus::FRAME_ERROR;
+    }
+
+    m_last_error = FrameError::NONE;
+    return FrameStatus::FRAME_READY;
+}
+
+/**
+ * @brief Validira SOH/STX/ACK/NAK, EOT, ciljnu adresu i checksum (logika iz hotel_ctrl.c).
+ */
+bool Rs485FrameParser::ValidateFrame()
+{
+    uint8_t start = m_buffer[0];
+    if (start != SOH && start != STX && start != ACK && start != NAK)
+    {
+        m_last_error = FrameError::BAD_START;
+        return false;
+    }
+
+    if (m_buffer[m_rx_count - 1] != EOT)
+    {
+        m_last_error = FrameError::MISSING_EOT;
+        return false;
+    }
+
+    uint16_t target_addr = (m_buffer[1] << 8) | m_buffer[2];
+    if (target_addr != m_local_address)
+    {
+        m_last_error = FrameError::WRONG_TARGET;
+        return false;
+    }
+
+    uint16_t data_length = m_buffer[5];
+    uint16_t calculated_checksum = 0;
+    for (uint16_t i = 6; i < (6 + data_length); i++)
+    {
+        calculated_checksum += m_buffer[i];
+    }
+    uint16_t received_checksum = (m_buffer[m_rx_count - 3] << 8) | m_buffer[m_rx_count - 2];
+
+    if (received_checksum != calculated_checksum)
+    {
+        m_last_error = FrameError::BAD_CHECKSUM;
+        return false;
+    }
+
+    return true;
+}
@@ -10,12 +10,20 @@
 #include "DebugConfig.h"   // Uključujemo za LOG_RS485
 #include "ProjectConfig.h" 
 #include "EepromStorage.h" // Za g_appConfig
+#include "Rs485Trace.h"
 
 // Globalna konfiguracija (treba biti ucitana u EepromStorage::Initialize)
 extern AppConfig g_appConfig;
 
-Rs485Service::Rs485Service() : m_rs485_serial(2) // Koristi UART2 (Serial2)
+Rs485Service::Rs485Service() :
+    m_uart_num((uart_port_t)RS485_UART_NUM),
+    m_uart_event_queue(NULL),
+    m_last_rx_time(0),
+    m_de_pin(RS485_DE_PIN1),
+    m_dedicated(false),
+    m_hw_de_control(RS485_HW_DE_CONTROL != 0)
 {
+    memset(&m_tx_stats, 0, sizeof(m_tx_stats));
     m_single_byte_mode = false; // Default: normalni mod (za LogPullManager i ostale)
     m_active_bus = 0; // Default: Lijevi bus aktivan
 }
@@ -32,12 +40,71 @@ void Rs485Service::Initialize()
     digitalWrite(RS485_DE_PIN1, LOW);  // DE1 = LOW (RX mod, spreman za TX)
     digitalWrite(RS485_DE_PIN2, HIGH); // DE2 = HIGH (disabled, ne ometa bus)
     
-    m_rs485_serial.begin(RS485_BAUDRATE, SERIAL_8N1, RS485_RX_PIN, RS485_TX_PIN);
+    if (!InstallUartDriver(RS485_TX_PIN, RS485_RX_PIN)) {
+        return;
+    }
     
     Serial.printf("[Rs485Service] Dual DE inicijalizovan: DE1=%d, DE2=%d, Aktivan bus=%d\n", 
                   RS485_DE_PIN1, RS485_DE_PIN2, m_active_bus);
 }
 
+/**
+ * @brief Inicijalizuje servis za jedan bus na vlastitom UART-u (RS485_WIRING_DUAL_UART).
+ */
+void Rs485Service::InitializeDedicated(uint8_t bus_id, uart_port_t uart_num, int tx_pin, int rx_pin, int de_pin)
+{
+    Serial.printf("[Rs485Service] Inicijalizacija zasebnog busa %d (UART%d)...\n", bus_id, uart_num);
+
+    m_dedicated = true;
+    m_active_bus = bus_id;
+    m_uart_num = uart_num;
+    m_de_pin = de_pin;
+
+    pinMode(m_de_pin, OUTPUT);
+    digitalWrite(m_de_pin, LOW); // RX mod
+
+    if (!InstallUartDriver(tx_pin, rx_pin)) {
+        return;
+    }
+
+    Serial.printf("[Rs485Service] Bus %d: TX=%d, RX=%d, DE=%d\n", bus_id, tx_pin, rx_pin, de_pin);
+}
+
+/**
+ * @brief Instalira ESP-IDF UART drajver sa event queue-om i postavlja pinove.
+ * @return true ako je drajver uspješno instaliran.
+ */
+bool Rs485Service::InstallUartDriver(int tx_pin, int rx_pin)
+{
+    // NOVO: ESP-IDF UART drajver sa event queue-om umjesto HardwareSerial polling-a
+    uart_config_t uart_config = {};
+    uart_config.baud_rate = RS485_BAUDRATE;
+    uart_config.data_bits = UART_DATA_8_BITS;
+    uart_config.parity = UART_PARITY_DISABLE;
+    uart_config.stop_bits = UART_STOP_BITS_1;
+    uart_config.flow_ctrl = UART_HW_FLOWCTRL_DISABLE;
+    uart_config.source_clk = UART_SCLK_APB;
+
+    esp_err_t err = uart_driver_install(m_uart_num, RS485_UART_RX_BUF_SIZE, 0,
+                                        RS485_UART_EVENT_QUEUE_LEN, &m_uart_event_queue, 0);
+    if (err == ESP_OK) err = uart_param_config(m_uart_num, &uart_config);
+    // NOVO: U half-duplex modu RTS vodi DE pin aktivnog busa; hardver ga drži HIGH
+    // od prvog start bita do zadnjeg stop bita okvira.
+    int rts_pin = m_hw_de_control ? m_de_pin : UART_PIN_NO_CHANGE;
+    if (err == ESP_OK) err = uart_set_pin(m_uart_num, tx_pin, rx_pin, rts_pin, UART_PIN_NO_CHANGE);
+    if (err == ESP_OK && m_hw_de_control) err = uart_set_mode(m_uart_num, UART_MODE_RS485_HALF_DUPLEX);
+    // RX timeout nakon N "tihih" znakova = kraj okvira -> UART_DATA event.
+    // NAPOMENA: EOT pattern-detect se NE koristi jer se 0x04 legalno pojavljuje
+    // unutar binarnih podataka (checksum, log zapisi); okvir se određuje dužinom.
+    if (err == ESP_OK) err = uart_set_rx_timeout(m_uart_num, RS485_RX_IDLE_SYMBOLS);
+
+    if (err != ESP_OK) {
+        Serial.printf("[Rs485Service] GRESKA: UART drajver nije instaliran (%s)\n", esp_err_to_name(err));
+        return false;
+    }
+    return true;
+}
+
 /**
  * @brief Aktivira single-byte ACK/NAK mod za STARI protokol.
  * @note Koristi UpdateManager za transfer fajlova sa STARIM protokolom.
@@ -45,7 +112,8 @@ void Rs485Service::Initialize()
 void Rs485Service::EnableSingleByteMode()
 {
     m_single_byte_mode = true;
-    Serial.println(F("[Rs485Service] Single-byte mod AKTIVIRAN (STARI protokol)"));
+    // Vlasnik magistrale mijenja mod po transakciji - ispis samo na detaljnom nivou
+    LOG_DEBUG(4, "[Rs485Service] Single-byte mod AKTIVIRAN (STARI protokol)\n");
 }
 
 /**
@@ -55,199 +123,239 @@ void Rs485Service::EnableSingleByteMode()
 void Rs485Service::DisableSingleByteMode()
 {
     m_single_byte_mode = false;
-    Serial.println(F("[Rs485Service] Single-byte mod DEAKTIVIRAN (normalni rad)"));
+    LOG_DEBUG(4, "[Rs485Service] Single-byte mod DEAKTIVIRAN (normalni rad)\n");
 }
 
 /**
- * @brief Izračunava Checksum na Data Polju paketa (počinje od indeksa 6).
+ * @brief Ispisuje razlog zbog kojeg je parser odbacio okvir.
  */
-uint16_t Rs485Service::CalculateChecksum(uint8_t* buffer, uint16_t data_length)
+void Rs485Service::LogFrameError()
 {
-    uint16_t checksum = 0;
-    for (uint16_t i = 6; i < (6 + data_length); i++) 
+    switch (m_parser.GetLastError())
     {
-        checksum += buffer[i]; 
+        case FrameError::BAD_LENGTH:
+            LOG_DEBUG(2, "[Rs485] Primljena nevalidna dužina paketa: %d. Resetujem prijem.\n", m_parser.GetFrame()[5]);
+            break;
+        case FrameError::BAD_START:
+            LOG_DEBUG(2, "[Rs485] ValidatePacket -> FAILED (Pogrešan početni bajt: 0x%02X)\n", m_parser.GetFrame()[0]);
+            break;
+        case FrameError::MISSING_EOT:
+            LOG_DEBUG(2, "[Rs485] ValidatePacket -> FAILED (Nedostaje EOT)\n");
+            break;
+        case FrameError::WRONG_TARGET:
+            LOG_DEBUG(4, "[Rs485] ValidatePacket -> INFO (Paket za drugog: 0x%02X%02X != 0x%04X)\n",
+                      m_parser.GetFrame()[1], m_parser.GetFrame()[2], g_appConfig.rs485_iface_addr);
+            break;
+        case FrameError::BAD_CHECKSUM:
+            LOG_DEBUG(2, "[Rs485] ValidatePacket -> FAILED (Checksum neispravan)\n");
+            break;
+        default:
+            break;
     }
-    return checksum;
 }
 
-/**
- * @brief Validira SOH/STX, Adrese, Dužinu i Checksum paketa. (Replicira logiku iz hotel_ctrl.c)
- */
-bool Rs485Service::ValidatePacket(uint8_t* buffer, uint16_t length)
+int Rs485Service::DrainRxBuffer(uint8_t* buffer, uint16_t buffer_size, uint16_t* bytes_consumed)
 {
-    // Minimalna dužina paketa je 10 bajtova
-    if (length < 10) { // Svi paketi, uključujući ACK/NAK odgovore, imaju minimalnu dužinu
-        LOG_DEBUG(2, "[Rs485] ValidatePacket -> FAILED (Prekratak paket: %d)\n", length);
-        return false;
-    }
+    uint8_t chunk[64];
+    size_t buffered = 0;
+    *bytes_consumed = 0;
 
-    uint16_t data_length = buffer[5];
-    uint16_t expectedLength = data_length + 9; 
+    uart_get_buffered_data_len(m_uart_num, &buffered);
+    while (buffered > 0)
+    {
+        int to_read = (buffered > sizeof(chunk)) ? sizeof(chunk) : buffered;
+        int read = uart_read_bytes(m_uart_num, chunk, to_read, 0);
+        if (read <= 0) break;
+        buffered -= read;
+        *bytes_consumed += read;
+        m_last_rx_time = millis();
 
-    if (length != expectedLength) { // Provjera konzistentnosti dužine
-        LOG_DEBUG(2, "[Rs485] ValidatePacket -> FAILED (Pogrešna dužina. Očekivano: %d, Primljeno: %d)\n", expectedLength, length);
-        return false;
-    }
-    
-    // 1. Provjera početnog i krajnjeg bajta (SOH/STX/ACK/NAK i EOT)
-    // Ovo je ključna ispravka koja prihvata ACK kao validan početak.
-    bool is_valid_start = (buffer[0] == SOH || buffer[0] == STX || buffer[0] == ACK || buffer[0] == NAK);
-    if (!is_valid_start) {
-        LOG_DEBUG(2, "[Rs485] ValidatePacket -> FAILED (Pogrešan početni bajt: 0x%02X)\n", buffer[0]);
-        return false;
-    }
-    if (buffer[length - 1] != EOT) { // Svi paketi se moraju završiti sa EOT
-        LOG_DEBUG(2, "[Rs485] ValidatePacket -> FAILED (Nedostaje EOT)\n");
-        return false;
-    }
+        for (int i = 0; i < read; i++)
+        {
+            FrameStatus status = m_parser.Feed(chunk[i]);
+            if (status == FrameStatus::INCOMPLETE) continue;
 
-    // 2. Provjera Adrese Cilja (Target Address) - mora biti naša adresa (rsifa)
-    uint16_t target_addr = (buffer[1] << 8) | buffer[2];
-    uint16_t my_addr = g_appConfig.rs485_iface_addr;
-    
-    if (target_addr != my_addr) { // Paket mora biti adresiran na nas
-        LOG_DEBUG(4, "[Rs485] ValidatePacket -> INFO (Paket za drugog: 0x%04X != 0x%04X)\n", target_addr, my_addr);
-        return false;
+            uint16_t frame_len = m_parser.GetLength();
+            if (status == FrameStatus::FRAME_ERROR)
+            {
+                g_rs485Trace.Record(m_active_bus, Rs485TraceDir::RX_ERROR, m_parser.GetFrame(), frame_len);
+                LogFrameError();
+                continue; // Odbaci okvir i čekaj novi od početka
+            }
+
+            // NOVO: Okvir ide u binarni trace; hex ispis na Serial je opcion (RS485_SERIAL_TRACE)
+            g_rs485Trace.Record(m_active_bus, Rs485TraceDir::RX, m_parser.GetFrame(), frame_len);
+#if RS485_SERIAL_TRACE
+            if (frame_len == 1) {
+                Serial.printf("[Rs485Service] -> Single-byte primljen: 0x%02X (%s)\n", 
+                              m_parser.GetFrame()[0], m_parser.GetFrame()[0] == ACK ? "ACK" : "NAK");
+            } else {
+                char response_packet_str[MAX_PACKET_LENGTH * 3 + 1];
+                Rs485Trace::FormatHex(m_parser.GetFrame(), frame_len, response_packet_str, sizeof(response_packet_str));
+                Serial.printf("[Rs485] -> RAW Prijem (kompletan paket) u %lu ms (%d B): [ %s]\n", millis(), frame_len, response_packet_str);
+            }
+#endif
+
+            if (frame_len > buffer_size) {
+                return -1;
+            }
+            memcpy(buffer, m_parser.GetFrame(), frame_len);
+            return frame_len; // Uspjeh! Ostatak (ako postoji) se odbacuje u SendPacket()
+        }
     }
+    return 0;
+}
 
-    // 3. Provjera Checksum-a
-    uint16_t received_checksum = (buffer[expectedLength - 3] << 8) | buffer[expectedLength - 2];
-    uint16_t calculated_checksum = CalculateChecksum(buffer, data_length);
-    
-    if (received_checksum != calculated_checksum) {
-        LOG_DEBUG(2, "[Rs485] ValidatePacket -> FAILED (Checksum neispravan. Primljen: 0x%X, Očekivan: 0x%X)\n", received_checksum, calculated_checksum);
-        return false;
+/**
+ * @brief Obrađuje evente koji su se nakupili u UART queue-u (bez čekanja).
+ * @details UART_DATA eventi samo signaliziraju da ima bajtova; overflow
+ *          zahtijeva reset drajvera i parsera.
+ */
+void Rs485Service::ProcessPendingEvents()
+{
+    uart_event_t event;
+    while (xQueueReceive(m_uart_event_queue, &event, 0) == pdTRUE)
+    {
+        if (event.type == UART_FIFO_OVF || event.type == UART_BUFFER_FULL) {
+            LOG_DEBUG(2, "[Rs485] RX overflow (event %d). Resetujem prijem.\n", event.type);
+            uart_flush_input(m_uart_num);
+            xQueueReset(m_uart_event_queue);
+            m_parser.Reset();
+            return;
+        }
     }
-    
-    return true;
 }
 
-int Rs485Service::ReceivePacket(uint8_t* buffer, uint16_t buffer_size, uint32_t timeout_ms)
+void Rs485Service::BeginReceive()
 {
-    unsigned long start_time = millis();
-    uint16_t rx_count = 0;
-    uint16_t expected_length = 0; // Očekivana ukupna dužina paketa
+    m_parser.SetLocalAddress(g_appConfig.rs485_iface_addr);
+    m_parser.SetSingleByteMode(m_single_byte_mode);
+    m_parser.Reset();
+}
 
-    while (millis() - start_time < timeout_ms)
-    {
-        if (m_rs485_serial.available())
-        {
-            uint8_t incoming_byte = m_rs485_serial.read();
-            
-            // =============================================================================
-            // WORKAROUND: Ignoriši null bajtove na početku (HIGH-Z artifact od voltage divider-a)
-            // Uzrok: DE=LOW drži RO pin u HIGH-Z, voltage divider vuče liniju prema GND
-            // TODO HARDVER: Dodati 10kΩ pull-up otpornik između GPIO34 i 3.3V
-            // =============================================================================
-            if (rx_count == 0 && incoming_byte == 0x00)
-            {
-                continue; // Preskoči null bajtove dok ne stigne pravi paket
-            }
-            
-            // Osiguraj da ne pređemo veličinu bafera
-            if (rx_count >= buffer_size)
-            {
-                return -1;
-            }
+int Rs485Service::PollPacket(uint8_t* buffer, uint16_t buffer_size)
+{
+    uint16_t consumed = 0;
+    ProcessPendingEvents();
+    return DrainRxBuffer(buffer, buffer_size, &consumed);
+}
 
-            buffer[rx_count++] = incoming_byte;
+void Rs485Service::WaitForRxEvent(TickType_t max_wait)
+{
+    uart_event_t event;
+    xQueuePeek(m_uart_event_queue, &event, max_wait);
+}
 
-            // =============================================================================
-            // KRITIČNA PROVJERA: SINGLE-BYTE MODE ZA STARI PROTOKOL (UpdateManager)
-            // Ako je m_single_byte_mode aktivan I primi se ACK ili NAK kao prvi bajt,
-            // to JE kompletan odgovor - vrati ga odmah bez čekanja!
-            // =============================================================================
-            if (m_single_byte_mode && rx_count == 1 && (buffer[0] == ACK || buffer[0] == NAK))
-            {
-                // Single-byte ACK/NAK za STARI protokol - ovo JE kompletan validni odgovor
-                Serial.printf("[Rs485Service] -> Single-byte primljen: 0x%02X (%s)\n", 
-                              buffer[0], buffer[0] == ACK ? "ACK" : "NAK");
-                return 1; // Vrati 1 bajt kao uspješan prijem
-            }
+int Rs485Service::ReceivePacket(uint8_t* buffer, uint16_t buffer_size, uint32_t timeout_ms)
+{
+    BeginReceive();
 
-            // KORAK 1: Čekamo minimalno 6 bajtova da bismo pročitali dužinu
-            // KONAČNA ISPRAVKA: Resetujemo start_time sa svakim primljenim bajtom.
-            // Ovo osigurava da timeout mjeri vrijeme *između* bajtova, a ne od početka poziva.
-            start_time = millis();
-            if (rx_count == 6)
-            {
-                uint8_t data_length = buffer[5];
-                expected_length = data_length + 9; // payload + header + checksum + EOT
-
-                // Provjera da li je očekivana dužina uopšte validna
-                if (expected_length < 10 || expected_length > buffer_size)
-                {
-                    LOG_DEBUG(2, "[Rs485] Primljena nevalidna dužina paketa: %d. Resetujem prijem.\n", data_length);
-                    rx_count = 0; // Resetuj i čekaj novi paket
-                    expected_length = 0;
-                    continue;
-                }
-            }
-            
-            // KORAK 2: Ako znamo očekivanu dužinu, čekamo da stignu svi bajtovi
-            if (expected_length > 0 && rx_count == expected_length)
-            {
-                // KORAK 3: Imamo kompletan paket. Ispiši ga prije validacije.
-                // Ovo je ispunjenje zahtjeva da se vidi sve što stigne.
-                if (rx_count > 0) {
-                    char response_packet_str[rx_count * 3 + 1];
-                    response_packet_str[0] = '\0';
-                    for (int i = 0; i < rx_count; i++) {
-                        sprintf(response_packet_str + strlen(response_packet_str), "%02X ", buffer[i]);
-                    }
-                    Serial.printf("[Rs485] -> RAW Prijem (kompletan paket) u %lu ms (%d B): [ %s]\n", millis(), rx_count, response_packet_str);
-                }
-
-                // KORAK 4: Tek sada validiraj paket.
-                if (ValidatePacket(buffer, rx_count))
-                {
-                    return rx_count; // Uspjeh! Vrati primljeni paket.
-                }
-                else
-                {
-                    // Paket je neispravan. Resetuj sve i čekaj novi od početka.
-                    rx_count = 0;
-                    expected_length = 0;
-                }
-            }
+    TickType_t timeout_ticks = pdMS_TO_TICKS(timeout_ms);
+    TickType_t start_tick = xTaskGetTickCount();
+
+    while (true)
+    {
+        // Bajtovi su možda stigli prije poziva - prvo isprazni RX buffer drajvera
+        uint16_t consumed = 0;
+        ProcessPendingEvents();
+        int result = DrainRxBuffer(buffer, buffer_size, &consumed);
+        if (result != 0) {
+            return result;
         }
-    }
 
-    // KONAČNA ISPRAVKA: Ako je timeout istekao, a primili smo neke bajtove, ispiši ih.
-    // Ovo je ključno za dijagnostiku nekompletnih/oštećenih paketa.
-    if (rx_count > 0) {
-        char incomplete_packet_str[rx_count * 3 + 1];
-        incomplete_packet_str[0] = '\0';
-        for (int i = 0; i < rx_count; i++) {
-            sprintf(incomplete_packet_str + strlen(incomplete_packet_str), "%02X ", buffer[i]);
+        // Timeout mjeri vrijeme *između* bajtova, a ne od početka poziva
+        if (consumed > 0) {
+            start_tick = xTaskGetTickCount();
         }
-        Serial.printf("[Rs485] TIMEOUT! Primljen nekompletan/oštećen paket (%d B): [ %s]\n", rx_count, incomplete_packet_str);
+
+        TickType_t elapsed = xTaskGetTickCount() - start_tick;
+        if (elapsed >= timeout_ticks) {
+            break;
+        }
+
+        // Zadatak spava dok UART ne prijavi RX timeout (kraj okvira) ili pun FIFO
+        WaitForRxEvent(timeout_ticks - elapsed);
     }
 
+    // Ako je timeout istekao, a primili smo neke bajtove, ispiši ih (dijagnostika).
+    LogIncompleteFrame();
+
     return 0; // Vraća 0 za timeout
 }
 
+/**
+ * @brief Ispisuje djelimično primljen okvir nakon isteka timeout-a.
+ */
+void Rs485Service::LogIncompleteFrame()
+{
+    if (!m_parser.IsInProgress()) {
+        return;
+    }
+    uint16_t rx_count = m_parser.GetLength();
+    g_rs485Trace.Record(m_active_bus, Rs485TraceDir::RX_PARTIAL, m_parser.GetFrame(), rx_count);
+#if RS485_SERIAL_TRACE
+    char incomplete_packet_str[MAX_PACKET_LENGTH * 3 + 1];
+    Rs485Trace::FormatHex(m_parser.GetFrame(), rx_count, incomplete_packet_str, sizeof(incomplete_packet_str));
+    Serial.printf("[Rs485] TIMEOUT! Primljen nekompletan/oštećen paket (%d B): [ %s]\n", rx_count, incomplete_packet_str);
+#else
+    LOG_DEBUG(3, "[Rs485] TIMEOUT! Primljen nekompletan/oštećen paket (%d B) - vidi /rs485_trace\n", rx_count);
+#endif
+}
+
 bool Rs485Service::SendPacket(const uint8_t* data, uint16_t length)
 {
-    // Isprazni prijemni bafer prije slanja
-    while(m_rs485_serial.available()) m_rs485_serial.read();
+    // Isprazni prijemni bafer (i zaostale evente) prije slanja
+    uart_flush_input(m_uart_num);
+    xQueueReset(m_uart_event_queue);
 
     LOG_DEBUG(4, "[Rs485] Slanje paketa -> Dužina: %d, Sadržaj: %02X %02X %02X %02X %02X %02X %02X...\n", length, data[0], data[1], data[2], data[3], data[4], data[5], data[6]);
 
-    // Koristi aktivan DE pin prema trenutno odabranom busu
-    uint8_t active_de_pin = (m_active_bus == 0) ? RS485_DE_PIN1 : RS485_DE_PIN2;
-    
-    digitalWrite(active_de_pin, HIGH); 
-    delayMicroseconds(50); 
+    g_rs485Trace.Record(m_active_bus, Rs485TraceDir::TX, data, length);
 
-    m_rs485_serial.write(data, length);
-    m_rs485_serial.flush(); 
-    
-    delayMicroseconds(50);
-    digitalWrite(active_de_pin, LOW); 
+    uint32_t start_us = micros();
+    int written;
 
-    return true;
+    if (m_hw_de_control)
+    {
+        // DE podiže i spušta UART (RTS) - bez zaštitnih pauza; jedini razmak
+        // između okvira je RX2TX_DEL_MS koji provodi Rs485BusOwner.
+        written = uart_write_bytes(m_uart_num, data, length);
+        uart_wait_tx_done(m_uart_num, pdMS_TO_TICKS(RS485_TX_DONE_TIMEOUT_MS));
+    }
+    else
+    {
+        // Koristi aktivan DE pin prema trenutno odabranom busu (ili DE pin zasebnog busa)
+        uint8_t active_de_pin = m_de_pin;
+
+        digitalWrite(active_de_pin, HIGH);
+        delayMicroseconds(RS485_SW_DE_GUARD_US);
+
+        written = uart_write_bytes(m_uart_num, data, length);
+        uart_wait_tx_done(m_uart_num, pdMS_TO_TICKS(RS485_TX_DONE_TIMEOUT_MS));
+
+        delayMicroseconds(RS485_SW_DE_GUARD_US);
+        digitalWrite(active_de_pin, LOW);
+    }
+
+    UpdateTxStats(length, (uint32_t)micros() - start_us);
+
+    return (written == length);
+}
+
+/**
+ * @brief Bilježi koliko je slanje okvira trajalo duže od samog okvira na liniji.
+ */
+void Rs485Service::UpdateTxStats(uint16_t length, uint32_t elapsed_us)
+{
+    // 8N1 = 10 bita po bajtu
+    uint32_t wire_us = (uint32_t)(((uint64_t)length * 10UL * 1000000UL) / RS485_BAUDRATE);
+    uint32_t overhead_us = (elapsed_us > wire_us) ? (elapsed_us - wire_us) : 0;
+
+    m_tx_stats.frames++;
+    m_tx_stats.total_overhead_us += overhead_us;
+    if (overhead_us > m_tx_stats.max_overhead_us) {
+        m_tx_stats.max_overhead_us = overhead_us;
+    }
 }
 
 /**
@@ -265,9 +373,25 @@ void Rs485Service::SelectBus(uint8_t busId)
     if (busId == m_active_bus) {
         return; // Već je odabran, nema potrebe mjenjati
     }
+
+    // Zaseban UART opslužuje tačno jedan bus - nema DE multipleksiranja
+    if (m_dedicated) {
+        Serial.printf("[Rs485Service] ERROR: Bus %d nije dostupan na UART%d (zaseban bus %d).\n", busId, m_uart_num, m_active_bus);
+        return;
+    }
     
     m_active_bus = busId;
-    
+    uint8_t old_de_pin = m_de_pin;
+    m_de_pin = (busId == 0) ? RS485_DE_PIN1 : RS485_DE_PIN2;
+
+    if (m_hw_de_control) {
+        // RTS prelazi na DE pin novog busa; stari DE pin se vraća u GPIO mod
+        // i postavlja na HIGH ispod (neaktivan bus).
+        uart_set_pin(m_uart_num, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE, m_de_pin, UART_PIN_NO_CHANGE);
+        pinMatrixOutDetach(old_de_pin, false, false);
+        pinMode(old_de_pin, OUTPUT);
+    }
+
     if (busId == 0) {
         // Aktiviraj Lijevi bus, onemogući Desni
         digitalWrite(RS485_DE_PIN1, LOW);  // DE1 = LOW (RX mod, spreman za TX)
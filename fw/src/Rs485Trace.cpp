@@ -0,0 +1,163 @@
+/**
+ ******************************************************************************
+ * @file    Rs485Trace.cpp
+ * @author  Gemini & [Vase Ime]
+ * @brief   Implementacija binarnog trace-a RS485 okvira.
+ ******************************************************************************
+ */
+
+#include "Rs485Trace.h"
+
+// Globalni trace (pišu Rs485Service instance, čita HttpServer)
+Rs485Trace g_rs485Trace;
+
+static const char* TRACE_DIR_NAMES[] = { "TX", "RX", "RX_PART", "RX_ERR" };
+
+// pcap format (libpcap, mikrosekunde)
+#define PCAP_MAGIC          0xA1B2C3D4
+#define PCAP_LINKTYPE_USER0 147
+#define PCAP_PSEUDO_HDR_LEN 2       // [bus, smjer] ispred bajtova okvira
+
+struct PcapGlobalHeader
+{
+    uint32_t magic;
+    uint16_t version_major;
+    uint16_t version_minor;
+    int32_t thiszone;
+    uint32_t sigfigs;
+    uint32_t snaplen;
+    uint32_t network;
+};
+
+struct PcapRecordHeader
+{
+    uint32_t ts_sec;
+    uint32_t ts_usec;
+    uint32_t incl_len;
+    uint32_t orig_len;
+};
+
+Rs485Trace::Rs485Trace() :
+    m_next_seq(1)
+{
+    memset(m_entries, 0, sizeof(m_entries));
+    portMUX_TYPE init = portMUX_INITIALIZER_UNLOCKED;
+    m_lock = init;
+}
+
+void Rs485Trace::Record(uint8_t bus, Rs485TraceDir dir, const uint8_t* data, uint16_t length)
+{
+    uint16_t copy_len = (length < RS485_TRACE_SNAP_LEN) ? length : RS485_TRACE_SNAP_LEN;
+    uint32_t now_us = (uint32_t)micros();
+
+    // Samo memcpy do SNAP_LEN bajtova - kritična sekcija je kratka
+    portENTER_CRITICAL(&m_lock);
+    uint32_t seq = m_next_seq++;
+    Rs485TraceEntry* e = &m_entries[seq % RS485_TRACE_ENTRIES];
+    e->seq = seq;
+    e->timestamp_us = now_us;
+    e->bus = bus;
+    e->dir = dir;
+    e->length = length;
+    memcpy(e->data, data, copy_len);
+    portEXIT_CRITICAL(&m_lock);
+}
+
+void Rs485Trace::Clear()
+{
+    portENTER_CRITICAL(&m_lock);
+    for (uint16_t i = 0; i < RS485_TRACE_ENTRIES; i++) {
+        m_entries[i].seq = 0;
+    }
+    portEXIT_CRITICAL(&m_lock);
+}
+
+/**
+ * @brief Kopira zapis sa datim seq; false ako je u međuvremenu prepisan ili obrisan.
+ */
+bool Rs485Trace::CopyEntry(uint32_t seq, Rs485TraceEntry* out)
+{
+    bool valid;
+    portENTER_CRITICAL(&m_lock);
+    const Rs485TraceEntry* e = &m_entries[seq % RS485_TRACE_ENTRIES];
+    valid = (e->seq == seq);
+    if (valid) {
+        memcpy(out, e, sizeof(Rs485TraceEntry));
+    }
+    portEXIT_CRITICAL(&m_lock);
+    return valid;
+}
+
+void Rs485Trace::WritePcap(Print& out)
+{
+    PcapGlobalHeader gh;
+    gh.magic = PCAP_MAGIC;
+    gh.version_major = 2;
+    gh.version_minor = 4;
+    gh.thiszone = 0;
+    gh.sigfigs = 0;
+    gh.snaplen = RS485_TRACE_SNAP_LEN + PCAP_PSEUDO_HDR_LEN;
+    gh.network = PCAP_LINKTYPE_USER0;
+    out.write((const uint8_t*)&gh, sizeof(gh));
+
+    portENTER_CRITICAL(&m_lock);
+    uint32_t end_seq = m_next_seq;
+    portEXIT_CRITICAL(&m_lock);
+    uint32_t start_seq = (end_seq > RS485_TRACE_ENTRIES) ? (end_seq - RS485_TRACE_ENTRIES) : 1;
+
+    Rs485TraceEntry e;
+    for (uint32_t seq = start_seq; seq < end_seq; seq++)
+    {
+        if (!CopyEntry(seq, &e)) continue;
+
+        uint16_t copy_len = (e.length < RS485_TRACE_SNAP_LEN) ? e.length : RS485_TRACE_SNAP_LEN;
+        PcapRecordHeader rh;
+        rh.ts_sec = e.timestamp_us / 1000000UL;
+        rh.ts_usec = e.timestamp_us % 1000000UL;
+        rh.incl_len = copy_len + PCAP_PSEUDO_HDR_LEN;
+        rh.orig_len = e.length + PCAP_PSEUDO_HDR_LEN;
+
+        uint8_t pseudo_hdr[PCAP_PSEUDO_HDR_LEN] = { e.bus, (uint8_t)e.dir };
+        out.write((const uint8_t*)&rh, sizeof(rh));
+        out.write(pseudo_hdr, sizeof(pseudo_hdr));
+        out.write(e.data, copy_len);
+    }
+}
+
+void Rs485Trace::WriteText(Print& out)
+{
+    portENTER_CRITICAL(&m_lock);
+    uint32_t end_seq = m_next_seq;
+    portEXIT_CRITICAL(&m_lock);
+    uint32_t start_seq = (end_seq > RS485_TRACE_ENTRIES) ? (end_seq - RS485_TRACE_ENTRIES) : 1;
+
+    Rs485TraceEntry e;
+    char hex[RS485_TRACE_SNAP_LEN * 3 + 1];
+    for (uint32_t seq = start_seq; seq < end_seq; seq++)
+    {
+        if (!CopyEntry(seq, &e)) continue;
+
+        uint16_t copy_len = (e.length < RS485_TRACE_SNAP_LEN) ? e.length : RS485_TRACE_SNAP_LEN;
+        FormatHex(e.data, copy_len, hex, sizeof(hex));
+        out.printf("%10lu us  bus %u  %-7s %3u B: %s%s\n",
+                   (unsigned long)e.timestamp_us, e.bus, TRACE_DIR_NAMES[(uint8_t)e.dir],
+                   e.length, hex, (e.length > copy_len) ? "..." : "");
+    }
+}
+
+size_t Rs485Trace::FormatHex(const uint8_t* data, uint16_t length, char* out, size_t out_size)
+{
+    static const char HEX_DIGITS[] = "0123456789ABCDEF";
+    size_t pos = 0;
+
+    if (out_size == 0) return 0;
+
+    for (uint16_t i = 0; i < length && (pos + 3) < out_size; i++)
+    {
+        out[pos++] = HEX_DIGITS[data[i] >> 4];
+        out[pos++] = HEX_DIGITS[data[i] & 0x0F];
+        out[pos++] = ' ';
+    }
+    out[pos] = '\0';
+    return pos;
+}
@@ -0,0 +1,191 @@
+/**
+ ******************************************************************************
+ * @file    RttEstimator.cpp
+ * @author  Gemini & [Vase Ime]
+ * @brief   Implementacija RTT procjene i adaptivnog timeout-a odgovora.
+ ******************************************************************************
+ */
+
+#include "RttEstimator.h"
+
+// Globalna tabela (ažurira LogPullManager, čita HttpServer)
+RttTable g_rttTable;
+
+// Minimalna varijansa u formuli (granularnost FreeRTOS tick-a)
+#define RTT_CLOCK_GRANULARITY_US    1000
+
+// =============================================================================
+// RttEstimator
+// =============================================================================
+
+void RttEstimator::Reset()
+{
+    m_srtt_us = 0;
+    m_rttvar_us = 0;
+    m_samples = 0;
+    m_timeouts = 0;
+}
+
+void RttEstimator::AddSample(uint32_t rtt_us)
+{
+    if (m_samples == 0)
+    {
+        m_srtt_us = rtt_us;
+        m_rttvar_us = rtt_us / 2;
+    }
+    else
+    {
+        // RTTVAR = 3/4 RTTVAR + 1/4 |SRTT - R|,  SRTT = 7/8 SRTT + 1/8 R
+        int32_t err = (int32_t)rtt_us - (int32_t)m_srtt_us;
+        uint32_t abs_err = (err < 0) ? (uint32_t)(-err) : (uint32_t)err;
+        m_rttvar_us = m_rttvar_us - (m_rttvar_us >> 2) + (abs_err >> 2);
+        m_srtt_us = (uint32_t)((int32_t)m_srtt_us + (err / 8));
+    }
+
+    if (m_samples < 0xFFFF) m_samples++;
+}
+
+uint32_t RttEstimator::GetRtoMs() const
+{
+    uint32_t var_term = 4 * m_rttvar_us;
+    if (var_term < RTT_CLOCK_GRANULARITY_US) var_term = RTT_CLOCK_GRANULARITY_US;
+
+    uint32_t rto_us = m_srtt_us + var_term;
+    return (rto_us + 999) / 1000 + RTT_TIMEOUT_MARGIN_MS;
+}
+
+uint32_t RttEstimator::GetTimeoutMs(uint32_t max_ms, uint8_t attempt) const
+{
+    if (m_samples == 0) {
+        return max_ms;
+    }
+
+    uint32_t timeout = GetRtoMs();
+    if (timeout < RTT_MIN_TIMEOUT_MS) timeout = RTT_MIN_TIMEOUT_MS;
+
+    // Eksponencijalni backoff ponovljenih pokušaja
+    for (uint8_t i = 0; i < attempt && timeout < max_ms; i++) {
+        timeout *= 2;
+    }
+
+    return (timeout > max_ms) ? max_ms : timeout;
+}
+
+// =============================================================================
+// RttTable
+// =============================================================================
+
+RttTable::RttTable()
+{
+    for (uint16_t i = 0; i < RTT_TABLE_SIZE; i++) {
+        m_slots[i].address = 0;
+        m_slots[i].used = false;
+        m_slots[i].rtt.Reset();
+    }
+    portMUX_TYPE init = portMUX_INITIALIZER_UNLOCKED;
+    m_lock = init;
+}
+
+/**
+ * @brief Pronalazi (ili kreira) slot adrese. Poziva se unutar kritične sekcije.
+ * @return NULL ako adresa ne postoji (create=false) ili je tabela puna.
+ */
+RttTable::Slot* RttTable::FindSlot(uint16_t address, bool create)
+{
+    uint16_t index = address % RTT_TABLE_SIZE;
+    for (uint16_t probe = 0; probe < RTT_TABLE_SIZE; probe++)
+    {
+        Slot* slot = &m_slots[index];
+        if (!slot->used)
+        {
+            if (!create) return NULL;
+            slot->used = true;
+            slot->address = address;
+            slot->rtt.Reset();
+            return slot;
+        }
+        if (slot->address == address) {
+            return slot;
+        }
+        index = (index + 1) % RTT_TABLE_SIZE;
+    }
+    return NULL;
+}
+
+void RttTable::AddSample(uint16_t address, uint32_t rtt_us)
+{
+    portENTER_CRITICAL(&m_lock);
+    Slot* slot = FindSlot(address, true);
+    if (slot != NULL) {
+        slot->rtt.AddSample(rtt_us);
+    }
+    m_aggregate.AddSample(rtt_us);
+    portEXIT_CRITICAL(&m_lock);
+}
+
+void RttTable::AddTimeout(uint16_t address)
+{
+    portENTER_CRITICAL(&m_lock);
+    Slot* slot = FindSlot(address, true);
+    if (slot != NULL) {
+        slot->rtt.AddTimeout();
+    }
+    m_aggregate.AddTimeout();
+    portEXIT_CRITICAL(&m_lock);
+}
+
+uint32_t RttTable::GetTimeoutMs(uint16_t address, uint32_t max_ms, uint8_t attempt)
+{
+    uint32_t timeout = max_ms;
+
+    portENTER_CRITICAL(&m_lock);
+    Slot* slot = FindSlot(address, false);
+    if (slot != NULL && slot->rtt.HasSamples())
+    {
+        timeout = slot->rtt.GetTimeoutMs(max_ms, attempt);
+    }
+    else if (m_aggregate.GetSamples() >= RTT_MIN_AGGREGATE_SAMPLES)
+    {
+        // Nepoznat (ili nikad dostupan) uređaj: zbirna procjena sa rezervom
+        timeout = m_aggregate.GetTimeoutMs(max_ms / RTT_UNSEEN_FACTOR, attempt) * RTT_UNSEEN_FACTOR;
+        if (timeout > max_ms) timeout = max_ms;
+    }
+    portEXIT_CRITICAL(&m_lock);
+
+    return timeout;
+}
+
+void RttTable::WriteJson(Print& out)
+{
+    portENTER_CRITICAL(&m_lock);
+    RttEstimator aggregate = m_aggregate;
+    portEXIT_CRITICAL(&m_lock);
+
+    out.printf("{\"aggregate\":{\"srtt_us\":%lu,\"rttvar_us\":%lu,\"samples\":%u,\"timeouts\":%u},",
+               (unsigned long)aggregate.GetSrttUs(), (unsigned long)aggregate.GetRttvarUs(),
+               aggregate.GetSamples(), aggregate.GetTimeouts());
+
+    // Kompaktni redovi (do 500 uređaja) umjesto objekata po uređaju
+    out.print("\"columns\":[\"addr\",\"srtt_us\",\"rttvar_us\",\"rto_ms\",\"samples\",\"timeouts\"],\"devices\":[");
+
+    bool first = true;
+    for (uint16_t i = 0; i < RTT_TABLE_SIZE; i++)
+    {
+        // Kopija slota pod lock-om, ispis izvan kritične sekcije
+        portENTER_CRITICAL(&m_lock);
+        Slot slot = m_slots[i];
+        portEXIT_CRITICAL(&m_lock);
+
+        if (!slot.used) continue;
+
+        out.printf("%s[%u,%lu,%lu,%lu,%u,%u]", first ? "" : ",",
+                   slot.address,
+                   (unsigned long)slot.rtt.GetSrttUs(),
+                   (unsigned long)slot.rtt.GetRttvarUs(),
+                   (unsigned long)(slot.rtt.HasSamples() ? slot.rtt.GetRtoMs() : 0),
+                   slot.rtt.GetSamples(),
+                   slot.rtt.GetTimeouts());
+        first = false;
+    }
+    out.print("]}");
+}
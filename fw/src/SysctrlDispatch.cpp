@@ -0,0 +1,134 @@
+/**
+ ******************************************************************************
+ * @file    SysctrlDispatch.cpp
+ * @author  Gemini & [Vase Ime]
+ * @brief   Implementacija tabele parametara i komandi /sysctrl.cgi.
+ ******************************************************************************
+ */
+
+#include "SysctrlDispatch.h"
+
+#define SYSCTRL_KEY_NAME(id, name) name,
+
+static constexpr const char* SYSCTRL_KEY_NAMES[SK_COUNT] = { SYSCTRL_KEY_LIST(SYSCTRL_KEY_NAME) };
+
+// Provjera sortiranosti u vrijeme kompajliranja (C++11 constexpr - samo rekurzija)
+static constexpr int SysctrlStrCmp(const char* a, const char* b)
+{
+    return (*a != *b || *a == '\0') ? ((int)(unsigned char)*a - (int)(unsigned char)*b) : SysctrlStrCmp(a + 1, b + 1);
+}
+
+static constexpr bool SysctrlKeysSorted(int i)
+{
+    return (i + 1 >= SK_COUNT) ? true : (SysctrlStrCmp(SYSCTRL_KEY_NAMES[i], SYSCTRL_KEY_NAMES[i + 1]) < 0 && SysctrlKeysSorted(i + 1));
+}
+
+static_assert(SysctrlKeysSorted(0), "SYSCTRL_KEY_LIST mora biti sortiran po strcmp() redoslijedu");
+
+// Redoslijed = prioritet (isti kao u ranijem if/else lancu - prva prisutna komanda pobjeđuje)
+static const SysctrlRoute SYSCTRL_ROUTES[] =
+{
+    // --- Lokalne komande ---
+    { SysctrlCmd::SET_IP,             3, { SK_IPA, SK_SNM, SK_GWA }, NULL },
+    { SysctrlCmd::PROTO,              1, { SK_PROTO }, NULL },
+    { SysctrlCmd::PROTO_LR,           2, { SK_PROTOL, SK_PROTOR }, NULL },
+    { SysctrlCmd::SET_PROTO,          1, { SK_SET_PROTO }, NULL },
+    { SysctrlCmd::SYSID,              1, { SK_SYSID }, NULL },
+    { SysctrlCmd::MDNS_NAME,          1, { SK_MDNSNAME }, NULL },
+    { SysctrlCmd::LOGGER_EN,          1, { SK_LOGGER_EN }, NULL },
+    { SysctrlCmd::TIME_SYNC_INTERVAL, 1, { SK_TIME_SYNC_INTERVAL }, NULL },
+    { SysctrlCmd::DUAL_BUS,           1, { SK_DUAL_BUS }, NULL },
+    { SysctrlCmd::BUS_WIRING,         1, { SK_BUS_WIRING }, NULL },
+    { SysctrlCmd::SET_IFACE,          1, { SK_SET_IFACE }, NULL },
+    { SysctrlCmd::SET_ADD_SYNC,       1, { SK_SET_ADD_SYNC }, NULL },
+    { SysctrlCmd::DATE_TIME,          1, { SK_TDU }, NULL },
+    { SysctrlCmd::DATE_TIME,          1, { SK_DTSET }, NULL },
+    { SysctrlCmd::LOG,                1, { SK_LOG }, NULL },
+    { SysctrlCmd::LOG,                1, { SK_RQLOG }, NULL },
+    { SysctrlCmd::LOAD_ADDR_LIST,     1, { SK_CAD }, "load" },
+    { SysctrlCmd::HC_FW_UPDATE,       1, { SK_FWU }, NULL },
+    { SysctrlCmd::HC_FW_UPDATE,       1, { SK_HCFWU }, NULL },
+    // --- Ne-blokirajuće komande (Update) ---
+    { SysctrlCmd::RC_OLD_FW_UPDATE,   1, { SK_CUD }, NULL },
+    { SysctrlCmd::RC_FW_UPDATE,       2, { SK_FUF, SK_FUL }, NULL },
+    { SysctrlCmd::RC_BL_UPDATE,       2, { SK_BUF, SK_BUL }, NULL },
+    { SysctrlCmd::RT_FW_UPDATE,       2, { SK_TUF, SK_OWA }, NULL },
+    { SysctrlCmd::RT_LOGO_UPDATE,     2, { SK_TLG, SK_OWA }, NULL },
+    { SysctrlCmd::RC_IMAGE_UPDATE,    4, { SK_IUF, SK_IUL, SK_IFA, SK_ILA }, NULL },
+    // --- RS485 upiti ---
+    { SysctrlCmd::PERMITED_GROUP,     2, { SK_PGA, SK_PGU }, NULL },
+    { SysctrlCmd::DIN_CFG,            2, { SK_CDI, SK_DI0 }, NULL },
+    { SysctrlCmd::RT_DISP_MSG,        2, { SK_TXA, SK_TXT }, NULL },
+    { SysctrlCmd::RT_DISP_STA,        2, { SK_TDA, SK_TDI }, NULL },
+    { SysctrlCmd::RT_QRC,             1, { SK_QRA }, NULL },
+    { SysctrlCmd::ROOM_TEMP,          1, { SK_THA }, NULL },
+    { SysctrlCmd::APPL_STAT,          2, { SK_STG, SK_VAL }, NULL },
+    { SysctrlCmd::BEDDING_REPL,       2, { SK_SBR, SK_PER }, NULL },
+    { SysctrlCmd::ROOM_STATUS,        1, { SK_CST }, NULL },
+    { SysctrlCmd::PREVIEW_IMG,        1, { SK_IPR }, NULL },
+    { SysctrlCmd::DOUT_STATE,         2, { SK_CDO, SK_CTRL }, NULL },
+    { SysctrlCmd::DISPL_BCKLGHT,      2, { SK_CBR, SK_BR }, NULL },
+    { SysctrlCmd::SOS_RESET,          1, { SK_RUD }, NULL },
+    { SysctrlCmd::RS485_CFG,          5, { SK_RSC, SK_RSA, SK_RGA, SK_RBA, SK_RIB }, NULL },
+    { SysctrlCmd::SYSTEM_ID,          2, { SK_SID, SK_NID }, NULL },
+    { SysctrlCmd::RESTART,            1, { SK_RST }, NULL },
+    { SysctrlCmd::HOTEL_STATUS,       1, { SK_HSSET }, NULL },
+};
+
+static const String SYSCTRL_EMPTY_VALUE;
+
+int FindSysctrlKey(const char* name)
+{
+    int low = 0;
+    int high = SK_COUNT - 1;
+    while (low <= high)
+    {
+        int mid = (low + high) / 2;
+        int cmp = strcmp(name, SYSCTRL_KEY_NAMES[mid]);
+        if (cmp == 0) return mid;
+        if (cmp < 0) high = mid - 1;
+        else low = mid + 1;
+    }
+    return -1;
+}
+
+// ============================================================================
+// SysctrlArgs
+// ============================================================================
+
+SysctrlArgs::SysctrlArgs()
+{
+    memset(m_values, 0, sizeof(m_values));
+    memset(m_ints, 0, sizeof(m_ints));
+}
+
+void SysctrlArgs::Add(const char* name, const String& value)
+{
+    int key = FindSysctrlKey(name);
+    if (key < 0 || m_values[key] != NULL) return;
+
+    m_values[key] = &value;
+    m_ints[key] = value.toInt();
+}
+
+const String& SysctrlArgs::Value(uint8_t key) const
+{
+    return (m_values[key] != NULL) ? *m_values[key] : SYSCTRL_EMPTY_VALUE;
+}
+
+const SysctrlRoute* FindSysctrlRoute(const SysctrlArgs& args)
+{
+    for (size_t r = 0; r < sizeof(SYSCTRL_ROUTES) / sizeof(SYSCTRL_ROUTES[0]); r++)
+    {
+        const SysctrlRoute* route = &SYSCTRL_ROUTES[r];
+        bool match = true;
+        for (uint8_t k = 0; k < route->key_count && match; k++) {
+            match = args.Has(route->keys[k]);
+        }
+        if (match && route->value != NULL) {
+            match = (args.Value(route->keys[0]) == route->value);
+        }
+        if (match) return route;
+    }
+    return NULL;
+}
@@ -21,15 +21,15 @@ static uint8_t toBCD(uint8_t val)
     return (uint8_t)(((val / 10) << 4) | (val % 10));
 }
 
-TimeSync::TimeSync() : m_rs485_service(NULL),
+TimeSync::TimeSync() : m_bus_owner(NULL),
                        m_last_sync_time(0)
 {
     // Konstruktor
 }
 
-void TimeSync::Initialize(Rs485Service *pRs485Service)
+void TimeSync::Initialize(Rs485BusOwner *pBusOwner)
 {
-    m_rs485_service = pRs485Service;
+    m_bus_owner = pBusOwner;
 }
 
 /**
@@ -128,7 +128,7 @@ void TimeSync::SendTimeBroadcast()
         packet[21] = EOT;
 
         LOG_DEBUG(3, "[TimeSync] RUBICON protokol (22B)\n");
-        m_rs485_service->SendPacket(packet, 22);
+        SendBroadcast(packet, 22);
         break;
     }
     
@@ -169,7 +169,7 @@ void TimeSync::SendTimeBroadcast()
         packet[16] = EOT;
 
         LOG_DEBUG(3, "[TimeSync] HC protokol (17B)\n");
-        m_rs485_service->SendPacket(packet, 17);
+        SendBroadcast(packet, 17);
         break;
     }
     }
@@ -254,7 +254,7 @@ void TimeSync::SendTimeBroadcast()
             packet[21] = EOT;
 
             LOG_DEBUG(3, "[TimeSync] Dodatni RUBICON paket [%d] (22B) na adresu %d\n", i, broadcast_addr);
-            m_rs485_service->SendPacket(packet, 22);
+            SendBroadcast(packet, 22);
             break;
         }
 
@@ -294,13 +294,32 @@ void TimeSync::SendTimeBroadcast()
             packet[16] = EOT;
 
             LOG_DEBUG(3, "[TimeSync] Dodatni HC paket [%d] (17B) na adresu %d\n", i, broadcast_addr);
-            m_rs485_service->SendPacket(packet, 17);
+            SendBroadcast(packet, 17);
             break;
         }
         }
     }
 }
 
+/**
+ * @brief Šalje broadcast okvir na sve buseve.
+ * @details Sa dijeljenim RX-om neaktivni bus ima DE=HIGH, pa okvir ionako ide na
+ *          oba busa. Sa zasebnim UART-om po busu okvir se šalje na svaki bus.
+ */
+void TimeSync::SendBroadcast(const uint8_t* packet, uint16_t length)
+{
+    if (!m_bus_owner->IsParallel())
+    {
+        m_bus_owner->Transact(BusPriority::TIME_SYNC, RS485_BUS_CURRENT, packet, length, NULL, 0, 0);
+        return;
+    }
+
+    for (uint8_t bus = 0; bus < RS485_MAX_BUS_LANES; bus++)
+    {
+        m_bus_owner->Transact(BusPriority::TIME_SYNC, bus, packet, length, NULL, 0, 0);
+    }
+}
+
 /**
  * @brief Provjerava da li je vrijeme za slanje broadcast-a.
  * @return true ako je vrijeme za slanje broadcast-a, u suprotnom false.
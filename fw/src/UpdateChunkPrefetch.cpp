@@ -0,0 +1,82 @@
+/**
+ ******************************************************************************
+ * @file    UpdateChunkPrefetch.cpp
+ * @author  Gemini & [Vase Ime]
+ * @brief   Implementacija prefetch-a chunk-ova update fajla.
+ ******************************************************************************
+ */
+
+#include "UpdateChunkPrefetch.h"
+
+UpdateChunkPrefetch::UpdateChunkPrefetch()
+{
+    Reset();
+}
+
+void UpdateChunkPrefetch::Reset()
+{
+    m_length = 0;
+    m_offset = 0;
+    m_chunk_size = 0;
+    m_sum = 0;
+    m_hits = 0;
+    m_misses = 0;
+}
+
+void UpdateChunkPrefetch::Prefetch(File& file, uint32_t offset, uint16_t chunk_size)
+{
+    m_length = 0;
+
+    if (chunk_size > sizeof(m_buffer) || offset >= file.size()) {
+        return;
+    }
+
+    // Nakon čitanja tekućeg chunk-a fajl je obično već na ovom offsetu
+    if (file.position() != offset && !file.seek(offset)) {
+        return;
+    }
+
+    int16_t len = file.read(m_buffer, chunk_size);
+    if (len <= 0) {
+        return;
+    }
+
+    m_offset = offset;
+    m_chunk_size = chunk_size;
+    m_sum = SumBytes(m_buffer, len);
+    m_length = len;
+}
+
+int16_t UpdateChunkPrefetch::Read(File& file, uint32_t offset, uint8_t* buffer, uint16_t chunk_size, uint16_t* data_sum)
+{
+    int16_t len;
+
+    if (m_length > 0 && m_offset == offset && m_chunk_size == chunk_size)
+    {
+        memcpy(buffer, m_buffer, m_length);
+        len = m_length;
+        *data_sum = m_sum;
+        m_hits++;
+        // Fajl je već pozicioniran iza ovog chunk-a (pročitan u Prefetch())
+    }
+    else
+    {
+        // Nema prefetch-a (prvi chunk) ili se offset promijenio (NAK/timeout)
+        if (file.position() != offset) {
+            file.seek(offset);
+        }
+        len = file.read(buffer, chunk_size);
+        *data_sum = (len > 0) ? SumBytes(buffer, len) : 0;
+        m_misses++;
+    }
+
+    m_length = 0;
+    return len;
+}
+
+uint16_t UpdateChunkPrefetch::SumBytes(const uint8_t* data, int16_t length)
+{
+    uint16_t sum = 0;
+    for (int16_t i = 0; i < length; i++) sum += data[i];
+    return sum;
+}
@@ -12,7 +12,9 @@
 #include "UpdateManager.h"
 #include "ProjectConfig.h" 
 #include "TimeSync.h"
-#include "LogPullManager.h"  // DODATO: Za GetBusForAddress()
+#include "DebugConfig.h"
+#include "Rs485Trace.h"
+#include "DeviceDirectory.h" // Za routing po adresi (bus/protokol)
 #include "HttpServer.h"      // NAKON ostalih da izbjegnemo FILE_READ konflikt
 #include <cstring>
 
@@ -24,8 +26,6 @@
 // Globalna konfiguracija (extern)
 extern AppConfig g_appConfig;
 
-// Extern za LogPullManager (za routing po adresi)
-extern LogPullManager* g_logPullManager_ptr; 
 
 // ============================================================================
 // --- STM32 CRC32 HARDWARE-LIKE SOFTWARE IMPLEMENTATION ---
@@ -64,8 +64,12 @@ UpdateManager::UpdateManager()
 {
     m_session.state = UpdateState::S_IDLE;
     m_sequence.is_active = false; // NOVO
-    m_rs485_service = NULL;
+    m_bus_owner = NULL;
     m_sd_card_manager = NULL;
+    m_tx_length = 0;
+    m_single_byte_ack = false;
+    m_bus_id = RS485_BUS_CURRENT;
+    m_session_start_time = 0;
     m_http_server = NULL;
     m_session.is_read_active = false;
     
@@ -74,9 +78,9 @@ UpdateManager::UpdateManager()
     m_session_in_progress = false;
 }
 
-void UpdateManager::Initialize(Rs485Service* pRs485Service, SdCardManager* pSdCardManager)
+void UpdateManager::Initialize(Rs485BusOwner* pBusOwner, SdCardManager* pSdCardManager)
 {
-    m_rs485_service = pRs485Service;
+    m_bus_owner = pBusOwner;
     m_sd_card_manager = pSdCardManager;
 }
 
@@ -90,24 +94,8 @@ void UpdateManager::Initialize(Rs485Service* pRs485Service, SdCardManager* pSdCa
  */
 uint16_t UpdateManager::GetChunkSizeForProtocol(uint16_t address)
 {
-    // Odredi protokol na osnovu adrese i dual-bus konfiguracije
-    ProtocolVersion proto;
-    
-    if (g_appConfig.enable_dual_bus_mode && g_logPullManager_ptr != NULL) {
-        int8_t bus = g_logPullManager_ptr->GetBusForAddress(address);
-        if (bus == 0) {
-            proto = static_cast<ProtocolVersion>(g_appConfig.protocol_version_L);
-        } else if (bus == 1) {
-            proto = static_cast<ProtocolVersion>(g_appConfig.protocol_version_R);
-        } else {
-            // Fallback: adresa nije u listama (ne bi se trebalo desiti jer StartSession odbija)
-            // Koristi protocol_version_L kao sigurnu opciju
-            proto = static_cast<ProtocolVersion>(g_appConfig.protocol_version_L);
-        }
-    } else {
-        // Single/Global bus mode - koristi protocol_version_L (koji je jednak protocol_version_R)
-        proto = static_cast<ProtocolVersion>(g_appConfig.protocol_version_L);
-    }
+    // Protokol busa ove adrese (nepoznata adresa / single mode -> protocol_version_L)
+    ProtocolVersion proto = g_deviceDirectory.GetProtocol(address);
     
     // EKSPLICITNA LISTA SVIH PROTOKOLA (bez default)
     switch (proto)
@@ -143,24 +131,8 @@ uint16_t UpdateManager::GetChunkSizeForProtocol(uint16_t address)
  */
 uint32_t UpdateManager::GetUpdateTimeoutForProtocol(uint16_t address)
 {
-    // Odredi protokol na osnovu adrese i dual-bus konfiguracije
-    ProtocolVersion proto;
-    
-    if (g_appConfig.enable_dual_bus_mode && g_logPullManager_ptr != NULL) {
-        int8_t bus = g_logPullManager_ptr->GetBusForAddress(address);
-        if (bus == 0) {
-            proto = static_cast<ProtocolVersion>(g_appConfig.protocol_version_L);
-        } else if (bus == 1) {
-            proto = static_cast<ProtocolVersion>(g_appConfig.protocol_version_R);
-        } else {
-            // Fallback: adresa nije u listama (ne bi se trebalo desiti jer StartSession odbija)
-            // Koristi protocol_version_L kao sigurnu opciju
-            proto = static_cast<ProtocolVersion>(g_appConfig.protocol_version_L);
-        }
-    } else {
-        // Single/Global bus mode - koristi protocol_version_L (koji je jednak protocol_version_R)
-        proto = static_cast<ProtocolVersion>(g_appConfig.protocol_version_L);
-    }
+    // Protokol busa ove adrese (nepoznata adresa / single mode -> protocol_version_L)
+    ProtocolVersion proto = g_deviceDirectory.GetProtocol(address);
     
     // EKSPLICITNA LISTA SVIH PROTOKOLA (bez default)
     switch (proto)
@@ -196,24 +168,8 @@ uint32_t UpdateManager::GetUpdateTimeoutForProtocol(uint16_t address)
  */
 bool UpdateManager::UseSingleByteAckForProtocol(uint16_t address)
 {
-    // Odredi protokol na osnovu adrese i dual-bus konfiguracije
-    ProtocolVersion proto;
-    
-    if (g_appConfig.enable_dual_bus_mode && g_logPullManager_ptr != NULL) {
-        int8_t bus = g_logPullManager_ptr->GetBusForAddress(address);
-        if (bus == 0) {
-            proto = static_cast<ProtocolVersion>(g_appConfig.protocol_version_L);
-        } else if (bus == 1) {
-            proto = static_cast<ProtocolVersion>(g_appConfig.protocol_version_R);
-        } else {
-            // Fallback: adresa nije u listama (ne bi se trebalo desiti jer StartSession odbija)
-            // Koristi protocol_version_L kao sigurnu opciju
-            proto = static_cast<ProtocolVersion>(g_appConfig.protocol_version_L);
-        }
-    } else {
-        // Single/Global bus mode - koristi protocol_version_L (koji je jednak protocol_version_R)
-        proto = static_cast<ProtocolVersion>(g_appConfig.protocol_version_L);
-    }
+    // Protokol busa ove adrese (nepoznata adresa / single mode -> protocol_version_L)
+    ProtocolVersion proto = g_deviceDirectory.GetProtocol(address);
     
     // EKSPLICITNA LISTA SVIH PROTOKOLA (bez default)
     switch (proto)
@@ -430,9 +386,9 @@ bool UpdateManager::StartSession(uint8_t clientAddress, uint8_t updateCmd)
     // =================================================================================
     // DUAL PROTOCOL MODE: Provjera da li je adresa u listama
     // =================================================================================
-    if (g_appConfig.enable_dual_bus_mode && g_logPullManager_ptr != NULL)
+    if (g_appConfig.enable_dual_bus_mode)
     {
-        int8_t bus = g_logPullManager_ptr->GetBusForAddress(clientAddress);
+        int8_t bus = g_deviceDirectory.GetBus(clientAddress);
         if (bus == -1)
         {
             Serial.printf("[UpdateManager] GREŠKA: U DUAL PROTOCOL MODE-u adresa 0x%X nije u ni jednoj listi!\n", clientAddress);
@@ -440,9 +396,11 @@ bool UpdateManager::StartSession(uint8_t clientAddress, uint8_t updateCmd)
             return false; // ODBIJ update ako ne znamo protokol
         }
         Serial.printf("[UpdateManager] Dual mode: Adresa 0x%X -> Bus %d\n", clientAddress, bus);
+        m_bus_id = (uint8_t)bus; // Sve transakcije sesije idu na bus ove adrese
     }
     else
     {
+        m_bus_id = RS485_BUS_CURRENT;
         // SINGLE/GLOBAL PROTOCOL MODE: Bilo koja adresa može da se update-uje
         Serial.printf("[UpdateManager] Single/Global mode: Update adrese 0x%X (protokol poznat)\n", clientAddress);
     }
@@ -464,14 +422,19 @@ bool UpdateManager::StartSession(uint8_t clientAddress, uint8_t updateCmd)
 
     // =================================================================================
     // KRITIČNO: Aktiviraj single-byte mod ako je STARI protokol
-    // Ovo omogućava Rs485Service da prihvati single-byte ACK/NAK
+    // Svaka transakcija ove sesije nosi flag, pa Rs485BusOwner prihvata
+    // single-byte ACK/NAK samo za naše okvire (ne i za HTTP/polling između njih)
     // =================================================================================
-    if (UseSingleByteAckForProtocol(clientAddress))
+    m_single_byte_ack = UseSingleByteAckForProtocol(clientAddress);
+    if (m_single_byte_ack)
     {
-        m_rs485_service->EnableSingleByteMode();
         Serial.println(F("[UpdateManager] STARI protokol detektovan - single-byte mod aktiviran"));
     }
 
+    m_prefetch.Reset();
+    m_update_rtt.Reset();
+    m_session_start_time = millis();
+
     Serial.printf("[UpdateManager] Sesija pokrenuta za klijenta 0x%X\n", clientAddress);
     
     m_session.state = UpdateState::S_STARTING;
@@ -542,6 +505,7 @@ void UpdateManager::Run()
         uint8_t response_buffer[MAX_PACKET_LENGTH];
         int response_len = 0;
         uint32_t response_timeout = 0;
+        bool rtt_sample = false; // Da li se odziv ovog okvira koristi za RTT procjenu
 
         // --- FAZA 1: SLANJE ---
         switch (m_session.state)
@@ -561,8 +525,10 @@ void UpdateManager::Run()
                 if ((m_session.bytesSent + m_session.read_chunk_size) >= m_session.fw_size) {
                     response_timeout = (m_session.type == TYPE_FW_RC || m_session.type == TYPE_BLDR_RC) ? IMG_COPY_DEL : FWR_COPY_DEL;
                 } else {
-                    // PROMJENA: Koristi dinamički timeout za update umjesto hardkodirane konstante
-                    response_timeout = GetUpdateTimeoutForProtocol(m_session.clientAddress); // 78ms (stari) ili 45ms (novi)
+                    // PROMJENA: Adaptivni timeout iz RTT-a ove sesije, ograničen timeout-om
+                    // protokola (78ms stari / 45ms novi). Uzorak samo iz prvog pokušaja (Karn).
+                    response_timeout = m_update_rtt.GetTimeoutMs(GetUpdateTimeoutForProtocol(m_session.clientAddress), m_session.retryCount);
+                    rtt_sample = (m_session.retryCount == 0);
                 }
                 break;
 
@@ -601,18 +567,36 @@ void UpdateManager::Run()
             m_session.state == S_WAITING_FOR_DATA_ACK ||
             m_session.state == S_WAITING_FOR_FINISH_ACK)
         {
-            response_len = m_rs485_service->ReceivePacket(response_buffer, MAX_PACKET_LENGTH, response_timeout);
+            // Okvir pripremljen u FAZI 1 ide kroz vlasnika magistrale (UPDATE klasa).
+            // NOVO: Predaja je neblokirajuća - dok je DATA okvir na liniji i čeka se
+            // ACK, sa kartice se čita sljedeći chunk.
+            BusTransaction txn;
+            if (m_bus_owner->Submit(&txn, BusPriority::UPDATE, m_bus_id,
+                                    m_tx_frame, m_tx_length,
+                                    response_buffer, MAX_PACKET_LENGTH,
+                                    response_timeout, m_single_byte_ack) &&
+                m_session.state == S_WAITING_FOR_DATA_ACK)
+            {
+                PrefetchNextChunk();
+            }
+            response_len = m_bus_owner->WaitForResult(&txn);
+
+            if (rtt_sample && response_len > 0) {
+                m_update_rtt.AddSample(txn.rtt_us);
+            } else if (rtt_sample && response_len == 0) {
+                m_update_rtt.AddTimeout();
+            }
 
             // =================================================================================
             // --- NOVO: Bezuslovni ispis primljenog RAW paketa, po uzoru na Rs485Service ---
             // =================================================================================
+#if RS485_SERIAL_TRACE
             if (response_len > 0) {
-                char raw_packet_str[response_len * 3 + 1] = {0};
-                for (int i = 0; i < response_len; i++) {
-                    sprintf(raw_packet_str + strlen(raw_packet_str), "%02X ", response_buffer[i]);
-                }
+                char raw_packet_str[MAX_PACKET_LENGTH * 3 + 1];
+                Rs485Trace::FormatHex(response_buffer, response_len, raw_packet_str, sizeof(raw_packet_str));
                 Serial.printf("[UpdateManager] -> RAW Odgovor primljen u %lu ms (%d B): [ %s]\n", millis(), response_len, raw_packet_str);
             }
+#endif
             if (response_len > 0) {
                 // Imamo odgovor, obradi ga
                 ProcessResponse(response_buffer, response_len);
@@ -902,7 +886,7 @@ void UpdateManager::SendFirmwareStartRequest()
     packet[total_packet_len - 2] = (checksum & 0xFF);
     packet[total_packet_len - 1] = EOT;
 
-    if (m_rs485_service->SendPacket(packet, total_packet_len)) {
+    if (StageFrame(packet, total_packet_len)) {
         s->timeoutStart = millis();
         s->state = S_WAITING_FOR_START_ACK;
     } else {
@@ -1000,8 +984,8 @@ void UpdateManager::SendFileStartRequest()
     Serial.println(F("---------------------------------------------"));
     // --- KRAJ DIJAGNOSTIKE ---
     // ISPRAVKA: Dužina paketa je 20, a ne 21
-    if (m_rs485_service->SendPacket(packet, 20)) {
-        Serial.printf("  -> Paket poslan u %lu ms.\n", millis()); // DIJAGNOSTIKA VREMENA
+    if (StageFrame(packet, 20)) {
+        Serial.printf("  -> Paket pripremljen u %lu ms.\n", millis()); // DIJAGNOSTIKA VREMENA
         s->state = S_WAITING_FOR_START_ACK;
     }
     else
@@ -1016,7 +1000,9 @@ void UpdateManager::SendDataPacket()
     UpdateSession* s = &m_session;
     // PROMJENA: Koristi dinamički chunk size za update umjesto hardkodirane konstante
     uint16_t chunk_size = GetChunkSizeForProtocol(s->clientAddress); // 64 (stari) ili 128 (novi)
-    int16_t bytes_read = s->fw_file.read(s->read_buffer, chunk_size);
+    uint16_t data_sum = 0;
+    // NOVO: Chunk je obično već pročitan (PrefetchNextChunk) dok je prethodni okvir bio na liniji
+    int16_t bytes_read = m_prefetch.Read(s->fw_file, s->bytesSent, s->read_buffer, chunk_size, &data_sum);
     
     if (bytes_read <= 0)
     {
@@ -1044,14 +1030,14 @@ void UpdateManager::SendDataPacket()
     
     memcpy(&packet[8], s->read_buffer, s->read_chunk_size);
     
-    uint16_t checksum = 0;
-    for (uint32_t i = 6; i < (6 + data_len); i++) checksum += packet[i];
+    // Suma podataka je izračunata pri čitanju chunk-a; dodaje se samo sekvenca
+    uint16_t checksum = packet[6] + packet[7] + data_sum;
 
     packet[total_packet_length - 3] = (checksum >> 8);
     packet[total_packet_length - 2] = (checksum & 0xFF);
     packet[total_packet_length - 1] = EOT;
     
-    if (m_rs485_service->SendPacket(packet, total_packet_length)) {
+    if (StageFrame(packet, total_packet_length)) {
         s->timeoutStart = millis();
         s->state = S_WAITING_FOR_DATA_ACK;
     }
@@ -1084,7 +1070,7 @@ void UpdateManager::SendFinishRequest()
     packet[8] = (checksum & 0xFF);
     packet[9] = EOT;
     
-    if (m_rs485_service->SendPacket(packet, 10)) {
+    if (StageFrame(packet, 10)) {
         s->timeoutStart = millis();
         s->state = S_WAITING_FOR_FINISH_ACK;
     }
@@ -1121,7 +1107,7 @@ void UpdateManager::SendRestartCommand()
     packet[8] = (checksum & 0xFF);
     packet[9] = EOT;
     
-    if (m_rs485_service->SendPacket(packet, 10)) {
+    if (m_bus_owner->Transact(BusPriority::UPDATE, m_bus_id, packet, 10, NULL, 0, 0, m_single_byte_ack) >= 0) {
         s->state = S_PENDING_APP_START; // Ne čekamo ACK, samo prelazimo u stanje pauze
     }
     else
@@ -1157,7 +1143,7 @@ void UpdateManager::SendAppExeCommand()
     packet[8] = (checksum & 0xFF);
     packet[9] = EOT;
     
-    if (m_rs485_service->SendPacket(packet, 10))
+    if (m_bus_owner->Transact(BusPriority::UPDATE, m_bus_id, packet, 10, NULL, 0, 0, m_single_byte_ack) >= 0)
     {
         CleanupSession(false); // Završavamo sesiju, ne čekamo odgovor
     }
@@ -1167,13 +1153,40 @@ void UpdateManager::SendAppExeCommand()
     }
 }
 
+/**
+ * @brief Čita chunk koji slijedi nakon trenutnog DATA okvira.
+ * @details Poziva se dok vlasnik magistrale šalje okvir i čeka ACK.
+ */
+void UpdateManager::PrefetchNextChunk()
+{
+    uint32_t next_offset = m_session.bytesSent + m_session.read_chunk_size;
+    if (next_offset >= m_session.fw_size) {
+        return; // Zadnji paket - nema šta čitati
+    }
+    m_prefetch.Prefetch(m_session.fw_file, next_offset, GetChunkSizeForProtocol(m_session.clientAddress));
+}
+
+/**
+ * @brief Kopira okvir u m_tx_frame; šalje ga FAZA 2 zajedno sa čekanjem odgovora.
+ * @return false ako okvir ne staje u buffer.
+ */
+bool UpdateManager::StageFrame(const uint8_t* packet, uint16_t length)
+{
+    if (length > sizeof(m_tx_frame)) {
+        return false;
+    }
+    memcpy(m_tx_frame, packet, length);
+    m_tx_length = length;
+    return true;
+}
+
 void UpdateManager::CleanupSession(bool failed /*= false*/)
 {
     // =================================================================================
     // KRITIČNO: Deaktiviraj single-byte mod nakon završetka transfera
-    // Ovo vraća Rs485Service u normalno stanje za LogPullManager i ostale funkcije
+    // Sljedeće transakcije sesije (ako postoje) ne smiju prihvatati 1-bajtni ACK
     // =================================================================================
-    m_rs485_service->DisableSingleByteMode();
+    m_single_byte_ack = false;
     
     // POKRENI SERVER - ALI SAMO AKO NEMA AKTIVNE SEKVENCE!
     // Ako je sekvenca aktivna, server ostaje zaustavljen do kraja cijele sekvence
@@ -1186,6 +1199,17 @@ void UpdateManager::CleanupSession(bool failed /*= false*/)
         m_session.fw_file.close();
         m_session.is_read_active = false;
     }
+
+    // NOVO: Trajanje transfera (poređenje sa/bez prefetch-a na istoj slici)
+    unsigned long elapsed_ms = millis() - m_session_start_time;
+    Serial.printf("[UpdateManager] Transfer: %lu B za %lu ms (%lu B/s), prefetch pogodaka %lu/%lu\n",
+                  (unsigned long)m_session.bytesSent, elapsed_ms,
+                  (elapsed_ms > 0) ? (unsigned long)((uint64_t)m_session.bytesSent * 1000UL / elapsed_ms) : 0UL,
+                  (unsigned long)m_prefetch.GetHits(),
+                  (unsigned long)(m_prefetch.GetHits() + m_prefetch.GetMisses()));
+    Serial.printf("[UpdateManager] RTT: srtt %lu us, rttvar %lu us, timeout %lu ms\n",
+                  (unsigned long)m_update_rtt.GetSrttUs(), (unsigned long)m_update_rtt.GetRttvarUs(),
+                  (unsigned long)m_update_rtt.GetTimeoutMs(GetUpdateTimeoutForProtocol(m_session.clientAddress)));
     
     // Reset TimeSync tajmer
     extern TimeSync g_timeSync;
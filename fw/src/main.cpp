@@ -16,9 +16,12 @@
 #include "EepromStorage.h"
 #include "SdCardManager.h"
 #include "Rs485Service.h"
+#include "Rs485BusOwner.h"
 #include "HttpServer.h"
 #include "HttpQueryManager.h"
+#include "RoomStatusSweep.h"
 #include "LogPullManager.h"
+#include "LogWriter.h"
 #include "TimeSync.h"
 #include "FirmwareUpdateManager.h" // NOVO
 #include "UpdateManager.h"
@@ -28,18 +31,24 @@
 // Deklaracija globalnih objekata
 NetworkManager g_networkManager; // VRAĆAMO NETWORK MANAGER
 EepromStorage g_eepromStorage;
+LogWriter g_logWriter; // NOVO: Zadatak za upis logova (jedini upisivač logova u g_eepromStorage)
 SdCardManager g_sdCardManager; // Ispravno: Koristimo SdCardManager
 Rs485Service g_rs485Service;
+#if RS485_DUAL_UART_AVAILABLE
+Rs485Service g_rs485ServiceR; // NOVO: Desni bus na zasebnom UART-u (RS485_WIRING_DUAL_UART)
+#endif
+Rs485BusOwner g_rs485BusOwner; // Jedini zadatak koji koristi g_rs485Service
 HttpServer g_httpServer;
 HttpQueryManager g_httpQueryManager;
+RoomStatusSweep g_roomStatusSweep; // NOVO: Status više soba jednim prolazom (/room_status)
 LogPullManager g_logPullManager;
+#if RS485_DUAL_UART_AVAILABLE
+LogPullManager g_logPullManagerR; // NOVO: Poller Desnog busa (samo u paralelnom L/R radu)
+#endif
 TimeSync g_timeSync;
 FirmwareUpdateManager g_fufUpdateManager; // NOVO
 UpdateManager g_updateManager;
 
-// Globalni pointer za dual bus routing (potreban u HttpQueryManager)
-LogPullManager* g_logPullManager_ptr = &g_logPullManager;
-
 // Globalna varijabla konfiguracije
 extern AppConfig g_appConfig; // Inicijalizacija na 0
 
@@ -78,6 +87,8 @@ void setup()
     g_sdCardManager.Initialize(SPI_SCK_PIN, SPI_MISO_PIN, SPI_MOSI_PIN, SPI_FLASH_CS_PIN);
 
     g_eepromStorage.Initialize(I2C_SDA_PIN, I2C_SCL_PIN);
+    g_logWriter.Initialize(&g_eepromStorage);
+    g_logWriter.StartTask();
     
     // --- FAZA 2.5: Ucitavanje Address List sa SD kartice (ako postoji) ---
     Serial.println(F("[setup] Provjera address list fajlova na SD kartici..."));
@@ -158,7 +169,31 @@ void setup()
     // Inicijalizujemo samo event handlere za WiFi
     // I Rs485 hardver
     g_networkManager.Initialize();
+
+    // NOVO: Paralelni L/R rad zahtijeva dual bus mode i zaseban UART za Desni bus
+    bool dualUart = g_appConfig.enable_dual_bus_mode &&
+                    g_appConfig.rs485_wiring_mode == RS485_WIRING_DUAL_UART;
+
+#if RS485_DUAL_UART_AVAILABLE
+    if (dualUart)
+    {
+        g_rs485Service.InitializeDedicated(0, (uart_port_t)RS485_UART_NUM, RS485_TX_PIN, RS485_RX_PIN, RS485_DE_PIN1);
+        g_rs485ServiceR.InitializeDedicated(1, (uart_port_t)RS485_UART_NUM_R, RS485_TX_PIN_R, RS485_RX_PIN_R, RS485_DE_PIN2);
+        g_rs485BusOwner.Initialize(&g_rs485Service, &g_rs485ServiceR);
+    }
+    else
+    {
+        g_rs485Service.Initialize();
+        g_rs485BusOwner.Initialize(&g_rs485Service);
+    }
+#else
+    if (dualUart) {
+        Serial.println(F("[setup] UPOZORENJE: Ploča nema TX pin Desnog busa (RS485_TX_PIN_R) - koristim dijeljeni RX."));
+    }
     g_rs485Service.Initialize();
+    g_rs485BusOwner.Initialize(&g_rs485Service);
+#endif
+    g_rs485BusOwner.StartTask();
 
     // --- FAZA 2.6: Provjera Emergency/Config Pin (Pin 39) ---
     Serial.println(F("[setup] Provjera Emergency Config pina..."));
@@ -199,11 +234,24 @@ void setup()
     // --- FAZA 3: Inicijalizacija Sub-Modula ---
     LOG_DEBUG(3, "[setup] Inicijalizacija Sub-Modula...\r\n");
 
-    g_logPullManager.Initialize(&g_rs485Service, &g_eepromStorage);
-    g_httpQueryManager.Initialize(&g_rs485Service);
-    g_fufUpdateManager.Initialize(&g_rs485Service, &g_sdCardManager); // NOVO
-    g_updateManager.Initialize(&g_rs485Service, &g_sdCardManager);
-    g_timeSync.Initialize(&g_rs485Service);
+    g_logPullManager.Initialize(&g_rs485BusOwner, &g_eepromStorage);
+    // Direktorij adresa i keš statusa soba grade se jednom, nad listama primarnog poller-a
+    g_logPullManager.BuildDeviceTables();
+#if RS485_DUAL_UART_AVAILABLE
+    if (g_rs485BusOwner.IsParallel())
+    {
+        // Svaki bus ima svoj poller; obje instance učitavaju obje liste
+        g_logPullManager.SetBusFilter(0);
+        g_logPullManagerR.SetBusFilter(1);
+        g_logPullManagerR.Initialize(&g_rs485BusOwner, &g_eepromStorage);
+    }
+#endif
+    g_httpQueryManager.Initialize(&g_rs485BusOwner);
+    g_roomStatusSweep.Initialize(&g_rs485BusOwner, &g_httpQueryManager);
+    g_roomStatusSweep.StartTask();
+    g_fufUpdateManager.Initialize(&g_rs485BusOwner, &g_sdCardManager); // NOVO
+    g_updateManager.Initialize(&g_rs485BusOwner, &g_sdCardManager);
+    g_timeSync.Initialize(&g_rs485BusOwner);
 
     LOG_DEBUG(3, "[setup] Priprema HTTP Servera (ne pokreće se još)...\n");
     g_httpServer.Initialize(
@@ -239,11 +287,9 @@ void loop()
 
     // HTTP komande se obrađuju direktno u HttpServer-u i imaju najveći prioritet.
     // HttpServer (ESPAsyncWebServer) radi u svom zadatku. Kada stigne zahtjev,
-    // on poziva ExecuteBlockingQuery, koji će zauzeti RS485 magistralu i blokirati
-    // samo zadatak od web servera, ne i ovu loop() petlju.
-    // Da bi se spriječilo da loop() uleti i pokrene npr. Polling dok HTTP upit čeka,
-    // moramo uvesti globalni flag ili mutex. Za sada, oslanjamo se na to da su HTTP
-    // upiti rijetki i brzi.
+    // ExecuteBlockingQuery predaje transakciju u HTTP red Rs485BusOwner-a.
+    // Vlasnik magistrale je jedini koji koristi UART: HTTP transakcija ide odmah
+    // nakon okvira koji je trenutno na liniji, a polling iz loop() čeka u svom redu.
 
     // Glavna state-mašina za pozadinske zadatke
     // Prioritet: Update > TimeSync > Polling
@@ -271,5 +317,20 @@ void loop()
         // Ako nijedan update nije aktivan, izvršavaju se redovni pozadinski zadaci.
         g_timeSync.Run();
         g_logPullManager.Run();
+        bool waiting = g_logPullManager.IsWaitingForResponse();
+#if RS485_DUAL_UART_AVAILABLE
+        if (g_rs485BusOwner.IsParallel())
+        {
+            g_logPullManagerR.Run();
+            waiting = waiting || g_logPullManagerR.IsWaitingForResponse();
+        }
+#endif
+
+        // NOVO: LogPullManager ne blokira dok vlasnik magistrale izvršava transakciju.
+        // loop() spava na notifikaciji o završetku (max 1 tick) umjesto da vrti praznu petlju.
+        // U paralelnom radu obje trake notifikuju isti (loop) zadatak.
+        if (waiting) {
+            ulTaskNotifyTake(pdTRUE, 1);
+        }
     }
 }
\ No newline at end of file
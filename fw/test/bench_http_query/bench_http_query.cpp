@@ -0,0 +1,349 @@
+/**
+ ******************************************************************************
+ * @file    bench_http_query.cpp
+ * @author  Gemini & [Vase Ime]
+ * @brief   Host benchmark HTTP->RS485 upita (cst) uz istovremene zahtjeve
+ *          koji ne koriste bus (index stranica).
+ *
+ * @note
+ * Pravi HttpQueryManager i Rs485BusOwner rade nad simuliranom magistralom.
+ * AsyncTCP je modeliran kao jedan zadatak koji obrađuje događaje konekcija
+ * redom (zahtjev, poll), kao na uređaju:
+ *  - blokirajuci: cst handler sjedi u ExecuteBlockingQuery() (stari kod),
+ *  - poll tick:   odgovor se dovršava tek na lwIP poll (~500 ms),
+ *  - budjenje:    završetak transakcije šalje poll konekcijama koje čekaju
+ *                 (HttpServer::OnQueryBusComplete/WakeQueryWaiters).
+ * Jedna soba ne odgovara (timeout na Bus 0 pa ponovo na Bus 1).
+ ******************************************************************************
+ */
+
+#include "host_test.h"
+#include "HttpQueryManager.h"
+#include "Rs485BusOwner.h"
+#include "EepromStorage.h"
+#include "SimRs485Bus.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+extern AppConfig g_appConfig;
+
+Rs485Service g_rs485Service;
+Rs485BusOwner g_rs485BusOwner;
+HttpQueryManager g_httpQueryManager;
+
+static const uint8_t CST_CLIENTS = 6;
+static const uint16_t FIRST_ROOM = 0x0201;
+static const uint16_t SILENT_ROOM = FIRST_ROOM + CST_CLIENTS - 1;
+static const uint32_t CST_THINK_MS = HTTP_QUERY_COALESCE_MS + 50; ///< Pauza između cst upita (bez dijeljenja rezultata)
+static const uint32_t PAGE_INTERVAL_MS = 10;    ///< Zahtjevi za stranicu (bez busa)
+static const uint32_t PAGE_WORK_US = 300;       ///< CPU vrijeme handlera stranice
+static const uint32_t POLL_TICK_MS = 500;       ///< lwIP tcp_poll interval (AsyncTCP)
+static const uint32_t RUN_MS = 4000;
+
+enum class Mode : uint8_t { BLOCKING, POLL_TICK, WAKE };
+
+enum EventType : uint8_t { EV_CST, EV_PAGE, EV_POLL };
+
+struct Event
+{
+    EventType type;
+    uint8_t conn;
+};
+
+/**
+ * @brief HTTP konekcija (klijent čeka odgovor).
+ */
+struct Connection
+{
+    std::mutex lock;
+    std::condition_variable cv;
+    bool answered;
+    HttpQuery* query;           ///< Upit čiji se odgovor čeka (AsyncTCP zadatak)
+    uint16_t address;
+};
+
+static Mode s_mode;
+static QueueHandle_t s_async_queue;             ///< Red događaja modeliranog AsyncTCP zadatka
+static Connection s_conns[CST_CLIENTS + 1];     ///< Zadnja je klijent stranice
+static const uint8_t PAGE_CONN = CST_CLIENTS;
+static std::mutex s_waiters_lock;
+static bool s_waiting[CST_CLIENTS];             ///< Tabela čekanja (HttpServer::m_query_waiters)
+static std::atomic<bool> s_stop;
+
+// ============================================================================
+// Sobe na busu
+// ============================================================================
+
+static uint16_t RoomResponder(void*, uint8_t, const uint8_t* tx, uint16_t tx_length, uint8_t* rx, uint16_t)
+{
+    if (tx_length < 7) return 0;
+    uint16_t address = (uint16_t)((tx[1] << 8) | tx[2]);
+    uint8_t cmd = tx[6];
+    if (address == SILENT_ROOM || (cmd != GET_APPL_STAT && cmd != RUBICON_GET_ROOM_STATUS)) {
+        return 0;
+    }
+
+    uint16_t iface = g_appConfig.rs485_iface_addr;
+    uint8_t data_len = 33;
+    uint16_t checksum = cmd;
+    uint16_t n = 0;
+    rx[n++] = SOH;
+    rx[n++] = (uint8_t)(iface >> 8);
+    rx[n++] = (uint8_t)iface;
+    rx[n++] = (uint8_t)(address >> 8);
+    rx[n++] = (uint8_t)address;
+    rx[n++] = data_len;
+    rx[n++] = cmd;
+    for (uint8_t i = 1; i < data_len; i++)
+    {
+        rx[n++] = '0';
+        checksum += '0';
+    }
+    rx[n++] = (uint8_t)(checksum >> 8);
+    rx[n++] = (uint8_t)checksum;
+    rx[n++] = EOT;
+    return n;
+}
+
+// ============================================================================
+// Modelirani AsyncTCP zadatak
+// ============================================================================
+
+static void Post(EventType type, uint8_t conn)
+{
+    Event ev = { type, conn };
+    xQueueSend(s_async_queue, &ev, portMAX_DELAY);
+}
+
+static void Answer(uint8_t conn)
+{
+    Connection* c = &s_conns[conn];
+    {
+        std::lock_guard<std::mutex> guard(c->lock);
+        c->answered = true;
+    }
+    c->cv.notify_all();
+}
+
+static void SetWaiting(uint8_t conn, bool waiting)
+{
+    std::lock_guard<std::mutex> guard(s_waiters_lock);
+    s_waiting[conn] = waiting;
+}
+
+/**
+ * @brief Kao HttpServer::FillQueryResponse(): odgovor tek kada upit nije PENDING.
+ */
+static void FillQueryResponse(uint8_t conn)
+{
+    Connection* c = &s_conns[conn];
+    if (c->query == NULL) return;
+    if (g_httpQueryManager.PollQuery(c->query) == HTTP_QUERY_PENDING) return;
+
+    SetWaiting(conn, false);
+    g_httpQueryManager.ReleaseQuery(c->query);
+    c->query = NULL;
+    Answer(conn);
+}
+
+static void HandleCst(uint8_t conn)
+{
+    Connection* c = &s_conns[conn];
+    uint8_t data[HTTP_CMD_DATA_SIZE] = { 0 };
+    HttpCommand cmd = {};
+    cmd.cmd_id = GET_APPL_STAT;
+    cmd.address = c->address;
+    cmd.string_ptr = data;
+
+    if (s_mode == Mode::BLOCKING)
+    {
+        uint8_t response[MAX_PACKET_LENGTH];
+        g_httpQueryManager.ExecuteBlockingQuery(&cmd, response);
+        Answer(conn);
+        return;
+    }
+
+    c->query = g_httpQueryManager.BeginQuery(&cmd);
+    if (c->query == NULL)
+    {
+        Answer(conn); // BUSY
+        return;
+    }
+    SetWaiting(conn, true);
+    FillQueryResponse(conn);
+}
+
+static void HandlePage(uint8_t conn)
+{
+    uint64_t until = HostNowNs() + PAGE_WORK_US * 1000ULL;
+    while (HostNowNs() < until) {
+    }
+    Answer(conn);
+}
+
+static void AsyncTcpTask(void*)
+{
+    Event ev;
+    while (true)
+    {
+        if (xQueueReceive(s_async_queue, &ev, portMAX_DELAY) != pdTRUE) continue;
+        switch (ev.type)
+        {
+        case EV_CST:  HandleCst(ev.conn); break;
+        case EV_PAGE: HandlePage(ev.conn); break;
+        case EV_POLL: FillQueryResponse(ev.conn); break;
+        }
+    }
+}
+
+/**
+ * @brief Poll događaj za sve konekcije koje čekaju bus.
+ */
+static void PollWaiters()
+{
+    bool waiting[CST_CLIENTS];
+    {
+        std::lock_guard<std::mutex> guard(s_waiters_lock);
+        memcpy(waiting, s_waiting, sizeof(waiting));
+    }
+    for (uint8_t i = 0; i < CST_CLIENTS; i++) {
+        if (waiting[i]) Post(EV_POLL, i);
+    }
+}
+
+/**
+ * @brief Završetak transakcije (zadatak vlasnika magistrale) - kao OnQueryBusComplete.
+ */
+static void OnQueryBusComplete(void*)
+{
+    PollWaiters();
+}
+
+// ============================================================================
+// Klijenti
+// ============================================================================
+
+struct Latencies
+{
+    std::vector<uint32_t> us;
+
+    uint32_t Percentile(uint32_t p)
+    {
+        if (us.empty()) return 0;
+        std::sort(us.begin(), us.end());
+        return us[((us.size() - 1) * p) / 100];
+    }
+};
+
+static uint32_t Request(EventType type, uint8_t conn)
+{
+    Connection* c = &s_conns[conn];
+    {
+        std::lock_guard<std::mutex> guard(c->lock);
+        c->answered = false;
+    }
+    uint64_t t0 = HostNowNs();
+    Post(type, conn);
+    std::unique_lock<std::mutex> guard(c->lock);
+    c->cv.wait(guard, [c]() { return c->answered; });
+    return (uint32_t)((HostNowNs() - t0) / 1000);
+}
+
+static void RunMode(Mode mode, const char* name, Latencies* cst, Latencies* page)
+{
+    s_mode = mode;
+    s_stop = false;
+    g_httpQueryManager.SetCompletionHandler(mode == Mode::WAKE ? OnQueryBusComplete : NULL, NULL);
+
+    std::vector<std::thread> threads;
+    std::mutex results_lock;
+    for (uint8_t i = 0; i < CST_CLIENTS; i++)
+    {
+        threads.push_back(std::thread([i, cst, &results_lock]() {
+            while (!s_stop)
+            {
+                uint32_t us = Request(EV_CST, i);
+                {
+                    std::lock_guard<std::mutex> guard(results_lock);
+                    cst->us.push_back(us);
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(CST_THINK_MS));
+            }
+        }));
+    }
+    threads.push_back(std::thread([page]() {
+        while (!s_stop)
+        {
+            page->us.push_back(Request(EV_PAGE, PAGE_CONN));
+            std::this_thread::sleep_for(std::chrono::milliseconds(PAGE_INTERVAL_MS));
+        }
+    }));
+    // lwIP poll tajmer (i u modu budjenja - ostaje rezerva)
+    threads.push_back(std::thread([mode]() {
+        while (!s_stop)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(POLL_TICK_MS));
+            if (mode != Mode::BLOCKING) PollWaiters();
+        }
+    }));
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(RUN_MS));
+    s_stop = true;
+    for (size_t i = 0; i < threads.size(); i++) threads[i].join();
+
+    // Upiti ne smiju ostati u slotovima sljedećeg mjerenja
+    while (true)
+    {
+        bool waiting = false;
+        for (uint8_t i = 0; i < CST_CLIENTS; i++) {
+            waiting = waiting || s_conns[i].query != NULL;
+        }
+        if (!waiting) break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        PollWaiters();
+    }
+
+    printf("  %-12s cst: %5lu upita  p50 %7lu us  p99 %7lu us | stranica: p50 %6lu us  p99 %7lu us\n",
+           name, (unsigned long)cst->us.size(),
+           (unsigned long)cst->Percentile(50), (unsigned long)cst->Percentile(99),
+           (unsigned long)page->Percentile(50), (unsigned long)page->Percentile(99));
+}
+
+int main()
+{
+    g_appConfig.enable_dual_bus_mode = false;
+    g_appConfig.rs485_iface_addr = 0x0001;
+    g_appConfig.protocol_version_L = (uint8_t)ProtocolVersion::BJELASNICA;
+    g_appConfig.protocol_version_R = (uint8_t)ProtocolVersion::BJELASNICA;
+
+    g_rs485Service.Initialize();
+    g_rs485BusOwner.Initialize(&g_rs485Service);
+    g_rs485BusOwner.StartTask();
+    g_httpQueryManager.Initialize(&g_rs485BusOwner);
+    g_simRs485Bus.responder = RoomResponder;
+
+    for (uint8_t i = 0; i < CST_CLIENTS; i++) {
+        s_conns[i].address = FIRST_ROOM + i;
+    }
+    s_async_queue = xQueueCreate(64, sizeof(Event));
+    xTaskCreate(AsyncTcpTask, "async_tcp", 8192, NULL, 3, NULL);
+
+    printf("%u cst klijenata (0x%04X ne odgovara), stranica svakih %lu ms, %lu ms po mjerenju\n",
+           CST_CLIENTS, SILENT_ROOM, (unsigned long)PAGE_INTERVAL_MS, (unsigned long)RUN_MS);
+
+    Latencies blocking_cst, blocking_page, tick_cst, tick_page, wake_cst, wake_page;
+    RunMode(Mode::BLOCKING, "blokirajuci", &blocking_cst, &blocking_page);
+    RunMode(Mode::POLL_TICK, "poll tick", &tick_cst, &tick_page);
+    RunMode(Mode::WAKE, "budjenje", &wake_cst, &wake_page);
+
+    // Stranica ne čeka bus, a cst ne čeka poll tick
+    CHECK(wake_page.Percentile(99) < blocking_page.Percentile(99));
+    CHECK(wake_cst.Percentile(50) * 4 < tick_cst.Percentile(50));
+    CHECK(wake_cst.Percentile(99) < POLL_TICK_MS * 1000UL);
+
+    return HOST_TEST_RESULT();
+}
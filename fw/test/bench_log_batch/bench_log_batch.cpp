@@ -0,0 +1,209 @@
+/**
+ ******************************************************************************
+ * @file    bench_log_batch.cpp
+ * @author  Gemini & [Vase Ime]
+ * @brief   Host benchmark grupnog upisa logova (LogWriter) pod naletom događaja.
+ *
+ * @note
+ * Pravi LogPullManager, Rs485BusOwner, LogWriter i EepromStorage (nad modelom
+ * 24C1024): svi uređaji na busu odjednom imaju po nekoliko logova. Poller ne
+ * čeka upis i DELETE, pa logovi sa više uređaja stižu u prozoru
+ * LOG_WRITER_FLUSH_MS i upisuju se zajedno. Mjeri se broj ciklusa upisa
+ * EEPROM-a (tWR) po logu; poređenje je upis log po log (WriteLog(), ranije:
+ * slot + metapodaci = 2 ciklusa po logu).
+ ******************************************************************************
+ */
+
+#include "host_test.h"
+#include "LogPullManager.h"
+#include "LogWriter.h"
+#include "EepromStorage.h"
+#include "Rs485BusOwner.h"
+#include "HttpQueryManager.h" // GET_APPL_STAT
+#include "SimI2cEeprom.h"
+#include "SimRs485Bus.h"
+
+extern AppConfig g_appConfig;
+
+EepromStorage g_eepromStorage;
+LogWriter g_logWriter;
+Rs485Service g_rs485Service;
+Rs485BusOwner g_rs485BusOwner;
+LogPullManager g_logPullManager;
+
+static const uint16_t DEVICE_COUNT = 32;
+static const uint16_t FIRST_ADDRESS = 0x0201;
+static const uint16_t LOGS_PER_DEVICE = 4;      ///< Nalet: svaki uređaj ima logove u istom trenutku
+static const uint32_t TIMEOUT_MS = 20000;
+
+static uint16_t s_pending_logs[DEVICE_COUNT];
+static uint32_t s_logs_sent = 0;
+static uint32_t s_logs_deleted = 0;
+
+// ============================================================================
+// Uređaji na busu
+// ============================================================================
+
+static uint16_t BuildResponse(uint8_t* rx, uint16_t source, uint8_t cmd, const uint8_t* data, uint8_t data_len)
+{
+    uint16_t iface = g_appConfig.rs485_iface_addr;
+    uint16_t checksum = cmd;
+    uint16_t n = 0;
+
+    rx[n++] = SOH;
+    rx[n++] = (uint8_t)(iface >> 8);
+    rx[n++] = (uint8_t)iface;
+    rx[n++] = (uint8_t)(source >> 8);
+    rx[n++] = (uint8_t)source;
+    rx[n++] = (uint8_t)(data_len + 1);
+    rx[n++] = cmd;
+    for (uint8_t i = 0; i < data_len; i++)
+    {
+        rx[n++] = data[i];
+        checksum += data[i];
+    }
+    rx[n++] = (uint8_t)(checksum >> 8);
+    rx[n++] = (uint8_t)checksum;
+    rx[n++] = EOT;
+    return n;
+}
+
+static uint16_t DeviceResponder(void*, uint8_t, const uint8_t* tx, uint16_t tx_length,
+                                uint8_t* rx, uint16_t)
+{
+    if (tx_length < 7) return 0;
+    uint16_t address = (uint16_t)((tx[1] << 8) | tx[2]);
+    uint8_t cmd = tx[6];
+    if (address < FIRST_ADDRESS || address >= FIRST_ADDRESS + DEVICE_COUNT) {
+        return 0;
+    }
+    uint16_t* pending = &s_pending_logs[address - FIRST_ADDRESS];
+
+    switch (cmd)
+    {
+    case GET_SYS_STAT:
+    {
+        uint8_t status[2] = { (uint8_t)(*pending ? '1' : '0'), '0' };
+        return BuildResponse(rx, address, cmd, status, sizeof(status));
+    }
+    case GET_LOG_LIST:
+    {
+        if (*pending == 0) {
+            return BuildResponse(rx, address, cmd, NULL, 0);
+        }
+        uint8_t log[LOG_RECORD_SIZE + 1];
+        memset(log, 0, sizeof(log));
+        log[0] = (uint8_t)(s_logs_sent >> 8);
+        log[1] = (uint8_t)s_logs_sent;
+        log[2] = 0x10; // event
+        s_logs_sent++;
+        return BuildResponse(rx, address, cmd, log, sizeof(log));
+    }
+    case DEL_LOG_LIST:
+        if (*pending)
+        {
+            (*pending)--;
+            s_logs_deleted++;
+        }
+        return 0;
+    case GET_APPL_STAT:
+    {
+        uint8_t room[32];
+        memset(room, '0', sizeof(room));
+        return BuildResponse(rx, address, cmd, room, sizeof(room));
+    }
+    default:
+        return 0;
+    }
+}
+
+// ============================================================================
+// Mjerenje
+// ============================================================================
+
+static void PrintWrites(const char* name, uint32_t logs, uint32_t page_writes, uint32_t flushes)
+{
+    printf("  %-30s logova: %4lu  upisa (FlushLogs): %4lu  ciklusa tWR: %4lu  (%.2f po logu)\n",
+           name, (unsigned long)logs, (unsigned long)flushes, (unsigned long)page_writes,
+           logs ? (double)page_writes / logs : 0.0);
+}
+
+int main()
+{
+    g_eepromStorage.Initialize(I2C_SDA_PIN, I2C_SCL_PIN);
+    g_appConfig.logger_enable = true;
+    g_appConfig.enable_dual_bus_mode = false;
+    g_appConfig.protocol_version_L = (uint8_t)ProtocolVersion::BJELASNICA; // Standardni protokol (fire-and-forget DELETE)
+
+    uint16_t addresses[DEVICE_COUNT];
+    for (uint16_t i = 0; i < DEVICE_COUNT; i++)
+    {
+        addresses[i] = FIRST_ADDRESS + i;
+        s_pending_logs[i] = LOGS_PER_DEVICE;
+    }
+    CHECK(g_eepromStorage.WriteAddressList(addresses, DEVICE_COUNT));
+
+    g_logWriter.Initialize(&g_eepromStorage);
+    g_logWriter.StartTask();
+    g_rs485Service.Initialize();
+    g_rs485BusOwner.Initialize(&g_rs485Service);
+    g_rs485BusOwner.StartTask();
+    g_logPullManager.Initialize(&g_rs485BusOwner, &g_eepromStorage);
+    g_logPullManager.BuildDeviceTables();
+
+    g_simRs485Bus.responder = DeviceResponder;
+
+    const uint32_t logs_expected = (uint32_t)DEVICE_COUNT * LOGS_PER_DEVICE;
+    printf("%u uređaja x %u logova, prozor grupe %u ms, tWR %lu us\n",
+           DEVICE_COUNT, LOGS_PER_DEVICE, LOG_WRITER_FLUSH_MS,
+           (unsigned long)g_simEeprom.write_cycle_us);
+
+    // ------------------------------------------------------------------------
+    // Nalet kroz poller i LogWriter
+    // ------------------------------------------------------------------------
+    g_simEeprom.ClearStats();
+    uint32_t start = millis();
+    while (s_logs_deleted < logs_expected && millis() - start < TIMEOUT_MS)
+    {
+        g_logPullManager.Run();
+        if (g_logPullManager.IsWaitingForResponse()) {
+            ulTaskNotifyTake(pdTRUE, 1);
+        }
+    }
+    uint32_t burst_ms = millis() - start;
+    uint32_t burst_page_writes = g_simEeprom.stats.page_writes;
+    LogWriterStats writer = g_logWriter.GetStats();
+
+    // ------------------------------------------------------------------------
+    // Log po log (ranije): svaki log je svoj upis slota i metapodataka
+    // ------------------------------------------------------------------------
+    const uint16_t SINGLE_LOGS = 16;
+    g_simEeprom.ClearStats();
+    for (uint16_t i = 0; i < SINGLE_LOGS; i++)
+    {
+        LogEntry entry;
+        memset(&entry, 0, sizeof(entry));
+        entry.log_id = (uint16_t)(0x8000 + i);
+        entry.event_code = 0x10;
+        entry.device_addr = FIRST_ADDRESS;
+        CHECK(g_eepromStorage.WriteLog(&entry) == LoggerStatus::LOGGER_OK);
+    }
+    uint32_t single_page_writes = g_simEeprom.stats.page_writes;
+
+    printf("  nalet upisan i obrisan za %lu ms, najveća grupa: %u, predaja->upisano avg %lu us\n",
+           (unsigned long)burst_ms, writer.max_batch,
+           (unsigned long)(writer.written ? writer.total_latency_us / writer.written : 0));
+    PrintWrites("nalet (grupni upis)", writer.written, burst_page_writes, writer.flushes);
+    PrintWrites("log po log (ranije)", SINGLE_LOGS, single_page_writes, SINGLE_LOGS);
+
+    CHECK_EQ(s_logs_deleted, logs_expected);
+    CHECK_EQ(s_logs_sent, s_logs_deleted);
+    CHECK_EQ(writer.written, logs_expected);
+    CHECK_EQ(writer.failed, 0u);
+    // Grupe od više logova: manje upisa od logova i manje ciklusa tWR po logu
+    CHECK(writer.max_batch > 1);
+    CHECK(writer.flushes < logs_expected);
+    CHECK(burst_page_writes * SINGLE_LOGS < single_page_writes * logs_expected);
+
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,368 @@
+/**
+ ******************************************************************************
+ * @file    bench_loop_latency.cpp
+ * @author  Gemini & [Vase Ime]
+ * @brief   Host benchmark trajanja iteracije loop()-a uz LogPullManager nad
+ *          simuliranom RS485 magistralom.
+ *
+ * @note
+ * Pravi LogPullManager, Rs485BusOwner, LogWriter i EepromStorage (nad modelom
+ * 24C1024) rade kao na uređaju; uređaje na busu glumi responder ispod (neki
+ * imaju logove, jedan ne odgovara). Petlja oponaša loop() iz main.cpp:
+ * Run(), pa ulTaskNotifyTake(1 tick) dok poller čeka. Responder provjerava i
+ * da poller ne šalje GET_LOG uređaju čiji DELETE još nije stigao, a obilazi
+ * druge uređaje dok log čeka upis.
+ *
+ * Poređenje je blokirajući obrazac od prije (Run() je sjedio u ReceivePacket()
+ * do odgovora ili timeout-a): iteracija tada traje koliko cijela transakcija.
+ *
+ * Zidni max iteracije na hostu (do nekoliko ms) nije rad Run()-a: to je
+ * preempcija (Run() budi zadatke vlasnika magistrale i LogWriter-a, koji na
+ * hostu dijele procesor sa petljom) i oduzimanje vCPU-a, koje se vidi i na
+ * praznoj iteraciji mjerenoj u istoj petlji. Zato se uz zidno vrijeme mjeri
+ * i rad iteracije (CPU sat niti, ograničen zidnim jer CPU sat u VM-u zna
+ * skočiti) i promjene konteksta: voljna znači da je nit čekala, nevoljna
+ * preempciju.
+ ******************************************************************************
+ */
+
+#include "host_test.h"
+#include "LogPullManager.h"
+#include "LogWriter.h"
+#include "EepromStorage.h"
+#include "Rs485BusOwner.h"
+#include "HttpQueryManager.h" // GET_APPL_STAT
+#include "SimRs485Bus.h"
+#include <algorithm>
+#include <vector>
+#include <sys/resource.h>
+
+extern AppConfig g_appConfig;
+
+EepromStorage g_eepromStorage;
+LogWriter g_logWriter;
+Rs485Service g_rs485Service;
+Rs485BusOwner g_rs485BusOwner;
+LogPullManager g_logPullManager;
+
+static const uint16_t DEVICE_COUNT = 24;
+static const uint16_t FIRST_ADDRESS = 0x0101;
+static const uint16_t SILENT_ADDRESS = FIRST_ADDRESS + 7;   ///< Uređaj koji ne odgovara
+static const uint16_t LOGS_PER_DEVICE = 3;                  ///< Samo svaki treći uređaj ima logove
+static const uint32_t RUN_MS = 3000;
+
+static uint16_t s_pending_logs[DEVICE_COUNT];
+static uint32_t s_logs_sent = 0;
+static uint32_t s_logs_deleted = 0;   ///< DELETE ide tek nakon upisa loga u EEPROM
+static bool s_log_outstanding[DEVICE_COUNT]; ///< Log je poslan, DELETE još nije stigao
+static uint16_t s_outstanding = 0;
+static uint16_t s_max_outstanding = 0;  ///< Uređaja sa logom u toku upisa istovremeno
+static uint32_t s_get_log_before_delete = 0;
+
+// ============================================================================
+// Uređaji na busu
+// ============================================================================
+
+static uint16_t BuildResponse(uint8_t* rx, uint16_t source, uint8_t cmd, const uint8_t* data, uint8_t data_len)
+{
+    uint16_t iface = g_appConfig.rs485_iface_addr;
+    uint16_t checksum = cmd;
+    uint16_t n = 0;
+
+    rx[n++] = SOH;
+    rx[n++] = (uint8_t)(iface >> 8);
+    rx[n++] = (uint8_t)iface;
+    rx[n++] = (uint8_t)(source >> 8);
+    rx[n++] = (uint8_t)source;
+    rx[n++] = (uint8_t)(data_len + 1);
+    rx[n++] = cmd;
+    for (uint8_t i = 0; i < data_len; i++)
+    {
+        rx[n++] = data[i];
+        checksum += data[i];
+    }
+    rx[n++] = (uint8_t)(checksum >> 8);
+    rx[n++] = (uint8_t)checksum;
+    rx[n++] = EOT;
+    return n;
+}
+
+static uint16_t DeviceResponder(void*, uint8_t, const uint8_t* tx, uint16_t tx_length,
+                                uint8_t* rx, uint16_t)
+{
+    if (tx_length < 7) return 0;
+    uint16_t address = (uint16_t)((tx[1] << 8) | tx[2]);
+    uint8_t cmd = tx[6];
+    if (address < FIRST_ADDRESS || address >= FIRST_ADDRESS + DEVICE_COUNT || address == SILENT_ADDRESS) {
+        return 0;
+    }
+    uint16_t* pending = &s_pending_logs[address - FIRST_ADDRESS];
+
+    switch (cmd)
+    {
+    case GET_SYS_STAT:
+    {
+        uint8_t status[2] = { (uint8_t)(*pending ? '1' : '0'), '0' };
+        return BuildResponse(rx, address, cmd, status, sizeof(status));
+    }
+    case GET_LOG_LIST:
+    {
+        if (*pending == 0) {
+            return BuildResponse(rx, address, cmd, NULL, 0);
+        }
+        // GET_LOG prije DELETE-a prethodnog loga bi vratio isti log (dupli upis)
+        if (s_log_outstanding[address - FIRST_ADDRESS]) {
+            s_get_log_before_delete++;
+        } else {
+            s_log_outstanding[address - FIRST_ADDRESS] = true;
+            s_outstanding++;
+            if (s_outstanding > s_max_outstanding) s_max_outstanding = s_outstanding;
+        }
+        uint8_t log[LOG_RECORD_SIZE + 1];
+        memset(log, 0, sizeof(log));
+        log[0] = (uint8_t)(s_logs_sent >> 8);
+        log[1] = (uint8_t)s_logs_sent;
+        log[2] = 0x10; // event
+        s_logs_sent++;
+        return BuildResponse(rx, address, cmd, log, sizeof(log));
+    }
+    case DEL_LOG_LIST:
+        if (*pending)
+        {
+            (*pending)--;
+            s_logs_deleted++;
+        }
+        if (s_log_outstanding[address - FIRST_ADDRESS])
+        {
+            s_log_outstanding[address - FIRST_ADDRESS] = false;
+            s_outstanding--;
+        }
+        return 0;
+    case GET_APPL_STAT:
+    {
+        uint8_t room[32];
+        memset(room, '0', sizeof(room));
+        return BuildResponse(rx, address, cmd, room, sizeof(room));
+    }
+    default:
+        return 0;
+    }
+}
+
+// ============================================================================
+// Mjerenje
+// ============================================================================
+
+/**
+ * @brief Promjene konteksta pozivajuće niti (voljne = nit je čekala, nevoljne = preempcija).
+ */
+static void ThreadSwitches(long* voluntary, long* involuntary)
+{
+    struct rusage usage;
+    getrusage(RUSAGE_THREAD, &usage);
+    *voluntary = usage.ru_nvcsw;
+    *involuntary = usage.ru_nivcsw;
+}
+
+struct LatencyStats
+{
+    std::vector<uint32_t> samples_us;
+    uint32_t max_us;
+    uint32_t slowest_work_us;   ///< Rad najsporije iteracije
+    uint32_t max_work_us;       ///< Rad = min(CPU niti, zid): bez preempcije i bez skokova CPU sata
+    uint32_t preempted;         ///< Iteracija sa nevoljnom promjenom konteksta
+    uint32_t blocked;           ///< Iteracija u kojoj je nit čekala (voljna promjena konteksta)
+
+    LatencyStats() : max_us(0), slowest_work_us(0), max_work_us(0), preempted(0), blocked(0) {}
+
+    void Add(uint64_t ns, uint64_t cpu_ns, long voluntary, long involuntary)
+    {
+        uint32_t us = (uint32_t)(ns / 1000);
+        uint32_t work_us = (uint32_t)(std::min(ns, cpu_ns) / 1000);
+        samples_us.push_back(us);
+        if (us >= max_us)
+        {
+            max_us = us;
+            slowest_work_us = work_us;
+        }
+        if (work_us > max_work_us) max_work_us = work_us;
+        if (voluntary) blocked++;
+        if (involuntary) preempted++;
+    }
+
+    void Print(const char* name)
+    {
+        std::sort(samples_us.begin(), samples_us.end());
+        size_t n = samples_us.size();
+        uint64_t sum = 0;
+        for (size_t i = 0; i < n; i++) sum += samples_us[i];
+        printf("  %-28s iteracija: %7lu  avg %6lu us  p99 %6lu us  max %6lu us\n", name,
+               (unsigned long)n,
+               (unsigned long)(n ? sum / n : 0),
+               (unsigned long)P99(),
+               (unsigned long)max_us);
+        printf("  %-28s rad max %5lu us (najsporija iteracija %lu us), preempcija %lu, čekanje %lu\n", "",
+               (unsigned long)max_work_us, (unsigned long)slowest_work_us,
+               (unsigned long)preempted, (unsigned long)blocked);
+    }
+
+    /// Nakon Print() (uzorci su sortirani)
+    uint32_t P99() const { return samples_us.empty() ? 0 : samples_us[(samples_us.size() * 99) / 100]; }
+};
+
+/**
+ * @brief Mjeri fn() zidnim satom, CPU satom niti i brojačima promjena konteksta.
+ */
+template <typename Fn>
+static void Measure(LatencyStats* stats, Fn fn)
+{
+    long vcsw0, ivcsw0, vcsw1, ivcsw1;
+    ThreadSwitches(&vcsw0, &ivcsw0);
+    uint64_t cpu0 = HostThreadCpuNs();
+    uint64_t t0 = HostNowNs();
+    fn();
+    uint64_t t1 = HostNowNs();
+    uint64_t cpu1 = HostThreadCpuNs();
+    ThreadSwitches(&vcsw1, &ivcsw1);
+    stats->Add(t1 - t0, cpu1 - cpu0, vcsw1 - vcsw0, ivcsw1 - ivcsw0);
+}
+
+static void Nothing() {}
+
+static void RunPoller() { g_logPullManager.Run(); }
+
+static void ResetDevices()
+{
+    for (uint16_t i = 0; i < DEVICE_COUNT; i++) {
+        s_pending_logs[i] = (i % 3 == 0) ? LOGS_PER_DEVICE : 0;
+        s_log_outstanding[i] = false;
+    }
+    s_outstanding = 0;
+    s_max_outstanding = 0;
+    s_get_log_before_delete = 0;
+    s_logs_sent = 0;
+    s_logs_deleted = 0;
+}
+
+/**
+ * @brief Petlja kao loop() u RUN_POLLING stanju, sa neblokirajućim poller-om.
+ * @param idle Prazna mjerena iteracija uz svaki Run() (šum hosta).
+ */
+static void BenchNonBlocking(LatencyStats* stats, LatencyStats* idle)
+{
+    uint32_t start = millis();
+
+    while (millis() - start < RUN_MS)
+    {
+        Measure(stats, RunPoller);
+        // Kontrola: prazna iteracija pod istim opterećenjem hosta (šum okruženja)
+        Measure(idle, Nothing);
+
+        if (g_logPullManager.IsWaitingForResponse()) {
+            ulTaskNotifyTake(pdTRUE, 1);
+        }
+    }
+}
+
+/**
+ * @brief Blokirajući obrazac od prije: svaka iteracija čeka odgovor na upit.
+ */
+static void BenchBlocking(LatencyStats* stats)
+{
+    uint8_t tx[10];
+    uint8_t rx[MAX_PACKET_LENGTH];
+    uint16_t iface = g_appConfig.rs485_iface_addr;
+    uint16_t index = 0;
+    uint32_t start = millis();
+
+    while (millis() - start < RUN_MS)
+    {
+        uint16_t address = FIRST_ADDRESS + (index++ % DEVICE_COUNT);
+        tx[0] = SOH;
+        tx[1] = (uint8_t)(address >> 8);
+        tx[2] = (uint8_t)address;
+        tx[3] = (uint8_t)(iface >> 8);
+        tx[4] = (uint8_t)iface;
+        tx[5] = 1;
+        tx[6] = GET_SYS_STAT;
+        tx[7] = 0;
+        tx[8] = GET_SYS_STAT;
+        tx[9] = EOT;
+
+        long vcsw0, ivcsw0, vcsw1, ivcsw1;
+        ThreadSwitches(&vcsw0, &ivcsw0);
+        uint64_t cpu0 = HostThreadCpuNs();
+        uint64_t t0 = HostNowNs();
+        g_rs485BusOwner.Transact(BusPriority::POLLING, RS485_BUS_CURRENT, tx, sizeof(tx),
+                                 rx, sizeof(rx), RS485_RESP_TOUT_MS);
+        uint64_t t1 = HostNowNs();
+        uint64_t cpu1 = HostThreadCpuNs();
+        ThreadSwitches(&vcsw1, &ivcsw1);
+        stats->Add(t1 - t0, cpu1 - cpu0, vcsw1 - vcsw0, ivcsw1 - ivcsw0);
+    }
+}
+
+int main()
+{
+    g_eepromStorage.Initialize(I2C_SDA_PIN, I2C_SCL_PIN);
+    g_appConfig.logger_enable = true;
+    g_appConfig.enable_dual_bus_mode = false;
+    g_appConfig.protocol_version_L = (uint8_t)ProtocolVersion::BJELASNICA; // Standardni protokol (fire-and-forget DELETE)
+
+    uint16_t addresses[DEVICE_COUNT];
+    for (uint16_t i = 0; i < DEVICE_COUNT; i++) {
+        addresses[i] = FIRST_ADDRESS + i;
+    }
+    CHECK(g_eepromStorage.WriteAddressList(addresses, DEVICE_COUNT));
+
+    g_logWriter.Initialize(&g_eepromStorage);
+    g_logWriter.StartTask();
+    g_rs485Service.Initialize();
+    g_rs485BusOwner.Initialize(&g_rs485Service);
+    g_rs485BusOwner.StartTask();
+    g_logPullManager.Initialize(&g_rs485BusOwner, &g_eepromStorage);
+    g_logPullManager.BuildDeviceTables();
+
+    g_simRs485Bus.responder = DeviceResponder;
+
+    printf("%u uređaja (0x%04X ne odgovara), %lu ms po mjerenju\n",
+           DEVICE_COUNT, SILENT_ADDRESS, (unsigned long)RUN_MS);
+
+    ResetDevices();
+    uint32_t logs_expected = 0;
+    for (uint16_t i = 0; i < DEVICE_COUNT; i++) {
+        if (FIRST_ADDRESS + i != SILENT_ADDRESS) logs_expected += s_pending_logs[i];
+    }
+
+    LatencyStats non_blocking;
+    LatencyStats idle;
+    BenchNonBlocking(&non_blocking, &idle);
+    printf("  logova upisano i obrisano: %lu / %lu, najviše uređaja sa logom u upisu: %u\n",
+           (unsigned long)s_logs_deleted, (unsigned long)logs_expected, s_max_outstanding);
+
+    LatencyStats blocking;
+    BenchBlocking(&blocking);
+
+    non_blocking.Print("neblokirajuci Run()");
+    idle.Print("prazna iteracija (šum)");
+    blocking.Print("blokirajuci upit (ranije)");
+
+    // Iteracija ne smije čekati na bus (ni na timeout uređaja koji ne odgovara).
+    // Zidni max je šum hosta (preempcija, vCPU), vidi praznu iteraciju.
+    // Najgori slučaj se zato provjerava kroz čekanje i rad iteracije: Run() nikada
+    // ne spava (detektor čekanja vidi svaki blokirajući upit), a rad je kraći od
+    // najkraćeg upita na liniji.
+    uint32_t shortest_txn_us = g_simRs485Bus.turnaround_us + g_simRs485Bus.FrameUs(10);
+    CHECK_EQ(s_logs_deleted, logs_expected);
+    CHECK_EQ(s_logs_sent, s_logs_deleted);
+    CHECK_EQ(s_get_log_before_delete, 0u);
+    // Dok log čeka upis i DELETE, poller obilazi druge uređaje
+    CHECK(s_max_outstanding > 1);
+    CHECK(non_blocking.P99() < 1000);
+    CHECK_EQ(non_blocking.blocked, 0u);
+    CHECK(non_blocking.max_work_us < shortest_txn_us);
+    CHECK_EQ(blocking.blocked, blocking.samples_us.size());
+    CHECK(blocking.P99() >= RS485_RESP_TOUT_MS * 1000UL);
+
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,395 @@
+/**
+ ******************************************************************************
+ * @file    bench_poll_scheduler.cpp
+ * @author  Gemini & [Vase Ime]
+ * @brief   Host benchmark kašnjenja događaj -> EEPROM na zgradi od 500 soba.
+ *
+ * @note
+ * Zgrada je na dva busa (dual bus mod, 2 x MAX_ADDRESS_LIST_SIZE_PER_BUS soba)
+ * sa jednim pollerom. Sobe glumi responder nad simuliranom magistralom: dio soba ne odgovara
+ * (isključen kontroler), a događaji dolaze po unaprijed zadanom rasporedu -
+ * aktivnosti od po tri događaja (kartica, vrata, kartica) u nasumičnim sobama
+ * i nalet u kojem desetine soba dobiju događaj skoro istovremeno. Soba vidi
+ * događaj od njegovog trenutka; kašnjenje je od tog trenutka do DELETE-a
+ * (DELETE ide tek nakon upisa loga u EEPROM).
+ *
+ * Novi poller se prije mjerenja zagrije bez događaja: prvi obilazak nakon
+ * boot-a puni keš statusa soba (GET_APPL_STAT po sobi), a mrtve sobe ulaze u
+ * backoff tek nakon POLL_BACKOFF_THRESHOLD timeout-a. Mjeri se ustaljen rad;
+ * trajanje zagrijavanja se ispisuje.
+ *
+ * Poređenje:
+ * - novi LogPullManager (PollScheduler: backoff mrtvih soba, vrući red) sa
+ *   LogWriter-om, kao loop() u main.cpp;
+ * - strogi round-robin od prije (GetNextAddress(): sve sa L, pa sve sa R):
+ *   status, pa GET_LOG /
+ *   WriteLog() / DELETE dok soba ima logova, svaka mrtva soba košta puni
+ *   timeout u svakom obilasku.
+ ******************************************************************************
+ */
+
+#include "host_test.h"
+#include "LogPullManager.h"
+#include "LogWriter.h"
+#include "EepromStorage.h"
+#include "Rs485BusOwner.h"
+#include "HttpQueryManager.h" // GET_APPL_STAT
+#include "SimRs485Bus.h"
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+extern AppConfig g_appConfig;
+
+EepromStorage g_eepromStorage;
+LogWriter g_logWriter;
+Rs485Service g_rs485Service;
+Rs485BusOwner g_rs485BusOwner;
+LogPullManager g_logPullManager;
+
+static const uint16_t ROOMS_PER_BUS = MAX_ADDRESS_LIST_SIZE_PER_BUS;
+static const uint16_t ROOM_COUNT = 2 * ROOMS_PER_BUS;
+static const uint16_t FIRST_ADDRESS = 0x0101;
+static const uint16_t DEAD_EVERY = 20;          ///< Svaka 20. soba ne odgovara (25 soba)
+static const uint32_t EVENTS_MS = 10000;        ///< Trajanje rasporeda događaja
+static const uint32_t ACTIVITY_PERIOD_MS = 400; ///< Nova aktivnost u nasumičnoj sobi
+static const uint32_t ACTIVITY_STEP_MS = 500;   ///< Razmak tri događaja jedne aktivnosti
+static const uint32_t BURST_AT_MS = 4000;
+static const uint16_t BURST_ROOMS = 40;         ///< Soba sa događajem u naletu (u 200 ms)
+static const uint32_t DRAIN_LIMIT_MS = 20000;   ///< Max vremena nakon rasporeda za preuzimanje
+
+struct Room
+{
+    std::vector<uint32_t> events_ms;   ///< Trenuci događaja (sortirano)
+    uint16_t deleted;                  ///< Događaja upisanih i obrisanih sa sobe
+};
+
+static Room s_rooms[ROOM_COUNT];
+static uint32_t s_event_count = 0;
+static uint64_t s_start_ns = 0;
+static bool s_started = false;                 ///< Prije StartSchedule() sobe nemaju događaja
+static std::atomic<uint32_t> s_deleted(0);
+static std::vector<uint32_t> s_latency_us;     ///< Puni ga samo nit vlasnika magistrale
+
+static bool IsDead(uint16_t index)
+{
+    return (index % DEAD_EVERY) == DEAD_EVERY - 1;
+}
+
+static uint32_t NowMs()
+{
+    return (uint32_t)((HostNowNs() - s_start_ns) / 1000000ULL);
+}
+
+/**
+ * @brief Broj događaja koji su se desili a nisu obrisani sa sobe.
+ */
+static uint16_t VisibleEvents(const Room* room, uint32_t now_ms)
+{
+    if (!s_started) return 0;
+    uint16_t n = room->deleted;
+    while (n < room->events_ms.size() && room->events_ms[n] <= now_ms) {
+        n++;
+    }
+    return (uint16_t)(n - room->deleted);
+}
+
+// ============================================================================
+// Raspored događaja
+// ============================================================================
+
+static uint32_t s_rand_state = 12345;
+
+static uint16_t RandomLiveRoom()
+{
+    uint16_t index;
+    do
+    {
+        s_rand_state = s_rand_state * 1103515245UL + 12345UL;
+        index = (uint16_t)((s_rand_state >> 16) % ROOM_COUNT);
+    } while (IsDead(index));
+    return index;
+}
+
+static void BuildSchedule()
+{
+    for (uint32_t t = 0; t < EVENTS_MS; t += ACTIVITY_PERIOD_MS)
+    {
+        Room* room = &s_rooms[RandomLiveRoom()];
+        for (uint8_t step = 0; step < 3; step++) {
+            room->events_ms.push_back(t + step * ACTIVITY_STEP_MS);
+        }
+    }
+    for (uint16_t i = 0; i < BURST_ROOMS; i++) {
+        s_rooms[RandomLiveRoom()].events_ms.push_back(BURST_AT_MS + i * 5);
+    }
+    for (uint16_t i = 0; i < ROOM_COUNT; i++)
+    {
+        std::sort(s_rooms[i].events_ms.begin(), s_rooms[i].events_ms.end());
+        s_event_count += (uint32_t)s_rooms[i].events_ms.size();
+    }
+}
+
+static void StartSchedule()
+{
+    for (uint16_t i = 0; i < ROOM_COUNT; i++) {
+        s_rooms[i].deleted = 0;
+    }
+    s_deleted = 0;
+    s_latency_us.clear();
+    s_latency_us.reserve(s_event_count);
+    s_start_ns = HostNowNs();
+    s_started = true;
+}
+
+// ============================================================================
+// Sobe na busu
+// ============================================================================
+
+static uint16_t BuildResponse(uint8_t* rx, uint16_t source, uint8_t cmd, const uint8_t* data, uint8_t data_len)
+{
+    uint16_t iface = g_appConfig.rs485_iface_addr;
+    uint16_t checksum = cmd;
+    uint16_t n = 0;
+
+    rx[n++] = SOH;
+    rx[n++] = (uint8_t)(iface >> 8);
+    rx[n++] = (uint8_t)iface;
+    rx[n++] = (uint8_t)(source >> 8);
+    rx[n++] = (uint8_t)source;
+    rx[n++] = (uint8_t)(data_len + 1);
+    rx[n++] = cmd;
+    for (uint8_t i = 0; i < data_len; i++)
+    {
+        rx[n++] = data[i];
+        checksum += data[i];
+    }
+    rx[n++] = (uint8_t)(checksum >> 8);
+    rx[n++] = (uint8_t)checksum;
+    rx[n++] = EOT;
+    return n;
+}
+
+static uint16_t RoomResponder(void*, uint8_t, const uint8_t* tx, uint16_t tx_length,
+                              uint8_t* rx, uint16_t)
+{
+    if (tx_length < 7) return 0;
+    uint16_t address = (uint16_t)((tx[1] << 8) | tx[2]);
+    uint8_t cmd = tx[6];
+    if (address < FIRST_ADDRESS || address >= FIRST_ADDRESS + ROOM_COUNT || IsDead(address - FIRST_ADDRESS)) {
+        return 0;
+    }
+    Room* room = &s_rooms[address - FIRST_ADDRESS];
+    uint16_t pending = VisibleEvents(room, NowMs());
+
+    switch (cmd)
+    {
+    case GET_SYS_STAT:
+    {
+        uint8_t status[2] = { (uint8_t)(pending ? '1' : '0'), '0' };
+        return BuildResponse(rx, address, cmd, status, sizeof(status));
+    }
+    case GET_LOG_LIST:
+    {
+        if (pending == 0) {
+            return BuildResponse(rx, address, cmd, NULL, 0);
+        }
+        uint8_t log[LOG_RECORD_SIZE + 1];
+        memset(log, 0, sizeof(log));
+        log[0] = (uint8_t)(room->deleted >> 8);
+        log[1] = (uint8_t)room->deleted;
+        log[2] = 0x10; // event
+        return BuildResponse(rx, address, cmd, log, sizeof(log));
+    }
+    case DEL_LOG_LIST:
+        if (pending)
+        {
+            uint64_t event_ns = s_start_ns + (uint64_t)room->events_ms[room->deleted] * 1000000ULL;
+            s_latency_us.push_back((uint32_t)((HostNowNs() - event_ns) / 1000));
+            room->deleted++;
+            s_deleted++;
+        }
+        return 0;
+    case GET_APPL_STAT:
+    {
+        uint8_t status[32];
+        memset(status, '0', sizeof(status));
+        return BuildResponse(rx, address, cmd, status, sizeof(status));
+    }
+    default:
+        return 0;
+    }
+}
+
+// ============================================================================
+// Mjerenje
+// ============================================================================
+
+struct LatencyResult
+{
+    uint32_t events;
+    uint32_t mean_ms;
+    uint32_t p99_ms;
+    uint32_t max_ms;
+};
+
+static LatencyResult TakeLatency()
+{
+    std::vector<uint32_t> samples = s_latency_us;
+    std::sort(samples.begin(), samples.end());
+    size_t n = samples.size();
+    uint64_t sum = 0;
+    for (size_t i = 0; i < n; i++) sum += samples[i];
+
+    LatencyResult result;
+    result.events = (uint32_t)n;
+    result.mean_ms = (uint32_t)(n ? sum / n / 1000 : 0);
+    result.p99_ms = n ? samples[(n * 99) / 100] / 1000 : 0;
+    result.max_ms = n ? samples[n - 1] / 1000 : 0;
+    return result;
+}
+
+static void PrintLatency(const char* name, const LatencyResult& r)
+{
+    printf("  %-30s događaja: %4lu  avg %5lu ms  p99 %5lu ms  max %5lu ms\n", name,
+           (unsigned long)r.events, (unsigned long)r.mean_ms,
+           (unsigned long)r.p99_ms, (unsigned long)r.max_ms);
+}
+
+static bool Done()
+{
+    return s_deleted >= s_event_count || NowMs() > EVENTS_MS + DRAIN_LIMIT_MS;
+}
+
+static void RunPoller()
+{
+    g_logPullManager.Run();
+    if (g_logPullManager.IsWaitingForResponse()) {
+        ulTaskNotifyTake(pdTRUE, 1);
+    }
+}
+
+/**
+ * @brief Novi poller bez događaja dok ne obiđe listu zadani broj puta.
+ * @return Trajanje zagrijavanja (ms).
+ */
+static uint32_t WarmUpScheduler(uint32_t sweeps)
+{
+    uint32_t start = millis();
+    while (g_logPullManager.GetScheduler().GetSweeps() < sweeps) {
+        RunPoller();
+    }
+    return millis() - start;
+}
+
+/**
+ * @brief Novi poller: petlja kao loop() u RUN_POLLING stanju.
+ */
+static void BenchScheduler()
+{
+    StartSchedule();
+    while (!Done()) {
+        RunPoller();
+    }
+}
+
+static int Request(uint8_t bus, uint16_t address, uint8_t cmd, uint8_t* rx, uint16_t rx_size, uint32_t timeout_ms)
+{
+    uint16_t iface = g_appConfig.rs485_iface_addr;
+    uint8_t tx[10] = { SOH, (uint8_t)(address >> 8), (uint8_t)address,
+                       (uint8_t)(iface >> 8), (uint8_t)iface, 1, cmd, 0, cmd, EOT };
+    int length = g_rs485BusOwner.Transact(BusPriority::POLLING, bus, tx, sizeof(tx),
+                                          rx, rx_size, timeout_ms);
+    delay(RX2TX_DEL_MS);
+    return length;
+}
+
+/**
+ * @brief Round-robin od prije: sobe redom, pražnjenje sa upisom u pozivaocu.
+ */
+static void BenchRoundRobin()
+{
+    uint8_t rx[MAX_PACKET_LENGTH];
+    uint16_t index = 0;
+
+    StartSchedule();
+    while (!Done())
+    {
+        uint16_t address = FIRST_ADDRESS + index;
+        uint8_t bus = (index < ROOMS_PER_BUS) ? 0 : 1;
+        index = (uint16_t)((index + 1) % ROOM_COUNT);
+
+        while (Request(bus, address, GET_SYS_STAT, rx, sizeof(rx), RS485_RESP_TOUT_MS) > 7 && rx[7] == '1')
+        {
+            if (Request(bus, address, GET_LOG_LIST, rx, sizeof(rx), RS485_RESP_TOUT_MS) < 7 + LOG_RECORD_SIZE) {
+                break;
+            }
+            LogEntry entry;
+            memcpy(&entry, &rx[7], LOG_RECORD_SIZE);
+            if (g_eepromStorage.WriteLog(&entry) != LoggerStatus::LOGGER_OK) {
+                break;
+            }
+            Request(bus, address, DEL_LOG_LIST, NULL, 0, 0);
+        }
+    }
+}
+
+int main()
+{
+    g_eepromStorage.Initialize(I2C_SDA_PIN, I2C_SCL_PIN);
+    g_appConfig.logger_enable = true;
+    g_appConfig.enable_dual_bus_mode = true;
+    g_appConfig.protocol_version_L = (uint8_t)ProtocolVersion::BJELASNICA; // Standardni protokol (fire-and-forget DELETE)
+    g_appConfig.protocol_version_R = (uint8_t)ProtocolVersion::BJELASNICA;
+
+    uint16_t addresses[ROOM_COUNT];
+    for (uint16_t i = 0; i < ROOM_COUNT; i++) {
+        addresses[i] = FIRST_ADDRESS + i;
+    }
+    CHECK(g_eepromStorage.WriteAddressListL(addresses, ROOMS_PER_BUS));
+    CHECK(g_eepromStorage.WriteAddressListR(addresses + ROOMS_PER_BUS, ROOMS_PER_BUS));
+
+    g_logWriter.Initialize(&g_eepromStorage);
+    g_logWriter.StartTask();
+    g_rs485Service.Initialize();
+    g_rs485BusOwner.Initialize(&g_rs485Service);
+    g_rs485BusOwner.StartTask();
+    g_logPullManager.Initialize(&g_rs485BusOwner, &g_eepromStorage);
+    g_logPullManager.BuildDeviceTables();
+
+    g_simRs485Bus.responder = RoomResponder;
+    BuildSchedule();
+
+    printf("%u soba (%u ne odgovara), %lu događaja u %lu ms, nalet %u soba u %lu. ms\n",
+           ROOM_COUNT, ROOM_COUNT / DEAD_EVERY, (unsigned long)s_event_count,
+           (unsigned long)EVENTS_MS, BURST_ROOMS, (unsigned long)BURST_AT_MS);
+
+    const PollScheduler& schedule = g_logPullManager.GetScheduler();
+    uint32_t warm_up_ms = WarmUpScheduler(POLL_BACKOFF_THRESHOLD);
+    uint32_t sweeps = schedule.GetSweeps();
+    uint32_t hot_visits = schedule.GetHotVisits();
+    uint32_t backoff_skips = schedule.GetBackoffSkips();
+    printf("  zagrijavanje (keš statusa, backoff mrtvih): %lu obilaska za %lu ms\n",
+           (unsigned long)sweeps, (unsigned long)warm_up_ms);
+
+    BenchScheduler();
+    LatencyResult scheduler = TakeLatency();
+    printf("  raspored: obilazaka %lu, vrućih posjeta %lu, preskočeno (backoff) %lu\n",
+           (unsigned long)(schedule.GetSweeps() - sweeps),
+           (unsigned long)(schedule.GetHotVisits() - hot_visits),
+           (unsigned long)(schedule.GetBackoffSkips() - backoff_skips));
+
+    BenchRoundRobin();
+    LatencyResult round_robin = TakeLatency();
+
+    PrintLatency("PollScheduler + LogWriter", scheduler);
+    PrintLatency("round-robin (ranije)", round_robin);
+
+    CHECK_EQ(scheduler.events, s_event_count);
+    CHECK_EQ(round_robin.events, s_event_count);
+    // Mrtve sobe ne koštaju timeout u svakom obilasku, aktivne se posjećuju češće.
+    // p99 su sobe iz naleta koje čekaju redovni obilazak - samo se ispisuje.
+    CHECK(scheduler.mean_ms < round_robin.mean_ms);
+
+    return HOST_TEST_RESULT();
+}
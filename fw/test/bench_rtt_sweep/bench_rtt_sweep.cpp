@@ -0,0 +1,185 @@
+/**
+ ******************************************************************************
+ * @file    bench_rtt_sweep.cpp
+ * @author  Gemini & [Vase Ime]
+ * @brief   Host benchmark obilaska busa: fiksni timeout vs RTT procjena po uređaju.
+ *
+ * @note
+ * Obilazak je STATUS upit svakoj sobi na busu (Submit/WaitForResult preko
+ * vlasnika magistrale, pauza RX2TX_DEL_MS između okvira), kao posjeta u
+ * LogPullManager-u bez logova. K soba je mrtvo (ne odgovara). Fiksno: svaki
+ * upit čeka RS485_RESP_TOUT_MS. Adaptivno: timeout iz RttTable, koja se puni
+ * kao u LogPullManager-u (uzorak na odgovor prvog pokušaja, timeout bez
+ * uzorka). Mjeri se drugi obilazak (prvi popuni tabelu); svaki osmi
+ * kontroler odgovara sporije, pa procjena po uređaju ne smije da ga odsiječe.
+ ******************************************************************************
+ */
+
+#include "host_test.h"
+#include "RttEstimator.h"
+#include "Rs485BusOwner.h"
+#include "SimRs485Bus.h"
+
+extern AppConfig g_appConfig;
+
+Rs485Service g_rs485Service;
+Rs485BusOwner g_rs485BusOwner;
+
+static const uint16_t ROOM_COUNT = 250;
+static const uint16_t FIRST_ADDRESS = 0x0101;
+static const uint32_t FAST_TURNAROUND_US = 1000;
+static const uint32_t SLOW_TURNAROUND_US = 4000;   ///< Svaki osmi kontroler (stariji firmware)
+
+static uint16_t s_dead_count = 0;
+
+static bool IsDead(uint16_t index)
+{
+    // Mrtve sobe raspoređene po busu (ne u bloku na kraju)
+    return s_dead_count && (index % (ROOM_COUNT / s_dead_count)) == 0 &&
+           index / (ROOM_COUNT / s_dead_count) < s_dead_count;
+}
+
+// ============================================================================
+// Sobe na busu
+// ============================================================================
+
+static uint16_t RoomResponder(void*, uint8_t, const uint8_t* tx, uint16_t tx_length,
+                              uint8_t* rx, uint16_t)
+{
+    if (tx_length < 7) return 0;
+    uint16_t address = (uint16_t)((tx[1] << 8) | tx[2]);
+    if (address < FIRST_ADDRESS || address >= FIRST_ADDRESS + ROOM_COUNT) return 0;
+    uint16_t index = (uint16_t)(address - FIRST_ADDRESS);
+    if (IsDead(index)) return 0;
+
+    g_simRs485Bus.turnaround_us = (index % 8 == 7) ? SLOW_TURNAROUND_US : FAST_TURNAROUND_US;
+
+    uint16_t iface = g_appConfig.rs485_iface_addr;
+    uint8_t cmd = tx[6];
+    uint16_t checksum = (uint16_t)(cmd + '0' + '0');
+    uint16_t n = 0;
+    rx[n++] = SOH;
+    rx[n++] = (uint8_t)(iface >> 8);
+    rx[n++] = (uint8_t)iface;
+    rx[n++] = (uint8_t)(address >> 8);
+    rx[n++] = (uint8_t)address;
+    rx[n++] = 3;
+    rx[n++] = cmd;
+    rx[n++] = '0';
+    rx[n++] = '0';
+    rx[n++] = (uint8_t)(checksum >> 8);
+    rx[n++] = (uint8_t)checksum;
+    rx[n++] = EOT;
+    return n;
+}
+
+// ============================================================================
+// Obilazak
+// ============================================================================
+
+struct SweepResult
+{
+    uint32_t sweep_ms;
+    uint16_t timeouts;
+    uint16_t live_timeouts;     ///< Soba koja odgovara, a timeout ju je odsjekao
+};
+
+/**
+ * @brief Jedan obilazak svih soba; rtt == NULL znači fiksni timeout.
+ */
+static SweepResult Sweep(RttTable* rtt)
+{
+    uint16_t iface = g_appConfig.rs485_iface_addr;
+    uint8_t rx[MAX_PACKET_LENGTH];
+    SweepResult result = { 0, 0, 0 };
+    uint32_t start = millis();
+
+    for (uint16_t i = 0; i < ROOM_COUNT; i++)
+    {
+        uint16_t address = FIRST_ADDRESS + i;
+        uint8_t tx[10] = { SOH, (uint8_t)(address >> 8), (uint8_t)address,
+                           (uint8_t)(iface >> 8), (uint8_t)iface, 1, GET_SYS_STAT, 0, GET_SYS_STAT, EOT };
+        uint32_t timeout_ms = rtt ? rtt->GetTimeoutMs(address, RS485_RESP_TOUT_MS) : RS485_RESP_TOUT_MS;
+
+        BusTransaction txn;
+        int length = -1;
+        if (g_rs485BusOwner.Submit(&txn, BusPriority::POLLING, RS485_BUS_CURRENT, tx, sizeof(tx),
+                                   rx, sizeof(rx), timeout_ms))
+        {
+            length = g_rs485BusOwner.WaitForResult(&txn);
+        }
+
+        if (length > 0)
+        {
+            if (rtt) rtt->AddSample(address, txn.rtt_us);
+        }
+        else
+        {
+            if (rtt) rtt->AddTimeout(address);
+            result.timeouts++;
+            if (!IsDead(i)) result.live_timeouts++;
+        }
+        delay(RX2TX_DEL_MS);
+    }
+
+    result.sweep_ms = millis() - start;
+    return result;
+}
+
+int main()
+{
+    g_appConfig.enable_dual_bus_mode = false;
+
+    g_rs485Service.Initialize();
+    g_rs485BusOwner.Initialize(&g_rs485Service);
+    g_rs485BusOwner.StartTask();
+    g_simRs485Bus.responder = RoomResponder;
+
+    printf("%u soba, fiksni timeout %u ms, odziv kontrolera %lu / %lu us (svaki osmi)\n",
+           ROOM_COUNT, RS485_RESP_TOUT_MS,
+           (unsigned long)FAST_TURNAROUND_US, (unsigned long)SLOW_TURNAROUND_US);
+
+    static const uint16_t DEAD_COUNTS[] = { 0, 25, 50 };
+    for (uint8_t d = 0; d < sizeof(DEAD_COUNTS) / sizeof(DEAD_COUNTS[0]); d++)
+    {
+        s_dead_count = DEAD_COUNTS[d];
+
+        // Fiksni timeout ne zavisi od istorije - drugi obilazak radi poređenja pod istim uslovima
+        Sweep(NULL);
+        SweepResult fixed = Sweep(NULL);
+
+        // Svaki scenario počinje sa praznom tabelom
+        static RttTable tables[sizeof(DEAD_COUNTS) / sizeof(DEAD_COUNTS[0])];
+        RttTable& table = tables[d];
+        SweepResult cold = Sweep(&table);
+        SweepResult adaptive = Sweep(&table);
+        uint32_t dead_timeout_ms = table.GetTimeoutMs(FIRST_ADDRESS, RS485_RESP_TOUT_MS);
+        uint32_t live_timeout_ms = table.GetTimeoutMs(FIRST_ADDRESS + 1, RS485_RESP_TOUT_MS);
+        uint32_t slow_timeout_ms = table.GetTimeoutMs(FIRST_ADDRESS + 7, RS485_RESP_TOUT_MS);
+
+        printf("  mrtvih %3u: fiksno %5lu ms, RTT %5lu ms (prvi obilazak %5lu ms, %+5.1f%%)  "
+               "timeout mrtva/živa/spora %lu/%lu/%lu ms\n",
+               s_dead_count, (unsigned long)fixed.sweep_ms, (unsigned long)adaptive.sweep_ms,
+               (unsigned long)cold.sweep_ms,
+               fixed.sweep_ms ? 100.0 * ((double)adaptive.sweep_ms - fixed.sweep_ms) / fixed.sweep_ms : 0.0,
+               (unsigned long)(s_dead_count ? dead_timeout_ms : 0), (unsigned long)live_timeout_ms,
+               (unsigned long)slow_timeout_ms);
+
+        // Timeout-i su tačno mrtve sobe - procjena ne odsijeca ni spore kontrolere
+        CHECK_EQ(fixed.timeouts, s_dead_count);
+        CHECK_EQ(adaptive.timeouts, s_dead_count);
+        CHECK_EQ(cold.live_timeouts, 0u);
+        CHECK_EQ(adaptive.live_timeouts, 0u);
+
+        if (s_dead_count)
+        {
+            // Ušteda je bar pola razlike timeout-a po mrtvoj sobi
+            int64_t saved_ms = (int64_t)fixed.sweep_ms - (int64_t)adaptive.sweep_ms;
+            int64_t expected_ms = (int64_t)s_dead_count * (RS485_RESP_TOUT_MS - dead_timeout_ms);
+            CHECK(dead_timeout_ms < RS485_RESP_TOUT_MS);
+            CHECK(saved_ms * 2 >= expected_ms);
+        }
+    }
+
+    return HOST_TEST_RESULT();
+}
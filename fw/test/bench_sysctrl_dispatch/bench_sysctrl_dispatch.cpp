@@ -0,0 +1,301 @@
+/**
+ ******************************************************************************
+ * @file    bench_sysctrl_dispatch.cpp
+ * @author  Gemini & [Vase Ime]
+ * @brief   Host mikrobenchmark izbora komande /sysctrl.cgi po komandi.
+ *
+ * @note
+ * Za svaku komandu mjeri se SysctrlArgs (jedan prolaz kroz parametre,
+ * binarna pretraga ključa) + FindSysctrlRoute(), i obrazac od prije:
+ * lanac hasParam() provjera istim redoslijedom, gdje svaka provjera linearno
+ * poredi imena parametara, a izabrana grana ponovo traži vrijednosti
+ * (getParam() + kopija String-a + toInt()). Oba načina moraju izabrati istu
+ * komandu. Vrijeme je najbolje od nekoliko ponavljanja (host raspoređivač).
+ ******************************************************************************
+ */
+
+#include "host_test.h"
+#include "SysctrlDispatch.h"
+#include <vector>
+
+static const uint32_t ITERATIONS = 20000;
+static const uint8_t ROUNDS = 5;
+
+struct Param
+{
+    String name;
+    String value;
+};
+
+typedef std::vector<Param> ParamList;
+
+/**
+ * @brief "a=1&b=2" -> lista parametara (bez URL dekodiranja, kao u testnim upitima).
+ */
+static ParamList ParseQuery(const char* query)
+{
+    ParamList params;
+    String q(query);
+    int start = 0;
+    while (start < (int)q.length())
+    {
+        int end = q.indexOf('&', start);
+        if (end < 0) end = q.length();
+        String pair = q.substring(start, end);
+        int eq = pair.indexOf('=');
+        Param p;
+        p.name = (eq < 0) ? pair : pair.substring(0, eq);
+        p.value = (eq < 0) ? String() : pair.substring(eq + 1);
+        params.push_back(p);
+        start = end + 1;
+    }
+    return params;
+}
+
+// ============================================================================
+// Ranije: lanac hasParam() provjera
+// ============================================================================
+
+struct ChainStep
+{
+    SysctrlCmd cmd;
+    const char* keys[SYSCTRL_ROUTE_MAX_KEYS];
+    const char* value;      ///< Vrijednost prvog ključa (cad=load)
+};
+
+// Redoslijed i uslovi kao u if/else lancu HandleSysctrlRequest() prije tabele
+static const ChainStep CHAIN[] =
+{
+    { SysctrlCmd::SET_IP,             { "ipa", "snm", "gwa" }, NULL },
+    { SysctrlCmd::PROTO,              { "proto" }, NULL },
+    { SysctrlCmd::PROTO_LR,           { "protoL", "protoR" }, NULL },
+    { SysctrlCmd::SET_PROTO,          { "set_proto" }, NULL },
+    { SysctrlCmd::SYSID,              { "sysid" }, NULL },
+    { SysctrlCmd::MDNS_NAME,          { "mdnsname" }, NULL },
+    { SysctrlCmd::LOGGER_EN,          { "logger_en" }, NULL },
+    { SysctrlCmd::TIME_SYNC_INTERVAL, { "time_sync_interval" }, NULL },
+    { SysctrlCmd::DUAL_BUS,           { "dual_bus" }, NULL },
+    { SysctrlCmd::BUS_WIRING,         { "bus_wiring" }, NULL },
+    { SysctrlCmd::SET_IFACE,          { "set_iface" }, NULL },
+    { SysctrlCmd::SET_ADD_SYNC,       { "set_add_sync" }, NULL },
+    { SysctrlCmd::DATE_TIME,          { "tdu" }, NULL },
+    { SysctrlCmd::DATE_TIME,          { "DTset" }, NULL },
+    { SysctrlCmd::LOG,                { "log" }, NULL },
+    { SysctrlCmd::LOG,                { "RQlog" }, NULL },
+    { SysctrlCmd::LOAD_ADDR_LIST,     { "cad" }, "load" },
+    { SysctrlCmd::HC_FW_UPDATE,       { "fwu" }, NULL },
+    { SysctrlCmd::HC_FW_UPDATE,       { "HCfwu" }, NULL },
+    { SysctrlCmd::RC_OLD_FW_UPDATE,   { "cud" }, NULL },
+    { SysctrlCmd::RC_FW_UPDATE,       { "fuf", "ful" }, NULL },
+    { SysctrlCmd::RC_BL_UPDATE,       { "buf", "bul" }, NULL },
+    { SysctrlCmd::RT_FW_UPDATE,       { "tuf", "owa" }, NULL },
+    { SysctrlCmd::RT_LOGO_UPDATE,     { "tlg", "owa" }, NULL },
+    { SysctrlCmd::RC_IMAGE_UPDATE,    { "iuf", "iul", "ifa", "ila" }, NULL },
+    { SysctrlCmd::PERMITED_GROUP,     { "pga", "pgu" }, NULL },
+    { SysctrlCmd::DIN_CFG,            { "cdi", "di0" }, NULL },
+    { SysctrlCmd::RT_DISP_MSG,        { "txa", "txt" }, NULL },
+    { SysctrlCmd::RT_DISP_STA,        { "tda", "tdi" }, NULL },
+    { SysctrlCmd::RT_QRC,             { "qra" }, NULL },
+    { SysctrlCmd::ROOM_TEMP,          { "tha" }, NULL },
+    { SysctrlCmd::APPL_STAT,          { "stg", "val" }, NULL },
+    { SysctrlCmd::BEDDING_REPL,       { "sbr", "per" }, NULL },
+    { SysctrlCmd::ROOM_STATUS,        { "cst" }, NULL },
+    { SysctrlCmd::PREVIEW_IMG,        { "ipr" }, NULL },
+    { SysctrlCmd::DOUT_STATE,         { "cdo", "ctrl" }, NULL },
+    { SysctrlCmd::DISPL_BCKLGHT,      { "cbr", "br" }, NULL },
+    { SysctrlCmd::SOS_RESET,          { "rud" }, NULL },
+    { SysctrlCmd::RS485_CFG,          { "rsc", "rsa", "rga", "rba", "rib" }, NULL },
+    { SysctrlCmd::SYSTEM_ID,          { "sid", "nid" }, NULL },
+    { SysctrlCmd::RESTART,            { "rst" }, NULL },
+    { SysctrlCmd::HOTEL_STATUS,       { "HSset" }, NULL },
+};
+
+/// AsyncWebServerRequest::hasParam()/getParam(): linearno poređenje imena
+static const Param* GetParam(const ParamList& params, const char* name)
+{
+    for (size_t i = 0; i < params.size(); i++)
+    {
+        if (params[i].name == name) return &params[i];
+    }
+    return NULL;
+}
+
+static bool ChainDispatch(const ParamList& params, SysctrlCmd* cmd, long* sum)
+{
+    for (size_t s = 0; s < sizeof(CHAIN) / sizeof(CHAIN[0]); s++)
+    {
+        const ChainStep* step = &CHAIN[s];
+        bool match = true;
+        for (uint8_t k = 0; k < SYSCTRL_ROUTE_MAX_KEYS && step->keys[k] != NULL && match; k++) {
+            match = (GetParam(params, step->keys[k]) != NULL);
+        }
+        if (match && step->value != NULL) {
+            match = (GetParam(params, step->keys[0])->value == step->value);
+        }
+        if (!match) continue;
+
+        // Grana ponovo čita vrijednosti: getParam("x")->value() u String, pa toInt()
+        for (uint8_t k = 0; k < SYSCTRL_ROUTE_MAX_KEYS && step->keys[k] != NULL; k++)
+        {
+            String value = GetParam(params, step->keys[k])->value;
+            *sum += value.toInt();
+        }
+        *cmd = step->cmd;
+        return true;
+    }
+    return false;
+}
+
+// ============================================================================
+// Tabela (SysctrlDispatch)
+// ============================================================================
+
+static bool TableDispatch(const ParamList& params, SysctrlCmd* cmd, long* sum)
+{
+    SysctrlArgs args;
+    for (size_t i = 0; i < params.size(); i++) {
+        args.Add(params[i].name.c_str(), params[i].value);
+    }
+    const SysctrlRoute* route = FindSysctrlRoute(args);
+    if (route == NULL) return false;
+
+    for (uint8_t k = 0; k < route->key_count; k++) {
+        *sum += args.Int(route->keys[k]);
+    }
+    *cmd = route->cmd;
+    return true;
+}
+
+// ============================================================================
+// Mjerenje
+// ============================================================================
+
+struct Sample
+{
+    const char* query;
+    SysctrlCmd cmd;
+};
+
+// Po jedan upit za svaku rutu, redoslijedom prioriteta
+static const Sample SAMPLES[] =
+{
+    { "ipa=192.168.0.199&snm=255.255.255.0&gwa=192.168.0.1", SysctrlCmd::SET_IP },
+    { "proto=1", SysctrlCmd::PROTO },
+    { "protoL=1&protoR=0", SysctrlCmd::PROTO_LR },
+    { "set_proto=1", SysctrlCmd::SET_PROTO },
+    { "sysid=1234", SysctrlCmd::SYSID },
+    { "mdnsname=hotel", SysctrlCmd::MDNS_NAME },
+    { "logger_en=1", SysctrlCmd::LOGGER_EN },
+    { "time_sync_interval=60", SysctrlCmd::TIME_SYNC_INTERVAL },
+    { "dual_bus=0", SysctrlCmd::DUAL_BUS },
+    { "bus_wiring=1", SysctrlCmd::BUS_WIRING },
+    { "set_iface=5", SysctrlCmd::SET_IFACE },
+    { "set_add_sync=1&sync_en0=1&sync_p0=60&sync_a0=258", SysctrlCmd::SET_ADD_SYNC },
+    { "tdu=1", SysctrlCmd::DATE_TIME },
+    { "DTset=5171020251530", SysctrlCmd::DATE_TIME },
+    { "log=3", SysctrlCmd::LOG },
+    { "RQlog=3", SysctrlCmd::LOG },
+    { "cad=load", SysctrlCmd::LOAD_ADDR_LIST },
+    { "fwu=1", SysctrlCmd::HC_FW_UPDATE },
+    { "HCfwu=1", SysctrlCmd::HC_FW_UPDATE },
+    { "cud=257", SysctrlCmd::RC_OLD_FW_UPDATE },
+    { "fuf=257&ful=300", SysctrlCmd::RC_FW_UPDATE },
+    { "buf=257&bul=300", SysctrlCmd::RC_BL_UPDATE },
+    { "tuf=257&owa=1", SysctrlCmd::RT_FW_UPDATE },
+    { "tlg=257&owa=1", SysctrlCmd::RT_LOGO_UPDATE },
+    { "iuf=257&iul=300&ifa=1&ila=14", SysctrlCmd::RC_IMAGE_UPDATE },
+    { "pga=257&pgu=3", SysctrlCmd::PERMITED_GROUP },
+    { "cdi=257&di0=1&di1=2&di2=0&di3=0&di4=0&di5=0&di6=0&di7=0", SysctrlCmd::DIN_CFG },
+    { "txa=257&txt=Dobrodosli&tx0=1&ty0=2", SysctrlCmd::RT_DISP_MSG },
+    { "tda=257&tdi=1", SysctrlCmd::RT_DISP_STA },
+    { "qra=257&qrc=https://hotel.example/room", SysctrlCmd::RT_QRC },
+    { "tha=257&spt=22", SysctrlCmd::ROOM_TEMP },
+    { "stg=257&val=1", SysctrlCmd::APPL_STAT },
+    { "sbr=257&per=3", SysctrlCmd::BEDDING_REPL },
+    { "cst=257", SysctrlCmd::ROOM_STATUS },
+    { "ipr=257", SysctrlCmd::PREVIEW_IMG },
+    { "cdo=257&ctrl=1&do0=1", SysctrlCmd::DOUT_STATE },
+    { "cbr=257&br=80", SysctrlCmd::DISPL_BCKLGHT },
+    { "rud=257", SysctrlCmd::SOS_RESET },
+    { "rsc=257&rsa=258&rga=65535&rba=39321&rib=5", SysctrlCmd::RS485_CFG },
+    { "sid=257&nid=1234", SysctrlCmd::SYSTEM_ID },
+    { "rst=257", SysctrlCmd::RESTART },
+    { "HSset=1", SysctrlCmd::HOTEL_STATUS },
+};
+
+typedef bool (*DispatchFn)(const ParamList& params, SysctrlCmd* cmd, long* sum);
+
+static volatile long s_sink;
+
+/**
+ * @return ns po izboru komande (najbolje od ROUNDS ponavljanja).
+ */
+static double Measure(DispatchFn fn, const ParamList& params)
+{
+    double best = 0;
+    for (uint8_t r = 0; r < ROUNDS; r++)
+    {
+        long sum = 0;
+        SysctrlCmd cmd = SysctrlCmd::SET_IP;
+        uint64_t t0 = HostNowNs();
+        for (uint32_t i = 0; i < ITERATIONS; i++) {
+            fn(params, &cmd, &sum);
+        }
+        double ns = (double)(HostNowNs() - t0) / ITERATIONS;
+        s_sink = s_sink + sum + (long)cmd;
+        if (r == 0 || ns < best) best = ns;
+    }
+    return best;
+}
+
+int main()
+{
+    const size_t count = sizeof(SAMPLES) / sizeof(SAMPLES[0]);
+    double table_total = 0;
+    double chain_total = 0;
+    double table_last = 0;
+    double chain_last = 0;
+
+    printf("%-50s %10s %10s\n", "upit", "tabela ns", "lanac ns");
+    for (size_t i = 0; i < count; i++)
+    {
+        ParamList params = ParseQuery(SAMPLES[i].query);
+
+        // Isti izbor komande kao lanac od prije (i isti zbir int vrijednosti ključeva)
+        SysctrlCmd table_cmd = SysctrlCmd::SET_IP;
+        SysctrlCmd chain_cmd = SysctrlCmd::SET_IP;
+        long table_sum = 0;
+        long chain_sum = 0;
+        CHECK(TableDispatch(params, &table_cmd, &table_sum));
+        CHECK(ChainDispatch(params, &chain_cmd, &chain_sum));
+        CHECK(table_cmd == SAMPLES[i].cmd);
+        CHECK(chain_cmd == SAMPLES[i].cmd);
+        CHECK_EQ(table_sum, chain_sum);
+
+        double table_ns = Measure(TableDispatch, params);
+        double chain_ns = Measure(ChainDispatch, params);
+        table_total += table_ns;
+        chain_total += chain_ns;
+        table_last = table_ns;
+        chain_last = chain_ns;
+
+        char query[51];
+        snprintf(query, sizeof(query), "%s", SAMPLES[i].query);
+        printf("%-50s %10.0f %10.0f\n", query, table_ns, chain_ns);
+    }
+
+    // Nepoznata komanda i cad sa drugom vrijednošću
+    SysctrlCmd cmd;
+    long sum = 0;
+    CHECK(!TableDispatch(ParseQuery("foo=1&bar=2"), &cmd, &sum));
+    CHECK(!TableDispatch(ParseQuery("cad=save"), &cmd, &sum));
+    CHECK(!ChainDispatch(ParseQuery("cad=save"), &cmd, &sum));
+
+    printf("prosjek: tabela %.0f ns, lanac %.0f ns\n", table_total / count, chain_total / count);
+
+    // Posljednja komanda u lancu (HSset) plaća sve provjere iznad sebe
+    CHECK(table_last < chain_last);
+    CHECK(table_total < chain_total);
+
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,220 @@
+/**
+ ******************************************************************************
+ * @file    bench_update_prefetch.cpp
+ * @author  Gemini & [Vase Ime]
+ * @brief   Host benchmark prenosa update slike: čitanje sa kartice uz okvir na liniji.
+ *
+ * @note
+ * Petlja je DATA faza UpdateManager::Run(): okvir iz chunk-a (Read()), predaja
+ * vlasniku magistrale (Submit), čekanje ACK-a (WaitForResult) i pauza od 5 ms.
+ * Preklopljeno: između Submit() i WaitForResult() Prefetch() čita sljedeći
+ * chunk dok je okvir na liniji. Sekvencijalno (ranije): isti kod bez
+ * Prefetch(), svaki chunk se čita sa kartice u kritičnom putu.
+ * Kartica je SimSdCard (fiksni trošak po čitanju + SPI takt), linija
+ * SimRs485Bus; uređaj provjerava sekvencu i checksum i slaže primljenu sliku.
+ ******************************************************************************
+ */
+
+#include "host_test.h"
+#include "UpdateChunkPrefetch.h"
+#include "Rs485BusOwner.h"
+#include "SimRs485Bus.h"
+#include "SimSdCard.h"
+#include <vector>
+
+extern AppConfig g_appConfig;
+
+Rs485Service g_rs485Service;
+Rs485BusOwner g_rs485BusOwner;
+
+static const uint16_t CLIENT_ADDRESS = 0x0150;
+static const uint32_t IMAGE_SIZE = 16 * 1024;
+static const uint16_t CHUNK_SIZE = UPDATE_DATA_CHUNK_SIZE;
+static const uint32_t LOOP_PAUSE_MS = 5;        ///< vTaskDelay() na kraju iteracije UpdateManager::Run()
+
+static uint8_t s_image[IMAGE_SIZE];
+static uint8_t s_received[IMAGE_SIZE];
+static uint16_t s_expected_seq = 1;
+static uint32_t s_bad_frames = 0;
+
+// ============================================================================
+// Uređaj koji prima sliku
+// ============================================================================
+
+static uint16_t ClientResponder(void*, uint8_t, const uint8_t* tx, uint16_t tx_length,
+                                uint8_t* rx, uint16_t)
+{
+    if (tx_length < 11 || tx[0] != STX) return 0;
+
+    uint16_t data_len = tx[5];
+    uint16_t seq = (uint16_t)((tx[6] << 8) | tx[7]);
+    uint16_t chunk = (uint16_t)(data_len - 2);
+    uint16_t checksum = (uint16_t)(tx[6] + tx[7]);
+    for (uint16_t i = 0; i < chunk; i++) checksum += tx[8 + i];
+    uint16_t frame_checksum = (uint16_t)((tx[tx_length - 3] << 8) | tx[tx_length - 2]);
+    uint32_t offset = (uint32_t)(seq - 1) * CHUNK_SIZE;
+
+    if (seq != s_expected_seq || checksum != frame_checksum || offset + chunk > IMAGE_SIZE)
+    {
+        s_bad_frames++;
+        return 0;
+    }
+    memcpy(&s_received[offset], &tx[8], chunk);
+    s_expected_seq++;
+
+    uint16_t iface = g_appConfig.rs485_iface_addr;
+    rx[0] = ACK;
+    rx[1] = (uint8_t)(iface >> 8);
+    rx[2] = (uint8_t)iface;
+    rx[3] = (uint8_t)(CLIENT_ADDRESS >> 8);
+    rx[4] = (uint8_t)CLIENT_ADDRESS;
+    rx[5] = tx[6];
+    rx[6] = tx[7];
+    rx[7] = EOT;
+    return 8;
+}
+
+// ============================================================================
+// Prenos
+// ============================================================================
+
+/**
+ * @brief DATA okvir kao UpdateManager::SendDataPacket().
+ */
+static uint16_t BuildDataFrame(uint8_t* packet, uint16_t seq, const uint8_t* data, uint16_t length, uint16_t data_sum)
+{
+    uint16_t iface = g_appConfig.rs485_iface_addr;
+    uint16_t data_len = length + 2;
+    uint16_t total = 9 + data_len;
+
+    packet[0] = STX;
+    packet[1] = (uint8_t)(CLIENT_ADDRESS >> 8);
+    packet[2] = (uint8_t)CLIENT_ADDRESS;
+    packet[3] = (uint8_t)(iface >> 8);
+    packet[4] = (uint8_t)iface;
+    packet[5] = (uint8_t)data_len;
+    packet[6] = (uint8_t)(seq >> 8);
+    packet[7] = (uint8_t)seq;
+    memcpy(&packet[8], data, length);
+
+    uint16_t checksum = packet[6] + packet[7] + data_sum;
+    packet[total - 3] = (uint8_t)(checksum >> 8);
+    packet[total - 2] = (uint8_t)checksum;
+    packet[total - 1] = EOT;
+    return total;
+}
+
+struct TransferResult
+{
+    uint32_t image_ms;
+    uint32_t hits;
+    uint32_t frames;
+    bool ok;
+};
+
+static TransferResult TransferImage(bool overlapped)
+{
+    File file(s_image, IMAGE_SIZE);
+    UpdateChunkPrefetch prefetch;
+    uint8_t chunk[CHUNK_SIZE];
+    uint8_t packet[MAX_PACKET_LENGTH];
+    uint8_t response[MAX_PACKET_LENGTH];
+
+    memset(s_received, 0, sizeof(s_received));
+    s_expected_seq = 1;
+    s_bad_frames = 0;
+
+    TransferResult result = { 0, 0, 0, true };
+    uint32_t offset = 0;
+    uint16_t seq = 1;
+    uint32_t start = millis();
+
+    while (offset < IMAGE_SIZE)
+    {
+        // FAZA 1: okvir iz chunk-a (iz prefetch buffera ili sa kartice)
+        uint16_t data_sum = 0;
+        int16_t length = prefetch.Read(file, offset, chunk, CHUNK_SIZE, &data_sum);
+        if (length <= 0)
+        {
+            result.ok = false;
+            break;
+        }
+        uint16_t frame_length = BuildDataFrame(packet, seq, chunk, (uint16_t)length, data_sum);
+
+        // FAZA 2: okvir na liniji i čekanje ACK-a
+        BusTransaction txn;
+        if (g_rs485BusOwner.Submit(&txn, BusPriority::UPDATE, RS485_BUS_CURRENT, packet, frame_length,
+                                   response, sizeof(response), UPDATE_PACKET_TIMEOUT_MS) &&
+            overlapped && offset + length < IMAGE_SIZE)
+        {
+            prefetch.Prefetch(file, offset + length, CHUNK_SIZE);
+        }
+        if (g_rs485BusOwner.WaitForResult(&txn) <= 0 || response[0] != ACK)
+        {
+            result.ok = false;
+            break;
+        }
+
+        offset += length;
+        seq++;
+        result.frames++;
+        vTaskDelay(pdMS_TO_TICKS(LOOP_PAUSE_MS));
+    }
+
+    result.image_ms = millis() - start;
+    result.hits = prefetch.GetHits();
+    result.ok = result.ok && s_bad_frames == 0 && memcmp(s_image, s_received, IMAGE_SIZE) == 0;
+    return result;
+}
+
+int main()
+{
+    g_appConfig.enable_dual_bus_mode = false;
+
+    g_rs485Service.Initialize();
+    g_rs485BusOwner.Initialize(&g_rs485Service);
+    g_rs485BusOwner.StartTask();
+    g_simRs485Bus.responder = ClientResponder;
+
+    for (uint32_t i = 0; i < IMAGE_SIZE; i++) {
+        s_image[i] = (uint8_t)((i * 7) ^ (i >> 8));
+    }
+
+    uint16_t frame_bytes = 9 + CHUNK_SIZE + 2;
+    printf("slika %lu B, chunk %u B, DATA okvir %u B = %lu us na liniji (%lu baud)\n",
+           (unsigned long)IMAGE_SIZE, CHUNK_SIZE, frame_bytes,
+           (unsigned long)g_simRs485Bus.FrameUs(frame_bytes), (unsigned long)g_simRs485Bus.baud);
+
+    // Trošak čitanja chunk-a: sektor u kešu, kartica na 4 MHz SPI, spora kartica / FAT lanac
+    static const uint32_t READ_COSTS_US[] = { 200, 2000, 6000 };
+    for (uint8_t i = 0; i < sizeof(READ_COSTS_US) / sizeof(READ_COSTS_US[0]); i++)
+    {
+        g_simSdCard.read_cost_us = READ_COSTS_US[i];
+        uint32_t chunk_read_us = READ_COSTS_US[i] + (CHUNK_SIZE * g_simSdCard.byte_cost_ns) / 1000;
+
+        TransferResult sequential = TransferImage(false);
+        TransferResult overlapped = TransferImage(true);
+
+        printf("  čitanje chunk-a %5lu us: sekvencijalno %6lu ms, preklopljeno %6lu ms (-%4.1f%%), "
+               "iz prefetch-a %lu / %lu\n",
+               (unsigned long)chunk_read_us, (unsigned long)sequential.image_ms,
+               (unsigned long)overlapped.image_ms,
+               sequential.image_ms ? 100.0 * ((double)sequential.image_ms - overlapped.image_ms) / sequential.image_ms : 0.0,
+               (unsigned long)overlapped.hits, (unsigned long)overlapped.frames);
+
+        CHECK(sequential.ok);
+        CHECK(overlapped.ok);
+        CHECK_EQ(sequential.hits, 0u);
+        // Prvi chunk se uvijek čita u kritičnom putu
+        CHECK_EQ(overlapped.hits, overlapped.frames - 1);
+        // Čitanje kraće od okvira na liniji je skriveno: ušteda je bar pola čitanja po
+        // okviru. Kratko čitanje (sektor u kešu) je ispod šuma hosta - samo se ispisuje.
+        if (chunk_read_us >= 1000)
+        {
+            int64_t saved_us = ((int64_t)sequential.image_ms - (int64_t)overlapped.image_ms) * 1000;
+            CHECK(saved_us * 2 >= (int64_t)chunk_read_us * (overlapped.frames - 1));
+        }
+    }
+
+    return HOST_TEST_RESULT();
+}
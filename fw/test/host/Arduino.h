@@ -0,0 +1,223 @@
+/**
+ ******************************************************************************
+ * @file    Arduino.h
+ * @author  Gemini & [Vase Ime]
+ * @brief   Host zamjena za Arduino-ESP32 jezgro (samo ono što moduli koriste).
+ *
+ * @note
+ * millis()/micros() su monotono vrijeme hosta od starta programa. Serial
+ * ispis je isključen osim ako je postavljena varijabla okruženja HOST_SERIAL
+ * (benchmarki ne smiju mjeriti printf).
+ ******************************************************************************
+ */
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <math.h>
+#include <algorithm>
+#include <string>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+
+using std::min;
+using std::max;
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define F(x) (x)
+#define PROGMEM
+#define IRAM_ATTR
+#define HIGH 1
+#define LOW 0
+#define OUTPUT 1
+#define INPUT 0
+#define INPUT_PULLUP 2
+#define SERIAL_8N1 0
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+void pinMode(int pin, int mode);
+void digitalWrite(int pin, int value);
+int digitalRead(int pin);
+
+class String
+{
+public:
+    String(const char* s = "") : m_s(s ? s : "") {}
+    String(const char* s, unsigned int len) : m_s(s, len) {}
+    String(const std::string& s) : m_s(s) {}
+    explicit String(char c) : m_s(1, c) {}
+    explicit String(int v, unsigned char base = 10) { FromLong(v, base); }
+    explicit String(unsigned int v, unsigned char base = 10) { FromULong(v, base); }
+    explicit String(long v, unsigned char base = 10) { FromLong(v, base); }
+    explicit String(unsigned long v, unsigned char base = 10) { FromULong(v, base); }
+    explicit String(unsigned char v, unsigned char base = 10) { FromULong(v, base); }
+    explicit String(double v, unsigned int decimals = 2)
+    {
+        char buf[48];
+        snprintf(buf, sizeof(buf), "%.*f", (int)decimals, v);
+        m_s = buf;
+    }
+
+    unsigned int length() const { return (unsigned int)m_s.size(); }
+    const char* c_str() const { return m_s.c_str(); }
+    bool reserve(unsigned int size) { m_s.reserve(size); return true; }
+    bool isEmpty() const { return m_s.empty(); }
+
+    String& operator+=(const String& s) { m_s += s.m_s; return *this; }
+    String& operator+=(const char* s) { m_s += s; return *this; }
+    String& operator+=(char c) { m_s += c; return *this; }
+    String& operator+=(int v) { return *this += String(v); }
+    String& operator+=(unsigned int v) { return *this += String(v); }
+    String& operator+=(long v) { return *this += String(v); }
+    String& operator+=(unsigned long v) { return *this += String(v); }
+    String& operator+=(unsigned char v) { return *this += String(v); }
+    bool concat(const String& s) { m_s += s.m_s; return true; }
+    bool concat(const char* s) { m_s += s; return true; }
+    bool concat(const char* s, unsigned int len) { m_s.append(s, len); return true; }
+    bool concat(char c) { m_s += c; return true; }
+
+    friend String operator+(const String& a, const String& b) { return String(a.m_s + b.m_s); }
+    friend String operator+(const String& a, const char* b) { return String(a.m_s + b); }
+    friend String operator+(const char* a, const String& b) { return String(a + b.m_s); }
+    friend String operator+(const String& a, char b) { return String(a.m_s + b); }
+
+    bool operator==(const String& s) const { return m_s == s.m_s; }
+    bool operator==(const char* s) const { return m_s == s; }
+    bool operator!=(const String& s) const { return m_s != s.m_s; }
+    bool operator!=(const char* s) const { return m_s != s; }
+    bool equals(const String& s) const { return m_s == s.m_s; }
+    bool equalsIgnoreCase(const String& s) const { return strcasecmp(c_str(), s.c_str()) == 0; }
+    char operator[](unsigned int i) const { return i < m_s.size() ? m_s[i] : 0; }
+    char charAt(unsigned int i) const { return (*this)[i]; }
+
+    int indexOf(char c, unsigned int from = 0) const { return Pos(m_s.find(c, from)); }
+    int indexOf(const char* s, unsigned int from = 0) const { return Pos(m_s.find(s, from)); }
+    int indexOf(const String& s, unsigned int from = 0) const { return Pos(m_s.find(s.m_s, from)); }
+    int lastIndexOf(char c) const { return Pos(m_s.rfind(c)); }
+    bool startsWith(const String& s) const { return m_s.compare(0, s.m_s.size(), s.m_s) == 0; }
+    bool endsWith(const String& s) const
+    {
+        return m_s.size() >= s.m_s.size() && m_s.compare(m_s.size() - s.m_s.size(), s.m_s.size(), s.m_s) == 0;
+    }
+    String substring(unsigned int from) const { return from < m_s.size() ? String(m_s.substr(from)) : String(); }
+    String substring(unsigned int from, unsigned int to) const
+    {
+        if (from > to) std::swap(from, to);
+        if (from >= m_s.size()) return String();
+        return String(m_s.substr(from, to - from));
+    }
+    void trim()
+    {
+        size_t b = m_s.find_first_not_of(" \t\r\n");
+        size_t e = m_s.find_last_not_of(" \t\r\n");
+        m_s = (b == std::string::npos) ? std::string() : m_s.substr(b, e - b + 1);
+    }
+    void replace(const String& from, const String& to)
+    {
+        if (from.m_s.empty()) return;
+        size_t pos = 0;
+        while ((pos = m_s.find(from.m_s, pos)) != std::string::npos)
+        {
+            m_s.replace(pos, from.m_s.size(), to.m_s);
+            pos += to.m_s.size();
+        }
+    }
+    void toUpperCase() { for (size_t i = 0; i < m_s.size(); i++) m_s[i] = (char)toupper((unsigned char)m_s[i]); }
+    void toLowerCase() { for (size_t i = 0; i < m_s.size(); i++) m_s[i] = (char)tolower((unsigned char)m_s[i]); }
+    long toInt() const { return strtol(m_s.c_str(), NULL, 10); }
+    float toFloat() const { return (float)strtod(m_s.c_str(), NULL); }
+
+private:
+    static int Pos(size_t p) { return p == std::string::npos ? -1 : (int)p; }
+    void FromLong(long v, unsigned char base)
+    {
+        if (base == 10) { char buf[24]; snprintf(buf, sizeof(buf), "%ld", v); m_s = buf; }
+        else FromULong((unsigned long)v, base);
+    }
+    void FromULong(unsigned long v, unsigned char base)
+    {
+        char buf[72];
+        int i = (int)sizeof(buf) - 1;
+        buf[i] = 0;
+        do { buf[--i] = "0123456789abcdefghijklmnopqrstuvwxyz"[v % base]; v /= base; } while (v && i > 0);
+        m_s = &buf[i];
+    }
+
+    std::string m_s;
+};
+
+class Print
+{
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size)
+    {
+        size_t n = 0;
+        while (size--) n += write(*buffer++);
+        return n;
+    }
+    size_t write(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)))
+    {
+        char buf[512];
+        va_list args;
+        va_start(args, format);
+        int len = vsnprintf(buf, sizeof(buf), format, args);
+        va_end(args);
+        if (len < 0) return 0;
+        if ((size_t)len >= sizeof(buf)) len = sizeof(buf) - 1;
+        return write((const uint8_t*)buf, (size_t)len);
+    }
+    size_t print(const char* s) { return write(s); }
+    size_t print(const String& s) { return write((const uint8_t*)s.c_str(), s.length()); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(int v, int base = 10) { return print(String((long)v, (unsigned char)base)); }
+    size_t print(unsigned int v, int base = 10) { return print(String((unsigned long)v, (unsigned char)base)); }
+    size_t print(long v, int base = 10) { return print(String(v, (unsigned char)base)); }
+    size_t print(unsigned long v, int base = 10) { return print(String(v, (unsigned char)base)); }
+    size_t println() { return write("\r\n"); }
+    template <typename T> size_t println(const T& v) { size_t n = print(v); return n + println(); }
+    template <typename T> size_t println(const T& v, int base) { size_t n = print(v, base); return n + println(); }
+};
+
+class Stream : public Print
+{
+public:
+    virtual int available() { return 0; }
+    virtual int read() { return -1; }
+    virtual int peek() { return -1; }
+    virtual void flush() {}
+};
+
+class HardwareSerial : public Stream
+{
+public:
+    explicit HardwareSerial(int uart_nr) : m_uart_nr(uart_nr) {}
+    void begin(unsigned long, uint32_t = SERIAL_8N1, int8_t = -1, int8_t = -1) {}
+    operator bool() const { return true; }
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+
+private:
+    int m_uart_nr;
+};
+
+extern HardwareSerial Serial;
+
+#endif // HOST_ARDUINO_H
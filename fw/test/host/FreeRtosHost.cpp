@@ -0,0 +1,331 @@
+/**
+ ******************************************************************************
+ * @file    FreeRtosHost.cpp
+ * @author  Gemini & [Vase Ime]
+ * @brief   Host implementacija FreeRTOS zamjene (std::thread/mutex/condvar).
+ *
+ * @note
+ * Prioriteti i afinitet se ignorišu - host raspoređivač je preemptivan i
+ * ima više jezgara, kao ESP32. Zadatak koji se vrati iz funkcije ili pozove
+ * vTaskDelete(NULL) samo završava svoju nit.
+ ******************************************************************************
+ */
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <string.h>
+
+unsigned long millis();
+
+struct HostTask
+{
+    std::mutex lock;
+    std::condition_variable cv;
+    uint32_t notify_value;
+
+    HostTask() : notify_value(0) {}
+};
+
+struct HostQueue
+{
+    std::mutex lock;
+    std::condition_variable cv;
+    std::deque<std::vector<uint8_t> > items;
+    UBaseType_t length;
+    UBaseType_t item_size;
+};
+
+struct HostSemaphore
+{
+    std::mutex lock;
+    std::condition_variable cv;
+    UBaseType_t count;
+    UBaseType_t max_count;
+    bool recursive;
+    std::thread::id owner;
+    UBaseType_t depth;
+};
+
+namespace
+{
+    std::recursive_mutex g_critical;
+
+    struct TaskExit {};
+
+    thread_local HostTask* t_current_task = NULL;
+
+    HostTask* CurrentTask()
+    {
+        // Nit koja nije kreirana sa xTaskCreate (main) dobija zadatak pri prvom pozivu
+        if (t_current_task == NULL) {
+            t_current_task = new HostTask();
+        }
+        return t_current_task;
+    }
+
+    // Čekanje sa FreeRTOS timeout-om (portMAX_DELAY = zauvijek)
+    template <typename Pred>
+    bool WaitFor(std::condition_variable& cv, std::unique_lock<std::mutex>& guard, TickType_t ticks, Pred pred)
+    {
+        if (ticks == portMAX_DELAY) {
+            cv.wait(guard, pred);
+            return true;
+        }
+        return cv.wait_for(guard, std::chrono::milliseconds(ticks), pred);
+    }
+}
+
+void HostEnterCritical() { g_critical.lock(); }
+void HostExitCritical() { g_critical.unlock(); }
+
+// ============================================================================
+// Zadaci
+// ============================================================================
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stack, void* param,
+                                   UBaseType_t priority, TaskHandle_t* handle, BaseType_t core)
+{
+    (void)name; (void)stack; (void)priority; (void)core;
+    HostTask* task = new HostTask();
+    if (handle != NULL) {
+        *handle = task;
+    }
+
+    std::thread([fn, param, task]() {
+        t_current_task = task;
+        try {
+            fn(param);
+        } catch (const TaskExit&) {
+        }
+    }).detach();
+    return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char* name, uint32_t stack, void* param,
+                       UBaseType_t priority, TaskHandle_t* handle)
+{
+    return xTaskCreatePinnedToCore(fn, name, stack, param, priority, handle, tskNO_AFFINITY);
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+    if (task == NULL || task == CurrentTask()) {
+        throw TaskExit();
+    }
+    // Brisanje drugog zadatka nije podržano na hostu (moduli ga ne koriste)
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(ticks));
+}
+
+TickType_t xTaskGetTickCount()
+{
+    return (TickType_t)millis();
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle()
+{
+    return CurrentTask();
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks)
+{
+    HostTask* task = CurrentTask();
+    std::unique_lock<std::mutex> guard(task->lock);
+    WaitFor(task->cv, guard, ticks, [task]() { return task->notify_value > 0; });
+    uint32_t value = task->notify_value;
+    if (value > 0) {
+        task->notify_value = clear_on_exit ? 0 : value - 1;
+    }
+    return value;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+    {
+        std::lock_guard<std::mutex> guard(task->lock);
+        task->notify_value++;
+    }
+    task->cv.notify_all();
+    return pdPASS;
+}
+
+void taskYIELD()
+{
+    std::this_thread::yield();
+}
+
+// ============================================================================
+// Redovi
+// ============================================================================
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size)
+{
+    HostQueue* queue = new HostQueue();
+    queue->length = length;
+    queue->item_size = item_size;
+    return queue;
+}
+
+void vQueueDelete(QueueHandle_t queue)
+{
+    delete queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t ticks)
+{
+    std::unique_lock<std::mutex> guard(queue->lock);
+    if (!WaitFor(queue->cv, guard, ticks, [queue]() { return queue->items.size() < queue->length; })) {
+        return pdFALSE;
+    }
+    const uint8_t* bytes = (const uint8_t*)item;
+    queue->items.push_back(std::vector<uint8_t>(bytes, bytes + queue->item_size));
+    guard.unlock();
+    queue->cv.notify_all();
+    return pdTRUE;
+}
+
+BaseType_t xQueueSendToBack(QueueHandle_t queue, const void* item, TickType_t ticks)
+{
+    return xQueueSend(queue, item, ticks);
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t ticks)
+{
+    std::unique_lock<std::mutex> guard(queue->lock);
+    if (!WaitFor(queue->cv, guard, ticks, [queue]() { return !queue->items.empty(); })) {
+        return pdFALSE;
+    }
+    memcpy(item, queue->items.front().data(), queue->item_size);
+    queue->items.pop_front();
+    guard.unlock();
+    queue->cv.notify_all();
+    return pdTRUE;
+}
+
+BaseType_t xQueuePeek(QueueHandle_t queue, void* item, TickType_t ticks)
+{
+    std::unique_lock<std::mutex> guard(queue->lock);
+    if (!WaitFor(queue->cv, guard, ticks, [queue]() { return !queue->items.empty(); })) {
+        return pdFALSE;
+    }
+    memcpy(item, queue->items.front().data(), queue->item_size);
+    return pdTRUE;
+}
+
+BaseType_t xQueueReset(QueueHandle_t queue)
+{
+    {
+        std::lock_guard<std::mutex> guard(queue->lock);
+        queue->items.clear();
+    }
+    queue->cv.notify_all();
+    return pdPASS;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue)
+{
+    std::lock_guard<std::mutex> guard(queue->lock);
+    return (UBaseType_t)queue->items.size();
+}
+
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t queue)
+{
+    std::lock_guard<std::mutex> guard(queue->lock);
+    return queue->length - (UBaseType_t)queue->items.size();
+}
+
+// ============================================================================
+// Semafori i muteksi
+// ============================================================================
+
+static SemaphoreHandle_t CreateSemaphore(UBaseType_t max_count, UBaseType_t initial_count, bool recursive)
+{
+    HostSemaphore* sem = new HostSemaphore();
+    sem->count = initial_count;
+    sem->max_count = max_count;
+    sem->recursive = recursive;
+    sem->depth = 0;
+    return sem;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary() { return CreateSemaphore(1, 0, false); }
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max_count, UBaseType_t initial_count) { return CreateSemaphore(max_count, initial_count, false); }
+SemaphoreHandle_t xSemaphoreCreateMutex() { return CreateSemaphore(1, 1, false); }
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex() { return CreateSemaphore(1, 1, true); }
+
+void vSemaphoreDelete(SemaphoreHandle_t sem)
+{
+    delete sem;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks)
+{
+    std::unique_lock<std::mutex> guard(sem->lock);
+    if (!WaitFor(sem->cv, guard, ticks, [sem]() { return sem->count > 0; })) {
+        return pdFALSE;
+    }
+    sem->count--;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem)
+{
+    {
+        std::lock_guard<std::mutex> guard(sem->lock);
+        if (sem->count >= sem->max_count) {
+            return pdFALSE;
+        }
+        sem->count++;
+    }
+    sem->cv.notify_all();
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t sem, TickType_t ticks)
+{
+    std::thread::id self = std::this_thread::get_id();
+    std::unique_lock<std::mutex> guard(sem->lock);
+    if (sem->depth > 0 && sem->owner == self)
+    {
+        sem->depth++;
+        return pdTRUE;
+    }
+    if (!WaitFor(sem->cv, guard, ticks, [sem]() { return sem->depth == 0; })) {
+        return pdFALSE;
+    }
+    sem->owner = self;
+    sem->depth = 1;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t sem)
+{
+    {
+        std::lock_guard<std::mutex> guard(sem->lock);
+        if (sem->depth == 0 || sem->owner != std::this_thread::get_id()) {
+            return pdFALSE;
+        }
+        if (--sem->depth > 0) {
+            return pdTRUE;
+        }
+    }
+    sem->cv.notify_all();
+    return pdTRUE;
+}
+
+UBaseType_t uxSemaphoreGetCount(SemaphoreHandle_t sem)
+{
+    std::lock_guard<std::mutex> guard(sem->lock);
+    return sem->count;
+}
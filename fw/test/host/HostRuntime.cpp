@@ -0,0 +1,68 @@
+/**
+ ******************************************************************************
+ * @file    HostRuntime.cpp
+ * @author  Gemini & [Vase Ime]
+ * @brief   Host implementacija Arduino vremena, GPIO-a i Serial-a.
+ ******************************************************************************
+ */
+
+#include "Arduino.h"
+#include <chrono>
+#include <thread>
+
+static const std::chrono::steady_clock::time_point s_start = std::chrono::steady_clock::now();
+
+unsigned long millis()
+{
+    return (unsigned long)std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - s_start).count();
+}
+
+unsigned long micros()
+{
+    return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - s_start).count();
+}
+
+void delay(unsigned long ms)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void delayMicroseconds(unsigned int us)
+{
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+void yield()
+{
+    std::this_thread::yield();
+}
+
+void pinMode(int, int) {}
+void digitalWrite(int, int) {}
+int digitalRead(int) { return LOW; }
+
+// ============================================================================
+// Serial (ispis samo sa HOST_SERIAL=1)
+// ============================================================================
+
+static bool SerialEnabled()
+{
+    static const bool enabled = getenv("HOST_SERIAL") != NULL;
+    return enabled;
+}
+
+size_t HardwareSerial::write(uint8_t c)
+{
+    if (SerialEnabled()) fputc(c, stdout);
+    return 1;
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size)
+{
+    if (SerialEnabled()) fwrite(buffer, 1, size, stdout);
+    return size;
+}
+
+HardwareSerial Serial(0);
@@ -0,0 +1,37 @@
+/**
+ ******************************************************************************
+ * @file    SD.h
+ * @author  Gemini & [Vase Ime]
+ * @brief   Host zamjena za Arduino-ESP32 SD File nad modelom kartice.
+ *
+ * @note
+ * Samo dio File API-ja koji koriste moduli pod testom (read, seek, position,
+ * size). Trošak čitanja je iz SimSdCard.h.
+ ******************************************************************************
+ */
+
+#ifndef HOST_SD_H
+#define HOST_SD_H
+
+#include "Arduino.h"
+#include "SimSdCard.h"
+
+class File
+{
+public:
+    File() : m_data(NULL), m_size(0), m_position(0) {}
+    File(const uint8_t* data, size_t size) : m_data(data), m_size(size), m_position(0) {}
+
+    size_t read(uint8_t* buffer, size_t length);
+    bool seek(uint32_t position);
+    size_t position() const { return m_position; }
+    size_t size() const { return m_size; }
+    operator bool() const { return m_data != NULL; }
+
+private:
+    const uint8_t* m_data;
+    size_t m_size;
+    size_t m_position;
+};
+
+#endif // HOST_SD_H
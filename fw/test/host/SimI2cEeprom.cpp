@@ -0,0 +1,216 @@
+/**
+ ******************************************************************************
+ * @file    SimI2cEeprom.cpp
+ * @author  Gemini & [Vase Ime]
+ * @brief   TwoWire nad modelom 24C1024 EEPROM-a (vidi SimI2cEeprom.h).
+ ******************************************************************************
+ */
+
+#include "Wire.h"
+#include "SimI2cEeprom.h"
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+
+    std::mutex s_bus_lock;
+    Clock::time_point s_busy_until;
+    uint32_t s_pointer = 0;
+
+    /**
+     * @brief Troši modelirano vrijeme transakcije sa data_bytes bajtova iza adrese uređaja.
+     */
+    void AccountTransaction(uint32_t clock_hz, size_t data_bytes)
+    {
+        // START + adresa (9 bita) + bajtovi (po 9 bita) + STOP/ponovljeni START
+        uint32_t bits = 1 + 9 + 9 * (uint32_t)data_bytes + 1;
+        uint32_t us = (uint32_t)(((uint64_t)bits * 1000000ULL + clock_hz - 1) / clock_hz) + g_simEeprom.txn_overhead_us;
+
+        g_simEeprom.stats.transactions++;
+        g_simEeprom.stats.bytes += (uint32_t)data_bytes;
+        g_simEeprom.stats.bus_us += us;
+        if (g_simEeprom.sleep_bus_time) {
+            std::this_thread::sleep_for(std::chrono::microseconds(us));
+        }
+    }
+
+    /**
+     * @brief Greška umjesto transakcije (ubačena ili takt iznad mogućnosti ožičenja).
+     * @return Kod greške ili 0.
+     */
+    uint8_t TransactionError(uint32_t clock_hz)
+    {
+        if (g_simEeprom.inject_count > 0)
+        {
+            g_simEeprom.inject_count--;
+            return g_simEeprom.inject_error;
+        }
+        if (g_simEeprom.max_ok_clock_hz != 0 && clock_hz > g_simEeprom.max_ok_clock_hz) {
+            return 4;
+        }
+        return 0;
+    }
+
+    bool AddressMatches(uint8_t address)
+    {
+        return (address & 0xFE) == g_simEeprom.base_address;
+    }
+
+    bool IsBusy()
+    {
+        return Clock::now() < s_busy_until;
+    }
+}
+
+SimI2cEeprom g_simEeprom;
+TwoWire Wire;
+
+SimI2cEeprom::SimI2cEeprom()
+{
+    Reset();
+}
+
+void SimI2cEeprom::Reset()
+{
+    base_address = 0x50;
+    write_cycle_us = 5000;
+    txn_overhead_us = 40;
+    sleep_bus_time = false;
+    inject_error = 0;
+    inject_count = 0;
+    max_ok_clock_hz = 0;
+    Erase(0xFF);
+    ClearStats();
+    s_busy_until = Clock::time_point();
+    s_pointer = 0;
+}
+
+void SimI2cEeprom::Erase(uint8_t value)
+{
+    memset(memory, value, sizeof(memory));
+}
+
+void SimI2cEeprom::ClearStats()
+{
+    memset(&stats, 0, sizeof(stats));
+}
+
+// ============================================================================
+// TwoWire
+// ============================================================================
+
+TwoWire::TwoWire() :
+    m_clock_hz(100000),
+    m_tx_address(0),
+    m_tx_length(0),
+    m_rx_length(0),
+    m_rx_index(0)
+{
+}
+
+bool TwoWire::begin(int sda, int scl, uint32_t frequency)
+{
+    (void)sda; (void)scl;
+    if (frequency != 0) {
+        m_clock_hz = frequency;
+    }
+    return true;
+}
+
+bool TwoWire::setClock(uint32_t frequency)
+{
+    m_clock_hz = frequency;
+    return true;
+}
+
+void TwoWire::beginTransmission(uint8_t address)
+{
+    m_tx_address = address;
+    m_tx_length = 0;
+}
+
+size_t TwoWire::write(uint8_t data)
+{
+    if (m_tx_length >= I2C_BUFFER_LENGTH) {
+        return 0;
+    }
+    m_tx_buffer[m_tx_length++] = data;
+    return 1;
+}
+
+size_t TwoWire::write(const uint8_t* data, size_t quantity)
+{
+    size_t written = 0;
+    while (written < quantity && write(data[written])) {
+        written++;
+    }
+    return written;
+}
+
+uint8_t TwoWire::endTransmission(bool send_stop)
+{
+    std::lock_guard<std::mutex> guard(s_bus_lock);
+    AccountTransaction(m_clock_hz, m_tx_length);
+
+    uint8_t error = TransactionError(m_clock_hz);
+    if (error != 0) {
+        return error;
+    }
+    if (!AddressMatches(m_tx_address) || IsBusy())
+    {
+        g_simEeprom.stats.nacks++;
+        return 2;
+    }
+
+    if (m_tx_length >= 2)
+    {
+        uint32_t block = (m_tx_address & 0x01) ? SIM_EEPROM_BLOCK_SIZE : 0;
+        s_pointer = block | ((uint32_t)m_tx_buffer[0] << 8) | m_tx_buffer[1];
+
+        if (m_tx_length > 2 && send_stop)
+        {
+            // Upis unutar stranice; preko kraja stranice adresa se vraća na njen početak
+            uint32_t page = s_pointer - (s_pointer % SIM_EEPROM_PAGE_SIZE);
+            uint32_t offset = s_pointer % SIM_EEPROM_PAGE_SIZE;
+            for (size_t i = 2; i < m_tx_length; i++)
+            {
+                g_simEeprom.memory[page + offset] = m_tx_buffer[i];
+                offset = (offset + 1) % SIM_EEPROM_PAGE_SIZE;
+            }
+            g_simEeprom.stats.page_writes++;
+            s_busy_until = Clock::now() + std::chrono::microseconds(g_simEeprom.write_cycle_us);
+        }
+    }
+    return 0;
+}
+
+uint8_t TwoWire::requestFrom(uint8_t address, size_t quantity, bool send_stop)
+{
+    (void)send_stop;
+    std::lock_guard<std::mutex> guard(s_bus_lock);
+    if (quantity > I2C_BUFFER_LENGTH) {
+        quantity = I2C_BUFFER_LENGTH;
+    }
+    m_rx_length = 0;
+    m_rx_index = 0;
+
+    AccountTransaction(m_clock_hz, quantity);
+    g_simEeprom.stats.read_transactions++;
+
+    if (TransactionError(m_clock_hz) != 0 || !AddressMatches(address) || IsBusy()) {
+        return 0;
+    }
+
+    // Sekvencijalno čitanje unutar bloka od 64 KB
+    uint32_t block = s_pointer - (s_pointer % SIM_EEPROM_BLOCK_SIZE);
+    for (size_t i = 0; i < quantity; i++)
+    {
+        m_rx_buffer[i] = g_simEeprom.memory[s_pointer];
+        s_pointer = block + ((s_pointer + 1) % SIM_EEPROM_BLOCK_SIZE);
+    }
+    m_rx_length = quantity;
+    return (uint8_t)quantity;
+}
@@ -0,0 +1,57 @@
+/**
+ ******************************************************************************
+ * @file    SimI2cEeprom.h
+ * @author  Gemini & [Vase Ime]
+ * @brief   Model 24C1024 I2C EEPROM-a sa vremenom magistrale (host testovi).
+ *
+ * @note
+ * Vrijeme transakcije = bitovi na liniji / takt + fiksni trošak transakcije
+ * (pokretanje I2C drajvera na ESP32). Zbir se vodi kao "modelirano vrijeme"
+ * (bus_us); sa sleep_bus_time nit zaista spava to vrijeme. Ciklus upisa
+ * (tWR) je uvijek u stvarnom vremenu jer ga firmware čeka ACK pollingom sa
+ * vTaskDelay(). Tokom ciklusa upisa uređaj ne potvrđuje svoju adresu.
+ ******************************************************************************
+ */
+
+#ifndef SIM_I2C_EEPROM_H
+#define SIM_I2C_EEPROM_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define SIM_EEPROM_SIZE         0x20000UL   // 128 KB (24C1024)
+#define SIM_EEPROM_BLOCK_SIZE   0x10000UL   // A16 je bit 0 I2C adrese
+#define SIM_EEPROM_PAGE_SIZE    256
+
+struct SimI2cStats
+{
+    uint32_t transactions;      ///< Adresne faze (START + adresa uređaja)
+    uint32_t read_transactions; ///< requestFrom()
+    uint32_t bytes;             ///< Bajtova podataka na liniji (bez adrese uređaja)
+    uint32_t page_writes;       ///< Pokrenutih ciklusa upisa
+    uint32_t nacks;             ///< Adresa nije potvrđena (ciklus upisa u toku)
+    uint64_t bus_us;            ///< Modelirano vrijeme magistrale
+};
+
+struct SimI2cEeprom
+{
+    uint8_t base_address;       ///< 0x50 (blok 0), base_address | 1 (blok 1)
+    uint32_t write_cycle_us;    ///< tWR
+    uint32_t txn_overhead_us;   ///< Fiksni trošak po transakciji
+    bool sleep_bus_time;        ///< Nit spava modelirano vrijeme transakcije
+    uint8_t inject_error;       ///< != 0: sljedećih inject_count transakcija vraća ovaj kod
+    uint32_t inject_count;
+    uint32_t max_ok_clock_hz;   ///< Iznad ovog takta transakcije vraćaju grešku magistrale (0 = bez ograničenja)
+
+    uint8_t memory[SIM_EEPROM_SIZE];
+    SimI2cStats stats;
+
+    SimI2cEeprom();
+    void Reset();             ///< Podrazumijevani parametri, obrisana memorija (0xFF), nulta statistika
+    void Erase(uint8_t value);
+    void ClearStats();
+};
+
+extern SimI2cEeprom g_simEeprom;
+
+#endif // SIM_I2C_EEPROM_H
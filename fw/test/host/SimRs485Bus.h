@@ -0,0 +1,53 @@
+/**
+ ******************************************************************************
+ * @file    SimRs485Bus.h
+ * @author  Gemini & [Vase Ime]
+ * @brief   Simulirana RS485 magistrala za host testove (zamjena za Rs485Service).
+ *
+ * @note
+ * SimRs485Service.cpp implementira Rs485Service nad ovim modelom: slanje
+ * traje koliko okvir na liniji (10 bita po bajtu), a odgovor daje responder
+ * testa (uređaji na busu). Bez odgovora prijem traje puni timeout, kao na
+ * liniji. Vrijeme je stvarno (nit vlasnika magistrale spava).
+ ******************************************************************************
+ */
+
+#ifndef SIM_RS485_BUS_H
+#define SIM_RS485_BUS_H
+
+#include <stdint.h>
+
+/**
+ * @brief Odgovor uređaja na primljeni okvir.
+ * @return Dužina odgovora u rx (0 = uređaj ne odgovara).
+ */
+typedef uint16_t (*SimRs485Responder)(void* context, uint8_t bus_id,
+                                      const uint8_t* tx, uint16_t tx_length,
+                                      uint8_t* rx, uint16_t rx_size);
+
+struct SimRs485Stats
+{
+    uint32_t frames_tx;
+    uint32_t frames_rx;
+    uint32_t timeouts;
+};
+
+struct SimRs485Bus
+{
+    uint32_t baud;              ///< Brzina linije (10 bita po bajtu)
+    uint32_t turnaround_us;     ///< Od kraja upita do prvog bajta odgovora
+    SimRs485Responder responder;
+    void* context;
+    SimRs485Stats stats;
+
+    SimRs485Bus();
+
+    /**
+     * @brief Trajanje n bajtova na liniji.
+     */
+    uint32_t FrameUs(uint16_t length) const { return (uint32_t)(((uint64_t)length * 10000000ULL) / baud); }
+};
+
+extern SimRs485Bus g_simRs485Bus;
+
+#endif // SIM_RS485_BUS_H
@@ -0,0 +1,119 @@
+/**
+ ******************************************************************************
+ * @file    SimRs485Service.cpp
+ * @author  Gemini & [Vase Ime]
+ * @brief   Rs485Service nad simuliranom magistralom (vidi SimRs485Bus.h).
+ ******************************************************************************
+ */
+
+#include "Rs485Service.h"
+#include "SimRs485Bus.h"
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+SimRs485Bus g_simRs485Bus;
+
+SimRs485Bus::SimRs485Bus() :
+    baud(RS485_BAUDRATE),
+    turnaround_us(1000),
+    responder(NULL),
+    context(NULL)
+{
+    memset(&stats, 0, sizeof(stats));
+}
+
+namespace
+{
+    // Odgovor na zadnji poslani okvir, po servisu (traci)
+    std::mutex s_lock;
+    std::map<const Rs485Service*, std::vector<uint8_t> > s_pending;
+
+    void SleepUs(uint32_t us)
+    {
+        std::this_thread::sleep_for(std::chrono::microseconds(us));
+    }
+}
+
+Rs485Service::Rs485Service() :
+    m_uart_num(UART_NUM_1),
+    m_uart_event_queue(NULL),
+    m_last_rx_time(0),
+    m_single_byte_mode(false),
+    m_active_bus(0),
+    m_de_pin(0),
+    m_dedicated(false),
+    m_hw_de_control(false)
+{
+    memset(&m_tx_stats, 0, sizeof(m_tx_stats));
+}
+
+void Rs485Service::Initialize() {}
+
+void Rs485Service::InitializeDedicated(uint8_t bus_id, uart_port_t uart_num, int, int, int)
+{
+    m_active_bus = bus_id;
+    m_uart_num = uart_num;
+    m_dedicated = true;
+}
+
+bool Rs485Service::SendPacket(const uint8_t* data, uint16_t length)
+{
+    SleepUs(g_simRs485Bus.FrameUs(length));
+    m_tx_stats.frames++;
+    g_simRs485Bus.stats.frames_tx++;
+
+    std::vector<uint8_t> response(MAX_PACKET_LENGTH);
+    uint16_t response_length = 0;
+    if (g_simRs485Bus.responder != NULL)
+    {
+        response_length = g_simRs485Bus.responder(g_simRs485Bus.context, m_active_bus, data, length,
+                                                  response.data(), (uint16_t)response.size());
+    }
+    response.resize(response_length);
+
+    std::lock_guard<std::mutex> guard(s_lock);
+    s_pending[this] = response;
+    return true;
+}
+
+int Rs485Service::ReceivePacket(uint8_t* buffer, uint16_t buffer_size, uint32_t timeout_ms)
+{
+    std::vector<uint8_t> response;
+    {
+        std::lock_guard<std::mutex> guard(s_lock);
+        response.swap(s_pending[this]);
+    }
+
+    if (response.empty() || g_simRs485Bus.turnaround_us >= timeout_ms * 1000UL)
+    {
+        SleepUs(timeout_ms * 1000UL);
+        g_simRs485Bus.stats.timeouts++;
+        return 0;
+    }
+
+    SleepUs(g_simRs485Bus.turnaround_us + g_simRs485Bus.FrameUs((uint16_t)response.size()));
+    m_last_rx_time = millis();
+    if (response.size() > buffer_size) {
+        return -1;
+    }
+    memcpy(buffer, response.data(), response.size());
+    g_simRs485Bus.stats.frames_rx++;
+    return (int)response.size();
+}
+
+void Rs485Service::BeginReceive() {}
+int Rs485Service::PollPacket(uint8_t*, uint16_t) { return 0; }
+void Rs485Service::WaitForRxEvent(TickType_t max_wait) { vTaskDelay(max_wait); }
+void Rs485Service::LogIncompleteFrame() {}
+void Rs485Service::EnableSingleByteMode() { m_single_byte_mode = true; }
+void Rs485Service::DisableSingleByteMode() { m_single_byte_mode = false; }
+
+void Rs485Service::SelectBus(uint8_t busId)
+{
+    if (!m_dedicated) {
+        m_active_bus = busId;
+    }
+}
@@ -0,0 +1,54 @@
+/**
+ ******************************************************************************
+ * @file    SimSdCard.cpp
+ * @author  Gemini & [Vase Ime]
+ * @brief   File nad modelom uSD kartice (vidi SimSdCard.h).
+ ******************************************************************************
+ */
+
+#include "SD.h"
+#include <chrono>
+#include <thread>
+
+SimSdCard g_simSdCard;
+
+SimSdCard::SimSdCard() :
+    read_cost_us(2000),
+    byte_cost_ns(2000)  // 4 MHz SPI (podrazumijevani takt SD biblioteke)
+{
+    ClearStats();
+}
+
+void SimSdCard::ClearStats()
+{
+    memset(&stats, 0, sizeof(stats));
+}
+
+size_t File::read(uint8_t* buffer, size_t length)
+{
+    if (m_position >= m_size) {
+        return 0;
+    }
+    if (length > m_size - m_position) {
+        length = m_size - m_position;
+    }
+
+    uint32_t us = g_simSdCard.read_cost_us + (uint32_t)(((uint64_t)length * g_simSdCard.byte_cost_ns) / 1000);
+    g_simSdCard.stats.reads++;
+    g_simSdCard.stats.bytes += (uint32_t)length;
+    g_simSdCard.stats.read_us += us;
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+
+    memcpy(buffer, m_data + m_position, length);
+    m_position += length;
+    return length;
+}
+
+bool File::seek(uint32_t position)
+{
+    if (position > m_size) {
+        return false;
+    }
+    m_position = position;
+    return true;
+}
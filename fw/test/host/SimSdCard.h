@@ -0,0 +1,39 @@
+/**
+ ******************************************************************************
+ * @file    SimSdCard.h
+ * @author  Gemini & [Vase Ime]
+ * @brief   Model uSD kartice sa troškom čitanja (host testovi).
+ *
+ * @note
+ * Fajl je niz bajtova u RAM-u pozivaoca; svaki File::read() troši fiksno
+ * vrijeme (SPI komanda, FAT, sektor) plus vrijeme po bajtu. Nit zaista spava
+ * to vrijeme, kao zadatak koji na uređaju čeka SPI transfer.
+ ******************************************************************************
+ */
+
+#ifndef SIM_SD_CARD_H
+#define SIM_SD_CARD_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+struct SimSdStats
+{
+    uint32_t reads;     ///< Poziva File::read()
+    uint32_t bytes;
+    uint64_t read_us;   ///< Modelirano vrijeme čitanja
+};
+
+struct SimSdCard
+{
+    uint32_t read_cost_us;      ///< Fiksni trošak po čitanju
+    uint32_t byte_cost_ns;      ///< Trošak po bajtu (takt SPI-a)
+    SimSdStats stats;
+
+    SimSdCard();
+    void ClearStats();
+};
+
+extern SimSdCard g_simSdCard;
+
+#endif // SIM_SD_CARD_H
@@ -0,0 +1,57 @@
+/**
+ ******************************************************************************
+ * @file    Wire.h
+ * @author  Gemini & [Vase Ime]
+ * @brief   Host zamjena za Arduino-ESP32 TwoWire nad modelom I2C EEPROM-a.
+ *
+ * @note
+ * Semantika povratnih kodova i bafera je kao u Arduino-ESP32 2.0.x
+ * (I2C_BUFFER_LENGTH 128, endTransmission: 0 OK, 2 NACK adrese, 3 NACK
+ * podatka, 4 greška magistrale, 5 timeout). Uređaj na liniji je model
+ * 24C1024 iz SimI2cEeprom.h.
+ ******************************************************************************
+ */
+
+#ifndef HOST_WIRE_H
+#define HOST_WIRE_H
+
+#include "Arduino.h"
+
+#ifndef I2C_BUFFER_LENGTH
+#define I2C_BUFFER_LENGTH 128
+#endif
+
+class TwoWire : public Stream
+{
+public:
+    TwoWire();
+
+    bool begin(int sda = -1, int scl = -1, uint32_t frequency = 0);
+    bool setClock(uint32_t frequency);
+    uint32_t getClock() const { return m_clock_hz; }
+    void setTimeOut(uint16_t timeout_ms) { (void)timeout_ms; }
+
+    void beginTransmission(uint8_t address);
+    size_t write(uint8_t data) override;
+    size_t write(const uint8_t* data, size_t quantity) override;
+    using Print::write;
+    uint8_t endTransmission(bool send_stop = true);
+
+    uint8_t requestFrom(uint8_t address, size_t quantity, bool send_stop = true);
+    int available() override { return (int)(m_rx_length - m_rx_index); }
+    int read() override { return (m_rx_index < m_rx_length) ? m_rx_buffer[m_rx_index++] : -1; }
+    int peek() override { return (m_rx_index < m_rx_length) ? m_rx_buffer[m_rx_index] : -1; }
+
+private:
+    uint32_t m_clock_hz;
+    uint8_t m_tx_address;
+    uint8_t m_tx_buffer[I2C_BUFFER_LENGTH];
+    size_t m_tx_length;
+    uint8_t m_rx_buffer[I2C_BUFFER_LENGTH];
+    size_t m_rx_length;
+    size_t m_rx_index;
+};
+
+extern TwoWire Wire;
+
+#endif // HOST_WIRE_H
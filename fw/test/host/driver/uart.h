@@ -0,0 +1,30 @@
+/**
+ ******************************************************************************
+ * @file    uart.h
+ * @author  Gemini & [Vase Ime]
+ * @brief   Host zamjena za ESP-IDF UART drajver - samo tipovi.
+ *
+ * @note
+ * Na hostu Rs485Service zamjenjuje simulirana magistrala (SimRs485Service.cpp),
+ * pa se funkcije drajvera ne pozivaju.
+ ******************************************************************************
+ */
+
+#ifndef HOST_DRIVER_UART_H
+#define HOST_DRIVER_UART_H
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include <stddef.h>
+
+typedef int esp_err_t;
+#ifndef ESP_OK
+#define ESP_OK 0
+#endif
+
+typedef enum { UART_NUM_0, UART_NUM_1, UART_NUM_2 } uart_port_t;
+typedef enum { UART_DATA, UART_BREAK, UART_BUFFER_FULL, UART_FIFO_OVF, UART_FRAME_ERR,
+               UART_PARITY_ERR, UART_DATA_BREAK, UART_PATTERN_DET, UART_EVENT_MAX } uart_event_type_t;
+typedef struct { uart_event_type_t type; size_t size; bool timeout_flag; } uart_event_t;
+
+#endif // HOST_DRIVER_UART_H
@@ -0,0 +1,9 @@
+/**
+ * @file    esp_task_wdt.h
+ * @brief   Host zamjena: watchdog zadataka ne postoji na hostu.
+ */
+#ifndef HOST_ESP_TASK_WDT_H
+#define HOST_ESP_TASK_WDT_H
+typedef int esp_err_t;
+static inline esp_err_t esp_task_wdt_reset() { return 0; }
+#endif // HOST_ESP_TASK_WDT_H
@@ -0,0 +1,10 @@
+/**
+ * @file    esp_timer.h
+ * @brief   Host zamjena: esp_timer_get_time() = micros() hosta.
+ */
+#ifndef HOST_ESP_TIMER_H
+#define HOST_ESP_TIMER_H
+#include <stdint.h>
+unsigned long micros();
+static inline int64_t esp_timer_get_time() { return (int64_t)micros(); }
+#endif // HOST_ESP_TIMER_H
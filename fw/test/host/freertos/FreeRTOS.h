@@ -0,0 +1,45 @@
+/**
+ ******************************************************************************
+ * @file    FreeRTOS.h
+ * @author  Gemini & [Vase Ime]
+ * @brief   Host zamjena za FreeRTOS (ESP-IDF) - tipovi i kritične sekcije.
+ *
+ * @note
+ * Tick je 1 ms. Kritične sekcije (portENTER_CRITICAL) dijele jedan globalni
+ * rekurzivni lock - na hostu nema prekida, pa je to dovoljan model.
+ * Implementacija je u test/host/FreeRtosHost.cpp.
+ ******************************************************************************
+ */
+
+#ifndef HOST_FREERTOS_H
+#define HOST_FREERTOS_H
+
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+#define pdMS_TO_TICKS(ms)       ((TickType_t)(ms))
+#define portTICK_PERIOD_MS      1
+#define portMAX_DELAY           ((TickType_t)0xFFFFFFFFUL)
+#define pdTRUE                  1
+#define pdFALSE                 0
+#define pdPASS                  1
+#define pdFAIL                  0
+#define tskNO_AFFINITY          0x7FFFFFFF
+
+typedef struct { int unused; } portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED { 0 }
+
+void HostEnterCritical();
+void HostExitCritical();
+
+#define portENTER_CRITICAL(mux)         ((void)(mux), HostEnterCritical())
+#define portEXIT_CRITICAL(mux)          ((void)(mux), HostExitCritical())
+#define portENTER_CRITICAL_ISR(mux)     portENTER_CRITICAL(mux)
+#define portEXIT_CRITICAL_ISR(mux)      portEXIT_CRITICAL(mux)
+#define taskENTER_CRITICAL(mux)         portENTER_CRITICAL(mux)
+#define taskEXIT_CRITICAL(mux)          portEXIT_CRITICAL(mux)
+
+#endif // HOST_FREERTOS_H
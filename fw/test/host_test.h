@@ -0,0 +1,74 @@
+/**
+ ******************************************************************************
+ * @file    host_test.h
+ * @author  Gemini & [Vase Ime]
+ * @brief   Minimalni okvir za host testove (g++, bez ESP32 toolchain-a).
+ *
+ * @note
+ * Testovi u test/ se grade sa `make -C test` (vidi test/Makefile). Svaki test
+ * je zaseban program: CHECK makroi broje greške, HOST_TEST_RESULT() vraća
+ * izlazni kod za main().
+ ******************************************************************************
+ */
+
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <chrono>
+#include <time.h>
+
+static int g_host_test_checks = 0;
+static int g_host_test_failures = 0;
+
+#define CHECK(cond) \
+    do { \
+        g_host_test_checks++; \
+        if (!(cond)) { \
+            g_host_test_failures++; \
+            printf("  FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        } \
+    } while (0)
+
+#define CHECK_EQ(actual, expected) \
+    do { \
+        g_host_test_checks++; \
+        long long _a = (long long)(actual); \
+        long long _e = (long long)(expected); \
+        if (_a != _e) { \
+            g_host_test_failures++; \
+            printf("  FAIL %s:%d: %s == %lld, ocekivano %lld\n", __FILE__, __LINE__, #actual, _a, _e); \
+        } \
+    } while (0)
+
+#define RUN_TEST(fn) \
+    do { \
+        printf("[ RUN  ] %s\n", #fn); \
+        fn(); \
+    } while (0)
+
+#define HOST_TEST_RESULT() \
+    (printf("%d provjera, %d gresaka\n", g_host_test_checks, g_host_test_failures), \
+     g_host_test_failures == 0 ? 0 : 1)
+
+/**
+ * @brief Monotono vrijeme hosta u nanosekundama (za benchmarke).
+ */
+static inline uint64_t HostNowNs()
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief CPU vrijeme pozivajuće niti u nanosekundama (bez vremena preempcije i spavanja).
+ */
+static inline uint64_t HostThreadCpuNs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+#endif // HOST_TEST_H
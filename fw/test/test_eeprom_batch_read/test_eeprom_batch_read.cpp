@@ -0,0 +1,172 @@
+/**
+ ******************************************************************************
+ * @file    test_eeprom_batch_read.cpp
+ * @author  Gemini & [Vase Ime]
+ * @brief   Host test grupnog čitanja logova (ReadLogRange) nad modelom 24C1024.
+ *
+ * @note
+ * Pravi EepromStorage radi nad SimI2cEeprom-om (vrijeme magistrale = bitovi /
+ * takt + trošak transakcije). Isti posao se ponavlja obrascem od prije
+ * (adresna transakcija + requestFrom od 16 B po slotu) i porede se broj
+ * transakcija i modelirano vrijeme magistrale:
+ *   - skeniranje pri startu bez metapodataka (skoro pun logger),
+ *   - blok za HTTP preuzimanje preko kraja kružnog bafera.
+ ******************************************************************************
+ */
+
+#include "host_test.h"
+#include "EepromStorage.h"
+#include "SimI2cEeprom.h"
+#include "Wire.h"
+#include <string>
+
+EepromStorage g_eepromStorage;
+
+static const uint16_t FILLED_SLOTS = MAX_LOG_ENTRIES - 5;  ///< Upisani logovi se obmotaju nakon 5 slotova
+static const uint16_t BLOCK_LOGS = 16;                     ///< Logova u jednom HTTP bloku (256 B)
+
+struct BusCost
+{
+    uint32_t transactions;
+    uint64_t bus_us;
+};
+
+static BusCost TakeCost()
+{
+    BusCost cost = { g_simEeprom.stats.transactions, g_simEeprom.stats.bus_us };
+    g_simEeprom.ClearStats();
+    return cost;
+}
+
+static void PrintCost(const char* name, const BusCost& cost)
+{
+    printf("  %-34s transakcija: %6lu  magistrala: %8.2f ms\n", name,
+           (unsigned long)cost.transactions, cost.bus_us / 1000.0);
+}
+
+static void MakeLog(LogEntry* entry, uint16_t log_id)
+{
+    memset(entry, 0, sizeof(LogEntry));
+    entry->log_id = log_id;
+    entry->event_code = 0x10;
+    entry->device_addr = (uint16_t)(0x0100 + (log_id % 64));
+    entry->timestamp = 1700000000UL + log_id;
+}
+
+static uint32_t SlotAddress(uint16_t index)
+{
+    return EEPROM_LOG_START_ADDR + ((uint32_t)index * LOG_ENTRY_SIZE);
+}
+
+/**
+ * @brief Čitanje jednog slota kao prije: adresna transakcija pa requestFrom od 16 B.
+ */
+static bool ReadSlotPerRecord(uint16_t index, uint8_t* dest)
+{
+    uint32_t address = SlotAddress(index);
+    uint8_t device_addr = (uint8_t)(EEPROM_I2C_ADDR | ((address >> 16) & 0x01));
+
+    Wire.beginTransmission(device_addr);
+    Wire.write((uint8_t)(address >> 8));
+    Wire.write((uint8_t)(address & 0xFF));
+    if (Wire.endTransmission(false) != 0) return false;
+    if (Wire.requestFrom(device_addr, (size_t)LOG_ENTRY_SIZE) != LOG_ENTRY_SIZE) return false;
+    for (uint8_t i = 0; i < LOG_ENTRY_SIZE; i++) {
+        dest[i] = (uint8_t)Wire.read();
+    }
+    return true;
+}
+
+static std::string HexOf(const uint8_t* data, size_t length)
+{
+    std::string hex;
+    char buf[3];
+    for (size_t i = 0; i < length; i++)
+    {
+        snprintf(buf, sizeof(buf), "%02X", data[i]);
+        hex += buf;
+    }
+    return hex;
+}
+
+int main()
+{
+    // Logovi od slota 0, bez metapodataka logera -> Initialize() skenira
+    for (uint16_t i = 0; i < FILLED_SLOTS; i++)
+    {
+        LogEntry entry;
+        MakeLog(&entry, (uint16_t)(i + 1));
+        memcpy(&g_simEeprom.memory[SlotAddress(i)], &entry, LOG_ENTRY_SIZE);
+    }
+
+    printf("%u logova, I2C %lu Hz\n", FILLED_SLOTS, (unsigned long)EEPROM_I2C_CLOCK_HZ);
+
+    // ------------------------------------------------------------------------
+    // Skeniranje pri startu
+    // ------------------------------------------------------------------------
+    g_simEeprom.ClearStats();
+    g_eepromStorage.Initialize(I2C_SDA_PIN, I2C_SCL_PIN);
+    BusCost boot_batched = TakeCost();
+
+    // Stari LoggerScan(): slot po slot do prvog praznog
+    uint8_t slot[LOG_ENTRY_SIZE];
+    uint16_t scanned = 0;
+    while (scanned < MAX_LOG_ENTRIES && ReadSlotPerRecord(scanned, slot))
+    {
+        scanned++;
+        uint16_t log_id = (uint16_t)(slot[0] | (slot[1] << 8));
+        if (log_id == 0 || log_id == 0xFFFF) break;
+    }
+    BusCost boot_per_record = TakeCost();
+    CHECK_EQ(scanned, FILLED_SLOTS + 1);
+
+    PrintCost("start: grupno (cijeli Initialize)", boot_batched);
+    PrintCost("start: slot po slot (ranije)", boot_per_record);
+
+    // Tail = 0: prvi blok su logovi 1..16
+    std::string expected = HexOf(&g_simEeprom.memory[SlotAddress(0)], BLOCK_LOGS * LOG_ENTRY_SIZE);
+    CHECK(expected == g_eepromStorage.ReadLogBlockAsHexString().c_str());
+
+    // ------------------------------------------------------------------------
+    // HTTP blok preko kraja kružnog bafera
+    // ------------------------------------------------------------------------
+    // ClearAllLogs() postavlja tail = head (slot FILLED_SLOTS), novi logovi se obmotaju
+    CHECK(g_eepromStorage.ClearAllLogs() == LoggerStatus::LOGGER_OK);
+    uint8_t written[BLOCK_LOGS * LOG_ENTRY_SIZE];
+    for (uint16_t i = 0; i < BLOCK_LOGS; i++)
+    {
+        LogEntry entry;
+        MakeLog(&entry, (uint16_t)(0x8000 + i));
+        memcpy(&written[i * LOG_ENTRY_SIZE], &entry, LOG_ENTRY_SIZE);
+        CHECK(g_eepromStorage.WriteLog(&entry) == LoggerStatus::LOGGER_OK);
+    }
+    CHECK(memcmp(&g_simEeprom.memory[SlotAddress(FILLED_SLOTS)], &written[0], LOG_ENTRY_SIZE) == 0);
+    CHECK(memcmp(&g_simEeprom.memory[SlotAddress(0)], &written[5 * LOG_ENTRY_SIZE], LOG_ENTRY_SIZE) == 0);
+
+    g_simEeprom.ClearStats();
+    String block = g_eepromStorage.ReadLogBlockAsHexString();
+    BusCost export_batched = TakeCost();
+
+    uint8_t per_record[BLOCK_LOGS * LOG_ENTRY_SIZE];
+    for (uint16_t i = 0; i < BLOCK_LOGS; i++) {
+        CHECK(ReadSlotPerRecord((uint16_t)((FILLED_SLOTS + i) % MAX_LOG_ENTRIES), &per_record[i * LOG_ENTRY_SIZE]));
+    }
+    BusCost export_per_record = TakeCost();
+
+    PrintCost("blok: grupno", export_batched);
+    PrintCost("blok: slot po slot (ranije)", export_per_record);
+
+    CHECK(HexOf(written, sizeof(written)) == block.c_str());
+    CHECK(memcmp(written, per_record, sizeof(written)) == 0);
+
+    // Blok preko kraja prstena: dva opsega (5 + 11 slotova), drugi u dva chunk-a od 128 B
+    CHECK_EQ(export_batched.transactions, 6u);
+    CHECK_EQ(export_per_record.transactions, 2u * BLOCK_LOGS);
+    // Bajtovi podataka su isti, ušteda je u adresnim fazama i trošku transakcija (~1/3)
+    CHECK(export_batched.bus_us * 3 < export_per_record.bus_us * 2);
+    // Skeniranje: 8 slotova po chunk-u umjesto jednog, i sa ostatkom Initialize()-a
+    CHECK(boot_batched.transactions * 4 < boot_per_record.transactions);
+    CHECK(boot_batched.bus_us * 3 < boot_per_record.bus_us * 2);
+
+    return HOST_TEST_RESULT();
+}
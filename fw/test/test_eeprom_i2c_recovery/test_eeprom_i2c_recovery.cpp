@@ -0,0 +1,122 @@
+/**
+ ******************************************************************************
+ * @file    test_eeprom_i2c_recovery.cpp
+ * @author  Gemini & [Vase Ime]
+ * @brief   Host test oporavka EepromStorage-a od I2C grešaka nad modelom 24C1024.
+ *
+ * @note
+ * NACK dok je EEPROM u ciklusu upisa je normalan i ne smije spustiti takt sa
+ * Fm+ na rezervni. Takt se spušta na grešku magistrale (kod 4/5 iz
+ * endTransmission()) ili kad uređaj ne odgovara ni nakon ACK polling-a.
+ ******************************************************************************
+ */
+
+#include "host_test.h"
+#include "EepromStorage.h"
+#include "SimI2cEeprom.h"
+#include "Wire.h"
+
+static const uint16_t LIST_COUNT = 40;
+
+static void FillList(uint16_t* list, uint16_t seed)
+{
+    for (uint16_t i = 0; i < LIST_COUNT; i++) {
+        list[i] = (uint16_t)(seed + i);
+    }
+}
+
+/**
+ * @brief Svježa memorija i EepromStorage na Fm+ taktu.
+ */
+static void StartAtFastClock(EepromStorage* storage)
+{
+    g_simEeprom.Reset();
+    storage->Initialize(I2C_SDA_PIN, I2C_SCL_PIN);
+    g_simEeprom.ClearStats();
+}
+
+static void TestWriteCycleNackKeepsClock()
+{
+    EepromStorage storage;
+    StartAtFastClock(&storage);
+    CHECK_EQ(Wire.getClock(), (uint32_t)EEPROM_I2C_CLOCK_HZ);
+
+    // Uređaj ne potvrđuje adresu kao tokom ciklusa upisa (upis, pa prvi ping-ovi)
+    uint16_t list[LIST_COUNT];
+    FillList(list, 0x0101);
+    g_simEeprom.inject_error = 2;
+    g_simEeprom.inject_count = 3;
+    CHECK(storage.WriteAddressList(list, LIST_COUNT));
+    CHECK_EQ(Wire.getClock(), (uint32_t)EEPROM_I2C_CLOCK_HZ);
+
+    // NACK na adresnoj fazi čitanja
+    uint16_t read[LIST_COUNT];
+    uint16_t count = 0;
+    g_simEeprom.inject_error = 2;
+    g_simEeprom.inject_count = 2;
+    CHECK(storage.ReadAddressList(read, LIST_COUNT, &count));
+    CHECK_EQ(count, LIST_COUNT);
+    CHECK(memcmp(list, read, sizeof(list)) == 0);
+    CHECK_EQ(Wire.getClock(), (uint32_t)EEPROM_I2C_CLOCK_HZ);
+}
+
+static void TestBusErrorLowersClock()
+{
+    EepromStorage storage;
+    StartAtFastClock(&storage);
+
+    uint16_t list[LIST_COUNT];
+    FillList(list, 0x0201);
+    CHECK(storage.WriteAddressList(list, LIST_COUNT));
+
+    // Greška magistrale (arbitraža) - čitanje se ponavlja na rezervnom taktu
+    uint16_t read[LIST_COUNT];
+    uint16_t count = 0;
+    g_simEeprom.inject_error = 4;
+    g_simEeprom.inject_count = 1;
+    CHECK(storage.ReadAddressList(read, LIST_COUNT, &count));
+    CHECK(memcmp(list, read, sizeof(list)) == 0);
+    CHECK_EQ(Wire.getClock(), (uint32_t)EEPROM_I2C_FALLBACK_CLOCK_HZ);
+}
+
+static void TestAckPollTimeoutLowersClock()
+{
+    EepromStorage storage;
+    StartAtFastClock(&storage);
+
+    // Uređaj ne odgovara duže od ACK poll timeout-a: tek tada rezervni takt, pa greška
+    uint16_t list[LIST_COUNT];
+    FillList(list, 0x0301);
+    g_simEeprom.inject_error = 2;
+    g_simEeprom.inject_count = 1000000;
+    CHECK(!storage.WriteAddressList(list, LIST_COUNT));
+    CHECK_EQ(Wire.getClock(), (uint32_t)EEPROM_I2C_FALLBACK_CLOCK_HZ);
+    g_simEeprom.inject_count = 0;
+}
+
+static void TestSlowWiringSelectsFallback()
+{
+    // Ožičenje ne podnosi Fm+: Initialize() bira rezervni takt i podaci su ispravni
+    EepromStorage storage;
+    g_simEeprom.Reset();
+    g_simEeprom.max_ok_clock_hz = EEPROM_I2C_FALLBACK_CLOCK_HZ;
+    storage.Initialize(I2C_SDA_PIN, I2C_SCL_PIN);
+    CHECK_EQ(Wire.getClock(), (uint32_t)EEPROM_I2C_FALLBACK_CLOCK_HZ);
+
+    uint16_t list[LIST_COUNT];
+    uint16_t read[LIST_COUNT];
+    uint16_t count = 0;
+    FillList(list, 0x0401);
+    CHECK(storage.WriteAddressList(list, LIST_COUNT));
+    CHECK(storage.ReadAddressList(read, LIST_COUNT, &count));
+    CHECK(memcmp(list, read, sizeof(list)) == 0);
+}
+
+int main()
+{
+    RUN_TEST(TestWriteCycleNackKeepsClock);
+    RUN_TEST(TestBusErrorLowersClock);
+    RUN_TEST(TestAckPollTimeoutLowersClock);
+    RUN_TEST(TestSlowWiringSelectsFallback);
+    return HOST_TEST_RESULT();
+}
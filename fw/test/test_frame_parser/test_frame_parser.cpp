@@ -0,0 +1,351 @@
+/**
+ ******************************************************************************
+ * @file    test_frame_parser.cpp
+ * @author  Gemini & [Vase Ime]
+ * @brief   Host test Rs485FrameParser-a: razdvojeni, spojeni i zašumljeni tokovi.
+ *
+ * @note
+ * Bajtovi se ubacuju kao u Rs485Service::DrainRxBuffer(): parser dobija
+ * komade proizvoljne veličine (kako ih vrati uart_read_bytes), greška odbacuje
+ * okvir i prijem nastavlja od sljedećeg bajta.
+ ******************************************************************************
+ */
+
+#include "host_test.h"
+#include "Rs485FrameParser.h"
+#include <string.h>
+#include <vector>
+
+static const uint16_t LOCAL_ADDR = 0x1234;
+
+struct Frame
+{
+    std::vector<uint8_t> bytes;
+};
+
+/**
+ * @brief Gradi okvir po pravilima iz hotel_ctrl.c.
+ */
+static std::vector<uint8_t> BuildFrame(uint8_t start, uint16_t target, uint16_t source,
+                                       const uint8_t* data, uint8_t data_len)
+{
+    std::vector<uint8_t> f;
+    f.push_back(start);
+    f.push_back((uint8_t)(target >> 8));
+    f.push_back((uint8_t)target);
+    f.push_back((uint8_t)(source >> 8));
+    f.push_back((uint8_t)source);
+    f.push_back(data_len);
+    uint16_t checksum = 0;
+    for (uint8_t i = 0; i < data_len; i++)
+    {
+        f.push_back(data[i]);
+        checksum += data[i];
+    }
+    f.push_back((uint8_t)(checksum >> 8));
+    f.push_back((uint8_t)checksum);
+    f.push_back((uint8_t)EOT);
+    return f;
+}
+
+static std::vector<uint8_t> SampleFrame(uint8_t seed, uint8_t data_len = 5)
+{
+    uint8_t data[255];
+    for (uint8_t i = 0; i < data_len; i++) {
+        data[i] = (uint8_t)(seed + i * 37);
+    }
+    return BuildFrame(SOH, LOCAL_ADDR, 0x0100 + seed, data, data_len);
+}
+
+/**
+ * @brief Sakuplja rezultate parsera preko više komada toka.
+ */
+struct Collector
+{
+    Rs485FrameParser parser;
+    std::vector<Frame> frames;
+    std::vector<FrameError> errors;
+
+    Collector() { parser.SetLocalAddress(LOCAL_ADDR); }
+
+    void FeedChunk(const uint8_t* data, size_t len)
+    {
+        for (size_t i = 0; i < len; i++)
+        {
+            FrameStatus status = parser.Feed(data[i]);
+            if (status == FrameStatus::FRAME_READY)
+            {
+                Frame f;
+                f.bytes.assign(parser.GetFrame(), parser.GetFrame() + parser.GetLength());
+                frames.push_back(f);
+            }
+            else if (status == FrameStatus::FRAME_ERROR)
+            {
+                errors.push_back(parser.GetLastError());
+            }
+        }
+    }
+
+    void FeedChunk(const std::vector<uint8_t>& data) { FeedChunk(data.data(), data.size()); }
+};
+
+static std::vector<uint8_t> Concat(const std::vector<uint8_t>& a, const std::vector<uint8_t>& b)
+{
+    std::vector<uint8_t> out(a);
+    out.insert(out.end(), b.begin(), b.end());
+    return out;
+}
+
+// ============================================================================
+
+static void TestWholeFrameByteByByte()
+{
+    std::vector<uint8_t> frame = SampleFrame(1);
+    Rs485FrameParser parser;
+    parser.SetLocalAddress(LOCAL_ADDR);
+
+    for (size_t i = 0; i + 1 < frame.size(); i++)
+    {
+        CHECK(parser.Feed(frame[i]) == FrameStatus::INCOMPLETE);
+        CHECK(parser.IsInProgress());
+    }
+    CHECK(parser.Feed(frame.back()) == FrameStatus::FRAME_READY);
+    CHECK_EQ(parser.GetLength(), frame.size());
+    CHECK(memcmp(parser.GetFrame(), frame.data(), frame.size()) == 0);
+    CHECK(!parser.IsInProgress());
+}
+
+static void TestSplitAtEveryPosition()
+{
+    std::vector<uint8_t> frame = SampleFrame(2, 20);
+    for (size_t split = 1; split < frame.size(); split++)
+    {
+        Collector c;
+        c.FeedChunk(frame.data(), split);
+        CHECK_EQ(c.frames.size(), 0);
+        c.FeedChunk(frame.data() + split, frame.size() - split);
+        CHECK_EQ(c.frames.size(), 1);
+        CHECK_EQ(c.errors.size(), 0);
+        if (!c.frames.empty()) {
+            CHECK(c.frames[0].bytes == frame);
+        }
+    }
+}
+
+static void TestSplitIntoSmallChunks()
+{
+    std::vector<uint8_t> stream;
+    for (uint8_t i = 0; i < 10; i++) {
+        stream = Concat(stream, SampleFrame(i, (uint8_t)(1 + i * 11)));
+    }
+
+    for (size_t chunk = 1; chunk <= 64; chunk++)
+    {
+        Collector c;
+        for (size_t pos = 0; pos < stream.size(); pos += chunk)
+        {
+            size_t len = (stream.size() - pos < chunk) ? stream.size() - pos : chunk;
+            c.FeedChunk(stream.data() + pos, len);
+        }
+        CHECK_EQ(c.frames.size(), 10);
+        CHECK_EQ(c.errors.size(), 0);
+    }
+}
+
+static void TestMergedFrames()
+{
+    std::vector<uint8_t> a = SampleFrame(3);
+    std::vector<uint8_t> b = SampleFrame(4, 12);
+    std::vector<uint8_t> c3 = BuildFrame(STX, LOCAL_ADDR, 0x0200, (const uint8_t*)"OK", 2);
+
+    Collector c;
+    c.FeedChunk(Concat(Concat(a, b), c3));
+    CHECK_EQ(c.frames.size(), 3);
+    CHECK_EQ(c.errors.size(), 0);
+    if (c.frames.size() == 3)
+    {
+        CHECK(c.frames[0].bytes == a);
+        CHECK(c.frames[1].bytes == b);
+        CHECK(c.frames[2].bytes == c3);
+    }
+}
+
+static void TestLeadingNullBytesIgnored()
+{
+    std::vector<uint8_t> stream(7, 0x00);
+    stream = Concat(stream, SampleFrame(5));
+
+    Collector c;
+    c.FeedChunk(stream);
+    CHECK_EQ(c.frames.size(), 1);
+    CHECK_EQ(c.errors.size(), 0);
+
+    // Null bajtovi između okvira (HIGH-Z na liniji) se takođe preskaču
+    Collector c2;
+    c2.FeedChunk(Concat(Concat(SampleFrame(6), std::vector<uint8_t>(3, 0x00)), SampleFrame(7)));
+    CHECK_EQ(c2.frames.size(), 2);
+}
+
+static void TestCorruptedFrameThenValid()
+{
+    std::vector<uint8_t> bad_checksum = SampleFrame(8);
+    bad_checksum[7] ^= 0x40;
+
+    std::vector<uint8_t> wrong_target = BuildFrame(SOH, LOCAL_ADDR + 1, 0x0100, (const uint8_t*)"abc", 3);
+
+    std::vector<uint8_t> missing_eot = SampleFrame(9);
+    missing_eot.back() = 0x05;
+
+    std::vector<uint8_t> bad_start = SampleFrame(10);
+    bad_start[0] = 0x55;
+
+    struct Case { const std::vector<uint8_t>* frame; FrameError error; } cases[] = {
+        { &bad_checksum, FrameError::BAD_CHECKSUM },
+        { &wrong_target, FrameError::WRONG_TARGET },
+        { &missing_eot,  FrameError::MISSING_EOT },
+        { &bad_start,    FrameError::BAD_START },
+    };
+
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+    {
+        std::vector<uint8_t> good = SampleFrame((uint8_t)(20 + i));
+        Collector c;
+        c.FeedChunk(Concat(*cases[i].frame, good));
+        CHECK_EQ(c.errors.size(), 1);
+        if (!c.errors.empty()) {
+            CHECK(c.errors[0] == cases[i].error);
+        }
+        CHECK_EQ(c.frames.size(), 1);
+        if (!c.frames.empty()) {
+            CHECK(c.frames[0].bytes == good);
+        }
+    }
+}
+
+static void TestBadLength()
+{
+    // data_len 0 -> ukupno 9 bajtova (< 10), data_len 250 -> 259 (> MAX_PACKET_LENGTH)
+    const uint8_t lengths[] = { 0, 250 };
+    for (size_t i = 0; i < sizeof(lengths); i++)
+    {
+        Rs485FrameParser parser;
+        parser.SetLocalAddress(LOCAL_ADDR);
+        uint8_t header[6] = { (uint8_t)SOH, 0x12, 0x34, 0x01, 0x00, lengths[i] };
+        FrameStatus status = FrameStatus::INCOMPLETE;
+        for (size_t b = 0; b < sizeof(header); b++) {
+            status = parser.Feed(header[b]);
+        }
+        // Greška se prijavljuje odmah po bajtu dužine - ne čeka se ostatak okvira
+        CHECK(status == FrameStatus::FRAME_ERROR);
+        CHECK(parser.GetLastError() == FrameError::BAD_LENGTH);
+    }
+
+    // Najveći dozvoljeni okvir (data_len + 9 == MAX_PACKET_LENGTH)
+    std::vector<uint8_t> max_frame = SampleFrame(11, (uint8_t)(MAX_PACKET_LENGTH - 9));
+    Collector c;
+    c.FeedChunk(max_frame);
+    CHECK_EQ(c.frames.size(), 1);
+    CHECK_EQ(c.errors.size(), 0);
+}
+
+static void TestGarbageThenReset()
+{
+    // Šum bez strukture okvira: parser ga drži kao početak okvira dok
+    // Rs485Service ne resetuje prijem (BeginReceive() prije sljedećeg upita)
+    const uint8_t noise[] = { 0x7F, 0x13, 0x99, 0xA5 };
+    Collector c;
+    c.FeedChunk(noise, sizeof(noise));
+    CHECK(c.parser.IsInProgress());
+    c.parser.Reset();
+    CHECK(!c.parser.IsInProgress());
+
+    std::vector<uint8_t> good = SampleFrame(12);
+    c.FeedChunk(good);
+    CHECK_EQ(c.frames.size(), 1);
+    CHECK_EQ(c.errors.size(), 0);
+}
+
+static void TestSingleByteMode()
+{
+    Rs485FrameParser parser;
+    parser.SetLocalAddress(LOCAL_ADDR);
+    parser.SetSingleByteMode(true);
+
+    CHECK(parser.Feed((uint8_t)ACK) == FrameStatus::FRAME_READY);
+    CHECK_EQ(parser.GetLength(), 1);
+    CHECK(parser.Feed((uint8_t)NAK) == FrameStatus::FRAME_READY);
+    CHECK_EQ(parser.GetLength(), 1);
+
+    // Pun okvir i dalje prolazi u single-byte modu (SOH nije ACK/NAK)
+    std::vector<uint8_t> frame = SampleFrame(13);
+    FrameStatus status = FrameStatus::INCOMPLETE;
+    for (size_t i = 0; i < frame.size(); i++) {
+        status = parser.Feed(frame[i]);
+    }
+    CHECK(status == FrameStatus::FRAME_READY);
+    CHECK_EQ(parser.GetLength(), frame.size());
+
+    // Bez single-byte moda ACK je samo početni bajt okvira
+    Rs485FrameParser normal;
+    normal.SetLocalAddress(LOCAL_ADDR);
+    CHECK(normal.Feed((uint8_t)ACK) == FrameStatus::INCOMPLETE);
+}
+
+/**
+ * @brief Nasumičan šum sa ubačenim okvirima: parser nikad ne prijavi okvir
+ *        koji nije validan i ne izlazi van bafera.
+ */
+static void TestRandomNoiseNeverYieldsInvalidFrame()
+{
+    uint32_t lcg = 12345;
+    Collector c;
+    size_t injected = 0;
+
+    for (int round = 0; round < 20000; round++)
+    {
+        lcg = lcg * 1103515245u + 12345u;
+        uint8_t kind = (uint8_t)(lcg >> 24);
+        if (kind < 16)
+        {
+            // Ispravan okvir nakon reseta (kao novi upit)
+            c.parser.Reset();
+            c.FeedChunk(SampleFrame((uint8_t)round, (uint8_t)(1 + (kind % 40))));
+            injected++;
+        }
+        else
+        {
+            uint8_t byte = (uint8_t)(lcg >> 16);
+            c.FeedChunk(&byte, 1);
+        }
+    }
+
+    CHECK(c.frames.size() >= injected);
+    for (size_t i = 0; i < c.frames.size(); i++)
+    {
+        const std::vector<uint8_t>& f = c.frames[i].bytes;
+        bool valid = f.size() >= 10 && f.size() == (size_t)f[5] + 9 &&
+                     f.back() == (uint8_t)EOT &&
+                     (uint16_t)((f[1] << 8) | f[2]) == LOCAL_ADDR;
+        uint16_t checksum = 0;
+        for (size_t b = 6; valid && b < 6u + f[5]; b++) {
+            checksum += f[b];
+        }
+        valid = valid && checksum == (uint16_t)((f[f.size() - 3] << 8) | f[f.size() - 2]);
+        CHECK(valid);
+    }
+}
+
+int main()
+{
+    RUN_TEST(TestWholeFrameByteByByte);
+    RUN_TEST(TestSplitAtEveryPosition);
+    RUN_TEST(TestSplitIntoSmallChunks);
+    RUN_TEST(TestMergedFrames);
+    RUN_TEST(TestLeadingNullBytesIgnored);
+    RUN_TEST(TestCorruptedFrameThenValid);
+    RUN_TEST(TestBadLength);
+    RUN_TEST(TestGarbageThenReset);
+    RUN_TEST(TestSingleByteMode);
+    RUN_TEST(TestRandomNoiseNeverYieldsInvalidFrame);
+    return HOST_TEST_RESULT();
+}
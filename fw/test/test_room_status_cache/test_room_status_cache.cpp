@@ -0,0 +1,216 @@
+/**
+ ******************************************************************************
+ * @file    test_room_status_cache.cpp
+ * @author  Gemini & [Vase Ime]
+ * @brief   Host test generacije slota RoomStatusCache-a (Invalidate vs. Store).
+ *
+ * @note
+ * Čitanje statusa koje je bilo u redu ili na liniji kada je komanda promijenila
+ * sobu vraća stanje prije komande i ne smije ući u keš. Provjerava se sam keš
+ * i asinhroni cst (HttpQueryManager) nad simuliranom magistralom: soba drži
+ * odgovor na status dok se ne preda komanda.
+ ******************************************************************************
+ */
+
+#include "host_test.h"
+#include "HttpQueryManager.h"
+#include "RoomStatusCache.h"
+#include "Rs485BusOwner.h"
+#include "EepromStorage.h"
+#include "SimRs485Bus.h"
+#include <atomic>
+#include <thread>
+
+extern AppConfig g_appConfig;
+
+Rs485Service g_rs485Service;
+Rs485BusOwner g_rs485BusOwner;
+HttpQueryManager g_httpQueryManager;
+
+static const uint16_t ROOMS[] = { 0x0301, 0x0302, 0x0303 };
+static const uint16_t ROOM_COUNT = sizeof(ROOMS) / sizeof(ROOMS[0]);
+static const uint32_t MAX_AGE_MS = 60000;
+
+static std::atomic<char> s_room_state;      ///< Stanje sobe ROOMS[0] ('0'/'1')
+static std::atomic<bool> s_hold_status;     ///< Soba drži odgovor na status
+static std::atomic<bool> s_status_on_wire;  ///< Upit statusa je stigao do sobe
+
+static const uint8_t* Payload(const char* text)
+{
+    return (const uint8_t*)text;
+}
+
+static bool CachedState(uint16_t address, char* state)
+{
+    RoomStatusSnapshot snapshot;
+    if (!g_roomStatusCache.Get(address, MAX_AGE_MS, &snapshot)) {
+        return false;
+    }
+    *state = snapshot.payload[0];
+    return true;
+}
+
+static void TestStaleStoreDropped()
+{
+    g_roomStatusCache.Build(ROOMS, ROOM_COUNT, NULL, 0);
+    char state = 0;
+
+    // Čitanje bez komande u međuvremenu ulazi u keš
+    uint16_t generation = g_roomStatusCache.GetGeneration(ROOMS[0]);
+    g_roomStatusCache.Store(ROOMS[0], 0, Payload("0"), 1, generation);
+    CHECK(CachedState(ROOMS[0], &state));
+    CHECK_EQ(state, '0');
+
+    // Komanda između predaje i odgovora: odgovor se odbacuje
+    generation = g_roomStatusCache.GetGeneration(ROOMS[0]);
+    g_roomStatusCache.Invalidate(ROOMS[0]);
+    g_roomStatusCache.Store(ROOMS[0], 0, Payload("0"), 1, generation);
+    CHECK(!CachedState(ROOMS[0], &state));
+
+    // Čitanje predato nakon komande se upisuje
+    generation = g_roomStatusCache.GetGeneration(ROOMS[0]);
+    g_roomStatusCache.Store(ROOMS[0], 0, Payload("1"), 1, generation);
+    CHECK(CachedState(ROOMS[0], &state));
+    CHECK_EQ(state, '1');
+}
+
+static void TestBroadcastInvalidatesAll()
+{
+    g_roomStatusCache.Build(ROOMS, ROOM_COUNT, NULL, 0);
+    uint16_t generations[ROOM_COUNT];
+    for (uint16_t i = 0; i < ROOM_COUNT; i++) {
+        generations[i] = g_roomStatusCache.GetGeneration(ROOMS[i]);
+    }
+
+    // Adresa van indeksa (grupna, broadcast) pomjera generaciju svih soba
+    g_roomStatusCache.Invalidate(0xFFFF);
+    char state = 0;
+    for (uint16_t i = 0; i < ROOM_COUNT; i++)
+    {
+        g_roomStatusCache.Store(ROOMS[i], 0, Payload("0"), 1, generations[i]);
+        CHECK(!CachedState(ROOMS[i], &state));
+    }
+}
+
+// ============================================================================
+// Asinhroni cst uz komandu dok je čitanje na liniji
+// ============================================================================
+
+static uint16_t BuildResponse(uint16_t address, uint8_t cmd, char data, uint8_t* rx)
+{
+    uint16_t iface = g_appConfig.rs485_iface_addr;
+    uint16_t checksum = (uint16_t)(cmd + (uint8_t)data);
+    uint16_t n = 0;
+    rx[n++] = SOH;
+    rx[n++] = (uint8_t)(iface >> 8);
+    rx[n++] = (uint8_t)iface;
+    rx[n++] = (uint8_t)(address >> 8);
+    rx[n++] = (uint8_t)address;
+    rx[n++] = 2;
+    rx[n++] = cmd;
+    rx[n++] = (uint8_t)data;
+    rx[n++] = (uint8_t)(checksum >> 8);
+    rx[n++] = (uint8_t)checksum;
+    rx[n++] = EOT;
+    return n;
+}
+
+static uint16_t RoomResponder(void*, uint8_t, const uint8_t* tx, uint16_t tx_length, uint8_t* rx, uint16_t)
+{
+    if (tx_length < 7) return 0;
+    uint16_t address = (uint16_t)((tx[1] << 8) | tx[2]);
+    uint8_t cmd = tx[6];
+
+    if (cmd == GET_APPL_STAT)
+    {
+        // Stanje se čita kada upit stigne, odgovor kasni dok test ne pusti sobu
+        char state = s_room_state;
+        s_status_on_wire = true;
+        while (s_hold_status) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return BuildResponse(address, cmd, state, rx);
+    }
+    if (cmd == SET_APPL_STAT)
+    {
+        s_room_state = '1';
+        return BuildResponse(address, cmd, 'A', rx);
+    }
+    return 0;
+}
+
+static int WaitQuery(HttpQuery* query)
+{
+    int result;
+    while ((result = g_httpQueryManager.PollQuery(query)) == HTTP_QUERY_PENDING) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return result;
+}
+
+static void TestQueryInFlightDuringCommand()
+{
+    g_roomStatusCache.Build(ROOMS, ROOM_COUNT, NULL, 0);
+    s_room_state = '0';
+    s_hold_status = true;
+    s_status_on_wire = false;
+
+    HttpCommand status = {};
+    status.cmd_id = GET_APPL_STAT;
+    status.address = ROOMS[0];
+    HttpQuery* status_query = g_httpQueryManager.BeginQuery(&status);
+    CHECK(status_query != NULL);
+    if (status_query == NULL) return;
+    while (!s_status_on_wire) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    // stg se predaje dok soba još odgovara starim stanjem
+    HttpCommand command = {};
+    command.cmd_id = SET_APPL_STAT;
+    command.address = ROOMS[0];
+    HttpQuery* command_query = g_httpQueryManager.BeginQuery(&command);
+    CHECK(command_query != NULL);
+    s_hold_status = false;
+
+    CHECK(WaitQuery(status_query) > 0);
+    CHECK_EQ(status_query->response[0], (uint8_t)'0');
+    g_httpQueryManager.ReleaseQuery(status_query);
+    if (command_query != NULL)
+    {
+        CHECK(WaitQuery(command_query) > 0);
+        g_httpQueryManager.ReleaseQuery(command_query);
+    }
+
+    // Stari odgovor nije ušao u keš - max_age upit ide na bus
+    char state = 0;
+    CHECK(!CachedState(ROOMS[0], &state));
+
+    // Novi cst vidi stanje poslije komande i puni keš
+    HttpQuery* fresh = g_httpQueryManager.BeginQuery(&status);
+    CHECK(fresh != NULL);
+    if (fresh == NULL) return;
+    CHECK(WaitQuery(fresh) > 0);
+    g_httpQueryManager.ReleaseQuery(fresh);
+    CHECK(CachedState(ROOMS[0], &state));
+    CHECK_EQ(state, '1');
+}
+
+int main()
+{
+    g_appConfig.enable_dual_bus_mode = false;
+    g_appConfig.rs485_iface_addr = 0x0001;
+    g_appConfig.protocol_version_L = (uint8_t)ProtocolVersion::BJELASNICA;
+    g_appConfig.protocol_version_R = (uint8_t)ProtocolVersion::BJELASNICA;
+
+    g_rs485Service.Initialize();
+    g_rs485BusOwner.Initialize(&g_rs485Service);
+    g_rs485BusOwner.StartTask();
+    g_httpQueryManager.Initialize(&g_rs485BusOwner);
+    g_simRs485Bus.responder = RoomResponder;
+
+    RUN_TEST(TestStaleStoreDropped);
+    RUN_TEST(TestBroadcastInvalidatesAll);
+    RUN_TEST(TestQueryInFlightDuringCommand);
+    return HOST_TEST_RESULT();
+}
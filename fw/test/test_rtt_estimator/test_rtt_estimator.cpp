@@ -0,0 +1,151 @@
+/**
+ ******************************************************************************
+ * @file    test_rtt_estimator.cpp
+ * @author  Gemini & [Vase Ime]
+ * @brief   Host test RTT procjene (RttEstimator, RttTable).
+ *
+ * @note
+ * Očekivane vrijednosti su izračunate ručno po formulama iz RttEstimator.cpp
+ * (cjelobrojno, kao na uređaju): SRTT/RTTVAR nakon uzoraka, RTO sa donjom
+ * granicom varijanse i marginom, ograničenje na [RTT_MIN_TIMEOUT_MS, max_ms],
+ * udvostručavanje timeout-a ponovljenog pokušaja (Karn) i zbirna procjena za
+ * uređaje bez uzoraka.
+ ******************************************************************************
+ */
+
+#include "host_test.h"
+#include "RttEstimator.h"
+
+static const uint32_t MAX_MS = RS485_RESP_TOUT_MS;
+
+static void TestFirstSample()
+{
+    RttEstimator rtt;
+    CHECK(!rtt.HasSamples());
+    CHECK_EQ(rtt.GetTimeoutMs(MAX_MS), MAX_MS);
+
+    // SRTT = R, RTTVAR = R/2; RTO = 2000 + 4*1000 us -> 6 ms + margina
+    rtt.AddSample(2000);
+    CHECK_EQ(rtt.GetSrttUs(), 2000u);
+    CHECK_EQ(rtt.GetRttvarUs(), 1000u);
+    CHECK_EQ(rtt.GetRtoMs(), 6u + RTT_TIMEOUT_MARGIN_MS);
+}
+
+static void TestSmoothing()
+{
+    RttEstimator rtt;
+    rtt.AddSample(2000);
+
+    // Sporiji odgovor: RTTVAR = 1000 - 250 + 2000/4, SRTT = 2000 + 2000/8
+    rtt.AddSample(4000);
+    CHECK_EQ(rtt.GetRttvarUs(), 1250u);
+    CHECK_EQ(rtt.GetSrttUs(), 2250u);
+    CHECK_EQ(rtt.GetRtoMs(), 8u + RTT_TIMEOUT_MARGIN_MS);   // 2250 + 5000 us, zaokruženo naviše
+
+    // Brži odgovor (negativna greška): RTTVAR = 1250 - 312 + 2000/4, SRTT = 2250 - 2000/8
+    rtt.AddSample(250);
+    CHECK_EQ(rtt.GetRttvarUs(), 1438u);
+    CHECK_EQ(rtt.GetSrttUs(), 2000u);
+    CHECK_EQ(rtt.GetSamples(), 3u);
+}
+
+static void TestClamping()
+{
+    // Vrlo brz uređaj: varijansa najmanje jedan tick, timeout najmanje RTT_MIN_TIMEOUT_MS
+    RttEstimator fast;
+    fast.AddSample(100);
+    CHECK_EQ(fast.GetRtoMs(), 2u + RTT_TIMEOUT_MARGIN_MS);  // 100 + 1000 us
+    CHECK_EQ(fast.GetTimeoutMs(MAX_MS), (uint32_t)RTT_MIN_TIMEOUT_MS);
+
+    // Spor uređaj: timeout ne prelazi fiksni timeout protokola
+    RttEstimator slow;
+    slow.AddSample(60000);
+    CHECK(slow.GetRtoMs() > MAX_MS);
+    CHECK_EQ(slow.GetTimeoutMs(MAX_MS), MAX_MS);
+}
+
+static void TestKarnBackoff()
+{
+    RttEstimator rtt;
+    rtt.AddSample(2000);
+    rtt.AddSample(4000);
+    uint32_t base = rtt.GetTimeoutMs(MAX_MS);
+    CHECK_EQ(base, 10u);
+
+    // Ponovljeni pokušaj: timeout se udvostručuje do fiksnog timeout-a
+    CHECK_EQ(rtt.GetTimeoutMs(MAX_MS, 1), 2 * base);
+    CHECK_EQ(rtt.GetTimeoutMs(MAX_MS, 2), 4 * base);
+    CHECK_EQ(rtt.GetTimeoutMs(MAX_MS, 3), MAX_MS);
+    CHECK_EQ(rtt.GetTimeoutMs(MAX_MS, 255), MAX_MS);
+
+    // Timeout ne mijenja procjenu (odgovor ponovljenog pokušaja se ne uzorkuje)
+    rtt.AddTimeout();
+    rtt.AddTimeout();
+    CHECK_EQ(rtt.GetTimeouts(), 2u);
+    CHECK_EQ(rtt.GetSrttUs(), 2250u);
+    CHECK_EQ(rtt.GetRttvarUs(), 1250u);
+    CHECK_EQ(rtt.GetTimeoutMs(MAX_MS), base);
+}
+
+static void TestSaturation()
+{
+    RttEstimator rtt;
+    for (uint32_t i = 0; i < 70000; i++) {
+        rtt.AddSample(3000);
+        rtt.AddTimeout();
+    }
+    CHECK_EQ(rtt.GetSamples(), 0xFFFFu);
+    CHECK_EQ(rtt.GetTimeouts(), 0xFFFFu);
+    CHECK_EQ(rtt.GetSrttUs(), 3000u);
+}
+
+static void TestTableUnseenDevice()
+{
+    static RttTable table;
+    const uint16_t DEAD = 0x0999;
+
+    // Bez dovoljno zbirnih uzoraka nepoznat uređaj dobija fiksni timeout
+    for (uint16_t i = 0; i < RTT_MIN_AGGREGATE_SAMPLES - 1; i++) {
+        table.AddSample((uint16_t)(0x0100 + i), 2000);
+    }
+    table.AddTimeout(DEAD);
+    CHECK_EQ(table.GetTimeoutMs(DEAD, MAX_MS), MAX_MS);
+
+    // Zbirno: SRTT 2000 us, RTTVAR opada ispod jednog tick-a -> RTO 5 ms -> 8 ms,
+    // pa x RTT_UNSEEN_FACTOR. Uređaj koji samo ne odgovara ostaje na zbirnoj procjeni.
+    table.AddSample((uint16_t)(0x0100 + RTT_MIN_AGGREGATE_SAMPLES), 2000);
+    CHECK_EQ(table.GetTimeoutMs(DEAD, MAX_MS), (uint32_t)RTT_MIN_TIMEOUT_MS * RTT_UNSEEN_FACTOR);
+    CHECK_EQ(table.GetTimeoutMs(DEAD, MAX_MS, 1), (uint32_t)RTT_MIN_TIMEOUT_MS * 2 * RTT_UNSEEN_FACTOR);
+    // Granica se primjenjuje na zbirnu procjenu (max_ms / faktor), pa tek onda faktor
+    CHECK_EQ(table.GetTimeoutMs(DEAD, MAX_MS, 2), (MAX_MS / RTT_UNSEEN_FACTOR) * RTT_UNSEEN_FACTOR);
+
+    // Uređaj sa uzorcima koristi svoju procjenu
+    const uint16_t SLOW = 0x0777;
+    table.AddSample(SLOW, 10000);
+    CHECK_EQ(table.GetTimeoutMs(SLOW, MAX_MS), 10u + 20u + RTT_TIMEOUT_MARGIN_MS);   // 10000 + 4*5000 us
+}
+
+static void TestTableCollisions()
+{
+    static RttTable table;
+
+    // Adrese sa istim hash-om (address % RTT_TABLE_SIZE) dobijaju svaka svoj slot
+    const uint16_t A = 0x0010;
+    const uint16_t B = (uint16_t)(A + RTT_TABLE_SIZE);
+    table.AddSample(A, 100);
+    table.AddSample(B, 20000);
+    CHECK_EQ(table.GetTimeoutMs(A, MAX_MS), (uint32_t)RTT_MIN_TIMEOUT_MS);
+    CHECK_EQ(table.GetTimeoutMs(B, MAX_MS), MAX_MS);
+}
+
+int main()
+{
+    RUN_TEST(TestFirstSample);
+    RUN_TEST(TestSmoothing);
+    RUN_TEST(TestClamping);
+    RUN_TEST(TestKarnBackoff);
+    RUN_TEST(TestSaturation);
+    RUN_TEST(TestTableUnseenDevice);
+    RUN_TEST(TestTableCollisions);
+    return HOST_TEST_RESULT();
+}